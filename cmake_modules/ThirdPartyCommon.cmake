@@ -0,0 +1,10 @@
+# Sources shared by several drivers live in the top level common directory.
+#
+# The path is resolved relative to this module so it works both from the source tree
+# and from per-driver package builds, where cmake_modules and common are copied next
+# to the driver sources (see make_deb_pkgs).
+#
+# Defines THIRDPARTY_COMMON_DIR and adds it to the include path.
+
+get_filename_component(THIRDPARTY_COMMON_DIR "${CMAKE_CURRENT_LIST_DIR}/../common" ABSOLUTE)
+include_directories(${THIRDPARTY_COMMON_DIR})
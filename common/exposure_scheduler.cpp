@@ -0,0 +1,199 @@
+/*
+    Exposure completion scheduler shared by the camera drivers
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "exposure_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <time.h>
+
+ExposureScheduler::ExposureScheduler(const Config &config)
+    : mConfig(config)
+{ }
+
+void ExposureScheduler::setConfig(const Config &config)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mConfig = config;
+}
+
+double ExposureScheduler::threadCpuTime()
+{
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return 0;
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+bool ExposureScheduler::sleepUntil(Clock::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mWake.wait_until(lock, deadline, [this]
+    {
+        return mCancelled;
+    });
+    return !mCancelled;
+}
+
+void ExposureScheduler::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCancelled = true;
+    }
+    mWake.notify_all();
+}
+
+ExposureScheduler::Timing ExposureScheduler::timing() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mTiming;
+}
+
+ExposureScheduler::Outcome ExposureScheduler::wait(double duration, const StatusFunction &status,
+        const ProgressFunction &progress, const std::atomic_bool &isAboutToQuit)
+{
+    Config config;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCancelled = false;
+        mTiming = Timing();
+        config = mConfig;
+    }
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + std::chrono::microseconds(static_cast<int64_t>(duration * 1e6));
+    const bool fastPhase = config.fastPollLead.count() > 0;
+    const Clock::time_point sleepEnd = fastPhase ? end - config.fastPollLead : end;
+    const double cpuStart = threadCpuTime();
+    int errors = 0;
+
+    auto finish = [&](Outcome outcome)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTiming.latency = std::chrono::duration<double, std::milli>(Clock::now() - end).count();
+        mTiming.cpuTime = threadCpuTime() - cpuStart;
+        if (outcome == OUTCOME_DONE)
+            mReadoutEstimate = mReadoutEstimate > 0 ? 0.7 * mReadoutEstimate + 0.3 * mTiming.latency : mTiming.latency;
+        return outcome;
+    };
+
+    // Sleep through the exposure, waking on whole second boundaries of the time left
+    // so the countdown stays neat, and check for early failures while at it.
+    while (true)
+    {
+        double timeLeft = std::chrono::duration<double>(end - Clock::now()).count();
+        if (Clock::now() >= sleepEnd)
+            break;
+
+        Clock::time_point wakeUp = sleepEnd;
+        if (timeLeft > 1.1)
+        {
+            double fraction = std::max(timeLeft - std::trunc(timeLeft), 0.005);
+            wakeUp = std::min(sleepEnd, Clock::now() + std::chrono::microseconds(static_cast<int64_t>(fraction * 1e6)));
+            timeLeft = std::round(timeLeft);
+        }
+
+        if (progress)
+            progress(timeLeft);
+
+        if (!sleepUntil(wakeUp) || isAboutToQuit)
+            return finish(OUTCOME_ABORTED);
+
+        if (wakeUp < sleepEnd)
+        {
+            switch (status())
+            {
+                case STATUS_FAILED:
+                    return finish(OUTCOME_FAILED);
+                case STATUS_DONE:
+                    return finish(OUTCOME_DONE);
+                case STATUS_ERROR:
+                    if (++errors >= config.maxErrors)
+                        return finish(OUTCOME_ERROR);
+                    break;
+                case STATUS_WORKING:
+                    errors = 0;
+                    break;
+            }
+        }
+    }
+
+    // Exposure is over. Skip most of the readout time seen so far, then poll for the
+    // frame with exponential backoff. In the fast poll phase the camera is polled at a
+    // fixed short interval from fastPollLead before to fastPollLead after the end of the
+    // exposure instead, and with backoff from there on.
+    double readoutEstimate;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        readoutEstimate = mReadoutEstimate;
+    }
+    if (!fastPhase && readoutEstimate > 0
+            && !sleepUntil(end + std::chrono::microseconds(static_cast<int64_t>(readoutEstimate * 800))))
+        return finish(OUTCOME_ABORTED);
+
+    if (fastPhase && progress)
+        progress(std::max(0.0, std::chrono::duration<double>(end - Clock::now()).count()));
+
+    const Clock::time_point fastEnd = end + config.fastPollLead;
+    bool fast = fastPhase;
+    std::chrono::microseconds interval = fast ? config.fastPoll : config.minPoll;
+    while (true)
+    {
+        if (isAboutToQuit)
+            return finish(OUTCOME_ABORTED);
+
+        Status current = status();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTiming.polls++;
+        }
+
+        switch (current)
+        {
+            case STATUS_DONE:
+                return finish(OUTCOME_DONE);
+            case STATUS_FAILED:
+                return finish(OUTCOME_FAILED);
+            case STATUS_ERROR:
+                if (++errors >= config.maxErrors)
+                    return finish(OUTCOME_ERROR);
+                break;
+            case STATUS_WORKING:
+                errors = 0;
+                break;
+        }
+
+        if (config.readoutTimeout.count() > 0 && Clock::now() - end > config.readoutTimeout)
+            return finish(OUTCOME_TIMEOUT);
+
+        if (!sleepUntil(Clock::now() + interval))
+            return finish(OUTCOME_ABORTED);
+
+        if (fast && Clock::now() >= fastEnd)
+        {
+            fast = false;
+            interval = config.minPoll;
+        }
+        else if (!fast)
+            interval = std::min(config.maxPoll,
+                                std::chrono::microseconds(static_cast<int64_t>(interval.count() * config.backoff)));
+    }
+}
@@ -0,0 +1,126 @@
+/*
+    Exposure completion scheduler shared by the camera drivers
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+/**
+ * @brief Waits for the end of a camera exposure without busy polling.
+ *
+ * The calling thread sleeps on a condition variable until the predicted end of the
+ * exposure, waking once per second to report the time left and to let the camera
+ * report an early failure. Once the exposure should be over, the camera status is
+ * polled with an exponential backoff until the frame is ready. Polling starts a little
+ * before the readout time observed on previous exposures has elapsed, so the backoff
+ * does not overshoot cameras with a long readout.
+ *
+ * Cameras that must be polled quickly around the end of the exposure can ask for a
+ * fast poll phase instead: from fastPollLead before to fastPollLead after the predicted
+ * end, the status is polled every fastPoll without backoff. A frame that is not ready by
+ * then is polled for with the usual backoff from minPoll up to maxPoll.
+ *
+ * The observed completion latency (from predicted end to detection) and the CPU time
+ * spent by the waiting thread are recorded for every exposure.
+ */
+class ExposureScheduler
+{
+    public:
+        enum Status
+        {
+            STATUS_WORKING,     // exposure or readout still in progress
+            STATUS_DONE,        // frame ready for download
+            STATUS_FAILED,      // camera reported a failed exposure
+            STATUS_ERROR        // status could not be read, will be retried
+        };
+
+        enum Outcome
+        {
+            OUTCOME_DONE,
+            OUTCOME_FAILED,
+            OUTCOME_ERROR,      // too many consecutive status errors
+            OUTCOME_ABORTED,    // cancel() was called or the quit flag was raised
+            OUTCOME_TIMEOUT     // frame not ready within the readout timeout
+        };
+
+        struct Config
+        {
+            std::chrono::microseconds minPoll {std::chrono::milliseconds(1)};
+            std::chrono::microseconds maxPoll {std::chrono::milliseconds(20)};
+            double backoff {1.5};
+            int maxErrors {10};
+            std::chrono::milliseconds readoutTimeout {0};   // 0 waits forever
+            std::chrono::milliseconds fastPollLead {0};     // fast poll window around the end, 0 disables it
+            std::chrono::microseconds fastPoll {std::chrono::milliseconds(1)};
+        };
+
+        struct Timing
+        {
+            double latency {0};     // ms between predicted end of exposure and detection
+            double cpuTime {0};     // ms of CPU used by the waiting thread
+            int polls {0};          // status checks done after the predicted end or in the fast poll phase
+        };
+
+        using StatusFunction   = std::function<Status()>;
+        using ProgressFunction = std::function<void(double timeLeft)>;
+
+    public:
+        ExposureScheduler() = default;
+        explicit ExposureScheduler(const Config &config);
+
+        void setConfig(const Config &config);
+
+        /**
+         * @brief Wait for an exposure started just before this call.
+         * @param duration exposure duration in seconds
+         * @param status reads the camera status, called roughly once per second during the
+         * exposure and with backoff afterwards
+         * @param progress receives the time left, rounded to whole seconds above one second
+         * @param isAboutToQuit checked on every wake up
+         */
+        Outcome wait(double duration, const StatusFunction &status, const ProgressFunction &progress,
+                     const std::atomic_bool &isAboutToQuit);
+
+        /** Wake the waiting thread and make wait() return OUTCOME_ABORTED. */
+        void cancel();
+
+        /** Timing of the last exposure waited for. */
+        Timing timing() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        /** Sleep until deadline. Returns false if cancelled. */
+        bool sleepUntil(Clock::time_point deadline);
+
+        static double threadCpuTime();
+
+        Config mConfig;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mWake;
+        bool mCancelled {false};
+        Timing mTiming;
+        double mReadoutEstimate {0};    // ms, smoothed latency of successful exposures
+};
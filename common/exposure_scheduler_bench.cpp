@@ -0,0 +1,145 @@
+/*
+    Exposure completion scheduler benchmark
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Compares ExposureScheduler with the sleep/spin polling loop the drivers used before,
+    against a simulated camera whose frame becomes ready after the exposure plus a readout delay.
+
+    Usage: exposure_scheduler_bench [readout ms] [exposures per duration]
+*/
+
+#include "exposure_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+// Simulated SDK: exposure status flips to done after duration + readout
+class SimulatedCamera
+{
+    public:
+        explicit SimulatedCamera(double readoutMs) : mReadoutMs(readoutMs) {}
+
+        void startExposure(double duration)
+        {
+            mReady = Clock::now() + std::chrono::microseconds(static_cast<int64_t>((duration * 1000 + mReadoutMs) * 1000));
+        }
+
+        bool isReady() const
+        {
+            return Clock::now() >= mReady;
+        }
+
+        Clock::time_point readyTime() const
+        {
+            return mReady;
+        }
+
+    private:
+        double mReadoutMs;
+        Clock::time_point mReady;
+};
+
+static double threadCpuMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// The polling loop from the ASI driver before ExposureScheduler
+static void legacyWait(SimulatedCamera &camera, double duration)
+{
+    Clock::time_point start = Clock::now();
+    bool done = false;
+    do
+    {
+        float delay = 0.1;
+        float timeLeft = std::max(duration - std::chrono::duration<double>(Clock::now() - start).count(), 0.0);
+
+        if (timeLeft > 1.1)
+            delay = std::max(timeLeft - std::trunc(timeLeft), 0.005f);
+
+        if (timeLeft < 0.2)
+        {
+            int i = 0;
+            do
+            {
+                done = camera.isReady();
+                usleep(1000);
+                i++;
+            }
+            while (i < 300 && !done);
+        }
+        else
+        {
+            usleep(delay * 1000 * 1000);
+            done = camera.isReady();
+        }
+    }
+    while (!done);
+}
+
+int main(int argc, char *argv[])
+{
+    double readoutMs = argc > 1 ? atof(argv[1]) : 30;
+    int count = argc > 2 ? atoi(argv[2]) : 5;
+    const double durations[] = {0.001, 0.01, 0.1, 0.5, 2.0};
+
+    SimulatedCamera camera(readoutMs);
+    ExposureScheduler scheduler;
+    std::atomic_bool quit {false};
+
+    printf("Simulated readout: %.1f ms, %d exposures per duration\n\n", readoutMs, count);
+    printf("%10s | %22s | %22s\n", "", "legacy polling", "scheduler");
+    printf("%10s | %10s %11s | %10s %11s\n", "exposure", "late (ms)", "cpu (ms)", "late (ms)", "cpu (ms)");
+
+    for (double duration : durations)
+    {
+        double legacyLate = 0, legacyCpu = 0, late = 0, cpu = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            camera.startExposure(duration);
+            double cpuStart = threadCpuMs();
+            legacyWait(camera, duration);
+            legacyLate += std::chrono::duration<double, std::milli>(Clock::now() - camera.readyTime()).count();
+            legacyCpu  += threadCpuMs() - cpuStart;
+
+            camera.startExposure(duration);
+            scheduler.wait(duration, [&]
+            {
+                return camera.isReady() ? ExposureScheduler::STATUS_DONE : ExposureScheduler::STATUS_WORKING;
+            }, nullptr, quit);
+            late += std::chrono::duration<double, std::milli>(Clock::now() - camera.readyTime()).count();
+            cpu  += scheduler.timing().cpuTime;
+        }
+
+        printf("%9.3fs | %10.2f %11.3f | %10.2f %11.3f\n", duration,
+               legacyLate / count, legacyCpu / count, late / count, cpu / count);
+    }
+
+    return 0;
+}
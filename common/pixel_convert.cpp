@@ -0,0 +1,580 @@
+/*
+    Pixel conversion kernels shared by the camera drivers
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "pixel_convert.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PIXEL_CONVERT_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXEL_CONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+namespace PixelConvert
+{
+
+namespace
+{
+
+// Position of the source channel that ends up in output channel c.
+inline int sourceChannel(int c, bool swapRB)
+{
+    if (!swapRB)
+        return c;
+    return c == 0 ? 2 : (c == 2 ? 0 : c);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Scalar kernels
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename T, int C>
+void swapRedBlueScalar(T *data, size_t pixels)
+{
+    for (size_t i = 0; i < pixels; i++, data += C)
+    {
+        T tmp   = data[0];
+        data[0] = data[2];
+        data[2] = tmp;
+    }
+}
+
+template <typename T, int C>
+void toPlanarScalar(const T *src, T *dst, size_t pixels, size_t planeSize, bool swapRB)
+{
+    T *p0 = dst + sourceChannel(0, swapRB) * planeSize;
+    T *p1 = dst + planeSize;
+    T *p2 = dst + sourceChannel(2, swapRB) * planeSize;
+    T *p3 = (C == 4) ? dst + 3 * planeSize : nullptr;
+
+    for (const T *end = src + pixels * C; src != end; src += C)
+    {
+        *p0++ = src[0];
+        *p1++ = src[1];
+        *p2++ = src[2];
+        if (C == 4)
+            *p3++ = src[3];
+    }
+}
+
+void swapRedBlueScalar(uint8_t *data, size_t pixels, int channels, int sampleBytes)
+{
+    if (sampleBytes == 2)
+    {
+        if (channels == 4)
+            swapRedBlueScalar<uint16_t, 4>(reinterpret_cast<uint16_t *>(data), pixels);
+        else
+            swapRedBlueScalar<uint16_t, 3>(reinterpret_cast<uint16_t *>(data), pixels);
+    }
+    else
+    {
+        if (channels == 4)
+            swapRedBlueScalar<uint8_t, 4>(data, pixels);
+        else
+            swapRedBlueScalar<uint8_t, 3>(data, pixels);
+    }
+}
+
+// Converts pixels [first, first + count) of the frame, planes are planeSize pixels apart.
+void toPlanarScalar(const uint8_t *src, uint8_t *dst, size_t first, size_t count, size_t planeSize,
+                    int channels, int sampleBytes, bool swapRB)
+{
+    if (sampleBytes == 2)
+    {
+        const uint16_t *s = reinterpret_cast<const uint16_t *>(src) + first * channels;
+        uint16_t *d = reinterpret_cast<uint16_t *>(dst) + first;
+        if (channels == 4)
+            toPlanarScalar<uint16_t, 4>(s, d, count, planeSize, swapRB);
+        else
+            toPlanarScalar<uint16_t, 3>(s, d, count, planeSize, swapRB);
+    }
+    else
+    {
+        const uint8_t *s = src + first * channels;
+        uint8_t *d = dst + first;
+        if (channels == 4)
+            toPlanarScalar<uint8_t, 4>(s, d, count, planeSize, swapRB);
+        else
+            toPlanarScalar<uint8_t, 3>(s, d, count, planeSize, swapRB);
+    }
+}
+
+#ifdef PIXEL_CONVERT_X86
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// x86 kernels
+///
+/// A group of 16 * channels bytes holds a whole number of pixels (16 / sampleBytes), so every
+/// conversion is a fixed byte permutation of a group. Each 16 byte output block is built by
+/// shuffling the input blocks with pshufb and or-ing the results; the masks are derived once
+/// from the same channel mapping the scalar code uses.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ShuffleTable
+{
+    int blocks;
+    alignas(16) uint8_t mask[4][4][16];   // [output block][input block][byte]
+};
+
+enum Operation
+{
+    OP_SWAP,
+    OP_PLANAR_RGB,
+    OP_PLANAR_BGR,
+    OP_COUNT
+};
+
+void buildTable(ShuffleTable &table, Operation op, int channels, int sampleBytes)
+{
+    const int pixelBytes = channels * sampleBytes;
+    table.blocks = channels;
+    memset(table.mask, 0x80, sizeof(table.mask));
+
+    for (int out = 0; out < channels; out++)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            int from;
+            if (op == OP_SWAP)
+            {
+                int j = out * 16 + i;
+                int pixel = j / pixelBytes, channel = (j % pixelBytes) / sampleBytes, byte = j % sampleBytes;
+                from = pixel * pixelBytes + sourceChannel(channel, true) * sampleBytes + byte;
+            }
+            else
+            {
+                // Output block 'out' is 16 bytes of plane 'out'
+                int pixel = i / sampleBytes, byte = i % sampleBytes;
+                from = pixel * pixelBytes + sourceChannel(out, op == OP_PLANAR_BGR) * sampleBytes + byte;
+            }
+            table.mask[out][from / 16][i] = static_cast<uint8_t>(from % 16);
+        }
+    }
+}
+
+const ShuffleTable &shuffleTable(Operation op, int channels, int sampleBytes)
+{
+    struct Tables
+    {
+        ShuffleTable table[OP_COUNT][2][2];   // [op][channels == 4][sampleBytes == 2]
+        Tables()
+        {
+            for (int op = 0; op < OP_COUNT; op++)
+                for (int c = 0; c < 2; c++)
+                    for (int s = 0; s < 2; s++)
+                        buildTable(table[op][c][s], static_cast<Operation>(op), c ? 4 : 3, s ? 2 : 1);
+        }
+    };
+    static const Tables tables;
+    return tables.table[op][channels == 4][sampleBytes == 2];
+}
+
+// Output block b of group g is stored at out[b] + g * outStride
+template <int blocks>
+__attribute__((target("ssse3")))
+void permuteSSSE3(const uint8_t *src, uint8_t *const out[4], size_t outStride, size_t groups, const ShuffleTable &table)
+{
+    __m128i mask[4][4];
+    for (int o = 0; o < blocks; o++)
+        for (int i = 0; i < blocks; i++)
+            mask[o][i] = _mm_load_si128(reinterpret_cast<const __m128i *>(table.mask[o][i]));
+
+    for (size_t g = 0; g < groups; g++, src += blocks * 16)
+    {
+        __m128i in[4];
+        for (int i = 0; i < blocks; i++)
+            in[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 16));
+
+        for (int o = 0; o < blocks; o++)
+        {
+            __m128i v = _mm_shuffle_epi8(in[0], mask[o][0]);
+            for (int i = 1; i < blocks; i++)
+                v = _mm_or_si128(v, _mm_shuffle_epi8(in[i], mask[o][i]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out[o] + g * outStride), v);
+        }
+    }
+}
+
+// Same as permuteSSSE3, two groups at a time: one per 128 bit lane.
+template <int blocks>
+__attribute__((target("avx2")))
+void permuteAVX2(const uint8_t *src, uint8_t *const out[4], size_t outStride, size_t groups, const ShuffleTable &table)
+{
+    const size_t groupBytes = blocks * 16;
+    __m256i mask[4][4];
+    for (int o = 0; o < blocks; o++)
+        for (int i = 0; i < blocks; i++)
+            mask[o][i] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(table.mask[o][i])));
+
+    size_t g = 0;
+    for (; g + 2 <= groups; g += 2, src += 2 * groupBytes)
+    {
+        __m256i in[4];
+        for (int i = 0; i < blocks; i++)
+        {
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 16));
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + groupBytes + i * 16));
+            in[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        }
+
+        for (int o = 0; o < blocks; o++)
+        {
+            __m256i v = _mm256_shuffle_epi8(in[0], mask[o][0]);
+            for (int i = 1; i < blocks; i++)
+                v = _mm256_or_si256(v, _mm256_shuffle_epi8(in[i], mask[o][i]));
+
+            uint8_t *dst = out[o] + g * outStride;
+            if (outStride == 16)
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), v);
+            else
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm256_castsi256_si128(v));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + outStride), _mm256_extracti128_si256(v, 1));
+            }
+        }
+    }
+
+    if (g < groups)
+    {
+        uint8_t *tail[4];
+        for (int o = 0; o < blocks; o++)
+            tail[o] = out[o] + g * outStride;
+        permuteSSSE3<blocks>(src, tail, outStride, groups - g, table);
+    }
+}
+
+void permute(Backend backend, const uint8_t *src, uint8_t *const out[4], size_t outStride, size_t groups,
+             const ShuffleTable &table)
+{
+    if (backend == BACKEND_AVX2)
+    {
+        if (table.blocks == 4)
+            permuteAVX2<4>(src, out, outStride, groups, table);
+        else
+            permuteAVX2<3>(src, out, outStride, groups, table);
+    }
+    else
+    {
+        if (table.blocks == 4)
+            permuteSSSE3<4>(src, out, outStride, groups, table);
+        else
+            permuteSSSE3<3>(src, out, outStride, groups, table);
+    }
+}
+
+// Returns the number of pixels converted, the caller finishes the tail with scalar code.
+size_t swapRedBlueX86(Backend backend, uint8_t *data, size_t pixels, int channels, int sampleBytes)
+{
+    const size_t groupPixels = 16 / sampleBytes;
+    const size_t groups = pixels / groupPixels;
+    const ShuffleTable &table = shuffleTable(OP_SWAP, channels, sampleBytes);
+
+    uint8_t *out[4];
+    for (int o = 0; o < channels; o++)
+        out[o] = data + o * 16;
+
+    permute(backend, data, out, channels * 16, groups, table);
+
+    return groups * groupPixels;
+}
+
+size_t toPlanarX86(Backend backend, const uint8_t *src, uint8_t *dst, size_t pixels, int channels, int sampleBytes,
+                   bool swapRB)
+{
+    const size_t groupPixels = 16 / sampleBytes;
+    const size_t groups = pixels / groupPixels;
+    const ShuffleTable &table = shuffleTable(swapRB ? OP_PLANAR_BGR : OP_PLANAR_RGB, channels, sampleBytes);
+
+    uint8_t *out[4];
+    for (int o = 0; o < channels; o++)
+        out[o] = dst + o * pixels * sampleBytes;
+
+    permute(backend, src, out, 16, groups, table);
+
+    return groups * groupPixels;
+}
+#endif
+
+#ifdef PIXEL_CONVERT_NEON
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// NEON kernels, using the structured load/store instructions.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t swapRedBlueNEON(uint8_t *data, size_t pixels, int channels, int sampleBytes)
+{
+    size_t i = 0;
+    if (sampleBytes == 1 && channels == 3)
+    {
+        for (; i + 16 <= pixels; i += 16, data += 48)
+        {
+            uint8x16x3_t v = vld3q_u8(data);
+            uint8x16_t t = v.val[0];
+            v.val[0] = v.val[2];
+            v.val[2] = t;
+            vst3q_u8(data, v);
+        }
+    }
+    else if (sampleBytes == 1)
+    {
+        for (; i + 16 <= pixels; i += 16, data += 64)
+        {
+            uint8x16x4_t v = vld4q_u8(data);
+            uint8x16_t t = v.val[0];
+            v.val[0] = v.val[2];
+            v.val[2] = t;
+            vst4q_u8(data, v);
+        }
+    }
+    else if (channels == 3)
+    {
+        uint16_t *p = reinterpret_cast<uint16_t *>(data);
+        for (; i + 8 <= pixels; i += 8, p += 24)
+        {
+            uint16x8x3_t v = vld3q_u16(p);
+            uint16x8_t t = v.val[0];
+            v.val[0] = v.val[2];
+            v.val[2] = t;
+            vst3q_u16(p, v);
+        }
+    }
+    else
+    {
+        uint16_t *p = reinterpret_cast<uint16_t *>(data);
+        for (; i + 8 <= pixels; i += 8, p += 32)
+        {
+            uint16x8x4_t v = vld4q_u16(p);
+            uint16x8_t t = v.val[0];
+            v.val[0] = v.val[2];
+            v.val[2] = t;
+            vst4q_u16(p, v);
+        }
+    }
+    return i;
+}
+
+size_t toPlanarNEON(const uint8_t *src, uint8_t *dst, size_t pixels, int channels, int sampleBytes, bool swapRB)
+{
+    const int r = swapRB ? 2 : 0, b = swapRB ? 0 : 2;
+    size_t i = 0;
+
+    if (sampleBytes == 1)
+    {
+        uint8_t *plane[4];
+        for (int c = 0; c < channels; c++)
+            plane[c] = dst + c * pixels;
+
+        if (channels == 3)
+        {
+            for (; i + 16 <= pixels; i += 16, src += 48)
+            {
+                uint8x16x3_t v = vld3q_u8(src);
+                vst1q_u8(plane[0] + i, v.val[r]);
+                vst1q_u8(plane[1] + i, v.val[1]);
+                vst1q_u8(plane[2] + i, v.val[b]);
+            }
+        }
+        else
+        {
+            for (; i + 16 <= pixels; i += 16, src += 64)
+            {
+                uint8x16x4_t v = vld4q_u8(src);
+                vst1q_u8(plane[0] + i, v.val[r]);
+                vst1q_u8(plane[1] + i, v.val[1]);
+                vst1q_u8(plane[2] + i, v.val[b]);
+                vst1q_u8(plane[3] + i, v.val[3]);
+            }
+        }
+    }
+    else
+    {
+        const uint16_t *s = reinterpret_cast<const uint16_t *>(src);
+        uint16_t *plane[4];
+        for (int c = 0; c < channels; c++)
+            plane[c] = reinterpret_cast<uint16_t *>(dst) + c * pixels;
+
+        if (channels == 3)
+        {
+            for (; i + 8 <= pixels; i += 8, s += 24)
+            {
+                uint16x8x3_t v = vld3q_u16(s);
+                vst1q_u16(plane[0] + i, v.val[r]);
+                vst1q_u16(plane[1] + i, v.val[1]);
+                vst1q_u16(plane[2] + i, v.val[b]);
+            }
+        }
+        else
+        {
+            for (; i + 8 <= pixels; i += 8, s += 32)
+            {
+                uint16x8x4_t v = vld4q_u16(s);
+                vst1q_u16(plane[0] + i, v.val[r]);
+                vst1q_u16(plane[1] + i, v.val[1]);
+                vst1q_u16(plane[2] + i, v.val[b]);
+                vst1q_u16(plane[3] + i, v.val[3]);
+            }
+        }
+    }
+    return i;
+}
+#endif
+
+Backend detectBackend()
+{
+    // Allow overriding the selection for debugging, e.g. INDI_PIXEL_CONVERT=scalar
+    const char *env = getenv("INDI_PIXEL_CONVERT");
+    if (env != nullptr)
+    {
+        for (Backend b : {BACKEND_SCALAR, BACKEND_SSSE3, BACKEND_AVX2, BACKEND_NEON})
+            if (strcmp(env, toString(b)) == 0 && isSupported(b))
+                return b;
+    }
+
+    if (isSupported(BACKEND_NEON))
+        return BACKEND_NEON;
+    if (isSupported(BACKEND_AVX2))
+        return BACKEND_AVX2;
+    if (isSupported(BACKEND_SSSE3))
+        return BACKEND_SSSE3;
+    return BACKEND_SCALAR;
+}
+
+std::atomic<int> &currentBackend()
+{
+    static std::atomic<int> current {detectBackend()};
+    return current;
+}
+
+bool isValidFormat(int channels, int sampleBytes)
+{
+    return (channels == 3 || channels == 4) && (sampleBytes == 1 || sampleBytes == 2);
+}
+
+}
+
+void swapRedBlue(uint8_t *data, size_t pixels, int channels, int sampleBytes)
+{
+    if (!isValidFormat(channels, sampleBytes))
+        return;
+
+    size_t done = 0;
+    switch (backend())
+    {
+#ifdef PIXEL_CONVERT_X86
+        case BACKEND_SSSE3:
+        case BACKEND_AVX2:
+            done = swapRedBlueX86(backend(), data, pixels, channels, sampleBytes);
+            break;
+#endif
+#ifdef PIXEL_CONVERT_NEON
+        case BACKEND_NEON:
+            done = swapRedBlueNEON(data, pixels, channels, sampleBytes);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    swapRedBlueScalar(data + done * channels * sampleBytes, pixels - done, channels, sampleBytes);
+}
+
+void interleavedToPlanar(const uint8_t *src, uint8_t *dst, size_t pixels, int channels, int sampleBytes,
+                         ChannelOrder order)
+{
+    if (!isValidFormat(channels, sampleBytes))
+        return;
+
+    const bool swapRB = (order == ORDER_BGR);
+    size_t done = 0;
+    switch (backend())
+    {
+#ifdef PIXEL_CONVERT_X86
+        case BACKEND_SSSE3:
+        case BACKEND_AVX2:
+            done = toPlanarX86(backend(), src, dst, pixels, channels, sampleBytes, swapRB);
+            break;
+#endif
+#ifdef PIXEL_CONVERT_NEON
+        case BACKEND_NEON:
+            done = toPlanarNEON(src, dst, pixels, channels, sampleBytes, swapRB);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    toPlanarScalar(src, dst, done, pixels - done, pixels, channels, sampleBytes, swapRB);
+}
+
+Backend backend()
+{
+    return static_cast<Backend>(currentBackend().load(std::memory_order_relaxed));
+}
+
+bool setBackend(Backend backend)
+{
+    if (!isSupported(backend))
+        return false;
+
+    currentBackend().store(backend);
+    return true;
+}
+
+bool isSupported(Backend backend)
+{
+    switch (backend)
+    {
+        case BACKEND_SCALAR:
+            return true;
+#ifdef PIXEL_CONVERT_X86
+        case BACKEND_SSSE3:
+            return __builtin_cpu_supports("ssse3");
+        case BACKEND_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef PIXEL_CONVERT_NEON
+        case BACKEND_NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+const char *toString(Backend backend)
+{
+    switch (backend)
+    {
+        case BACKEND_SCALAR:
+            return "scalar";
+        case BACKEND_SSSE3:
+            return "ssse3";
+        case BACKEND_AVX2:
+            return "avx2";
+        case BACKEND_NEON:
+            return "neon";
+    }
+    return "unknown";
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+    Pixel conversion kernels shared by the camera drivers
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Colour frame conversion kernels shared by the camera drivers.
+ *
+ * Every function works on interleaved frames of 3 (RGB/BGR) or 4 (RGBA/BGRA) channels
+ * with 8 or 16 bit samples. The implementation is picked at runtime from the best
+ * backend supported by the CPU, falling back to plain scalar loops.
+ */
+namespace PixelConvert
+{
+
+enum Backend
+{
+    BACKEND_SCALAR,
+    BACKEND_SSSE3,
+    BACKEND_AVX2,
+    BACKEND_NEON
+};
+
+enum ChannelOrder
+{
+    ORDER_RGB,  // source is R, G, B[, A]
+    ORDER_BGR   // source is B, G, R[, A]
+};
+
+/**
+ * @brief Swap the first and third channel of every pixel in place (RGB <-> BGR).
+ * @param data interleaved frame
+ * @param pixels number of pixels in the frame
+ * @param channels 3 or 4
+ * @param sampleBytes 1 or 2
+ */
+void swapRedBlue(uint8_t *data, size_t pixels, int channels, int sampleBytes);
+
+/**
+ * @brief Split an interleaved frame into consecutive colour planes R, G, B (then A for 4 channels),
+ * which is the layout expected for 3D colour FITS.
+ * @param src interleaved frame
+ * @param dst destination of pixels * channels * sampleBytes bytes, must not overlap src
+ * @param pixels number of pixels in the frame
+ * @param channels 3 or 4
+ * @param sampleBytes 1 or 2
+ * @param order channel order of the source frame
+ */
+void interleavedToPlanar(const uint8_t *src, uint8_t *dst, size_t pixels, int channels, int sampleBytes,
+                         ChannelOrder order);
+
+/** @return backend currently used by the conversion functions */
+Backend backend();
+
+/**
+ * @brief Force a specific backend, mostly useful for benchmarks and debugging.
+ * @return false if the backend is not supported by this CPU/build.
+ */
+bool setBackend(Backend backend);
+
+/** @return true if the backend can run on this CPU/build */
+bool isSupported(Backend backend);
+
+const char *toString(Backend backend);
+
+}
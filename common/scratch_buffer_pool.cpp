@@ -0,0 +1,212 @@
+/*
+    Scratch buffer pool shared by the camera drivers
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "scratch_buffer_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ScratchBuffer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+ScratchBuffer::ScratchBuffer(ScratchBufferPool *pool, size_t slot, uint8_t *data, size_t size)
+    : mPool(pool), mSlot(slot), mData(data), mSize(size)
+{ }
+
+ScratchBuffer::~ScratchBuffer()
+{
+    reset();
+}
+
+ScratchBuffer::ScratchBuffer(ScratchBuffer &&other)
+    : mPool(other.mPool), mSlot(other.mSlot), mData(other.mData), mSize(other.mSize)
+{
+    other.mPool = nullptr;
+    other.mData = nullptr;
+    other.mSize = 0;
+}
+
+ScratchBuffer &ScratchBuffer::operator=(ScratchBuffer &&other)
+{
+    if (this != &other)
+    {
+        reset();
+        mPool = other.mPool;
+        mSlot = other.mSlot;
+        mData = other.mData;
+        mSize = other.mSize;
+        other.mPool = nullptr;
+        other.mData = nullptr;
+        other.mSize = 0;
+    }
+    return *this;
+}
+
+void ScratchBuffer::reset()
+{
+    if (mPool != nullptr)
+        mPool->release(mSlot);
+
+    mPool = nullptr;
+    mData = nullptr;
+    mSize = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// ScratchBufferPool
+////////////////////////////////////////////////////////////////////////////////////////////////////
+ScratchBufferPool::ScratchBufferPool(bool hugePages)
+    : mHugePages(hugePages)
+{ }
+
+ScratchBufferPool::~ScratchBufferPool()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto &slot : mSlots)
+        unmap(slot);
+}
+
+bool ScratchBufferPool::hugePagesRequested()
+{
+    const char *env = getenv("INDI_SCRATCH_HUGEPAGES");
+    return env != nullptr && strcmp(env, "1") == 0;
+}
+
+uint8_t *ScratchBufferPool::map(size_t &capacity)
+{
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void *ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (mHugePages)
+    {
+        // Explicit huge pages need a reserved pool (vm.nr_hugepages), fall back silently if there is none.
+        size_t hugeCapacity = (capacity + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        ptr = mmap(nullptr, hugeCapacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED)
+            capacity = hugeCapacity;
+    }
+#endif
+
+    if (ptr == MAP_FAILED)
+    {
+        capacity = (capacity + pageSize - 1) / pageSize * pageSize;
+        ptr = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED)
+            return nullptr;
+
+#ifdef MADV_HUGEPAGE
+        // Otherwise ask for transparent huge pages
+        if (mHugePages)
+            madvise(ptr, capacity, MADV_HUGEPAGE);
+#endif
+    }
+
+    mAllocated += capacity;
+    mHighWaterMark = std::max(mHighWaterMark, mAllocated);
+    return static_cast<uint8_t *>(ptr);
+}
+
+void ScratchBufferPool::unmap(Slot &slot)
+{
+    if (slot.data == nullptr)
+        return;
+
+    munmap(slot.data, slot.capacity);
+    mAllocated -= slot.capacity;
+    slot.data = nullptr;
+    slot.capacity = 0;
+}
+
+ScratchBuffer ScratchBufferPool::acquire(size_t size)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (size == 0)
+        return ScratchBuffer();
+
+    // Prefer the smallest idle buffer that is large enough, otherwise grow an idle one.
+    size_t best = mSlots.size(), idle = mSlots.size();
+    for (size_t i = 0; i < mSlots.size(); i++)
+    {
+        const Slot &slot = mSlots[i];
+        if (slot.inUse)
+            continue;
+
+        if (slot.capacity >= size && (best == mSlots.size() || slot.capacity < mSlots[best].capacity))
+            best = i;
+        if (idle == mSlots.size())
+            idle = i;
+    }
+
+    if (best == mSlots.size())
+    {
+        if (idle == mSlots.size())
+        {
+            mSlots.push_back(Slot());
+            idle = mSlots.size() - 1;
+        }
+
+        Slot &slot = mSlots[idle];
+        unmap(slot);
+
+        size_t capacity = size;
+        slot.data = map(capacity);
+        if (slot.data == nullptr)
+            return ScratchBuffer();
+        slot.capacity = capacity;
+        best = idle;
+    }
+
+    mSlots[best].inUse = true;
+    return ScratchBuffer(this, best, mSlots[best].data, size);
+}
+
+void ScratchBufferPool::release(size_t slot)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (slot < mSlots.size())
+        mSlots[slot].inUse = false;
+}
+
+void ScratchBufferPool::trim()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto &slot : mSlots)
+        if (!slot.inUse)
+            unmap(slot);
+}
+
+size_t ScratchBufferPool::allocatedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAllocated;
+}
+
+size_t ScratchBufferPool::highWaterMark() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHighWaterMark;
+}
@@ -0,0 +1,129 @@
+/*
+    Scratch buffer pool shared by the camera drivers
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class ScratchBufferPool;
+
+/**
+ * @brief A scratch buffer borrowed from a ScratchBufferPool.
+ * The memory goes back to the pool when the object is destroyed or reset.
+ */
+class ScratchBuffer
+{
+    public:
+        ScratchBuffer() = default;
+        ~ScratchBuffer();
+
+        ScratchBuffer(ScratchBuffer &&other);
+        ScratchBuffer &operator=(ScratchBuffer &&other);
+
+        ScratchBuffer(const ScratchBuffer &) = delete;
+        ScratchBuffer &operator=(const ScratchBuffer &) = delete;
+
+        uint8_t *data() const
+        {
+            return mData;
+        }
+
+        size_t size() const
+        {
+            return mSize;
+        }
+
+        explicit operator bool() const
+        {
+            return mData != nullptr;
+        }
+
+        /** Give the memory back to the pool now. */
+        void reset();
+
+    private:
+        friend class ScratchBufferPool;
+        ScratchBuffer(ScratchBufferPool *pool, size_t slot, uint8_t *data, size_t size);
+
+        ScratchBufferPool *mPool {nullptr};
+        size_t mSlot {0};
+        uint8_t *mData {nullptr};
+        size_t mSize {0};
+};
+
+/**
+ * @brief Per-device pool of page-aligned scratch buffers reused across exposures.
+ *
+ * Buffers are mapped lazily and only grown when a larger frame (ROI/binning change) is
+ * requested, so repeated exposures of the same size do not touch the allocator or take
+ * fresh page faults. Optionally the memory is backed by huge pages.
+ */
+class ScratchBufferPool
+{
+    public:
+        explicit ScratchBufferPool(bool hugePages = hugePagesRequested());
+        ~ScratchBufferPool();
+
+        ScratchBufferPool(const ScratchBufferPool &) = delete;
+        ScratchBufferPool &operator=(const ScratchBufferPool &) = delete;
+
+        /** Borrow a buffer of at least size bytes. Returns an empty buffer if the memory cannot be mapped. */
+        ScratchBuffer acquire(size_t size);
+
+        /** Unmap every buffer that is not currently borrowed. */
+        void trim();
+
+        /** Bytes currently mapped by the pool. */
+        size_t allocatedBytes() const;
+
+        /** Largest number of bytes the pool ever had mapped at once. */
+        size_t highWaterMark() const;
+
+        bool usesHugePages() const
+        {
+            return mHugePages;
+        }
+
+        /** True if INDI_SCRATCH_HUGEPAGES=1 is set in the environment. */
+        static bool hugePagesRequested();
+
+    private:
+        friend class ScratchBuffer;
+        void release(size_t slot);
+
+        struct Slot
+        {
+            uint8_t *data {nullptr};
+            size_t capacity {0};
+            bool inUse {false};
+        };
+
+        uint8_t *map(size_t &capacity);
+        void unmap(Slot &slot);
+
+        mutable std::mutex mMutex;
+        std::vector<Slot> mSlots;
+        bool mHugePages {false};
+        size_t mAllocated {0};
+        size_t mHighWaterMark {0};
+};
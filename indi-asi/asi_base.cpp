@@ -23,6 +23,7 @@
 #include "asi_base.h"
 #include "asi_helpers.h"
 #include "usb_utils.h"
+#include "pixel_convert.h"
 
 #include "config.h"
 
@@ -36,13 +37,17 @@
 #include <unistd.h>
 #include <cstring>
 #include <errno.h>
+#include <thread>
 
 #define MAX_EXP_RETRIES         2
 #define VERBOSE_EXPOSURE        3
 #define TEMP_TIMER_MS           1000 /* Temperature polling time (ms) */
 #define TEMP_THRESHOLD          .25  /* Differential temperature threshold (C)*/
+#define STREAM_STATS_MS         1000 /* Streaming counters update interval (ms) */
+#define STREAM_READ_TIMEOUT_MS  100  /* Streamer wait for the next frame (ms) */
 
 #define CONTROL_TAB "Controls"
+#define STREAMING_TAB "Streaming"
 
 static bool warn_roi_height = true;
 static bool warn_roi_width = true;
@@ -70,13 +75,32 @@ void ASIBase::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
         LOGF_ERROR("Failed to start video capture (%s).", Helpers::toString(ret));
     }
 
+    // The SDK fills ring slots on this thread while a second thread feeds the streamer,
+    // so a stalled encoder or recorder no longer holds up the sensor readout.
+    uint32_t totalBytes = PrimaryCCD.getFrameBufferSize();
+    int waitMS          = static_cast<int>((ExposureRequest * 2000.0) + 500);
+
+    mFrameRing.reset(totalBytes);
+    updateStreamStats();
+    std::thread frameConsumer(&ASIBase::workerStreamFrames, this);
+
+    INDI::ElapsedTimer statsTimer;
     while (!isAboutToQuit)
     {
-        uint8_t *targetFrame = PrimaryCCD.getFrameBuffer();
-        uint32_t totalBytes  = PrimaryCCD.getFrameBufferSize();
-        int waitMS           = static_cast<int>((ExposureRequest * 2000.0) + 500);
+        uint8_t *targetFrame = mFrameRing.beginWrite();
 
         ret = ASIGetVideoData(mCameraInfo.CameraID, targetFrame, totalBytes, waitMS);
+        mFrameRing.endWrite(ret == ASI_SUCCESS);
+
+        if (statsTimer.elapsed() >= STREAM_STATS_MS)
+        {
+            int dropped = 0;
+            if (ASIGetDroppedFrames(mCameraInfo.CameraID, &dropped) == ASI_SUCCESS)
+                mFrameRing.setDropped(dropped);
+            updateStreamStats();
+            statsTimer.start();
+        }
+
         if (ret != ASI_SUCCESS)
         {
             if (ret != ASI_ERROR_TIMEOUT)
@@ -89,15 +113,53 @@ void ASIBase::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
             usleep(100);
             continue;
         }
+    }
+
+    mFrameRing.close();
+    frameConsumer.join();
+
+    ASIStopVideoCapture(mCameraInfo.CameraID);
+    updateStreamStats();
+}
+
+void ASIBase::workerStreamFrames()
+{
+    const size_t totalBytes = mFrameRing.frameSize();
+
+    while (mFrameRing.isOpen())
+    {
+        uint8_t *frame = mFrameRing.beginRead(STREAM_READ_TIMEOUT_MS);
+        if (frame == nullptr)
+            continue;
 
         if (mCurrentVideoFormat == ASI_IMG_RGB24)
-            for (uint32_t i = 0; i < totalBytes; i += 3)
-                std::swap(targetFrame[i], targetFrame[i + 2]);
+            PixelConvert::swapRedBlue(frame, totalBytes / 3, 3, 1);
 
-        Streamer->newFrame(targetFrame, totalBytes);
+        Streamer->newFrame(frame, totalBytes);
+        mFrameRing.endRead();
     }
+}
 
-    ASIStopVideoCapture(mCameraInfo.CameraID);
+void ASIBase::updateExposureStats()
+{
+    ExposureScheduler::Timing timing = mExposureScheduler.timing();
+
+    ExposureStatsNP[EXPOSURE_LATENCY].setValue(timing.latency);
+    ExposureStatsNP[EXPOSURE_CPU_TIME].setValue(timing.cpuTime);
+    ExposureStatsNP[EXPOSURE_POLLS].setValue(timing.polls);
+    ExposureStatsNP.setState(IPS_OK);
+    ExposureStatsNP.apply();
+}
+
+void ASIBase::updateStreamStats()
+{
+    FrameRing::Stats stats = mFrameRing.stats();
+
+    StreamStatsNP[STREAM_DELIVERED].setValue(stats.delivered);
+    StreamStatsNP[STREAM_OVERWRITTEN].setValue(stats.overwritten);
+    StreamStatsNP[STREAM_DROPPED].setValue(stats.dropped);
+    StreamStatsNP.setState((stats.overwritten > 0 || stats.dropped > 0) ? IPS_BUSY : IPS_OK);
+    StreamStatsNP.apply();
 }
 
 void ASIBase::workerBlinkExposure(const std::atomic_bool &isAboutToQuit, int blinks, float duration)
@@ -193,143 +255,115 @@ void ASIBase::workerExposure(const std::atomic_bool &isAboutToQuit, float durati
         return;
     }
 
-    INDI::ElapsedTimer exposureTimer;
-
     if (duration > VERBOSE_EXPOSURE)
         LOGF_INFO("Taking a %g seconds frame...", duration);
 
-    int statRetry = 0;
     ASI_EXPOSURE_STATUS status = ASI_EXP_IDLE;
-    do
+    auto readStatus = [&]()
     {
-        float delay = 0.1;
-        float timeLeft = std::max(duration - exposureTimer.elapsed() / 1000.0, 0.0);
-
-        /*
-         * Check the status every second until the time left is
-         * about one second, after which decrease the poll interval
-         *
-         * For expsoures with more than a second left try
-         * to keep the displayed "exposure left" value at
-         * a full second boundary, which keeps the
-         * count down neat
-         */
-        if (timeLeft > 1.1)
+        ASI_ERROR_CODE ret = ASIGetExpStatus(mCameraInfo.CameraID, &status);
+        if (ret != ASI_SUCCESS)
         {
-            delay = std::max(timeLeft - std::trunc(timeLeft), 0.005f);
-            timeLeft = std::round(timeLeft);
+            LOGF_DEBUG("Failed to get exposure status (%s)", Helpers::toString(ret));
+            return ExposureScheduler::STATUS_ERROR;
         }
 
-        if (timeLeft > 0)
+        switch (status)
         {
-            PrimaryCCD.setExposureLeft(timeLeft);
+            case ASI_EXP_SUCCESS:
+                return ExposureScheduler::STATUS_DONE;
+            case ASI_EXP_FAILED:
+                return ExposureScheduler::STATUS_FAILED;
+            default:
+                return ExposureScheduler::STATUS_WORKING;
         }
+    };
+
+    ExposureScheduler::Outcome outcome = mExposureScheduler.wait(duration, readStatus, [this](double timeLeft)
+    {
+        PrimaryCCD.setExposureLeft(timeLeft);
+    }, isAboutToQuit);
+
+    updateExposureStats();
 
-        ASI_ERROR_CODE ret;
-        if (timeLeft < 0.2)
+    // 2021-09-11 <sterne-jaeger@openfuture.de>: Fix for
+    // https://www.indilib.org/forum/development/10346-asi-driver-sends-image-after-abort.html
+    // Aborting an exposure also returns ASI_SUCCESS here, therefore
+    // we need to ensure that the quit flag is not set if we want to continue.
+    if (outcome == ExposureScheduler::OUTCOME_ABORTED || isAboutToQuit)
+        return;
+
+    if (outcome == ExposureScheduler::OUTCOME_ERROR)
+    {
+        LOG_ERROR("Exposure status timed out");
+        PrimaryCCD.setExposureFailed();
+        return;
+    }
+
+    if (outcome == ExposureScheduler::OUTCOME_FAILED)
+    {
+        if (++mExposureRetry < MAX_EXP_RETRIES)
         {
-            int i = 0;
-            // exposure can fail in some cases if we don't call this fast enough
-            do
-            {
-                ret = ASIGetExpStatus(mCameraInfo.CameraID, &status);
-                usleep(1000);
-                i++;
-            }
-            while(i < 300 && status == ASI_EXP_WORKING);
+            LOG_DEBUG("ASIGetExpStatus failed. Restarting exposure...");
+            ASIStopExposure(mCameraInfo.CameraID);
+            workerExposure(isAboutToQuit, duration);
+            return;
         }
-        else
+
+        LOGF_WARN("Exposure failed after %d attempts. Attempting USB reset...", mExposureRetry);
+        ASIStopExposure(mCameraInfo.CameraID);
+        ASICloseCamera(mCameraInfo.CameraID);
+
+        LOGF_INFO("Attempting USB reset for device %s...", mCameraInfo.Name);
+        resetUSBDevice();
+
+        LOG_INFO("Reopening camera after reset...");
+        ASI_ERROR_CODE ret = ASIOpenCamera(mCameraInfo.CameraID);
+        if (ret != ASI_SUCCESS)
         {
-            usleep(delay * 1000 * 1000);
-            ret = ASIGetExpStatus(mCameraInfo.CameraID, &status);
-        }
-        // 2021-09-11 <sterne-jaeger@openfuture.de>: Fix for
-        // https://www.indilib.org/forum/development/10346-asi-driver-sends-image-after-abort.html
-        // Aborting an exposure also returns ASI_SUCCESS here, therefore
-        // we need to ensure that the quit flag is not set if we want to continue.
-        if (isAboutToQuit)
+            LOGF_ERROR("Failed to reopen camera after USB reset (%s)", Helpers::toString(ret));
+            PrimaryCCD.setExposureFailed();
             return;
+        }
 
+        LOG_INFO("Reinitializing camera...");
+        ret = ASIInitCamera(mCameraInfo.CameraID);
         if (ret != ASI_SUCCESS)
         {
-            LOGF_DEBUG("Failed to get exposure status (%s)", Helpers::toString(ret));
-            if (++statRetry < 10)
-            {
-                usleep(100);
-                continue;
-            }
-
-            LOGF_ERROR("Exposure status timed out (%s)", Helpers::toString(ret));
+            LOGF_ERROR("Failed to reinitialize camera after USB reset (%s)", Helpers::toString(ret));
             PrimaryCCD.setExposureFailed();
             return;
         }
 
-        if (status == ASI_EXP_FAILED)
+        // Restore previous settings
+        ASI_IMG_TYPE currentType = getImageType();
+        ret = ASISetROIFormat(mCameraInfo.CameraID,
+                              PrimaryCCD.getSubW() / PrimaryCCD.getBinX(),
+                              PrimaryCCD.getSubH() / PrimaryCCD.getBinY(),
+                              PrimaryCCD.getBinX(), currentType);
+        if (ret != ASI_SUCCESS)
         {
-            if (++mExposureRetry < MAX_EXP_RETRIES)
-            {
-                LOG_DEBUG("ASIGetExpStatus failed. Restarting exposure...");
-                ASIStopExposure(mCameraInfo.CameraID);
-                workerExposure(isAboutToQuit, duration);
-                return;
-            }
-
-            LOGF_WARN("Exposure failed after %d attempts. Attempting USB reset...", mExposureRetry);
-            ASIStopExposure(mCameraInfo.CameraID);
-            ASICloseCamera(mCameraInfo.CameraID);
-
-            LOGF_INFO("Attempting USB reset for device %s...", mCameraInfo.Name);
-            resetUSBDevice();
-
-            LOG_INFO("Reopening camera after reset...");
-            ASI_ERROR_CODE ret = ASIOpenCamera(mCameraInfo.CameraID);
-            if (ret != ASI_SUCCESS)
-            {
-                LOGF_ERROR("Failed to reopen camera after USB reset (%s)", Helpers::toString(ret));
-                PrimaryCCD.setExposureFailed();
-                return;
-            }
-
-            LOG_INFO("Reinitializing camera...");
-            ret = ASIInitCamera(mCameraInfo.CameraID);
-            if (ret != ASI_SUCCESS)
-            {
-                LOGF_ERROR("Failed to reinitialize camera after USB reset (%s)", Helpers::toString(ret));
-                PrimaryCCD.setExposureFailed();
-                return;
-            }
-
-            // Restore previous settings
-            ASI_IMG_TYPE currentType = getImageType();
-            ret = ASISetROIFormat(mCameraInfo.CameraID,
-                                  PrimaryCCD.getSubW() / PrimaryCCD.getBinX(),
-                                  PrimaryCCD.getSubH() / PrimaryCCD.getBinY(),
-                                  PrimaryCCD.getBinX(), currentType);
-            if (ret != ASI_SUCCESS)
-            {
-                LOGF_ERROR("Failed to restore ROI format after USB reset (%s)", Helpers::toString(ret));
-                PrimaryCCD.setExposureFailed();
-                return;
-            }
-
-            ret = ASISetStartPos(mCameraInfo.CameraID,
-                                 PrimaryCCD.getSubX() / PrimaryCCD.getBinX(),
-                                 PrimaryCCD.getSubY() / PrimaryCCD.getBinY());
-            if (ret != ASI_SUCCESS)
-            {
-                LOGF_ERROR("Failed to restore start position after USB reset (%s)", Helpers::toString(ret));
-                PrimaryCCD.setExposureFailed();
-                return;
-            }
+            LOGF_ERROR("Failed to restore ROI format after USB reset (%s)", Helpers::toString(ret));
+            PrimaryCCD.setExposureFailed();
+            return;
+        }
 
-            // Try one more time after reset
-            LOG_INFO("Attempting exposure again after USB reset...");
-            ASIStopExposure(mCameraInfo.CameraID);
-            workerExposure(isAboutToQuit, duration);
+        ret = ASISetStartPos(mCameraInfo.CameraID,
+                             PrimaryCCD.getSubX() / PrimaryCCD.getBinX(),
+                             PrimaryCCD.getSubY() / PrimaryCCD.getBinY());
+        if (ret != ASI_SUCCESS)
+        {
+            LOGF_ERROR("Failed to restore start position after USB reset (%s)", Helpers::toString(ret));
+            PrimaryCCD.setExposureFailed();
             return;
         }
+
+        // Try one more time after reset
+        LOG_INFO("Attempting exposure again after USB reset...");
+        ASIStopExposure(mCameraInfo.CameraID);
+        workerExposure(isAboutToQuit, duration);
+        return;
     }
-    while (status != ASI_EXP_SUCCESS);
 
     // Reset exposure retry
     mExposureRetry = 0;
@@ -348,6 +382,17 @@ ASIBase::ASIBase()
     setVersion(ASI_VERSION_MAJOR, ASI_VERSION_MINOR);
     mTimerWE.setSingleShot(true);
     mTimerNS.setSingleShot(true);
+
+    // Exposure can fail in some cases if the status is not read fast enough
+    // near the end of the exposure, so poll every millisecond from 200 ms before
+    // to 200 ms after the end, like the SDK examples do, and back off during a
+    // longer readout.
+    ExposureScheduler::Config config;
+    config.minPoll = std::chrono::milliseconds(1);
+    config.maxPoll = std::chrono::milliseconds(10);
+    config.fastPollLead = std::chrono::milliseconds(200);
+    config.fastPoll = std::chrono::milliseconds(1);
+    mExposureScheduler.setConfig(config);
 }
 
 ASIBase::~ASIBase()
@@ -397,6 +442,16 @@ bool ASIBase::initProperties()
     BlinkNP.fill(getDeviceName(), "BLINK", "Blink", CONTROL_TAB, IP_RW, 60, IPS_IDLE);
     BlinkNP.load();
 
+    ExposureStatsNP[EXPOSURE_LATENCY ].fill("EXPOSURE_LATENCY",  "Completion latency (ms)", "%.1f", 0, 1e6, 0, 0);
+    ExposureStatsNP[EXPOSURE_CPU_TIME].fill("EXPOSURE_CPU_TIME", "Wait CPU time (ms)",      "%.2f", 0, 1e6, 0, 0);
+    ExposureStatsNP[EXPOSURE_POLLS   ].fill("EXPOSURE_POLLS",    "Status polls",            "%.f",  0, 1e6, 0, 0);
+    ExposureStatsNP.fill(getDeviceName(), "CCD_EXPOSURE_STATS", "Exposure Stats", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
+    StreamStatsNP[STREAM_DELIVERED  ].fill("STREAM_DELIVERED",   "Delivered",   "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_OVERWRITTEN].fill("STREAM_OVERWRITTEN", "Overwritten", "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_DROPPED    ].fill("STREAM_DROPPED",     "Dropped",     "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP.fill(getDeviceName(), "STREAM_FRAME_STATS", "Frames", STREAMING_TAB, IP_RO, 60, IPS_IDLE);
+
     BayerTP[2].setText(getBayerString());
 
     ADCDepthNP[0].fill("BITS", "Bits", "%2.0f", 0, 32, 1, mCameraInfo.BitDepth);
@@ -529,6 +584,8 @@ bool ASIBase::updateProperties()
         }
 
         defineProperty(BlinkNP);
+        defineProperty(StreamStatsNP);
+        defineProperty(ExposureStatsNP);
         defineProperty(ADCDepthNP);
         defineProperty(SDKVersionSP);
         if (!mSerialNumber.empty())
@@ -562,6 +619,8 @@ bool ASIBase::updateProperties()
             deleteProperty(VideoFormatSP.getName());
 
         deleteProperty(BlinkNP.getName());
+        deleteProperty(StreamStatsNP.getName());
+        deleteProperty(ExposureStatsNP.getName());
         deleteProperty(SDKVersionSP.getName());
         if (!mSerialNumber.empty())
         {
@@ -1082,6 +1141,7 @@ bool ASIBase::AbortExposure()
 {
     LOG_DEBUG("Aborting exposure...");
 
+    mExposureScheduler.cancel();
     mWorker.quit();
 
     ASIStopExposure(mCameraInfo.CameraID);
@@ -1232,14 +1292,18 @@ int ASIBase::grabImage(float duration)
     int nChannels = (type == ASI_IMG_RGB24) ? 3 : 1;
     size_t nTotalBytes = subW * subH * nChannels * (PrimaryCCD.getBPP() / 8);
 
+    ScratchBuffer scratch;
     if (type == ASI_IMG_RGB24)
     {
-        buffer = static_cast<uint8_t *>(malloc(nTotalBytes));
-        if (buffer == nullptr)
+        scratch = mScratchPool.acquire(nTotalBytes);
+        if (!scratch)
         {
-            LOGF_ERROR("%s: %d malloc failed (RGB 24).", getDeviceName());
+            LOGF_ERROR("%s: scratch buffer allocation failed (RGB 24).", getDeviceName());
             return -1;
         }
+        buffer = scratch.data();
+        LOGF_DEBUG("Scratch buffers: %zu bytes mapped, peak %zu bytes.", mScratchPool.allocatedBytes(),
+                   mScratchPool.highWaterMark());
     }
 
     ret = ASIGetDataAfterExp(mCameraInfo.CameraID, buffer, nTotalBytes);
@@ -1249,28 +1313,12 @@ int ASIBase::grabImage(float duration)
             "Failed to get data after exposure (%dx%d #%d channels) (%s).",
             subW, subH, nChannels, Helpers::toString(ret)
         );
-        if (type == ASI_IMG_RGB24)
-            free(buffer);
         return -1;
     }
 
     if (type == ASI_IMG_RGB24)
     {
-        uint8_t *dstR = image;
-        uint8_t *dstG = image + subW * subH;
-        uint8_t *dstB = image + subW * subH * 2;
-
-        const uint8_t *src = buffer;
-        const uint8_t *end = buffer + subW * subH * 3;
-
-        while (src != end)
-        {
-            *dstB++ = *src++;
-            *dstG++ = *src++;
-            *dstR++ = *src++;
-        }
-
-        free(buffer);
+        PixelConvert::interleavedToPlanar(buffer, image, subW * subH, 3, 1, PixelConvert::ORDER_BGR);
     }
     guard.unlock();
 
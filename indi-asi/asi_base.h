@@ -29,6 +29,9 @@
 #include "indipropertynumber.h"
 #include "indipropertytext.h"
 #include "indisinglethreadpool.h"
+#include "frame_ring.h"
+#include "scratch_buffer_pool.h"
+#include "exposure_scheduler.h"
 
 #include <vector>
 
@@ -87,6 +90,7 @@ class ASIBase : public INDI::CCD
     protected:
         INDI::SingleThreadPool mWorker;
         void workerStreamVideo(const std::atomic_bool &isAboutToQuit);
+        void workerStreamFrames();
         void workerBlinkExposure(const std::atomic_bool &isAboutToQuit, int blinks, float duration);
         void workerExposure(const std::atomic_bool &isAboutToQuit, float duration);
 
@@ -136,6 +140,21 @@ class ASIBase : public INDI::CCD
         /** Reset USB device when camera gets stuck */
         void resetUSBDevice();
 
+        /** Publish streaming frame counters */
+        void updateStreamStats();
+
+        /** Publish completion latency and CPU time of the last exposure */
+        void updateExposureStats();
+
+        /** Waits for exposure completion without busy polling */
+        ExposureScheduler mExposureScheduler;
+
+        /** Frame slots shared between the SDK reader and the streamer while streaming */
+        FrameRing mFrameRing;
+
+        /** Reusable buffers for colour frame deinterleaving */
+        ScratchBufferPool mScratchPool;
+
         /** Additional Properties to INDI::CCD */
         INDI::PropertyNumber  CoolerNP {1};
         INDI::PropertySwitch  CoolerSP {2};
@@ -156,6 +175,22 @@ class ASIBase : public INDI::CCD
             BLINK_DURATION
         };
 
+        INDI::PropertyNumber  StreamStatsNP {3};
+        enum
+        {
+            STREAM_DELIVERED,
+            STREAM_OVERWRITTEN,
+            STREAM_DROPPED
+        };
+
+        INDI::PropertyNumber  ExposureStatsNP {3};
+        enum
+        {
+            EXPOSURE_LATENCY,
+            EXPOSURE_CPU_TIME,
+            EXPOSURE_POLLS
+        };
+
         INDI::PropertySwitch  FlipSP {2};
         enum
         {
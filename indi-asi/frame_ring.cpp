@@ -0,0 +1,162 @@
+/*
+    ASI Camera video frame ring
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "frame_ring.h"
+
+#include <chrono>
+
+FrameRing::FrameRing(size_t slots)
+    : mSlots(slots < 3 ? 3 : slots)
+{ }
+
+void FrameRing::reset(size_t frameSize)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    for (auto &slot : mSlots)
+    {
+        // Only reallocate on size change, so restarting a stream with the same ROI is free.
+        if (slot.data.size() != frameSize)
+        {
+            slot.data.resize(frameSize);
+            slot.data.shrink_to_fit();
+        }
+        slot.state = SLOT_FREE;
+    }
+
+    mReadyQueue.clear();
+    mFrameSize  = frameSize;
+    mWriteIndex = -1;
+    mReadIndex  = -1;
+    mClosed     = false;
+    mStats      = Stats();
+}
+
+void FrameRing::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClosed = true;
+    }
+    mReady.notify_all();
+}
+
+bool FrameRing::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return !mClosed;
+}
+
+uint8_t *FrameRing::beginWrite()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mClosed)
+        return nullptr;
+
+    for (size_t i = 0; i < mSlots.size(); ++i)
+    {
+        if (mSlots[i].state == SLOT_FREE)
+        {
+            mWriteIndex = static_cast<int>(i);
+            mSlots[i].state = SLOT_WRITING;
+            return mSlots[i].data.data();
+        }
+    }
+
+    // No free slot: the consumer is behind. With at least three slots and a single
+    // consumer holding at most one of them, there is always a ready frame to recycle.
+    size_t oldest = mReadyQueue.front();
+    mReadyQueue.pop_front();
+    mStats.overwritten++;
+
+    mWriteIndex = static_cast<int>(oldest);
+    mSlots[oldest].state = SLOT_WRITING;
+    return mSlots[oldest].data.data();
+}
+
+void FrameRing::endWrite(bool filled)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mWriteIndex < 0)
+            return;
+
+        Slot &slot = mSlots[mWriteIndex];
+        if (filled)
+        {
+            slot.state = SLOT_READY;
+            mReadyQueue.push_back(mWriteIndex);
+        }
+        else
+            slot.state = SLOT_FREE;
+
+        mWriteIndex = -1;
+    }
+
+    if (filled)
+        mReady.notify_one();
+}
+
+uint8_t *FrameRing::beginRead(int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    auto isReady = [this]
+    {
+        return mClosed || !mReadyQueue.empty();
+    };
+
+    if (!mReady.wait_for(lock, std::chrono::milliseconds(timeoutMs), isReady))
+        return nullptr;
+
+    if (mClosed)
+        return nullptr;
+
+    mReadIndex = static_cast<int>(mReadyQueue.front());
+    mReadyQueue.pop_front();
+    mSlots[mReadIndex].state = SLOT_READING;
+    mStats.delivered++;
+    return mSlots[mReadIndex].data.data();
+}
+
+void FrameRing::endRead()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mReadIndex < 0)
+        return;
+
+    mSlots[mReadIndex].state = SLOT_FREE;
+    mReadIndex = -1;
+}
+
+void FrameRing::setDropped(uint64_t dropped)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.dropped = dropped;
+}
+
+FrameRing::Stats FrameRing::stats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
@@ -0,0 +1,115 @@
+/*
+    ASI Camera video frame ring
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief FrameRing is a fixed-size ring of preallocated frame slots shared between
+ * one producer (the thread reading frames from the SDK) and one consumer (the thread
+ * handing frames to the streamer).
+ *
+ * The producer never blocks: when every slot is waiting for the consumer, the oldest
+ * undelivered frame is recycled and counted as overwritten. The consumer waits for the
+ * next ready frame in arrival order.
+ */
+class FrameRing
+{
+    public:
+        struct Stats
+        {
+            uint64_t delivered {0};     // frames handed to the consumer
+            uint64_t overwritten {0};   // ready frames recycled before the consumer got to them
+            uint64_t dropped {0};       // frames lost upstream (e.g. reported by the SDK)
+        };
+
+    public:
+        explicit FrameRing(size_t slots = 3);
+
+        /** Preallocate all slots for frames of frameSize bytes and clear counters/queues. */
+        void reset(size_t frameSize);
+
+        /** Wake up any waiting consumer and refuse further frames until reset() is called. */
+        void close();
+
+        size_t frameSize() const
+        {
+            return mFrameSize;
+        }
+
+        bool isOpen() const;
+
+        // Producer side
+
+        /** Get a slot to fill. Never returns nullptr while the ring is open. */
+        uint8_t *beginWrite();
+
+        /** Publish the slot returned by beginWrite(), or give it back if the fill failed. */
+        void endWrite(bool filled);
+
+        // Consumer side
+
+        /** Wait up to timeoutMs for the oldest ready frame. Returns nullptr on timeout or close. */
+        uint8_t *beginRead(int timeoutMs);
+
+        /** Return the slot obtained from beginRead() to the free list. */
+        void endRead();
+
+        // Statistics
+
+        /** Account for frames dropped before they reached the ring. */
+        void setDropped(uint64_t dropped);
+
+        Stats stats() const;
+
+    private:
+        enum SlotState
+        {
+            SLOT_FREE,
+            SLOT_WRITING,
+            SLOT_READY,
+            SLOT_READING
+        };
+
+        struct Slot
+        {
+            std::vector<uint8_t> data;
+            SlotState state {SLOT_FREE};
+        };
+
+        mutable std::mutex mMutex;
+        std::condition_variable mReady;
+
+        std::vector<Slot> mSlots;
+        std::deque<size_t> mReadyQueue;
+        size_t mFrameSize {0};
+        int mWriteIndex {-1};
+        int mReadIndex {-1};
+        bool mClosed {true};
+
+        Stats mStats;
+};
@@ -0,0 +1,107 @@
+/*
+    ASI Camera video frame ring tests
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "frame_ring.h"
+
+#include <ASICamera2.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+// Stand-in for ASIGetVideoData: stamps a sequence number into the frame after a fixed readout time.
+static ASI_ERROR_CODE mockASIGetVideoData(unsigned char *pBuffer, long lBuffSize, int readoutUs)
+{
+    static uint32_t sequence = 0;
+
+    std::this_thread::sleep_for(std::chrono::microseconds(readoutUs));
+    memset(pBuffer, 0, lBuffSize);
+    ++sequence;
+    memcpy(pBuffer, &sequence, sizeof(sequence));
+    return ASI_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    int frames       = argc > 1 ? atoi(argv[1]) : 2000;
+    long frameSize   = argc > 2 ? atol(argv[2]) : 640 * 480 * 2;
+    int readoutUs    = argc > 3 ? atoi(argv[3]) : 500;
+    int consumerUs   = argc > 4 ? atoi(argv[4]) : 800;
+
+    FrameRing ring;
+    ring.reset(frameSize);
+
+    std::atomic_bool failed {false};
+    std::thread consumer([&]
+    {
+        uint32_t last = 0;
+        while (ring.isOpen())
+        {
+            uint8_t *frame = ring.beginRead(100);
+            if (frame == nullptr)
+                continue;
+
+            uint32_t sequence = 0;
+            memcpy(&sequence, frame, sizeof(sequence));
+            if (sequence <= last)
+            {
+                fprintf(stderr, "Out of order frame %u after %u\n", sequence, last);
+                failed = true;
+            }
+            last = sequence;
+
+            // Simulate a slow encoder/recorder
+            std::this_thread::sleep_for(std::chrono::microseconds(consumerUs));
+            ring.endRead();
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+    {
+        uint8_t *frame = ring.beginWrite();
+        ASI_ERROR_CODE ret = mockASIGetVideoData(frame, frameSize, readoutUs);
+        ring.endWrite(ret == ASI_SUCCESS);
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Let the consumer drain what is left before closing
+    std::this_thread::sleep_for(std::chrono::microseconds(consumerUs * 4 + 200000));
+    ring.close();
+    consumer.join();
+
+    FrameRing::Stats stats = ring.stats();
+    printf("Produced: %d in %.3fs (%.1f fps)\n", frames, elapsed, frames / elapsed);
+    printf("Delivered: %llu Overwritten: %llu Dropped: %llu\n",
+           static_cast<unsigned long long>(stats.delivered),
+           static_cast<unsigned long long>(stats.overwritten),
+           static_cast<unsigned long long>(stats.dropped));
+
+    if (stats.delivered + stats.overwritten != static_cast<uint64_t>(frames))
+    {
+        fprintf(stderr, "Frame accounting mismatch\n");
+        failed = true;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -194,6 +194,13 @@ bool ATIKCCD::initProperties()
 
     BayerTP[2].setText("RGGB");
 
+    // Exposure completion timing
+    IUFillNumber(&ExposureStatsN[EXPOSURE_LATENCY], "EXPOSURE_LATENCY", "Completion latency (ms)", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumber(&ExposureStatsN[EXPOSURE_CPU_TIME], "EXPOSURE_CPU_TIME", "Wait CPU time (ms)", "%.2f", 0, 1e6, 0, 0);
+    IUFillNumber(&ExposureStatsN[EXPOSURE_POLLS], "EXPOSURE_POLLS", "Status polls", "%.f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&ExposureStatsNP, ExposureStatsN, 3, getDeviceName(), "CCD_EXPOSURE_STATS", "Exposure Stats",
+                       IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
     INDI::FilterInterface::initProperties(FILTER_TAB);
 
     addAuxControls();
@@ -245,6 +252,7 @@ bool ATIKCCD::updateProperties()
             INDI::FilterInterface::updateProperties();
 
         defineProperty(&VersionInfoSP);
+        defineProperty(&ExposureStatsNP);
     }
     else
     {
@@ -272,6 +280,7 @@ bool ATIKCCD::updateProperties()
             INDI::FilterInterface::updateProperties();
 
         deleteProperty(VersionInfoSP.name);
+        deleteProperty(ExposureStatsNP.name);
     }
 
     return true;
@@ -653,6 +662,8 @@ bool ATIKCCD::Disconnect()
     pthread_mutex_lock(&condMutex);
     tState = threadState;
     threadRequest = StateTerminate;
+    exposureCancelled = true;
+    exposureScheduler.cancel();
     pthread_cond_signal(&cv);
     pthread_mutex_unlock(&condMutex);
     pthread_join(imagingThread, nullptr);
@@ -1146,6 +1157,7 @@ bool ATIKCCD::StartExposure(float duration)
         LOGF_INFO("Taking a %g seconds frame...", ExposureRequest);
 
     InExposure = true;
+    exposureCancelled = false;
     pthread_mutex_lock(&condMutex);
     threadRequest = StateExposure;
     pthread_cond_signal(&cv);
@@ -1163,6 +1175,8 @@ bool ATIKCCD::AbortExposure()
     LOG_DEBUG("Aborting camera exposure...");
     pthread_mutex_lock(&condMutex);
     threadRequest = StateAbort;
+    exposureCancelled = true;
+    exposureScheduler.cancel();
     pthread_cond_signal(&cv);
     while (threadState == StateExposure)
     {
@@ -1518,95 +1532,99 @@ void *ATIKCCD::imagingThreadEntry()
 }
 
 /////////////////////////////////////////////////////////
-/// Dedicated imaging thread
+/// Wait for the end of exposure and download the image.
+/// Called on the imaging thread with condMutex locked.
 /////////////////////////////////////////////////////////
 void ATIKCCD::checkExposureProgress()
 {
-    int expRetry = 0;
-    int uSecs = 1000000;
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    double elapsed = (now.tv_sec - ExpStart.tv_sec) + (now.tv_usec - ExpStart.tv_usec) / 1e6;
 
-    while (threadRequest == StateExposure)
+    auto readStatus = [this]()
     {
-        pthread_mutex_unlock(&condMutex);
         pthread_mutex_lock(&accessMutex);
-        if (ArtemisImageReady(hCam))
-        {
-            InExposure = false;
-            PrimaryCCD.setExposureLeft(0.0);
-            if (ExposureRequest > VERBOSE_EXPOSURE)
-                DEBUG(INDI::Logger::DBG_SESSION, "Exposure done, downloading image...");
-            pthread_mutex_lock(&condMutex);
-            exposureSetRequest(StateIdle);
-            pthread_mutex_unlock(&condMutex);
-            grabImage();
-            pthread_mutex_lock(&condMutex);
-            pthread_mutex_unlock(&accessMutex);
-            break;
-        }
-
-        int state = ArtemisCameraState(hCam);
+        bool ready = ArtemisImageReady(hCam);
+        int state  = ready ? CAMERA_IDLE : ArtemisCameraState(hCam);
         pthread_mutex_unlock(&accessMutex);
-        if (state == -1)
-        {
-            if (++expRetry < MAX_EXP_RETRIES)
-            {
-                if (threadRequest == StateExposure)
-                {
-                    LOG_DEBUG("ASIGetExpStatus failed. Restarting exposure...");
-                }
-                InExposure = false;
-                pthread_mutex_lock(&accessMutex);
-                ArtemisStopExposure(hCam);
-                pthread_mutex_unlock(&accessMutex);
-                usleep(100000);
-                pthread_mutex_lock(&condMutex);
-                exposureSetRequest(StateRestartExposure);
-                break;
-            }
-            else
-            {
-                if (threadRequest == StateExposure)
-                {
-                    LOGF_ERROR("Exposure failed after %d attempts.", expRetry);
-                }
-                pthread_mutex_lock(&accessMutex);
-                ArtemisStopExposure(hCam);
-                pthread_mutex_unlock(&accessMutex);
-                PrimaryCCD.setExposureFailed();
-                usleep(100000);
-                pthread_mutex_lock(&condMutex);
-                exposureSetRequest(StateIdle);
-                break;
-            }
-        }
 
+        if (ready)
+            return ExposureScheduler::STATUS_DONE;
+        return state == -1 ? ExposureScheduler::STATUS_FAILED : ExposureScheduler::STATUS_WORKING;
+    };
+
+    // The scheduler sleeps until the predicted end of exposure, then polls with backoff.
+    // AbortExposure and Disconnect cancel it.
+    pthread_mutex_unlock(&condMutex);
+    ExposureScheduler::Outcome outcome = exposureScheduler.wait(std::max(0.0, ExposureRequest - elapsed), readStatus,
+                                         [this](double timeLeft)
+    {
+        PrimaryCCD.setExposureLeft(timeLeft);
+    }, exposureCancelled);
+    updateExposureStats();
+
+    if (outcome == ExposureScheduler::OUTCOME_ABORTED)
+    {
+        pthread_mutex_lock(&condMutex);
+        return;
+    }
+
+    if (outcome == ExposureScheduler::OUTCOME_DONE)
+    {
+        exposureRetry = 0;
+        InExposure = false;
+        PrimaryCCD.setExposureLeft(0.0);
+        if (ExposureRequest > VERBOSE_EXPOSURE)
+            LOG_INFO("Exposure done, downloading image...");
+        pthread_mutex_lock(&condMutex);
+        exposureSetRequest(StateIdle);
+        pthread_mutex_unlock(&condMutex);
         pthread_mutex_lock(&accessMutex);
-        float timeLeft = ArtemisExposureTimeRemaining(hCam);
+        grabImage();
         pthread_mutex_unlock(&accessMutex);
-        if (timeLeft > 1.1)
-        {
-            float fraction = timeLeft - static_cast<float>(static_cast<int>(timeLeft));
-            if (fraction >= 0.005)
-            {
-                uSecs = (fraction * 1000000.0f);
-            }
-            else
-            {
-                uSecs = 1000000;
-            }
-        }
-        else
-        {
-            uSecs = 10000;
-        }
-        if (timeLeft >= 0.0049)
-        {
-            PrimaryCCD.setExposureLeft(timeLeft);
-        }
+        pthread_mutex_lock(&condMutex);
+        return;
+    }
 
-        usleep(uSecs);
+    InExposure = false;
+    pthread_mutex_lock(&accessMutex);
+    ArtemisStopExposure(hCam);
+    pthread_mutex_unlock(&accessMutex);
+    usleep(100000);
+
+    if (outcome == ExposureScheduler::OUTCOME_FAILED && ++exposureRetry < MAX_EXP_RETRIES)
+    {
+        LOG_DEBUG("Camera reported an error. Restarting exposure...");
         pthread_mutex_lock(&condMutex);
+        exposureSetRequest(StateRestartExposure);
+        return;
+    }
+
+    pthread_mutex_lock(&condMutex);
+    if (threadRequest == StateExposure)
+    {
+        if (outcome == ExposureScheduler::OUTCOME_FAILED)
+            LOGF_ERROR("Exposure failed after %d attempts.", exposureRetry);
+        else
+            LOG_ERROR("Exposure status could not be read.");
     }
+    exposureRetry = 0;
+    PrimaryCCD.setExposureFailed();
+    exposureSetRequest(StateIdle);
+}
+
+/////////////////////////////////////////////////////////
+/// Publish the completion timing of the last exposure
+/////////////////////////////////////////////////////////
+void ATIKCCD::updateExposureStats()
+{
+    ExposureScheduler::Timing timing = exposureScheduler.timing();
+
+    ExposureStatsN[EXPOSURE_LATENCY].value  = timing.latency;
+    ExposureStatsN[EXPOSURE_CPU_TIME].value = timing.cpuTime;
+    ExposureStatsN[EXPOSURE_POLLS].value    = timing.polls;
+    ExposureStatsNP.s = IPS_OK;
+    IDSetNumber(&ExposureStatsNP, nullptr);
 }
 
 /////////////////////////////////////////////////////////
@@ -21,11 +21,15 @@
 
 #pragma once
 
+#include "exposure_scheduler.h"
+
 #include <AtikCameras.h>
 
 #include <indifilterinterface.h>
 #include <indiccd.h>
 
+#include <atomic>
+
 class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
 {
     public:
@@ -122,6 +126,7 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         // Exposure Progress
         void checkExposureProgress();
         void exposureSetRequest(ImageState request);
+        void updateExposureStats();
 
         // Guiding
         static void TimerHelperNS(void *context);
@@ -241,6 +246,16 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         };
 
 
+        // Exposure completion timing
+        INumber ExposureStatsN[3];
+        INumberVectorProperty ExposureStatsNP;
+        enum
+        {
+            EXPOSURE_LATENCY,
+            EXPOSURE_CPU_TIME,
+            EXPOSURE_POLLS,
+        };
+
         struct timeval ExpStart;
         double ExposureRequest { 0 };
         double TemperatureRequest { 1e6 };
@@ -254,6 +269,11 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         pthread_mutex_t condMutex = PTHREAD_MUTEX_INITIALIZER;
         pthread_mutex_t accessMutex = PTHREAD_MUTEX_INITIALIZER;
 
+        // Waits for the end of exposure on the imaging thread
+        ExposureScheduler exposureScheduler;
+        std::atomic_bool exposureCancelled { false };
+        int exposureRetry { 0 };
+
         // Pulse Guiding
         int WEtimerID;
         int NStimerID;
@@ -0,0 +1,160 @@
+/*
+ ATIK CCD exposure completion benchmark
+
+ Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+ Benchmark of short exposure sequences (flats, focus frames) on the mock Artemis API: the
+ polling loop ATIKCCD::checkExposureProgress used before against ExposureScheduler with the
+ status check the driver uses now. Reports frames per second, the time from the frame being
+ ready to its detection and the status calls made per frame.
+
+ Usage: atik_exposure_bench [frames] [readout ms] [query us]
+*/
+
+#include "atik_mock_api.h"
+#include "exposure_scheduler.h"
+
+#include <AtikCameras.h>
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static pthread_mutex_t condMutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t accessMutex = PTHREAD_MUTEX_INITIALIZER;
+
+struct Result
+{
+    double framesPerSecond;
+    double lateMs;
+    double queriesPerFrame;
+};
+
+// ATIKCCD::checkExposureProgress before ExposureScheduler, without the download
+static void legacyWait(ArtemisHandle hCam)
+{
+    int uSecs = 1000000;
+
+    pthread_mutex_lock(&condMutex);
+    while (true)
+    {
+        pthread_mutex_unlock(&condMutex);
+        pthread_mutex_lock(&accessMutex);
+        if (ArtemisImageReady(hCam))
+        {
+            pthread_mutex_unlock(&accessMutex);
+            return;
+        }
+
+        int state = ArtemisCameraState(hCam);
+        pthread_mutex_unlock(&accessMutex);
+        if (state == -1)
+            return;
+
+        pthread_mutex_lock(&accessMutex);
+        float timeLeft = ArtemisExposureTimeRemaining(hCam);
+        pthread_mutex_unlock(&accessMutex);
+        if (timeLeft > 1.1)
+        {
+            float fraction = timeLeft - static_cast<float>(static_cast<int>(timeLeft));
+            if (fraction >= 0.005)
+                uSecs = (fraction * 1000000.0f);
+            else
+                uSecs = 1000000;
+        }
+        else
+        {
+            uSecs = 10000;
+        }
+
+        usleep(uSecs);
+        pthread_mutex_lock(&condMutex);
+    }
+}
+
+// ATIKCCD::checkExposureProgress now, without the download
+static void schedulerWait(ArtemisHandle hCam, ExposureScheduler &scheduler, double duration)
+{
+    static std::atomic_bool quit { false };
+
+    scheduler.wait(duration, [hCam]()
+    {
+        pthread_mutex_lock(&accessMutex);
+        bool ready = ArtemisImageReady(hCam);
+        int state  = ready ? CAMERA_IDLE : ArtemisCameraState(hCam);
+        pthread_mutex_unlock(&accessMutex);
+
+        if (ready)
+            return ExposureScheduler::STATUS_DONE;
+        return state == -1 ? ExposureScheduler::STATUS_FAILED : ExposureScheduler::STATUS_WORKING;
+    }, nullptr, quit);
+}
+
+static Result run(bool legacy, int frames, double duration, const AtikMock::Config &config)
+{
+    ArtemisHandle hCam = nullptr;
+    ExposureScheduler scheduler;
+    double late = 0;
+
+    AtikMock::configure(config);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < frames; i++)
+    {
+        ArtemisStartExposure(hCam, duration);
+        if (legacy)
+            legacyWait(hCam);
+        else
+            schedulerWait(hCam, scheduler, duration);
+        late += std::chrono::duration<double, std::milli>(Clock::now() - AtikMock::readyTime()).count();
+        ArtemisStopExposure(hCam);
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    return { frames / seconds, late / frames, static_cast<double>(AtikMock::counters().statusQueries) / frames };
+}
+
+int main(int argc, char *argv[])
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 20;
+    AtikMock::Config config;
+    config.readoutMicros = (argc > 2 ? atof(argv[2]) : 15) * 1000;
+    config.queryMicros   = argc > 3 ? atoi(argv[3]) : 200;
+
+    const double durations[] = {0.001, 0.01, 0.05, 0.2, 1.0, 2.5};
+
+    printf("%d frames per duration, %.1f ms readout, %u us per status call\n\n", frames, config.readoutMicros / 1000.0,
+           config.queryMicros);
+    printf("%10s | %28s | %28s\n", "", "legacy polling", "scheduler");
+    printf("%10s | %8s %9s %9s | %8s %9s %9s\n", "exposure", "fps", "late ms", "calls", "fps", "late ms", "calls");
+
+    for (double duration : durations)
+    {
+        Result legacy = run(true, frames, duration, config);
+        Result current = run(false, frames, duration, config);
+        printf("%9.3fs | %8.2f %9.2f %9.1f | %8.2f %9.2f %9.1f\n", duration, legacy.framesPerSecond, legacy.lateMs,
+               legacy.queriesPerFrame, current.framesPerSecond, current.lateMs, current.queriesPerFrame);
+    }
+
+    return 0;
+}
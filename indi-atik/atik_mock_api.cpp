@@ -0,0 +1,115 @@
+/*
+ ATIK CCD mock Artemis API
+
+ Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "atik_mock_api.h"
+
+#include <AtikCameras.h>
+
+#include <mutex>
+#include <thread>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+std::mutex mockLock;
+AtikMock::Config mockConfig;
+AtikMock::Counters mockCounters;
+
+bool exposing = false;
+Clock::time_point exposureEnd;
+Clock::time_point frameReady;
+
+// Counts a status call and spends the time of the USB round trip, outside the lock
+Clock::time_point query()
+{
+    uint32_t micros;
+    {
+        std::lock_guard<std::mutex> lock(mockLock);
+        mockCounters.statusQueries++;
+        micros = mockConfig.queryMicros;
+    }
+    if (micros > 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(micros));
+    return Clock::now();
+}
+}
+
+void AtikMock::configure(const Config &config)
+{
+    std::lock_guard<std::mutex> lock(mockLock);
+    mockConfig   = config;
+    mockCounters = Counters();
+    exposing     = false;
+}
+
+AtikMock::Counters AtikMock::counters()
+{
+    std::lock_guard<std::mutex> lock(mockLock);
+    return mockCounters;
+}
+
+std::chrono::steady_clock::time_point AtikMock::readyTime()
+{
+    std::lock_guard<std::mutex> lock(mockLock);
+    return frameReady;
+}
+
+int ArtemisStartExposure(ArtemisHandle, float seconds)
+{
+    std::lock_guard<std::mutex> lock(mockLock);
+    mockCounters.exposures++;
+    exposing    = true;
+    exposureEnd = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(seconds * 1e6));
+    frameReady  = exposureEnd + std::chrono::microseconds(mockConfig.readoutMicros);
+    return ARTEMIS_OK;
+}
+
+int ArtemisStopExposure(ArtemisHandle)
+{
+    std::lock_guard<std::mutex> lock(mockLock);
+    exposing = false;
+    return ARTEMIS_OK;
+}
+
+BOOL ArtemisImageReady(ArtemisHandle)
+{
+    Clock::time_point now = query();
+    std::lock_guard<std::mutex> lock(mockLock);
+    return exposing && now >= frameReady;
+}
+
+int ArtemisCameraState(ArtemisHandle)
+{
+    Clock::time_point now = query();
+    std::lock_guard<std::mutex> lock(mockLock);
+    if (!exposing || now >= frameReady)
+        return CAMERA_IDLE;
+    return now < exposureEnd ? CAMERA_EXPOSING : CAMERA_DOWNLOADING;
+}
+
+float ArtemisExposureTimeRemaining(ArtemisHandle)
+{
+    Clock::time_point now = query();
+    std::lock_guard<std::mutex> lock(mockLock);
+    if (!exposing || now >= exposureEnd)
+        return 0;
+    return std::chrono::duration<float>(exposureEnd - now).count();
+}
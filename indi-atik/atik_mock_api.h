@@ -0,0 +1,55 @@
+/*
+ ATIK CCD mock Artemis API
+
+ Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Stand-in for the exposure calls of the Artemis API, linked instead of libatikcameras to
+ * time exposure completion without a camera.
+ *
+ * An exposure becomes ready readoutMicros after its duration has elapsed. Every status call
+ * (ArtemisImageReady, ArtemisCameraState, ArtemisExposureTimeRemaining) takes queryMicros,
+ * like a USB round trip, and is counted.
+ */
+namespace AtikMock
+{
+
+struct Config
+{
+    uint32_t readoutMicros { 0 };
+    uint32_t queryMicros { 0 };
+};
+
+struct Counters
+{
+    uint32_t exposures { 0 };
+    uint32_t statusQueries { 0 };
+};
+
+void configure(const Config &config);
+Counters counters();
+
+/** When the frame of the last exposure started became ready. */
+std::chrono::steady_clock::time_point readyTime();
+
+}
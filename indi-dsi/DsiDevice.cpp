@@ -13,6 +13,7 @@
 #include "DsiException.h"
 #include "Util.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
@@ -29,6 +30,12 @@
 #define MILLISEC 2
 #endif
 
+/* Fields are read with FIELD_TRANSFERS bulk transfers of up to FIELD_CHUNK_SIZE
+ * bytes queued on EP 0x86.  The chunk size is a multiple of the 512 byte bulk
+ * packet size, so only the last transfer of a field can be short. */
+#define FIELD_TRANSFERS  4
+#define FIELD_CHUNK_SIZE (128 * 1024)
+
 static unsigned int last_time;
 
 static unsigned int get_sysclock_ms()
@@ -808,16 +815,281 @@ int DSI::Device::startExposure(int howlong, int gain, int offs)
     return 0;
 }
 
+namespace
+{
+struct FieldChunk
+{
+    unsigned char *data;
+    size_t size;
+    bool odd;
+    bool last; /* last chunk of its field, a short one is reported once the read is over */
+};
+
+struct FieldRead
+{
+    std::vector<FieldChunk> chunks;
+    std::vector<bool> done;
+    std::vector<size_t> received; /* actual length of each done chunk */
+    size_t submitted  = 0;
+    int in_flight     = 0;
+    bool failed       = false;
+    std::string error;
+};
+
+struct FieldTransfer
+{
+    FieldRead *read;
+    size_t chunk;
+    struct libusb_transfer *transfer;
+};
+}
+
+static bool submit_field_chunk(FieldTransfer *slot)
+{
+    FieldRead *read         = slot->read;
+    const FieldChunk &chunk = read->chunks[read->submitted];
+
+    slot->chunk              = read->submitted;
+    slot->transfer->buffer   = chunk.data;
+    slot->transfer->length   = chunk.size;
+    int rc                   = libusb_submit_transfer(slot->transfer);
+    if (rc < 0)
+    {
+        read->failed = true;
+        read->error  = std::string("submit failed, ") + libusb_error_name(rc);
+        return false;
+    }
+    read->submitted++;
+    read->in_flight++;
+    return true;
+}
+
+static void LIBUSB_CALL field_read_callback(struct libusb_transfer *transfer)
+{
+    FieldTransfer *slot     = static_cast<FieldTransfer *>(transfer->user_data);
+    FieldRead *read         = slot->read;
+    const FieldChunk &chunk = read->chunks[slot->chunk];
+
+    read->in_flight--;
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED ||
+            (static_cast<size_t>(transfer->actual_length) < chunk.size && !chunk.last))
+    {
+        if (!read->failed)
+        {
+            std::stringstream ss;
+            ss << "transfer status " << transfer->status << ", " << transfer->actual_length << " of " << chunk.size
+               << " bytes";
+            read->error = ss.str();
+        }
+        read->failed = true;
+        return;
+    }
+    read->received[slot->chunk] = transfer->actual_length;
+    read->done[slot->chunk]     = true;
+
+    if (!read->failed && read->submitted < read->chunks.size())
+        submit_field_chunk(slot);
+}
+
+/* Reads the even field (if any) and then the odd field.  All chunks of both
+ * fields are queued back to back, so the camera never waits for the next
+ * request, not even between the fields.  progress is told how many leading
+ * bytes of each field have arrived. */
+void DSI::Device::readFields(unsigned char *even, size_t even_size, unsigned char *odd, size_t odd_size,
+                             const std::function<void(size_t even_ready, size_t odd_ready)> &progress)
+{
+    FieldRead read;
+    for (int f = 0; f < 2; f++)
+    {
+        unsigned char *data = f ? odd : even;
+        size_t size         = f ? odd_size : even_size;
+        for (size_t offset = 0; offset < size; offset += FIELD_CHUNK_SIZE)
+        {
+            size_t length = std::min<size_t>(FIELD_CHUNK_SIZE, size - offset);
+            read.chunks.push_back({ data + offset, length, f == 1, offset + length == size });
+        }
+    }
+    read.done.assign(read.chunks.size(), false);
+    read.received.assign(read.chunks.size(), 0);
+
+    FieldTransfer slots[FIELD_TRANSFERS];
+    for (int i = 0; i < FIELD_TRANSFERS; i++)
+    {
+        slots[i].read     = &read;
+        slots[i].chunk    = 0;
+        slots[i].transfer = nullptr;
+        if (read.failed || read.submitted >= read.chunks.size())
+            continue;
+        slots[i].transfer = libusb_alloc_transfer(0);
+        if (slots[i].transfer == nullptr)
+            continue;
+        libusb_fill_bulk_transfer(slots[i].transfer, handle, 0x86, nullptr, 0, field_read_callback, &slots[i],
+                                  60000 * MILLISEC);
+        submit_field_chunk(&slots[i]);
+    }
+
+    if (read.in_flight == 0 && !read.chunks.empty())
+    {
+        /* Nothing could be queued, read the fields one at a time */
+        for (int i = 0; i < FIELD_TRANSFERS; i++)
+            if (slots[i].transfer != nullptr)
+                libusb_free_transfer(slots[i].transfer);
+
+        for (int f = 0; f < 2; f++)
+        {
+            size_t size = f ? odd_size : even_size;
+            int transferred = 0;
+            if (size == 0)
+                continue;
+            int status = libusb_bulk_transfer(handle, 0x86, f ? odd : even, size, &transferred, 60000 * MILLISEC);
+            if (status != 0)
+            {
+                std::stringstream ss;
+                ss << std::dec << "read " << (f ? "odd" : "even") << " data, status = (" << status << ") "
+                   << strerror(-status);
+                throw device_read_error(ss.str());
+            }
+            if (static_cast<size_t>(transferred) < size)
+            {
+                std::stringstream ss;
+                ss << std::dec << "read " << (f ? "odd" : "even") << " data, " << transferred << " of " << size
+                   << " bytes";
+                throw device_read_error(ss.str());
+            }
+        }
+        progress(even_size, odd_size);
+        return;
+    }
+
+    size_t chunk = 0, even_ready = 0, odd_ready = 0;
+    bool cancelled = false;
+    while (read.in_flight > 0)
+    {
+        struct timeval tv = { 1, 0 };
+        int rc = libusb_handle_events_timeout_completed(nullptr, &tv, nullptr);
+        if (rc < 0 && rc != LIBUSB_ERROR_INTERRUPTED && !read.failed)
+        {
+            read.failed = true;
+            read.error  = std::string("event handling failed, ") + libusb_error_name(rc);
+        }
+
+        if (read.failed && !cancelled)
+        {
+            for (int i = 0; i < FIELD_TRANSFERS; i++)
+                if (slots[i].transfer != nullptr)
+                    libusb_cancel_transfer(slots[i].transfer);
+            cancelled = true;
+        }
+
+        /* Chunks complete in order on one endpoint, report the contiguous part */
+        bool advanced = false;
+        for (; chunk < read.chunks.size() && read.done[chunk]; chunk++)
+        {
+            (read.chunks[chunk].odd ? odd_ready : even_ready) += read.received[chunk];
+            advanced = true;
+        }
+        if (advanced && !read.failed)
+            progress(even_ready, odd_ready);
+    }
+
+    for (int i = 0; i < FIELD_TRANSFERS; i++)
+        if (slots[i].transfer != nullptr)
+            libusb_free_transfer(slots[i].transfer);
+
+    if (read.failed)
+    {
+        const char *field = (chunk < read.chunks.size() && read.chunks[chunk].odd) ? "odd" : "even";
+        throw device_read_error(std::string("read ") + field + " data, " + read.error);
+    }
+
+    /* A short final chunk ends its field early, the rest of the buffer still holds the previous frame */
+    for (int f = 0; f < 2; f++)
+    {
+        size_t size  = f ? odd_size : even_size;
+        size_t ready = f ? odd_ready : even_ready;
+        if (ready < size)
+        {
+            std::stringstream ss;
+            ss << std::dec << "read " << (f ? "odd" : "even") << " data, " << ready << " of " << size << " bytes";
+            throw device_read_error(ss.str());
+        }
+    }
+}
+
+/* Reads one frame into the persistent buffers of the current binning mode and
+ * points framebuffer at it.  Image rows are copied out of the fields while the
+ * rest of the fields is still in transfer. */
+unsigned char *DSI::Device::readFrame(const FrameLayout &layout, size_t even_size, size_t odd_size)
+{
+    ReadoutBuffers &buffers = readout_buffers[binning2x2 ? 1 : 0];
+    const size_t frame_size = 2 * static_cast<size_t>(layout.image_width) * layout.image_height;
+
+    if (buffers.even.size() < even_size)
+        buffers.even.resize(even_size);
+    if (buffers.odd.size() < odd_size)
+        buffers.odd.resize(odd_size);
+    if (buffers.frame.size() < frame_size)
+        buffers.frame.resize(frame_size);
+
+    unsigned char *even = buffers.even.data();
+    unsigned char *odd  = buffers.odd.data();
+    framebuffer         = buffers.frame.data();
+
+    unsigned int merged = 0;
+    auto merge = [&](size_t even_ready, size_t odd_ready)
+    {
+        unsigned int ready = rowsReady(layout, even_ready, odd_ready);
+        if (ready > merged)
+        {
+            mergeRows(layout, even, odd, framebuffer, merged, ready);
+            merged = ready;
+        }
+    };
+
+    readFields(even, even_size, odd, odd_size, merge);
+
+    /* Keep the raw fields for dsi_frame_bench */
+    const char *capture = getenv("INDI_DSI_CAPTURE");
+    if (capture != nullptr)
+    {
+        static unsigned int captured = 0;
+        std::stringstream path;
+        path << capture << "/dsi_" << layout.image_width << "x" << layout.image_height << "_" << captured++
+             << ".fields";
+        if (!saveFields(path.str().c_str(), layout, even, even_size, odd, odd_size))
+            std::cerr << "cannot write " << path.str() << std::endl;
+    }
+
+    if (log_commands)
+    {
+        log_command_info(false, "r 86", even_size + odd_size, (char *)odd, 0);
+        std::cerr << std::dec << "read " << (layout.interlaced ? "interlaced" : "progressive") << " data, requested "
+                  << even_size << " + " << odd_size << " bytes, " << layout.read_width << " x "
+                  << (even_size + odd_size) / (2 * layout.read_width) << std::endl
+                  << "t_image_height  =" << layout.image_height << std::endl
+                  << "t_image_width   =" << layout.image_width << std::endl
+                  << "t_image_offset_x=" << layout.offset_x << std::endl
+                  << "t_image_offset_y=" << layout.offset_y << std::endl
+                  << "merged rows     =" << merged << std::endl;
+    }
+
+    if (merged < layout.image_height)
+    {
+        std::stringstream ss;
+        ss << "fields hold only " << merged << " of " << layout.image_height << " image rows";
+        throw device_read_error(ss.str());
+    }
+
+    return framebuffer;
+}
+
 unsigned char *DSI::Device::downloadImage()
 {
-    int status = 0;
-    int transferred = 0;
     int interlaced = 0;
     int rawtemp = 0;
     unsigned int t_read_width = 0;
     unsigned int t_read_height_even = 0;
     unsigned int t_read_height_odd = 0;
-    unsigned int t_read_height = 0;
     unsigned int t_read_bpp = 0;
     unsigned int t_image_width = 0;
     unsigned int t_image_height = 0;
@@ -852,86 +1124,19 @@ unsigned char *DSI::Device::downloadImage()
         t_image_offset_y   = image_offset_y;
     }
 
-    t_read_height = t_read_height_even + t_read_height_odd;
-    t_read_bpp    = read_bpp;
-
-    unsigned int odd_size  = t_read_bpp * t_read_width * t_read_height_odd;
-    unsigned int even_size = t_read_bpp * t_read_width * t_read_height_even;
-    unsigned int all_size  = t_read_bpp * t_read_width * t_read_height;
-    unsigned char *odd_data = new unsigned char[odd_size];
-    unsigned char *even_data = nullptr;
-
-    if (interlaced)
-        even_data = new unsigned char[even_size];
-
-    framebuffer = new unsigned char[all_size];
+    t_read_bpp = read_bpp;
 
-    if (interlaced)
-    {
-        /* XXX: There has to be  a way to calculate a more optimal readout
-               time here. */
-        status = libusb_bulk_transfer(handle, 0x86, even_data, even_size, &transferred, 60000 * MILLISEC);
-        if (log_commands)
-        {
-            log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)even_data, 0);
-
-            std::cerr << std::dec << "read even data, status = (" << status << ") " << (status > 0 ? "" : strerror(-status))
-                      << std::endl
-                      << "    requested " << even_size << " bytes " << t_read_width << " x " << t_read_height_even
-                      << " (even pixels)" << std::endl
-                      << "Transferred: " << transferred << " bytes" << std::endl;
-        }
-
-        if (status != 0)
-        {
-            std::stringstream ss;
-            ss << std::dec << "read even data, status = (" << status << ") " << strerror(-status);
-            throw device_read_error(ss.str());
-        }
-
-        status = libusb_bulk_transfer(handle, 0x86, odd_data, odd_size, &transferred, 60000 * MILLISEC);
-        if (log_commands)
-        {
-            log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)odd_data, 0);
-
-            std::cerr << std::dec << "read odd data, status = (" << status << ") " << (status > 0 ? "" : strerror(-status))
-                      << std::endl
-                      << "    requested " << odd_size << " bytes " << t_read_width << " x " << t_read_height_odd
-                      << " (odd pixels)" << std::endl
-                      << "Transferred: " << transferred << " bytes" << std::endl;
-        }
-
-        if (status != 0)
-        {
-            std::stringstream ss;
-            ss << std::dec << "read odd data, status = (" << status << ") " << strerror(-status);
-            throw device_read_error(ss.str());
-        }
-    }
-    else // progressive mode for DSI III (gs)
+    if (!interlaced) // progressive mode for DSI III (gs)
     {
         if ((!vdd_on) && (exposure_time >= VDD_TRH))
             command(DeviceCommand::SET_VDD_MODE, VddMode::ON.value());
-
-        status = libusb_bulk_transfer(handle, 0x86, odd_data, odd_size, &transferred, 60000 * MILLISEC);
-        if (log_commands)
-        {
-            log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)odd_data, 0);
-
-            std::cerr << std::dec << "read progressive data, status = (" << status << ") " << std::endl
-                      << "    requested " << odd_size << " bytes " << t_read_width << " x " << t_read_height_odd
-                      << " (pixels)" << std::endl
-                      << "Transferred: " << transferred << " bytes" << std::endl;
-        }
-
-        if (status != 0)
-        {
-            std::stringstream ss;
-            ss << std::dec << "read progressive data, status = (" << status << ") ";
-            throw device_read_error(ss.str());
-        }
     }
 
+    FrameLayout layout = { t_read_width, t_image_width, t_image_height, t_image_offset_x, t_image_offset_y,
+                           interlaced != 0
+                         };
+    readFrame(layout, t_read_bpp * t_read_width * t_read_height_even, t_read_bpp * t_read_width * t_read_height_odd);
+
     /* Update temperature for devices with sensor (gs) */
 
     if (has_tempsensor)
@@ -945,85 +1150,7 @@ unsigned char *DSI::Device::downloadImage()
     /* disable 2x2 binning after downloading image (gs) */
     disable2x2Binning();
 
-    unsigned char msb = 0, lsb = 0, is_odd = 0;
-    unsigned int x_ptr = 0, line_start = 0, y_ptr = 0, read_ptr = 0, write_ptr = 0;
-    char *even = (char *)even_data;
-    char *odd  = (char *)odd_data;
-
-    if (log_commands)
-        std::cerr << "t_image_height  =" << t_image_height << std::endl
-                  << "t_image_width   =" << t_image_width << std::endl
-                  << "t_image_offset_x=" << t_image_offset_x << std::endl
-                  << "t_image_offset_y=" << t_image_offset_y << std::endl
-                  << "t_read_width    =" << t_read_width << std::endl
-                  << "t_read_height   =" << t_read_height << std::endl
-                  << "t_read_bpp      =" << t_read_bpp << std::endl;
-
-    if (interlaced)
-    {
-        for (write_ptr = y_ptr = 0; y_ptr < t_image_height; y_ptr++)
-        {
-            line_start = t_read_width * ((y_ptr + t_image_offset_y) / 2);
-            is_odd     = (y_ptr + t_image_offset_y) % 2;
-
-            std::cerr << "starting image row " << y_ptr << ", write_ptr=" << write_ptr << ", line_start=" << line_start
-                      << ", is_odd=" << (is_odd == 0 ? 0 : 1) << ", read_ptr=" << (line_start + t_image_offset_x) * 2
-                      << std::endl;
-
-            for (x_ptr = 0; x_ptr < t_image_width; x_ptr++)
-            {
-                read_ptr = (line_start + x_ptr + t_image_offset_x) * 2;
-                if (is_odd == 1) // odd line
-                {
-                    msb = odd[read_ptr];
-                    lsb = odd[read_ptr + 1];
-                }
-                else
-                {
-                    // even line
-                    msb = even[read_ptr];
-                    lsb = even[read_ptr + 1];
-                }
-                framebuffer[write_ptr++] = msb;
-                framebuffer[write_ptr++] = lsb;
-            }
-        }
-    }
-    else
-    {
-        for (write_ptr = y_ptr = 0; y_ptr < t_image_height; y_ptr++)
-        {
-            line_start = t_read_width * (y_ptr + t_image_offset_y);
-
-            // std::cerr << "starting image row " << y_ptr
-            //      << ", write_ptr=" << write_ptr
-            //      << ", line_start=" << line_start
-            //      << ", read_ptr=" << (line_start+t_image_offset_x)*2
-            //      << std::endl;
-            for (x_ptr = 0; x_ptr < t_image_width; x_ptr++)
-            {
-                read_ptr = (line_start + x_ptr + t_image_offset_x) * 2;
-
-                msb = odd[read_ptr];
-                lsb = odd[read_ptr + 1];
-
-                framebuffer[write_ptr++] = msb;
-                framebuffer[write_ptr++] = lsb;
-            }
-        }
-    }
-
-    if (log_commands)
-        std::cerr << "write_ptr=" << write_ptr << std::endl;
-
-    delete[] odd_data;
-
-    if (interlaced)
-        delete[] even_data;
-
     return framebuffer;
-
-    throw dsi_exception("unsupported image command");
 }
 
 /* ask camera for remaining exposure time for long exposures (gs) */
@@ -1092,14 +1219,11 @@ void DSI::Device::disable2x2Binning()
 
 unsigned char *DSI::Device::getImage(DeviceCommand __command, int howlong)
 {
-    int transferred = 0;
-
     if (((__command == DeviceCommand::TRIGGER)) || (__command == DeviceCommand::TEST_PATTERN))
     {
         // Monkey code.  Monkey see (SniffUSB), monkey do).  Some part of this
         // is required because w/o it, I get segfaults on the second attempt
         // to run the code.
-        int status = 0;
         int interlaced = 0;
         int rawtemp = 0;
 
@@ -1303,17 +1427,6 @@ unsigned char *DSI::Device::getImage(DeviceCommand __command, int howlong)
             t_image_offset_y = 0;
         }
 
-        unsigned int odd_size  = t_read_bpp * t_read_width * t_read_height_odd;
-        unsigned int even_size = t_read_bpp * t_read_width * t_read_height_even;
-        unsigned int all_size  = t_read_bpp * t_read_width * t_read_height;
-        unsigned char *odd_data = new unsigned char[odd_size];
-        unsigned char *even_data = nullptr;
-
-        if (interlaced)
-            even_data = new unsigned char[even_size];
-
-        framebuffer = new unsigned char[all_size];
-
         /* The Meade driver seems to only issue a GET_EXP_TIME_COUNT command
          * when the exposure is over about 2 seconds (count = 20,000).  From
          * testing, it looks like if I try to issue this command for exposures
@@ -1332,46 +1445,10 @@ unsigned char *DSI::Device::getImage(DeviceCommand __command, int howlong)
         if (last_time == 0)
             last_time = get_sysclock_ms();
 
-        if (interlaced)
-        {
-            /* XXX: There has to be  a way to calculate a more optimal readout
-               time here. */
-            status = libusb_bulk_transfer(handle, 0x86, even_data, even_size, &transferred, 60000 * MILLISEC);
-            if (log_commands)
-            {
-                log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)even_data, 0);
-
-                std::cerr << std::dec << "read even data, status = (" << status << ") " << (status > 0 ? "" : strerror(-status))
-                          << std::endl
-                          << "    requested " << even_size << " bytes " << t_read_width << " x " << t_read_height_even
-                          << " (even pixels)" << std::endl;
-            }
-
-            if (status < 0)
-            {
-                std::stringstream ss;
-                ss << std::dec << "read even data, status = (" << status << ") " << strerror(-status);
-                throw device_read_error(ss.str());
-            }
-        }
-
-        status = libusb_bulk_transfer(handle, 0x86, odd_data, odd_size, &transferred, 60000 * MILLISEC);
-        if (log_commands)
-        {
-            log_command_info(false, "r 86", (status > 0 ? status : 0), (char *)even_data, 0);
-
-            std::cerr << std::dec << "read odd data, status = (" << status << ") " << (status > 0 ? "" : strerror(-status))
-                      << std::endl
-                      << "    requested " << odd_size << " bytes " << t_read_width << " x " << t_read_height_odd
-                      << " (odd pixels)" << std::endl;
-        }
-
-        if (status < 0)
-        {
-            std::stringstream ss;
-            ss << std::dec << "read odd data, status = (" << status << ") " << strerror(-status);
-            throw device_read_error(ss.str());
-        }
+        FrameLayout layout = { t_read_width, t_image_width, t_image_height, t_image_offset_x, t_image_offset_y,
+                               interlaced != 0
+                             };
+        readFrame(layout, t_read_bpp * t_read_width * t_read_height_even, t_read_bpp * t_read_width * t_read_height_odd);
 
         if (has_tempsensor)
         {
@@ -1383,80 +1460,6 @@ unsigned char *DSI::Device::getImage(DeviceCommand __command, int howlong)
 
         disable2x2Binning();
 
-        unsigned char msb = 0, lsb = 0, is_odd = 0;
-        unsigned int x_ptr = 0, line_start = 0, y_ptr = 0, read_ptr = 0, write_ptr = 0;
-        char *even = (char *)even_data;
-        char *odd  = (char *)odd_data;
-
-        if (log_commands)
-            std::cerr << "t_image_height  =" << t_image_height << std::endl
-                      << "t_image_width   =" << t_image_width << std::endl
-                      << "t_image_offset_x=" << t_image_offset_x << std::endl
-                      << "t_image_offset_y=" << t_image_offset_y << std::endl
-                      << "t_read_width    =" << t_read_width << std::endl
-                      << "t_read_height   =" << t_read_height << std::endl
-                      << "t_read_bpp      =" << t_read_bpp << std::endl;
-
-        if (interlaced)
-        {
-            for (write_ptr = y_ptr = 0; y_ptr < t_image_height; y_ptr++)
-            {
-                line_start = t_read_width * ((y_ptr + t_image_offset_y) / 2);
-                is_odd     = (y_ptr + t_image_offset_y) % 2;
-
-                std::cerr << "starting image row " << y_ptr << ", write_ptr=" << write_ptr << ", line_start=" << line_start
-                          << ", is_odd=" << (is_odd == 0 ? 0 : 1) << ", read_ptr=" << (line_start + t_image_offset_x) * 2
-                          << std::endl;
-                for (x_ptr = 0; x_ptr < t_image_width; x_ptr++)
-                {
-                    read_ptr = (line_start + x_ptr + t_image_offset_x) * 2;
-                    if (is_odd == 1) // odd line
-                    {
-                        msb = odd[read_ptr];
-                        lsb = odd[read_ptr + 1];
-                    }
-                    else
-                    {
-                        // even line
-                        msb = even[read_ptr];
-                        lsb = even[read_ptr + 1];
-                    }
-                    framebuffer[write_ptr++] = msb;
-                    framebuffer[write_ptr++] = lsb;
-                }
-            }
-        }
-        else
-        {
-            for (write_ptr = y_ptr = 0; y_ptr < t_image_height; y_ptr++)
-            {
-                line_start = t_read_width * (y_ptr + t_image_offset_y);
-
-                //std::cerr << "starting image row " << y_ptr
-                //     << ", write_ptr=" << write_ptr
-                //     << ", line_start=" << line_start
-                //     << ", read_ptr=" << (line_start+t_image_offset_x)*2 << std::endl;
-                for (x_ptr = 0; x_ptr < t_image_width; x_ptr++)
-                {
-                    read_ptr = (line_start + x_ptr + t_image_offset_x) * 2;
-
-                    msb = odd[read_ptr];
-                    lsb = odd[read_ptr + 1];
-
-                    framebuffer[write_ptr++] = msb;
-                    framebuffer[write_ptr++] = lsb;
-                }
-            }
-        }
-
-        if (log_commands)
-            std::cerr << "write_ptr=" << write_ptr << std::endl;
-
-        delete[] odd_data;
-
-        if (interlaced)
-            delete[] even_data;
-
         return framebuffer;
     }
 
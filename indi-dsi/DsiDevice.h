@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include "DsiFrame.h"
 #include "DsiTypes.h"
 
 #include <libusb.h>
 
+#include <functional>
 #include <string>
+#include <vector>
 
 #ifndef LONGEXP
 #define LONGEXP 20000
@@ -33,6 +36,17 @@ class Device
         /* image frame buffer (gs) */
         unsigned char *framebuffer;
 
+        /* Field and frame buffers of the 1x1 [0] and 2x2 [1] readouts.  They are
+             * kept between exposures and only grow when a readout needs more room.
+             */
+        struct ReadoutBuffers
+        {
+            std::vector<unsigned char> even;
+            std::vector<unsigned char> odd;
+            std::vector<unsigned char> frame;
+        };
+        ReadoutBuffers readout_buffers[2];
+
         /* These are chip-specific sizes required to parameterize the image
              * retrieval.
              */
@@ -175,6 +189,14 @@ class Device
         virtual unsigned char *getImage(int howlong);
         virtual unsigned char *getImage(DeviceCommand __command, int howlong);
 
+        /* Read the even and odd fields from EP 0x86 and assemble them into
+             * framebuffer as they arrive.  Returns framebuffer, throws
+             * device_read_error.
+             */
+        unsigned char *readFrame(const FrameLayout &layout, size_t even_size, size_t odd_size);
+        void readFields(unsigned char *even, size_t even_size, unsigned char *odd, size_t odd_size,
+                        const std::function<void(size_t even_ready, size_t odd_ready)> &progress);
+
         void sendRegister(AdRegister adr, unsigned int arg);
 
     public:
@@ -257,6 +279,7 @@ class Device
         virtual unsigned char *downloadImage();
         virtual int startExposure(int howlong, int gain = 0, int offs = 0x0ff);
         virtual int ExposureInProgress();
+        /* Big endian image of the last readout, owned by the device. */
         virtual unsigned char *ccdFramebuffer();
 
         virtual void set1x1Binning();
@@ -0,0 +1,139 @@
+/**
+ * Meade DSI frame assembly
+ *
+ * Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "DsiFrame.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#include <arm_neon.h>
+#define DSI_FRAME_NEON
+#endif
+
+unsigned int DSI::rowsReady(const FrameLayout &layout, size_t even_bytes, size_t odd_bytes)
+{
+    const size_t row_bytes = 2 * static_cast<size_t>(layout.read_width);
+    if (row_bytes == 0)
+        return 0;
+
+    if (!layout.interlaced)
+    {
+        size_t rows = odd_bytes / row_bytes;
+        return rows <= layout.offset_y ? 0 : std::min<size_t>(layout.image_height, rows - layout.offset_y);
+    }
+
+    /* Field row r holds image rows 2r (even field) and 2r + 1 (odd field) */
+    const size_t even_rows = even_bytes / row_bytes;
+    const size_t odd_rows  = odd_bytes / row_bytes;
+    const size_t complete  = std::min(2 * even_rows, 2 * odd_rows + 1);
+    return complete <= layout.offset_y ? 0 : std::min<size_t>(layout.image_height, complete - layout.offset_y);
+}
+
+void DSI::mergeRows(const FrameLayout &layout, const unsigned char *even, const unsigned char *odd, unsigned char *dst,
+                    unsigned int first, unsigned int last)
+{
+    const size_t row_bytes = 2 * static_cast<size_t>(layout.image_width);
+
+    for (unsigned int y = first; y < last; y++)
+    {
+        const unsigned int field_y = y + layout.offset_y;
+        const unsigned char *field = odd;
+        size_t line_start          = field_y;
+
+        if (layout.interlaced)
+        {
+            field      = (field_y % 2) ? odd : even;
+            line_start = field_y / 2;
+        }
+
+        memcpy(dst + y * row_bytes, field + 2 * (line_start * layout.read_width + layout.offset_x), row_bytes);
+    }
+}
+
+void DSI::beToHost(uint16_t *dst, const unsigned char *src, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i + 16));
+
+        v0 = _mm_or_si128(_mm_slli_epi16(v0, 8), _mm_srli_epi16(v0, 8));
+        v1 = _mm_or_si128(_mm_slli_epi16(v1, 8), _mm_srli_epi16(v1, 8));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 8), v1);
+    }
+#elif defined(DSI_FRAME_NEON)
+    for (; i + 16 <= count; i += 16)
+    {
+        uint8x16_t v0 = vrev16q_u8(vld1q_u8(src + 2 * i));
+        uint8x16_t v1 = vrev16q_u8(vld1q_u8(src + 2 * i + 16));
+
+        vst1q_u16(dst + i, vreinterpretq_u16_u8(v0));
+        vst1q_u16(dst + i + 8, vreinterpretq_u16_u8(v1));
+    }
+#endif
+
+    for (; i < count; i++)
+        dst[i] = static_cast<uint16_t>((src[2 * i] << 8) | src[2 * i + 1]);
+}
+
+bool DSI::saveFields(const char *path, const FrameLayout &layout, const unsigned char *even, size_t even_size,
+                     const unsigned char *odd, size_t odd_size)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == nullptr)
+        return false;
+
+    fprintf(f, "DSIFIELDS %u %u %u %u %u %d %zu %zu\n", layout.read_width, layout.image_width, layout.image_height,
+            layout.offset_x, layout.offset_y, layout.interlaced ? 1 : 0, even_size, odd_size);
+    bool ok = fwrite(even, 1, even_size, f) == even_size && fwrite(odd, 1, odd_size, f) == odd_size;
+    return fclose(f) == 0 && ok;
+}
+
+bool DSI::loadFields(const char *path, FrameLayout &layout, std::vector<unsigned char> &even,
+                     std::vector<unsigned char> &odd)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr)
+        return false;
+
+    int interlaced = 0;
+    size_t even_size = 0, odd_size = 0;
+    bool ok = fscanf(f, "DSIFIELDS %u %u %u %u %u %d %zu %zu", &layout.read_width, &layout.image_width,
+                     &layout.image_height, &layout.offset_x, &layout.offset_y, &interlaced, &even_size, &odd_size) == 8 &&
+              fgetc(f) == '\n';
+    if (ok)
+    {
+        layout.interlaced = interlaced != 0;
+        even.resize(even_size);
+        odd.resize(odd_size);
+        ok = fread(even.data(), 1, even_size, f) == even_size && fread(odd.data(), 1, odd_size, f) == odd_size;
+    }
+    fclose(f);
+    return ok;
+}
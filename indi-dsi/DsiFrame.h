@@ -0,0 +1,61 @@
+/**
+ * Meade DSI frame assembly
+ *
+ * Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DSI
+{
+/* Where the image sits in the fields read from the camera.  All sizes are in
+ * 16 bit samples, stored big endian by the camera. */
+struct FrameLayout
+{
+    unsigned int read_width;    /* samples per field row */
+    unsigned int image_width;
+    unsigned int image_height;
+    unsigned int offset_x;
+    unsigned int offset_y;
+    bool interlaced;            /* even and odd image rows come in separate fields */
+};
+
+/* Number of leading image rows whose field rows are complete, given how many
+ * bytes of each field have been received.  Progressive images only use the
+ * odd field. */
+unsigned int rowsReady(const FrameLayout &layout, size_t even_bytes, size_t odd_bytes);
+
+/* Copy image rows [first, last) out of the fields into dst, one row of
+ * image_width samples after the other.  The byte order is left alone. */
+void mergeRows(const FrameLayout &layout, const unsigned char *even, const unsigned char *odd, unsigned char *dst,
+               unsigned int first, unsigned int last);
+
+/* Convert count big endian samples to host order, src and dst may be the same. */
+void beToHost(uint16_t *dst, const unsigned char *src, size_t count);
+
+/* Raw fields as read from the camera, with the layout in a one line text
+ * header.  Written by the driver when INDI_DSI_CAPTURE names a directory and
+ * read back by dsi_frame_bench. */
+bool saveFields(const char *path, const FrameLayout &layout, const unsigned char *even, size_t even_size,
+                const unsigned char *odd, size_t odd_size);
+bool loadFields(const char *path, FrameLayout &layout, std::vector<unsigned char> &even,
+                std::vector<unsigned char> &odd);
+}
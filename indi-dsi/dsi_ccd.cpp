@@ -474,8 +474,7 @@ bool DSICCD::saveConfigItems(FILE *fp)
 
 void DSICCD::grabImage()
 {
-    uint16_t *buf = nullptr;
-    int x = 0, y = 0;
+    unsigned char *buf = nullptr;
 
     std::unique_lock<std::mutex> guard(ccdBufferLock);
     // Let's get a pointer to the frame buffer
@@ -487,24 +486,17 @@ void DSICCD::grabImage()
 
     try
     {
-        buf = (uint16_t *)dsi->ccdFramebuffer();
+        buf = dsi->ccdFramebuffer();
     }
     catch (...)
     {
         LOG_INFO("Image download failed!");
         return;
     }
-    guard.unlock();
 
-    for (y = 0; y < height; ++y)
-    {
-        for (x = 0; x < width; ++x)
-        {
-            ((uint16_t *)image)[x + width * y] = ntohs(buf[x + width * y]);
-        }
-    }
-
-    delete buf;
+    // The DSI frame buffer is big endian and owned by the device
+    DSI::beToHost(reinterpret_cast<uint16_t *>(image), buf, static_cast<size_t>(width) * height);
+    guard.unlock();
 
     // Let INDI::CCD know we're done filling the image buffer
     ExposureComplete(&PrimaryCCD);
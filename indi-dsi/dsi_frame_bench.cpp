@@ -0,0 +1,224 @@
+/**
+ * Meade DSI frame assembly benchmark
+ *
+ * Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Benchmark of the DSI frame assembly against the loops DSI::Device::downloadImage and
+ * DSICCD::grabImage used before, on raw fields captured by the driver with INDI_DSI_CAPTURE
+ * set to a directory (the .fields files). Without capture files synthetic DSI Pro (interlaced)
+ * and DSI Pro III (progressive) fields are used. The results of both are compared.
+ *
+ * Usage: dsi_frame_bench [iterations] [capture.fields ...]
+ */
+
+#include "DsiFrame.h"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+struct Capture
+{
+    std::string name;
+    DSI::FrameLayout layout;
+    std::vector<unsigned char> even, odd;
+};
+
+// Field sizes as computed by DSI::Device::downloadImage for 1x1 binning
+static Capture synthetic(const char *name, unsigned int read_width, unsigned int height_even, unsigned int height_odd,
+                         unsigned int image_width, unsigned int image_height, unsigned int offset_x,
+                         unsigned int offset_y)
+{
+    Capture capture;
+    capture.name   = name;
+    capture.layout = { ((2 * read_width / 512) + 1) * 256, image_width, image_height, offset_x, offset_y, height_even > 0 };
+    capture.even.resize(2 * static_cast<size_t>(capture.layout.read_width) * height_even);
+    capture.odd.resize(2 * static_cast<size_t>(capture.layout.read_width) * height_odd);
+
+    srand(1);
+    for (std::vector<unsigned char> *field : { &capture.even, &capture.odd })
+        for (unsigned char &c : *field)
+            c = rand() & 0xff;
+    return capture;
+}
+
+// DSI::Device::downloadImage before the kernels: fresh buffers, pixel by pixel merge with the
+// row debug output, then the ntohs loop of DSICCD::grabImage
+static void legacy(const Capture &capture, uint16_t *image, std::ostream &debug)
+{
+    const DSI::FrameLayout &l = capture.layout;
+    unsigned char *even_data  = nullptr;
+    unsigned char *odd_data   = new unsigned char[capture.odd.size()];
+    if (l.interlaced)
+        even_data = new unsigned char[capture.even.size()];
+    unsigned char *framebuffer = new unsigned char[capture.even.size() + capture.odd.size()];
+
+    // stands in for the bulk transfers
+    memcpy(odd_data, capture.odd.data(), capture.odd.size());
+    if (l.interlaced)
+        memcpy(even_data, capture.even.data(), capture.even.size());
+
+    unsigned char msb = 0, lsb = 0, is_odd = 0;
+    unsigned int x_ptr = 0, line_start = 0, y_ptr = 0, read_ptr = 0, write_ptr = 0;
+    char *even = (char *)even_data;
+    char *odd  = (char *)odd_data;
+
+    for (write_ptr = y_ptr = 0; y_ptr < l.image_height; y_ptr++)
+    {
+        if (l.interlaced)
+        {
+            line_start = l.read_width * ((y_ptr + l.offset_y) / 2);
+            is_odd     = (y_ptr + l.offset_y) % 2;
+            debug << "starting image row " << y_ptr << ", write_ptr=" << write_ptr << ", line_start=" << line_start
+                  << ", is_odd=" << (is_odd == 0 ? 0 : 1) << ", read_ptr=" << (line_start + l.offset_x) * 2
+                  << std::endl;
+        }
+        else
+        {
+            line_start = l.read_width * (y_ptr + l.offset_y);
+            is_odd     = 1;
+        }
+
+        for (x_ptr = 0; x_ptr < l.image_width; x_ptr++)
+        {
+            read_ptr = (line_start + x_ptr + l.offset_x) * 2;
+            msb      = is_odd ? odd[read_ptr] : even[read_ptr];
+            lsb      = is_odd ? odd[read_ptr + 1] : even[read_ptr + 1];
+            framebuffer[write_ptr++] = msb;
+            framebuffer[write_ptr++] = lsb;
+        }
+    }
+
+    uint16_t *buf = reinterpret_cast<uint16_t *>(framebuffer);
+    for (unsigned int y = 0; y < l.image_height; ++y)
+        for (unsigned int x = 0; x < l.image_width; ++x)
+            image[x + l.image_width * y] = ntohs(buf[x + l.image_width * y]);
+
+    delete[] odd_data;
+    if (l.interlaced)
+        delete[] even_data;
+    delete[] framebuffer;
+}
+
+// The driver now: persistent buffers, the rows merged as the fields arrive and a vector byte swap
+static void current(const Capture &capture, uint16_t *image, std::vector<unsigned char> &even,
+                    std::vector<unsigned char> &odd, std::vector<unsigned char> &frame)
+{
+    const DSI::FrameLayout &l = capture.layout;
+    if (even.size() < capture.even.size())
+        even.resize(capture.even.size());
+    if (odd.size() < capture.odd.size())
+        odd.resize(capture.odd.size());
+    if (frame.size() < 2 * static_cast<size_t>(l.image_width) * l.image_height)
+        frame.resize(2 * static_cast<size_t>(l.image_width) * l.image_height);
+
+    // stands in for the queued transfers, merging every 128 KB as DSI::Device::readFrame does
+    const size_t chunk = 128 * 1024;
+    unsigned int merged = 0;
+    size_t even_ready = 0, odd_ready = 0;
+    while (even_ready < capture.even.size() || odd_ready < capture.odd.size())
+    {
+        if (even_ready < capture.even.size())
+        {
+            size_t n = std::min(chunk, capture.even.size() - even_ready);
+            memcpy(even.data() + even_ready, capture.even.data() + even_ready, n);
+            even_ready += n;
+        }
+        else
+        {
+            size_t n = std::min(chunk, capture.odd.size() - odd_ready);
+            memcpy(odd.data() + odd_ready, capture.odd.data() + odd_ready, n);
+            odd_ready += n;
+        }
+
+        unsigned int ready = DSI::rowsReady(l, even_ready, odd_ready);
+        DSI::mergeRows(l, even.data(), odd.data(), frame.data(), merged, ready);
+        merged = ready;
+    }
+
+    DSI::beToHost(image, frame.data(), static_cast<size_t>(l.image_width) * l.image_height);
+}
+
+template <typename F>
+static double measure(int iterations, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    bool failed    = false;
+
+    std::vector<Capture> captures;
+    for (int i = 2; i < argc; i++)
+    {
+        Capture capture;
+        capture.name = argv[i];
+        if (!DSI::loadFields(argv[i], capture.layout, capture.even, capture.odd))
+        {
+            fprintf(stderr, "%s: not a DSI field capture\n", argv[i]);
+            return 1;
+        }
+        captures.push_back(capture);
+    }
+    if (captures.empty())
+    {
+        captures.push_back(synthetic("DSI Pro", 537, 253, 252, 508, 488, 23, 13));
+        captures.push_back(synthetic("DSI Pro III", 1434, 0, 1050, 1360, 1024, 30, 13));
+    }
+
+    // The row debug output of the interlaced loop went to stderr, here it is thrown away
+    std::ofstream debug("/dev/null");
+    std::vector<unsigned char> even, odd, frame;
+
+    printf("%-24s %11s %10s %10s %8s\n", "capture", "size", "legacy ms", "new ms", "speedup");
+    for (const Capture &capture : captures)
+    {
+        const DSI::FrameLayout &l = capture.layout;
+        std::vector<uint16_t> reference(static_cast<size_t>(l.image_width) * l.image_height);
+        std::vector<uint16_t> output(reference.size());
+
+        double legacyMs = measure(iterations, [&]()
+        {
+            legacy(capture, reference.data(), debug);
+        });
+        double newMs = measure(iterations, [&]()
+        {
+            current(capture, output.data(), even, odd, frame);
+        });
+
+        char size[32];
+        snprintf(size, sizeof(size), "%ux%u%s", l.image_width, l.image_height, l.interlaced ? "i" : "p");
+        printf("%-24s %11s %10.3f %10.3f %7.2fx%s\n", capture.name.c_str(), size, legacyMs, newMs, legacyMs / newMs,
+               output != reference ? " MISMATCH" : "");
+        if (output != reference)
+            failed = true;
+    }
+
+    return failed ? 1 : 0;
+}
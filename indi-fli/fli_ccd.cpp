@@ -21,6 +21,8 @@
 
 */
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <time.h>
 #include <math.h>
@@ -39,6 +41,7 @@
 #define MAX_X_BIN      16   /* Max Horizontal binning */
 #define MAX_Y_BIN      16   /* Max Vertical binning */
 #define TEMP_THRESHOLD .25  /* Differential temperature threshold (C)*/
+#define DOWNLOAD_SLICES 10  /* Progress updates per image download */
 
 static std::unique_ptr<FLICCD> fliCCD(new FLICCD());
 
@@ -88,6 +91,13 @@ bool FLICCD::initProperties()
     IUFillNumberVector(&FlushNP, FlushN, 1, getDeviceName(), "CCD_FLUSH_COUNT", "N Flush", OPTIONS_TAB,
                        IP_RW, 60, IPS_IDLE);
 
+    // Download progress and throughput
+    IUFillNumber(&DownloadN[DOWNLOAD_PROGRESS], "DOWNLOAD_PROGRESS", "Progress (%)", "%.f", 0., 100., 1, 0);
+    IUFillNumber(&DownloadN[DOWNLOAD_RATE], "DOWNLOAD_RATE", "Rate (MB/s)", "%.2f", 0., 1000., 1, 0);
+    IUFillNumber(&DownloadN[DOWNLOAD_DURATION], "DOWNLOAD_DURATION", "Duration (s)", "%.3f", 0., 3600., 1, 0);
+    IUFillNumberVector(&DownloadNP, DownloadN, 3, getDeviceName(), "CCD_DOWNLOAD", "Download", IMAGE_INFO_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
     // Background Flushing
     IUFillSwitch(&BackgroundFlushS[0], "ENABLED", "Enabled", ISS_ON);
     IUFillSwitch(&BackgroundFlushS[1], "DISABLED", "Disabled", ISS_OFF);
@@ -119,6 +129,7 @@ bool FLICCD::updateProperties()
         defineProperty(&CamInfoTP);
         defineProperty(&CoolerNP);
         defineProperty(&FlushNP);
+        defineProperty(&DownloadNP);
         defineProperty(&BackgroundFlushSP);
 
         setupParams();
@@ -133,6 +144,7 @@ bool FLICCD::updateProperties()
         deleteProperty(CamInfoTP.name);
         deleteProperty(CoolerNP.name);
         deleteProperty(FlushNP.name);
+        deleteProperty(DownloadNP.name);
         deleteProperty(BackgroundFlushSP.name);
 
         if (CameraModeS != nullptr)
@@ -662,19 +674,62 @@ bool FLICCD::grabImage()
     else
     {
         bool success = true;
-        for (int i = 0; i < height; i++)
+        const size_t total = static_cast<size_t>(height) * row_size;
+        const size_t slice = static_cast<size_t>((height + DOWNLOAD_SLICES - 1) / DOWNLOAD_SLICES) * row_size;
+        size_t done = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        DownloadN[DOWNLOAD_PROGRESS].value = 0;
+        DownloadNP.s = IPS_BUSY;
+        IDSetNumber(&DownloadNP, nullptr);
+
+        while (done < total)
         {
-            if ((err = FLIGrabRow(fli_dev, image + (i * row_size), width)))
+            const size_t chunk = std::min(slice, total - done);
+            size_t grabbed = 0;
+
+            if (FLICam.domain == FLIDOMAIN_USB)
+                err = FLIGrabFrame(fli_dev, image + done, chunk, &grabbed);
+            else
             {
-                /* print this error once but read to the end to flush the array */
+                /* FLIGrabFrame() is only implemented for USB cameras */
+                while (grabbed < chunk && (err = FLIGrabRow(fli_dev, image + done + grabbed, width)) == 0)
+                    grabbed += row_size;
+            }
+
+            if (err)
+            {
+                /* print this error once but read to the end to flush the array, skipping the failed row */
                 if (success)
                 {
-                    LOGF_ERROR("FLIGrabRow() failed at row %d. %s.", i, strerror(-err));
+                    LOGF_ERROR("Image download failed at row %d. %s.", static_cast<int>((done + grabbed) / row_size),
+                               strerror(-err));
                     success = false;
                 }
+                grabbed += row_size;
+            }
+            else if (grabbed == 0)
+            {
+                LOGF_ERROR("Image download stopped after %d of %d rows.", static_cast<int>(done / row_size), height);
+                success = false;
+                break;
             }
+
+            done = std::min(total, done + grabbed);
+
+            DownloadN[DOWNLOAD_PROGRESS].value = 100.0 * done / total;
+            IDSetNumber(&DownloadNP, nullptr);
         }
 
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        DownloadN[DOWNLOAD_DURATION].value = seconds;
+        DownloadN[DOWNLOAD_RATE].value = seconds > 0 ? done / seconds / 1e6 : 0;
+        DownloadNP.s = success ? IPS_OK : IPS_ALERT;
+        IDSetNumber(&DownloadNP, nullptr);
+
+        LOGF_DEBUG("Downloaded %d rows in %.3f seconds, %.2f MB/s.", static_cast<int>(done / row_size), seconds,
+                   DownloadN[DOWNLOAD_RATE].value);
+
         if (!success)
             return false;
     }
@@ -67,7 +67,7 @@ class FLICCD : public INDI::CCD
         // Calculate Time until exposure is complete
         float calcTimeLeft();
 
-        // Fetch image row by row from the CCD
+        // Fetch the image from the CCD, a slice of rows at a time
         bool grabImage();
 
         // Get initial CCD values upon connection
@@ -101,6 +101,16 @@ class FLICCD : public INDI::CCD
         INumber FlushN[1];
         INumberVectorProperty FlushNP;
 
+        // Readout progress and throughput of the last download
+        enum
+        {
+            DOWNLOAD_PROGRESS,
+            DOWNLOAD_RATE,
+            DOWNLOAD_DURATION,
+        };
+        INumber DownloadN[3];
+        INumberVectorProperty DownloadNP;
+
         ISwitch BackgroundFlushS[2];
         ISwitchVectorProperty BackgroundFlushSP;
 
@@ -21,6 +21,7 @@
 #include "kepler.h"
 
 #include <unistd.h>
+#include <algorithm>
 #include <memory>
 #include <map>
 #include <locale>
@@ -29,6 +30,8 @@
 
 #define FLI_MAX_SUPPORTED_CAMERAS 4
 #define VERBOSE_EXPOSURE          3
+#define STREAM_TIMEOUT_MS         1000  /* Time past the exposure to wait for a streamed frame (ms) */
+#define STREAM_STATS_MS           1000  /* Minimum interval between streaming statistics updates (ms) */
 
 template <typename E>
 constexpr auto to_underlying(E e) noexcept
@@ -235,6 +238,150 @@ void Kepler::workerExposure(const std::atomic_bool &isAboutToQuit, float duratio
     }
 }
 
+/********************************************************************************
+* Read frames of multi-frame captures into the stream buffers. A capture is only
+* armed again once all its frames were read.
+********************************************************************************/
+void Kepler::workerStream(const std::atomic_bool &isAboutToQuit, float duration)
+{
+    const uint32_t frames = StreamSettingsNP[STREAM_CAPTURE_FRAMES].getValue();
+    const uint32_t timeout = duration * 1000 + STREAM_TIMEOUT_MS;
+    const size_t spare = m_StreamBuffers.size() - 1;
+    uint32_t armed = 0;
+    INDI::ElapsedTimer statsTimer;
+
+    while (!isAboutToQuit)
+    {
+        if (armed == 0)
+        {
+            int32_t result = -1;
+            for (int i = 0; i < 3 && !isAboutToQuit; i++)
+            {
+                result = FPROFrame_CaptureStart(m_CameraHandle, frames);
+                if (result == 0)
+                    break;
+
+                // Wait 100ms before trying again
+                usleep(100 * 1000);
+            }
+
+            if (result != 0)
+            {
+                // Unless quitting cut the retries short, the stream cannot go on
+                if (!isAboutToQuit)
+                {
+                    LOGF_ERROR("Failed to start capture: %d", result);
+                    Streamer->setStream(false);
+                    StreamStatsNP.setState(IPS_ALERT);
+                    StreamStatsNP.apply();
+                }
+                break;
+            }
+            armed = frames;
+            StreamStatsNP[STREAM_CAPTURES].setValue(StreamStatsNP[STREAM_CAPTURES].getValue() + 1);
+        }
+
+        size_t index = spare;
+        {
+            std::lock_guard<std::mutex> lock(m_StreamMutex);
+            if (!m_StreamFree.empty())
+            {
+                index = m_StreamFree.front();
+                m_StreamFree.pop_front();
+            }
+        }
+
+        StreamBuffer &buffer = m_StreamBuffers[index];
+        uint32_t grabSize = buffer.frame.size();
+        requestPlanes(buffer.unpacked);
+
+        INDI::ElapsedTimer readTimer;
+        int32_t result = FPROFrame_GetVideoFrameUnpacked(m_CameraHandle, buffer.frame.data(), &grabSize, timeout,
+                         &buffer.unpacked, nullptr);
+        double readTime = readTimer.nsecsElapsed() / 1e6;
+
+        if (result >= 0)
+        {
+            armed--;
+            auto received = StreamStatsNP[STREAM_FRAMES].getValue() + 1;
+            StreamStatsNP[STREAM_FRAMES].setValue(received);
+            m_StreamReadTotal += readTime;
+            StreamStatsNP[STREAM_READ].setValue(m_StreamReadTotal / received);
+            StreamStatsNP[STREAM_READ_MAX].setValue(std::max(StreamStatsNP[STREAM_READ_MAX].getValue(), readTime));
+
+            // The publisher had no buffer to spare for this frame
+            if (index == spare)
+                StreamStatsNP[STREAM_DROPPED].setValue(StreamStatsNP[STREAM_DROPPED].getValue() + 1);
+            else
+            {
+                std::lock_guard<std::mutex> lock(m_StreamMutex);
+                m_StreamReady.push_back(index);
+                m_StreamCondition.notify_one();
+            }
+        }
+        else
+        {
+            // Start over with a fresh capture
+            StreamStatsNP[STREAM_FAILED].setValue(StreamStatsNP[STREAM_FAILED].getValue() + 1);
+            LOGF_DEBUG("Failed to grab streamed frame: %d", result);
+            FPROFrame_CaptureStop(m_CameraHandle);
+            armed = 0;
+
+            if (index != spare)
+            {
+                std::lock_guard<std::mutex> lock(m_StreamMutex);
+                m_StreamFree.push_front(index);
+            }
+        }
+
+        if (statsTimer.elapsed() >= STREAM_STATS_MS)
+        {
+            StreamStatsNP.setState(StreamStatsNP[STREAM_DROPPED].getValue() > 0 ? IPS_ALERT : IPS_BUSY);
+            StreamStatsNP.apply();
+            statsTimer.start();
+        }
+    }
+
+    FPROFrame_CaptureStop(m_CameraHandle);
+}
+
+/********************************************************************************
+* Hand the unpacked frames to the streamer and recorder.
+********************************************************************************/
+void Kepler::workerPublish(const std::atomic_bool &isAboutToQuit)
+{
+    std::unique_lock<std::mutex> lock(m_StreamMutex);
+    while (!isAboutToQuit)
+    {
+        if (m_StreamReady.empty())
+        {
+            m_StreamCondition.wait_for(lock, std::chrono::milliseconds(100));
+            continue;
+        }
+
+        size_t index = m_StreamReady.front();
+        m_StreamReady.pop_front();
+        lock.unlock();
+
+        const FPROUNPACKEDIMAGES &unpacked = m_StreamBuffers[index].unpacked;
+        switch (MergePlanesSP.findOnSwitchIndex())
+        {
+            case to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH):
+                Streamer->newFrame(reinterpret_cast<uint8_t*>(unpacked.pMergedImage), unpacked.uiMergedBufferSize);
+                break;
+            case to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_HIGHONLY):
+                Streamer->newFrame(reinterpret_cast<uint8_t*>(unpacked.pHighImage), unpacked.uiHighBufferSize);
+                break;
+            case to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_LOWONLY):
+                Streamer->newFrame(reinterpret_cast<uint8_t*>(unpacked.pLowImage), unpacked.uiLowBufferSize);
+                break;
+        }
+
+        lock.lock();
+        m_StreamFree.push_back(index);
+    }
+}
+
 Kepler::Kepler(const FPRODEVICEINFO &info, std::wstring name) : m_CameraInfo(info)
 {
     setVersion(FLI_CCD_VERSION_MAJOR, FLI_CCD_VERSION_MINOR);
@@ -269,7 +416,7 @@ bool Kepler::initProperties()
     INDI::CCD::initProperties();
 
     // Set Camera capabilities
-    SetCCDCapability(CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_COOLER | CCD_HAS_SHUTTER);
+    SetCCDCapability(CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_COOLER | CCD_HAS_SHUTTER | CCD_HAS_STREAMING);
 
     // Add capture format
     CaptureFormat mono = {"INDI_MONO", "Mono", 16, true};
@@ -333,6 +480,19 @@ bool Kepler::initProperties()
     RequestStatSP[INDI_DISABLED].fill("INDI_DISABLED", "Disabled", ISS_OFF);
     RequestStatSP.fill(getDeviceName(), "REQUEST_STATS", "Statistics", IMAGE_SETTINGS_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
 
+    // Streaming
+    StreamSettingsNP[STREAM_CAPTURE_FRAMES].fill("STREAM_CAPTURE_FRAMES", "Frames per capture", "%.f", 1, 10000, 10, 100);
+    StreamSettingsNP[STREAM_BUFFERS].fill("STREAM_BUFFERS", "Buffers", "%.f", 2, 64, 1, 4);
+    StreamSettingsNP.fill(getDeviceName(), "STREAM_SETTINGS", "Settings", STREAMING_TAB, IP_RW, 60, IPS_IDLE);
+
+    StreamStatsNP[STREAM_FRAMES].fill("STREAM_FRAMES", "Frames", "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_DROPPED].fill("STREAM_DROPPED", "Dropped", "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_FAILED].fill("STREAM_FAILED", "Failed reads", "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_CAPTURES].fill("STREAM_CAPTURES", "Captures armed", "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STREAM_READ].fill("STREAM_READ", "Read & unpack (ms)", "%.3f", 0, 1e6, 0, 0);
+    StreamStatsNP[STREAM_READ_MAX].fill("STREAM_READ_MAX", "Max read & unpack (ms)", "%.3f", 0, 1e6, 0, 0);
+    StreamStatsNP.fill(getDeviceName(), "STREAM_STATS", "Statistics", STREAMING_TAB, IP_RO, 60, IPS_IDLE);
+
     /*****************************************************************************************************
     // Legacy Properties
     ******************************************************************************************************/
@@ -404,6 +564,8 @@ bool Kepler::updateProperties()
         defineProperty(BlackLevelNP);
         defineProperty(GPSStateLP);
         defineProperty(RequestStatSP);
+        defineProperty(StreamSettingsNP);
+        defineProperty(StreamStatsNP);
     }
     else
     {
@@ -416,6 +578,8 @@ bool Kepler::updateProperties()
         deleteProperty(BlackLevelNP);
         deleteProperty(GPSStateLP);
         deleteProperty(RequestStatSP);
+        deleteProperty(StreamSettingsNP);
+        deleteProperty(StreamStatsNP);
     }
 
     return true;
@@ -511,6 +675,15 @@ bool Kepler::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
         // Merge Planes
         if (MergePlanesSP.isNameMatch(name))
         {
+            // The publisher picks the plane of streamed frames from it
+            if (Streamer->isBusy())
+            {
+                LOG_ERROR("Cannot change merging while streaming/recording.");
+                MergePlanesSP.setState(IPS_ALERT);
+                MergePlanesSP.apply();
+                return true;
+            }
+
             MergePlanesSP.update(states, names, n);
             MergePlanesSP.setState(IPS_OK);
 
@@ -681,6 +854,9 @@ bool Kepler::Connect()
 ********************************************************************************/
 bool Kepler::Disconnect()
 {
+    m_Worker.quit();
+    m_StreamWorker.quit();
+    releaseStreamBuffers();
     free(m_FrameBuffer);
     m_FrameBuffer = nullptr;
     FPROCam_Close(m_CameraHandle);
@@ -849,12 +1025,7 @@ void Kepler::prepareUnpacked()
 
     // Merging Planes
     int index = MergePlanesSP.findOnSwitchIndex();
-    fproUnpacked.bLowImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_LOWONLY)
-                                    || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
-    fproUnpacked.bHighImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_HIGHONLY)
-                                     || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
-    fproUnpacked.bMergedImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
-    fproUnpacked.bMetaDataRequest = true;
+    requestPlanes(fproUnpacked);
 
     // Statistics
     fproStats.bLowRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_LOWONLY)
@@ -867,6 +1038,20 @@ void Kepler::prepareUnpacked()
     fproUnpacked.eMergeFormat = FPRO_IMAGE_FORMAT::IFORMAT_FITS;
 
 }
+
+/********************************************************************************
+* Select the planes to unpack, keeping any buffers the SDK already allocated.
+********************************************************************************/
+void Kepler::requestPlanes(FPROUNPACKEDIMAGES &images)
+{
+    int index = MergePlanesSP.findOnSwitchIndex();
+    images.bLowImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_LOWONLY)
+                              || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
+    images.bHighImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_HIGHONLY)
+                               || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
+    images.bMergedImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
+    images.bMetaDataRequest = true;
+}
 /********************************************************************************
 *
 ********************************************************************************/
@@ -897,6 +1082,12 @@ int Kepler::SetTemperature(double temperature)
 ********************************************************************************/
 bool Kepler::StartExposure(float duration)
 {
+    if (Streamer->isBusy())
+    {
+        LOG_ERROR("Cannot take exposure while streaming/recording is active.");
+        return false;
+    }
+
     m_Worker.start(std::bind(&Kepler::workerExposure, this, std::placeholders::_1, duration));
     return true;
 }
@@ -908,6 +1099,88 @@ bool Kepler::AbortExposure()
     return (FPROFrame_CaptureStop(m_CameraHandle) == 0);
 }
 
+/********************************************************************************
+*
+********************************************************************************/
+bool Kepler::StartStreaming()
+{
+    const float duration = 1.0 / Streamer->getTargetFPS();
+    int32_t result = FPROCtrl_SetExposure(m_CameraHandle, duration * 1e9, 0, false);
+    if (result != 0)
+    {
+        LOGF_ERROR("Failed to set streaming exposure: %d", result);
+        return false;
+    }
+
+    // One more buffer than requested is kept as the spare
+    const size_t count = StreamSettingsNP[STREAM_BUFFERS].getValue() + 1;
+    try
+    {
+        releaseStreamBuffers();
+        m_StreamBuffers.resize(count);
+        for (auto &buffer : m_StreamBuffers)
+        {
+            buffer.frame.resize(m_TotalFrameBufferSize);
+            memset(&buffer.unpacked, 0, sizeof(buffer.unpacked));
+            buffer.unpacked.eMergeFormat = FPRO_IMAGE_FORMAT::IFORMAT_NONE;
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        LOGF_ERROR("Failed to allocate %zu stream buffers of %u bytes.", count, m_TotalFrameBufferSize);
+        m_StreamBuffers.clear();
+        return false;
+    }
+
+    for (size_t i = 0; i + 1 < count; i++)
+        m_StreamFree.push_back(i);
+
+    for (size_t i = 0; i < StreamStatsNP.size(); i++)
+        StreamStatsNP[i].setValue(0);
+    m_StreamReadTotal = 0;
+    StreamStatsNP.setState(IPS_BUSY);
+    StreamStatsNP.apply();
+
+    Streamer->setPixelFormat(INDI_MONO, 16);
+    Streamer->setSize(PrimaryCCD.getSubW() / PrimaryCCD.getBinX(), PrimaryCCD.getSubH() / PrimaryCCD.getBinY());
+
+    LOGF_INFO("Starting video streaming with exposure %.3f seconds, %.f frames per capture.", duration,
+              StreamSettingsNP[STREAM_CAPTURE_FRAMES].getValue());
+    m_StreamWorker.start(std::bind(&Kepler::workerPublish, this, std::placeholders::_1));
+    m_Worker.start(std::bind(&Kepler::workerStream, this, std::placeholders::_1, duration));
+    return true;
+}
+
+/********************************************************************************
+*
+********************************************************************************/
+bool Kepler::StopStreaming()
+{
+    m_Worker.quit();
+    m_StreamWorker.quit();
+    releaseStreamBuffers();
+
+    StreamStatsNP.setState(StreamStatsNP[STREAM_DROPPED].getValue() > 0 ? IPS_ALERT : IPS_OK);
+    StreamStatsNP.apply();
+    LOGF_DEBUG("Streaming stopped: %.f frames, %.f dropped, %.f failed, %.3f ms average read & unpack.",
+               StreamStatsNP[STREAM_FRAMES].getValue(), StreamStatsNP[STREAM_DROPPED].getValue(),
+               StreamStatsNP[STREAM_FAILED].getValue(), StreamStatsNP[STREAM_READ].getValue());
+    return true;
+}
+
+/********************************************************************************
+*
+********************************************************************************/
+void Kepler::releaseStreamBuffers()
+{
+    std::lock_guard<std::mutex> lock(m_StreamMutex);
+    for (auto &buffer : m_StreamBuffers)
+        FPROFrame_FreeUnpackedBuffers(&buffer.unpacked);
+    m_StreamBuffers.clear();
+    m_StreamFree.clear();
+    m_StreamReady.clear();
+}
+
 /********************************************************************************
 *
 ********************************************************************************/
@@ -1098,6 +1371,7 @@ bool Kepler::saveConfigItems(FILE * fp)
     MergePlanesSP.save(fp);
     MergeCalibrationFilesTP.save(fp);
     RequestStatSP.save(fp);
+    StreamSettingsNP.save(fp);
     if (LowGainSP.size() > 0)
         LowGainSP.save(fp);
     if (HighGainSP.size() > 0)
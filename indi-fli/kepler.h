@@ -29,6 +29,11 @@
 #include <inditimer.h>
 #include <indisinglethreadpool.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
 class Kepler : public INDI::CCD
 {
     public:
@@ -47,6 +52,9 @@ class Kepler : public INDI::CCD
         bool StartExposure(float duration) override;
         bool AbortExposure() override;
 
+        bool StartStreaming() override;
+        bool StopStreaming() override;
+
         virtual bool ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n) override;
         virtual bool ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int n) override;
         virtual bool ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n) override;
@@ -95,6 +103,24 @@ class Kepler : public INDI::CCD
         // GPS State
         INDI::PropertyLight GPSStateLP {4};
 
+        // Streaming
+        INDI::PropertyNumber StreamSettingsNP {2};
+        enum
+        {
+            STREAM_CAPTURE_FRAMES,
+            STREAM_BUFFERS
+        };
+        INDI::PropertyNumber StreamStatsNP {6};
+        enum
+        {
+            STREAM_FRAMES,
+            STREAM_DROPPED,
+            STREAM_FAILED,
+            STREAM_CAPTURES,
+            STREAM_READ,
+            STREAM_READ_MAX
+        };
+
 #ifdef LEGACY_MODE
         //****************************************************************************************
         // Legacy INDI Properties
@@ -126,6 +152,7 @@ class Kepler : public INDI::CCD
         //****************************************************************************************
         bool setup();
         void prepareUnpacked();
+        void requestPlanes(FPROUNPACKEDIMAGES &images);
         void readTemperature();
         void readGPS();
 
@@ -133,6 +160,9 @@ class Kepler : public INDI::CCD
         // Workers
         //****************************************************************************************
         void workerExposure(const std::atomic_bool &isAboutToQuit, float duration);
+        void workerStream(const std::atomic_bool &isAboutToQuit, float duration);
+        void workerPublish(const std::atomic_bool &isAboutToQuit);
+        void releaseStreamBuffers();
 
         //****************************************************************************************
         // Variables
@@ -158,6 +188,21 @@ class Kepler : public INDI::CCD
         // GPS
         FPROGPSSTATE m_LastGPSState {FPROGPSSTATE::FPRO_GPS_NOT_DETECTED};
 
+        // Streaming, frames are unpacked into a pool of buffers which the publisher hands to the streamer.
+        // The last buffer is the spare, frames read into it while the publisher lags behind are dropped.
+        struct StreamBuffer
+        {
+            std::vector<uint8_t> frame;
+            FPROUNPACKEDIMAGES unpacked;
+        };
+        std::vector<StreamBuffer> m_StreamBuffers;
+        std::deque<size_t> m_StreamFree;
+        std::deque<size_t> m_StreamReady;
+        std::mutex m_StreamMutex;
+        std::condition_variable m_StreamCondition;
+        INDI::SingleThreadPool m_StreamWorker;
+        double m_StreamReadTotal {0};
+
         // Temperature
         INDI::Timer m_TemperatureTimer;
         INDI::Timer m_GPSTimer;
@@ -173,5 +218,6 @@ class Kepler : public INDI::CCD
         static constexpr uint32_t GPS_TIMER_PERIOD {5000};
 
         static constexpr const char *GPS_TAB {"GPS"};
+        static constexpr const char *STREAMING_TAB {"Streaming"};
         static constexpr const char *LEGACY_TAB {"Legacy"};
 };
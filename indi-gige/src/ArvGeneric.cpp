@@ -20,6 +20,10 @@
 
 using namespace arv;
 
+/* Buffers queued on the stream during continuous acquisition. Enough to ride out a slow
+ * consumer for a few frames without the stream running out (underrun) */
+#define ARV_VIDEO_POOL_BUFFERS (8)
+
 const char *ArvGeneric::_str_val(const char *s)
 {
     return (s ? s : "None");
@@ -101,6 +105,10 @@ bool ArvGeneric::_stream_active()
 {
     return this->stream_active;
 }
+bool ArvGeneric::is_streaming()
+{
+    return this->video.active;
+}
 
 ArvGeneric::ArvGeneric(void *camera_device) : ArvCamera(camera_device)
 {
@@ -152,6 +160,11 @@ void ArvGeneric::_init()
     this->stream        = nullptr;
     this->stream_active = false;
 
+    this->video.active            = false;
+    this->video.signal_id         = 0;
+    this->video.fn_frame_callback = nullptr;
+    this->video.usr_ptr           = nullptr;
+
     /* Don't clear device_id, its needed to re-attach with connect() */
 }
 
@@ -159,6 +172,7 @@ bool ArvGeneric::disconnect()
 {
     if (this->is_connected())
     {
+        this->stream_stop();
         this->_test_exposure_and_abort();
         g_clear_object(&this->camera);
     }
@@ -316,6 +330,7 @@ void ArvGeneric::_trigger_exposure()
 
 void ArvGeneric::exposure_start(void)
 {
+    this->stream_stop();
     this->_test_exposure_and_abort();
     this->stream = this->_stream_create();
     this->buffer = this->_buffer_create();
@@ -382,3 +397,92 @@ ARV_EXPOSURE_STATUS ArvGeneric::exposure_poll(void (*fn_image_callback)(void *co
             return ARV_EXPOSURE_UNKNOWN;
     }
 }
+
+void ArvGeneric::_video_new_buffer(::ArvStream *stream, void *user_data)
+{
+    ArvGeneric *const self = static_cast<ArvGeneric *>(user_data);
+
+    ::ArvBuffer *const buf = arv_stream_try_pop_buffer(stream);
+    if (buf == nullptr)
+        return;
+
+    /* Incomplete frames are counted as failures by the stream, just recycle them */
+    if ((arv_buffer_get_status(buf) == ARV_BUFFER_STATUS_SUCCESS) && (self->video.fn_frame_callback != nullptr))
+    {
+        size_t size;
+        uint8_t const *const data = (uint8_t const *)arv_buffer_get_data(buf, &size);
+        self->video.fn_frame_callback(self->video.usr_ptr, data, size);
+    }
+
+    /* Give the buffer back to the pool */
+    arv_stream_push_buffer(stream, buf);
+}
+
+bool ArvGeneric::stream_start(double const fps, void (*fn_frame_callback)(void *const, uint8_t const *const, size_t),
+                              void *const usr_ptr)
+{
+    if (this->video.active)
+        return true;
+
+    this->_test_exposure_and_abort();
+
+    this->stream = this->_stream_create();
+    if (this->stream == nullptr)
+        return false;
+
+    gint const payload = arv_camera_get_payload(this->camera, &(this->error));
+    for (int i = 0; i < ARV_VIDEO_POOL_BUFFERS; i++)
+        arv_stream_push_buffer(this->stream, arv_buffer_new(payload, nullptr));
+
+    this->video.fn_frame_callback = fn_frame_callback;
+    this->video.usr_ptr           = usr_ptr;
+    this->video.signal_id = g_signal_connect(this->stream, "new-buffer", G_CALLBACK(ArvGeneric::_video_new_buffer), this);
+    arv_stream_set_emit_signals(this->stream, TRUE);
+
+    /* Free running: no trigger, the camera paces the frames */
+    arv_camera_clear_triggers(this->camera, &(this->error));
+    if (fps > 0)
+    {
+        this->cam.frame_rate.set(fps);
+        arv_camera_set_frame_rate(this->camera, this->cam.frame_rate.val(), &(this->error));
+    }
+    arv_camera_set_acquisition_mode(this->camera, ARV_ACQUISITION_MODE_CONTINUOUS, &(this->error));
+    arv_camera_start_acquisition(this->camera, &(this->error));
+
+    this->video.active = true;
+    return true;
+}
+
+void ArvGeneric::stream_stop(void)
+{
+    if (!this->video.active)
+        return;
+
+    arv_camera_stop_acquisition(this->camera, &(this->error));
+    arv_stream_set_emit_signals(this->stream, FALSE);
+    g_signal_handler_disconnect(this->stream, this->video.signal_id);
+
+    /* Releasing the stream joins its thread and frees the buffer pool */
+    g_clear_object(&this->stream);
+
+    /* Back to single, software triggered frames */
+    arv_camera_set_trigger(this->camera, "Software", &(this->error));
+
+    this->video.active            = false;
+    this->video.signal_id         = 0;
+    this->video.fn_frame_callback = nullptr;
+    this->video.usr_ptr           = nullptr;
+}
+
+bool ArvGeneric::get_stream_stats(uint64_t *const completed, uint64_t *const failures, uint64_t *const underruns)
+{
+    if (!this->video.active)
+        return false;
+
+    guint64 n_completed, n_failures, n_underruns;
+    arv_stream_get_statistics(this->stream, &n_completed, &n_failures, &n_underruns);
+    *completed = n_completed;
+    *failures  = n_failures;
+    *underruns = n_underruns;
+    return true;
+}
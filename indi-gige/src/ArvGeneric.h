@@ -66,6 +66,12 @@ class ArvGeneric : public arv::ArvCamera
     ARV_EXPOSURE_STATUS exposure_poll(void (*fn_image_callback)(void *const, uint8_t const *const, size_t),
                                       void *const usr_ptr);
 
+    bool is_streaming();
+    bool stream_start(double const fps, void (*fn_frame_callback)(void *const, uint8_t const *const, size_t),
+                      void *const usr_ptr);
+    void stream_stop(void);
+    bool get_stream_stats(uint64_t *const completed, uint64_t *const failures, uint64_t *const underruns);
+
   protected:
     void _init(void);
     bool _configure(void);
@@ -97,6 +103,17 @@ class ArvGeneric : public arv::ArvCamera
 
     bool stream_active;
 
+    /* continuous acquisition, buffers are recycled from the "new-buffer" signal handler */
+    static void _video_new_buffer(::ArvStream *stream, void *user_data);
+
+    struct
+    {
+        bool active;
+        gulong signal_id;
+        void (*fn_frame_callback)(void *const, uint8_t const *const, size_t);
+        void *usr_ptr;
+    } video;
+
     /* Camera properties */
     struct
     {
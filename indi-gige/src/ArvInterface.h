@@ -109,6 +109,13 @@ class ArvCamera
     virtual void exposure_abort(void)                      = 0;
     virtual ARV_EXPOSURE_STATUS exposure_poll(void (*fn_image_callback)(void *const, uint8_t const *const, size_t),
                                               void *const) = 0;
+
+    /* Continuous acquisition, fn_frame_callback is called from the stream thread for every completed frame */
+    virtual bool is_streaming()                                                                         = 0;
+    virtual bool stream_start(double const fps, void (*fn_frame_callback)(void *const, uint8_t const *const, size_t),
+                              void *const)                                                              = 0;
+    virtual void stream_stop(void)                                                                      = 0;
+    virtual bool get_stream_stats(uint64_t *const completed, uint64_t *const failures, uint64_t *const underruns) = 0;
 };
 
 class ArvFactory
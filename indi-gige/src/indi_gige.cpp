@@ -21,10 +21,12 @@
 #include <list>
 #include <sys/time.h>
 #include <deque>
+#include <algorithm>
 #include <memory>
 
 #include "indidevapi.h"
 #include "eventloop.h"
+#include "stream/streammanager.h"
 
 #include "indi_gige.h"
 
@@ -43,7 +45,10 @@
 #define TIMER_US_TO_MS (1000)
 #define TIMER_US_TO_S  (1000000)
 #define TIMER_TICK_MS  (100)
-#define CAPS           (CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME)
+#define TIMER_STATS_US (1000000UL) /* Stream statistics refresh */
+#define STREAM_EXPOSURE_DUTY (0.8) /* Part of the frame period used for the exposure, the rest is readout */
+#define STREAMING_TAB  "Streaming"
+#define CAPS           (CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_STREAMING)
 
 static class Loader
 {
@@ -79,6 +84,14 @@ bool GigECCD::initProperties()
     this->SetCCDCapability((CAPS));
     this->addConfigurationControl();
     this->addDebugControl();
+
+    IUFillNumber(&this->indiprop_stream_stats[0], "COMPLETED", "Completed", "%.0f", 0, 1e12, 0, 0);
+    IUFillNumber(&this->indiprop_stream_stats[1], "FAILURES", "Failures", "%.0f", 0, 1e12, 0, 0);
+    IUFillNumber(&this->indiprop_stream_stats[2], "UNDERRUNS", "Underruns", "%.0f", 0, 1e12, 0, 0);
+    IUFillNumber(&this->indiprop_stream_stats[3], "FPS", "Frames/s", "%.1f", 0, 1e6, 0, 0);
+    IUFillNumber(&this->indiprop_stream_stats[4], "WRONG_SIZE", "Wrong size", "%.0f", 0, 1e12, 0, 0);
+    IUFillNumberVector(&this->indiprop_stream_stats_prop, this->indiprop_stream_stats, 5, getDeviceName(),
+                       "STREAM_STATS", "Stream Stats", STREAMING_TAB, IP_RO, 60, IPS_IDLE);
     return true;
 }
 
@@ -109,6 +122,9 @@ bool GigECCD::_update_geometry(void)
         LOGF_INFO("Reserving INDI image buffer size %i bytes", indi_bufsize);
         PrimaryCCD.setFrameBufferSize(frame_byte_size);
     }
+
+    Streamer->setSize(PrimaryCCD.getSubW() / PrimaryCCD.getBinX(), PrimaryCCD.getSubH() / PrimaryCCD.getBinY());
+    return indi_bufsize == frame_byte_size;
 }
 
 void GigECCD::_update_indi_properties(void)
@@ -127,12 +143,14 @@ void GigECCD::_update_indi_properties(void)
 
     defineProperty(&indiprop_info_prop);
     defineProperty(&this->indiprop_gain_prop);
+    defineProperty(&this->indiprop_stream_stats_prop);
 }
 
 void GigECCD::_delete_indi_properties(void)
 {
     this->deleteProperty(this->indiprop_gain_prop.name);
     this->deleteProperty(this->indiprop_info_prop.name);
+    this->deleteProperty(this->indiprop_stream_stats_prop.name);
 }
 
 //Initial call
@@ -146,6 +164,7 @@ bool GigECCD::updateProperties()
         this->SetCCDParams(this->camera->get_width().max(), this->camera->get_height().max(),
                            this->camera->get_bpp().val(), this->camera->get_pixel_pitch().val(),
                            this->camera->get_pixel_pitch().val());
+        Streamer->setPixelFormat(INDI_MONO, this->camera->get_bpp().val());
 
         (void)this->_update_geometry();
         this->timer_id = this->SetTimer(TIMER_TICK_MS);
@@ -224,6 +243,86 @@ void GigECCD::_receive_image_hook(void *const class_ptr, uint8_t const *const da
     cls->_update_image(data, size);
 }
 
+bool GigECCD::StartStreaming()
+{
+    double const fps = Streamer->getTargetFPS();
+    LOGF_INFO("%s fps=%.2f", __PRETTY_FUNCTION__, fps);
+
+    /* Keep the exposure well inside the frame period, so the readout fits and the camera can hold the rate */
+    double const exposure_us = std::min(STREAM_EXPOSURE_DUTY * TIMER_US_TO_S / fps, camera->get_exposure().max());
+    camera->set_exposure_time(exposure_us);
+    LOGF_DEBUG("Streaming exposure %.0f us", exposure_us);
+
+    if (!camera->stream_start(fps, this->_receive_frame_hook, this))
+    {
+        LOG_ERROR("Failed to start continuous acquisition");
+        return false;
+    }
+
+    this->stream_stats_completed = 0;
+    this->stream_wrong_size      = 0;
+    TIME_VAL_GET(&this->stream_stats_time);
+    this->indiprop_stream_stats_prop.s = IPS_BUSY;
+    IDSetNumber(&this->indiprop_stream_stats_prop, nullptr);
+    return true;
+}
+
+bool GigECCD::StopStreaming()
+{
+    LOGF_INFO("%s", __PRETTY_FUNCTION__);
+    this->_update_stream_stats();
+    camera->stream_stop();
+
+    this->indiprop_stream_stats_prop.s = IPS_IDLE;
+    IDSetNumber(&this->indiprop_stream_stats_prop, nullptr);
+    return true;
+}
+
+/* Called from the aravis stream thread, the buffer goes back to the pool on return */
+void GigECCD::_stream_frame(uint8_t const *const data, size_t size)
+{
+    if (!Streamer->isStreaming() && !Streamer->isRecording())
+        return;
+
+    if (size != (size_t)PrimaryCCD.getFrameBufferSize())
+    {
+        if (this->stream_wrong_size++ == 0)
+            LOGF_WARN("Dropping streamed frames of %zu bytes, expected %d bytes", size, PrimaryCCD.getFrameBufferSize());
+        return;
+    }
+
+    Streamer->newFrame(data, size);
+}
+
+void GigECCD::_receive_frame_hook(void *const class_ptr, uint8_t const *const data, size_t size)
+{
+    GigECCD *const cls = static_cast<GigECCD *const>(class_ptr);
+    cls->_stream_frame(data, size);
+}
+
+void GigECCD::_update_stream_stats(void)
+{
+    uint64_t completed, failures, underruns;
+    if (!this->camera->get_stream_stats(&completed, &failures, &underruns))
+        return;
+
+    struct timeval now;
+    TIME_VAL_GET(&now);
+    uint64_t const elapsed = TIME_VAL_US(&now) - TIME_VAL_US(&this->stream_stats_time);
+
+    this->indiprop_stream_stats[0].value = completed;
+    this->indiprop_stream_stats[1].value = failures;
+    this->indiprop_stream_stats[2].value = underruns;
+    this->indiprop_stream_stats[4].value = this->stream_wrong_size;
+    if (elapsed > 0)
+        this->indiprop_stream_stats[3].value =
+            (double)(completed - this->stream_stats_completed) * TIMER_US_TO_S / (double)elapsed;
+    IDSetNumber(&this->indiprop_stream_stats_prop, nullptr);
+
+    this->stream_stats_completed = completed;
+    this->stream_stats_time      = now;
+}
+
 void GigECCD::_handle_failed(void)
 {
     LOG_ERROR("Failure occurred, filling image with black");
@@ -263,7 +362,19 @@ void GigECCD::_handle_timeout(struct timeval *const tv, uint32_t timeout_us)
 void GigECCD::TimerHit()
 {
     this->timer_id = this->SetTimer(TIMER_TICK_MS);
-    if (!this->camera->is_connected() || !this->camera->is_exposing())
+    if (!this->camera->is_connected())
+        return;
+
+    if (this->camera->is_streaming())
+    {
+        struct timeval now;
+        TIME_VAL_GET(&now);
+        if (TIME_VAL_US(&now) - TIME_VAL_US(&this->stream_stats_time) >= TIMER_STATS_US)
+            this->_update_stream_stats();
+        return;
+    }
+
+    if (!this->camera->is_exposing())
         return;
 
     arv::ARV_EXPOSURE_STATUS const status = camera->exposure_poll(this->_receive_image_hook, this);
@@ -311,6 +422,13 @@ bool GigECCD::UpdateCCDFrame(int x, int y, int w, int h)
 {
     LOGF_INFO("%s x=%i y=%i w=%i h=%i", __PRETTY_FUNCTION__, x, y, w, h);
 
+    /* The buffer pool is sized for the current payload */
+    if (this->camera->is_streaming())
+    {
+        LOG_ERROR("Cannot change the frame while streaming");
+        return false;
+    }
+
     this->camera->set_geometry(x, y, w, h);
     return this->_update_geometry();
 }
@@ -318,6 +436,11 @@ bool GigECCD::UpdateCCDFrame(int x, int y, int w, int h)
 bool GigECCD::UpdateCCDBin(int binx, int biny)
 {
     LOGF_INFO("%s binx=%i biny=%i", __PRETTY_FUNCTION__, binx, biny);
+    if (this->camera->is_streaming())
+    {
+        LOG_ERROR("Cannot change binning while streaming");
+        return false;
+    }
     camera->set_bin(binx, biny);
     return UpdateCCDFrame(PrimaryCCD.getSubX(), PrimaryCCD.getSubY(), PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
 }
@@ -21,6 +21,7 @@
 #define GENERIC_CCD_H
 
 #include <indiccd.h>
+#include <atomic>
 #include <iostream>
 
 #include "ArvInterface.h"
@@ -44,6 +45,9 @@ class GigECCD : public INDI::CCD
     bool StartExposure(float duration);
     bool AbortExposure();
 
+    bool StartStreaming();
+    bool StopStreaming();
+
   protected:
     void TimerHit();
     virtual bool UpdateCCDFrame(int x, int y, int w, int h);
@@ -56,6 +60,9 @@ class GigECCD : public INDI::CCD
     bool _update_geometry(void);
     void _update_image(uint8_t const *const data, size_t size);
     static void _receive_image_hook(void *const class_ptr, uint8_t const *const data, size_t size);
+    void _stream_frame(uint8_t const *const data, size_t size);
+    static void _receive_frame_hook(void *const class_ptr, uint8_t const *const data, size_t size);
+    void _update_stream_stats(void);
 
     void _handle_failed(void);
     void _handle_timeout(struct timeval *const tv, uint32_t timeout_us);
@@ -65,6 +72,9 @@ class GigECCD : public INDI::CCD
     int timer_id;
     struct timeval exposure_start_time;
     struct timeval exposure_transfer_time;
+    struct timeval stream_stats_time;
+    uint64_t stream_stats_completed;
+    std::atomic<uint64_t> stream_wrong_size {0};
 
     /* Indi properties */
 
@@ -72,6 +82,8 @@ class GigECCD : public INDI::CCD
     INumberVectorProperty indiprop_gain_prop;
     IText indiprop_info[3] {};
     ITextVectorProperty indiprop_info_prop;
+    INumber indiprop_stream_stats[5];
+    INumberVectorProperty indiprop_stream_stats_prop;
 
     virtual bool ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n);
 
@@ -27,6 +27,7 @@
 #include "gphoto_readimage.h"
 
 #include <algorithm>
+#include <indielapsedtimer.h>
 #include <stream/streammanager.h>
 
 #include <sharedblob.h>
@@ -301,6 +302,18 @@ bool GPhotoCCD::initProperties()
     ForceBULBSP[INDI_DISABLED].fill("Off", "Off", isNikon ? ISS_ON : ISS_OFF);
     ForceBULBSP.fill(getDeviceName(), "CCD_FORCE_BLOB", "Force BULB", OPTIONS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
+    // Decode Mode
+    DecodeModeSP[DECODE_FILE].fill("DECODE_FILE", "File", ISS_OFF);
+    DecodeModeSP[DECODE_MEMORY].fill("DECODE_MEMORY", "Memory", ISS_ON);
+    DecodeModeSP.fill(getDeviceName(), "CCD_DECODE_MODE", "Decode", OPTIONS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
+    // Decode Latency
+    DecodeLatencyNP[LATENCY_DOWNLOAD].fill("DOWNLOAD", "Download (ms)", "%.1f", 0, 1e6, 0, 0);
+    DecodeLatencyNP[LATENCY_DECODE].fill("DECODE", "Decode (ms)", "%.1f", 0, 1e6, 0, 0);
+    DecodeLatencyNP[LATENCY_COPY].fill("COPY", "Copy (ms)", "%.1f", 0, 1e6, 0, 0);
+    DecodeLatencyNP[LATENCY_PUBLISH].fill("PUBLISH", "Publish (ms)", "%.1f", 0, 1e6, 0, 0);
+    DecodeLatencyNP.fill(getDeviceName(), "CCD_DECODE_LATENCY", "Latency", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
     // Upload File
     UploadFileTP[0].fill("PATH", "Path", nullptr);
     UploadFileTP.fill(getDeviceName(), "CCD_UPLOAD_FILE", "Upload File", OPTIONS_TAB, IP_RW, 0, IPS_IDLE);
@@ -425,6 +438,8 @@ bool GPhotoCCD::updateProperties()
 
         defineProperty(ForceBULBSP);
         defineProperty(DownloadTimeoutNP);
+        defineProperty(DecodeModeSP);
+        defineProperty(DecodeLatencyNP);
     }
     else
     {
@@ -451,6 +466,8 @@ bool GPhotoCCD::updateProperties()
 
         deleteProperty(ForceBULBSP);
         deleteProperty(DownloadTimeoutNP);
+        deleteProperty(DecodeModeSP);
+        deleteProperty(DecodeLatencyNP);
 
         HideExtendedOptions();
     }
@@ -592,6 +609,21 @@ bool GPhotoCCD::ISNewSwitch(const char * dev, const char * name, ISState * state
             return true;
         }
 
+        ///////////////////////////////////////////////////////////////////////////////////////////////
+        // Decode Mode
+        // Memory decodes the downloaded buffer directly instead of going through a temporary file.
+        ///////////////////////////////////////////////////////////////////////////////////////////////
+        if (DecodeModeSP.isNameMatch(name))
+        {
+            if (!DecodeModeSP.update(states, names, n))
+                return false;
+
+            DecodeModeSP.setState(IPS_OK);
+            DecodeModeSP.apply();
+            saveConfig(DecodeModeSP);
+            return true;
+        }
+
         if (ExposurePresetSP.isNameMatch(name))
         {
             if (!ExposurePresetSP.update(states, names, n))
@@ -1224,6 +1256,24 @@ bool GPhotoCCD::grabImage()
     {
         char filename[MAXRBUF] = "/tmp/indi_XXXXXX";
         const char *extension = "unknown";
+        // In memory mode the camera file buffer is decoded directly, no temporary file is written.
+        const bool inMemory = !isSimulation() && DecodeModeSP[DECODE_MEMORY].getState() == ISS_ON;
+        const bool tempFile = !isSimulation() && !inMemory;
+        const char *fileData = nullptr;
+        unsigned long fileSize = 0;
+        double copyTime = 0;
+        INDI::ElapsedTimer stageTimer;
+
+        auto completeExposure = [&]()
+        {
+            DecodeLatencyNP[LATENCY_COPY].setValue(copyTime + stageTimer.nsecsElapsed() / 1e6);
+            stageTimer.start();
+            ExposureComplete(&PrimaryCCD);
+            DecodeLatencyNP[LATENCY_PUBLISH].setValue(stageTimer.nsecsElapsed() / 1e6);
+            DecodeLatencyNP.setState(IPS_OK);
+            DecodeLatencyNP.apply();
+        };
+
         if (isSimulation())
         {
             if (uploadFile == nullptr || !uploadFile[0])
@@ -1241,6 +1291,26 @@ bool GPhotoCCD::grabImage()
             }
             extension =  found + 1;
         }
+        else if (inMemory)
+        {
+            int ret = gphoto_read_exposure(gphotodrv);
+            if (ret != GP_OK)
+            {
+                LOGF_ERROR("Exposure failed to download image... %s", gp_result_as_string(ret));
+                if (ret == GP_ERROR_DIRECTORY_NOT_FOUND)
+                    LOG_INFO("Make sure BULB switch is ON in the camera. Try setting AF switch to OFF.");
+                return false;
+            }
+
+            gphoto_get_buffer(gphotodrv, &fileData, &fileSize);
+            if (fileData == nullptr || fileSize == 0)
+            {
+                LOG_ERROR("Exposure failed, camera returned no image data.");
+                return false;
+            }
+
+            extension = gphoto_get_file_extension(gphotodrv);
+        }
         else
         {
             int fd = mkstemp(filename);
@@ -1273,12 +1343,18 @@ bool GPhotoCCD::grabImage()
         if (ExposureRequest > 3)
             LOG_INFO("Exposure done, downloading image...");
 
+        DecodeLatencyNP[LATENCY_DOWNLOAD].setValue(stageTimer.nsecsElapsed() / 1e6);
+        stageTimer.start();
+
         if (strcasecmp(extension, "jpg") == 0 || strcasecmp(extension, "jpeg") == 0)
         {
-            if (read_jpeg(filename, &memptr, &memsize, &naxis, &w, &h))
+            int rc = inMemory ? read_jpeg_mem(reinterpret_cast<unsigned char *>(const_cast<char *>(fileData)), fileSize,
+                                              &memptr, &memsize, &naxis, &w, &h)
+                     : read_jpeg(filename, &memptr, &memsize, &naxis, &w, &h);
+            if (rc)
             {
                 LOG_ERROR("Exposure failed to parse jpeg.");
-                if (!isSimulation())
+                if (tempFile)
                     unlink(filename);
                 return false;
             }
@@ -1292,9 +1368,13 @@ bool GPhotoCCD::grabImage()
             char bayer_pattern[8] = {};
             auto libraw_ok = false;
 
+            if (inMemory)
+                libraw_ok = read_libraw_mem(fileData, fileSize, &memptr, &memsize, &naxis, &w, &h, &bpp, bayer_pattern,
+                                            &copyTime) == 0;
+
             // In case the file read operation fails due to some disk delay (unlikely)
             // Try again before giving up.
-            for (int i = 0; i < 2; i++)
+            for (int i = 0; i < 2 && !inMemory; i++)
             {
                 // On error, try again in 500ms
                 if (read_libraw(filename, &memptr, &memsize, &naxis, &w, &h, &bpp, bayer_pattern))
@@ -1309,7 +1389,7 @@ bool GPhotoCCD::grabImage()
             if (libraw_ok == false)
             {
                 LOG_ERROR("Exposure failed to parse raw image.");
-                if (!isSimulation())
+                if (tempFile)
                     unlink(filename);
                 return false;
             }
@@ -1317,7 +1397,7 @@ bool GPhotoCCD::grabImage()
             LOGF_DEBUG("read_libraw: memsize (%d) naxis (%d) w (%d) h (%d) bpp (%d) bayer pattern (%s)",
                        memsize, naxis, w, h, bpp, bayer_pattern);
 
-            if (!isSimulation())
+            if (tempFile)
                 unlink(filename);
 
             BayerTP[2].setText(bayer_pattern);
@@ -1325,6 +1405,9 @@ bool GPhotoCCD::grabImage()
             SetCCDCapability(GetCCDCapability() | CCD_HAS_BAYER);
         }
 
+        DecodeLatencyNP[LATENCY_DECODE].setValue(stageTimer.nsecsElapsed() / 1e6 - copyTime);
+        stageTimer.start();
+
         if (EncodeFormatSP[FORMAT_FITS].getState() == ISS_ON)
             PrimaryCCD.setImageExtension("fits");
         else
@@ -1402,7 +1485,7 @@ bool GPhotoCCD::grabImage()
 #endif
             }
 
-            ExposureComplete(&PrimaryCCD);
+            completeExposure();
 
             // Restore old pointer and release memory
             //PrimaryCCD.setFrameBuffer(memptr);
@@ -1433,7 +1516,7 @@ bool GPhotoCCD::grabImage()
 #endif
             }
 
-            ExposureComplete(&PrimaryCCD);
+            completeExposure();
         }
     }
 
@@ -2070,6 +2153,9 @@ bool GPhotoCCD::saveConfigItems(FILE * fp)
     // Force BULB Mode
     ForceBULBSP.save(fp);
 
+    // Decode Mode
+    DecodeModeSP.save(fp);
+
     return true;
 }
 
@@ -205,6 +205,22 @@ class GPhotoCCD : public INDI::CCD, public INDI::FocuserInterface
         INDI::PropertySwitch ForceBULBSP {2};
         // Wait this many seconds before giving up on exposure download
         INDI::PropertyNumber DownloadTimeoutNP {1};
+        // Decode RAW/JPEG captures from a temporary file or straight from the downloaded buffer
+        INDI::PropertySwitch DecodeModeSP {2};
+        enum
+        {
+            DECODE_FILE,
+            DECODE_MEMORY
+        };
+        // Time spent in each stage of the last FITS/XISF capture
+        INDI::PropertyNumber DecodeLatencyNP {4};
+        enum
+        {
+            LATENCY_DOWNLOAD,
+            LATENCY_DECODE,
+            LATENCY_COPY,
+            LATENCY_PUBLISH
+        };
         // Upload file, used for testing purposes under simulation under native mode
         INDI::PropertyText UploadFileTP {1};
         INDI::PropertyBlob imageBP {INDI::Property()};
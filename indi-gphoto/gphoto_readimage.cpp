@@ -13,6 +13,7 @@
 #pragma GCC diagnostic pop
 
 
+#include <chrono>
 #include <unistd.h>
 #include <arpa/inet.h>
 
@@ -137,37 +138,10 @@ int dcraw_parse_header_info(const char *filename, struct dcraw_header *header)
     return 0;
 }
 
-int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
-                char *bayer_pattern)
+// Copy the visible area of an unpacked raw image into memptr
+static int copy_libraw(LibRaw &RawProcessor, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h,
+                       int *bitsperpixel, char *bayer_pattern)
 {
-    int ret = 0;
-    // Creation of image processing object
-    LibRaw RawProcessor;
-
-    // Let us open the file
-    if ((ret = RawProcessor.open_file(filename)) != LIBRAW_SUCCESS)
-    {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open %s: %s", filename, libraw_strerror(ret));
-        RawProcessor.recycle();
-        return -1;
-    }
-
-    // Let us unpack the image
-    if ((ret = RawProcessor.unpack()) != LIBRAW_SUCCESS)
-    {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot unpack %s: %s", filename, libraw_strerror(ret));
-        RawProcessor.recycle();
-        return -1;
-    }
-
-    // Covert to image
-    if ((ret = RawProcessor.raw2image()) != LIBRAW_SUCCESS)
-    {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot convert %s : %s", filename, libraw_strerror(ret));
-        RawProcessor.recycle();
-        return -1;
-    }
-
     *n_axis       = 2;
     *w            = RawProcessor.imgdata.rawdata.sizes.width;
     *h            = RawProcessor.imgdata.rawdata.sizes.height;
@@ -215,6 +189,74 @@ int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_
     return 0;
 }
 
+int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
+                char *bayer_pattern)
+{
+    int ret = 0;
+    // Creation of image processing object
+    LibRaw RawProcessor;
+
+    // Let us open the file
+    if ((ret = RawProcessor.open_file(filename)) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open %s: %s", filename, libraw_strerror(ret));
+        RawProcessor.recycle();
+        return -1;
+    }
+
+    // Let us unpack the image
+    if ((ret = RawProcessor.unpack()) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot unpack %s: %s", filename, libraw_strerror(ret));
+        RawProcessor.recycle();
+        return -1;
+    }
+
+    // Covert to image
+    if ((ret = RawProcessor.raw2image()) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot convert %s : %s", filename, libraw_strerror(ret));
+        RawProcessor.recycle();
+        return -1;
+    }
+
+    return copy_libraw(RawProcessor, memptr, memsize, n_axis, w, h, bitsperpixel, bayer_pattern);
+}
+
+int read_libraw_mem(const void *buffer, size_t size, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h,
+                    int *bitsperpixel, char *bayer_pattern, double *copy_ms)
+{
+    int ret = 0;
+    LibRaw RawProcessor;
+
+    // LibRaw reads straight from the camera file buffer, which must stay valid until we are done.
+    if ((ret = RawProcessor.open_buffer(const_cast<void *>(buffer), size)) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open raw buffer: %s", libraw_strerror(ret));
+        return -1;
+    }
+
+    if ((ret = RawProcessor.unpack()) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot unpack raw buffer: %s", libraw_strerror(ret));
+        return -1;
+    }
+
+    // raw2image() is skipped: it only builds a 4 component copy of raw_image that we never read.
+    if (RawProcessor.imgdata.rawdata.raw_image == nullptr)
+    {
+        DEBUGDEVICE(device, INDI::Logger::DBG_ERROR, "Raw buffer does not contain a bayer image.");
+        return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ret = copy_libraw(RawProcessor, memptr, memsize, n_axis, w, h, bitsperpixel, bayer_pattern);
+    if (copy_ms)
+        *copy_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return ret;
+}
+
 int read_jpeg(const char *filename, uint8_t **memptr, size_t *memsize, int *naxis, int *w, int *h)
 {
     unsigned char *r_data = nullptr, *g_data = nullptr, *b_data = nullptr;
@@ -31,8 +31,11 @@
 #include "core/rpicam_encoder.hpp"
 #include "output/output.hpp"
 
+#include <libcamera/formats.h>
+
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 #include <vector>
 #include <map>
 #include <unistd.h>
@@ -45,6 +48,131 @@
 
 
 #define CONTROL_TAB "Controls"
+#define STREAMING_TAB "Streaming"
+
+// Layout of a raw Bayer stream
+struct RawStreamFormat
+{
+    char bayer[5] {};
+    int bits {0};
+    bool packed {false};
+};
+
+/////////////////////////////////////////////////////////////////////////////
+/// Raw Bayer stream formats are named like SRGGB10_CSI2P or SBGGR16.
+/// Compressed formats are left to LibRaw.
+/////////////////////////////////////////////////////////////////////////////
+static bool parseRawFormat(const libcamera::PixelFormat &pixelFormat, RawStreamFormat &raw)
+{
+    const std::string format = pixelFormat.toString();
+    if (format.size() < 6 || format[0] != 'S')
+        return false;
+
+    size_t suffix = format.find('_');
+    raw.packed = suffix != std::string::npos;
+    if (raw.packed && format.substr(suffix) != "_CSI2P")
+        return false;
+
+    raw.bits = atoi(format.substr(5, raw.packed ? suffix - 5 : std::string::npos).c_str());
+    if (!(raw.bits == 8 || (raw.packed && (raw.bits == 10 || raw.bits == 12)) || (!raw.packed && raw.bits > 8 && raw.bits <= 16)))
+        return false;
+
+    strncpy(raw.bayer, format.c_str() + 1, 4);
+    raw.bayer[4] = '\0';
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Unpack one raw frame into 16 bit pixels.
+/////////////////////////////////////////////////////////////////////////////
+static void unpackRawStream(const uint8_t *data, const StreamInfo &info, const RawStreamFormat &raw, uint16_t *buffer)
+{
+    const unsigned int w = info.width;
+    for (unsigned int y = 0; y < info.height; y++)
+    {
+        const uint8_t *src = data + static_cast<size_t>(y) * info.stride;
+        uint16_t *dst = buffer + static_cast<size_t>(y) * w;
+        unsigned int x = 0;
+
+        if (raw.bits == 8)
+        {
+            for (; x < w; x++)
+                dst[x] = src[x];
+        }
+        else if (raw.bits == 10 && raw.packed)
+        {
+            // 4 pixels in 5 bytes, the fifth byte holds the 2 low bits of each
+            for (; x + 4 <= w; x += 4, src += 5)
+            {
+                dst[x]     = (src[0] << 2) | (src[4] & 0x3);
+                dst[x + 1] = (src[1] << 2) | ((src[4] >> 2) & 0x3);
+                dst[x + 2] = (src[2] << 2) | ((src[4] >> 4) & 0x3);
+                dst[x + 3] = (src[3] << 2) | (src[4] >> 6);
+            }
+            for (int i = 0; x < w; x++, i++)
+                dst[x] = (src[i] << 2) | ((src[4] >> (i * 2)) & 0x3);
+        }
+        else if (raw.bits == 12 && raw.packed)
+        {
+            // 2 pixels in 3 bytes, the third byte holds the 4 low bits of each
+            for (; x + 2 <= w; x += 2, src += 3)
+            {
+                dst[x]     = (src[0] << 4) | (src[2] & 0xF);
+                dst[x + 1] = (src[1] << 4) | (src[2] >> 4);
+            }
+            if (x < w)
+                dst[x] = (src[0] << 4) | (src[2] & 0xF);
+        }
+        else
+            memcpy(dst, src, w * sizeof(uint16_t));
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Convert a full range YUV420 frame to 8 bit RGB, either planar or interleaved.
+/////////////////////////////////////////////////////////////////////////////
+static void convertYUV420(const uint8_t *data, const StreamInfo &info, uint8_t *buffer, bool planar)
+{
+    const size_t plane = static_cast<size_t>(info.width) * info.height;
+    const unsigned int uvStride = info.stride / 2;
+    const uint8_t *Y = data;
+    const uint8_t *U = Y + static_cast<size_t>(info.stride) * info.height;
+    const uint8_t *V = U + static_cast<size_t>(uvStride) * ((info.height + 1) / 2);
+    uint8_t *R = buffer, *G = planar ? buffer + plane : buffer + 1, *B = planar ? buffer + plane * 2 : buffer + 2;
+    const int step = planar ? 1 : 3;
+
+    auto clamp = [](int value)
+    {
+        return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+    };
+
+    // BT.601 full range, 16 bit fixed point
+    for (unsigned int y = 0; y < info.height; y++)
+    {
+        const uint8_t *yRow = Y + static_cast<size_t>(y) * info.stride;
+        const uint8_t *uRow = U + static_cast<size_t>(y / 2) * uvStride;
+        const uint8_t *vRow = V + static_cast<size_t>(y / 2) * uvStride;
+
+        for (unsigned int x = 0; x < info.width; x++, R += step, G += step, B += step)
+        {
+            int luma = yRow[x];
+            int u = uRow[x / 2] - 128;
+            int v = vRow[x / 2] - 128;
+
+            *R = clamp(luma + ((91881 * v) >> 16));
+            *G = clamp(luma - ((22554 * u + 46802 * v) >> 16));
+            *B = clamp(luma + ((116130 * u) >> 16));
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/////////////////////////////////////////////////////////////////////////////
+static size_t yuv420Size(const StreamInfo &info)
+{
+    return static_cast<size_t>(info.stride) * info.height + 2 * static_cast<size_t>(info.stride / 2) * ((info.height + 1) / 2);
+}
 
 static class Loader
 {
@@ -126,6 +254,9 @@ int INDILibCamera::getColorspaceFlags(std::string const &codec)
 /////////////////////////////////////////////////////////////////////////////
 void INDILibCamera::workerStreamVideo(const std::atomic_bool &isAboutToQuit, double framerate)
 {
+    // Only one camera manager may exist at a time
+    closeSession();
+
     RPiCamEncoder app;
     auto options = app.GetOptions();
     configureVideoOptions(options, framerate);
@@ -209,6 +340,200 @@ void INDILibCamera::outputReady(void *mem, size_t size, int64_t timestamp_us, bo
     ccdguard.unlock();
 }
 
+/////////////////////////////////////////////////////////////////////////////
+/// Stream unencoded frames: raw Bayer straight from the sensor, or the YUV420
+/// video stream converted to RGB. Frames go to the streamer without the
+/// MJPEG encoder, packed raw formats are unpacked into a buffer allocated once.
+/////////////////////////////////////////////////////////////////////////////
+void INDILibCamera::workerStreamRaw(const std::atomic_bool &isAboutToQuit, double framerate)
+{
+    // Only one camera manager may exist at a time
+    closeSession();
+
+    const bool raw = StreamFormatSP[STREAM_RAW].getState() == ISS_ON;
+    RPiCamEncoder app;
+    auto options = app.GetOptions();
+    configureVideoOptions(options, framerate);
+    options->codec = "yuv420";
+
+    libcamera::Stream *stream = nullptr;
+    StreamInfo info;
+    RawStreamFormat format;
+
+    try
+    {
+        app.OpenCamera();
+        app.ConfigureVideo(raw ? RPiCamApp::FLAG_VIDEO_RAW : RPiCamApp::FLAG_VIDEO_NONE);
+        stream = raw ? app.RawStream() : app.VideoStream();
+        info = app.GetStreamInfo(stream);
+        if (raw && !parseRawFormat(info.pixel_format, format))
+            throw std::runtime_error("unsupported raw format " + info.pixel_format.toString());
+        if (!raw && info.pixel_format != libcamera::formats::YUV420)
+            throw std::runtime_error("unsupported video format " + info.pixel_format.toString());
+        app.StartCamera();
+    }
+    catch (std::exception &e)
+    {
+        LOGF_ERROR("Error opening camera: %s", e.what());
+        shutdownVideo();
+        return;
+    }
+
+    const int depth = (raw && format.bits > 8) ? 16 : 8;
+    const size_t frameSize = static_cast<size_t>(info.width) * info.height * (raw ? depth / 8 : 3);
+    const size_t bufferSize = raw ? static_cast<size_t>(info.stride) * info.height : yuv420Size(info);
+    // 8 bit and unpacked 16 bit rows without padding can be sent as they are
+    const bool zeroCopy = raw && !format.packed && info.stride * 8 == info.width * depth;
+
+    if (!zeroCopy)
+        m_StreamBuffer.resize(frameSize);
+
+    Streamer->setPixelFormat(raw ? bayerToPixelFormat(format.bayer) : INDI_RGB, depth);
+    Streamer->setSize(info.width, info.height);
+
+    LOGF_INFO("Streaming %s %ux%u %s frames.", raw ? "raw" : "RGB", info.width, info.height,
+              info.pixel_format.toString().c_str());
+
+    resetStreamStats();
+    INDI::ElapsedTimer statsTimer;
+
+    while (!isAboutToQuit)
+    {
+        RPiCamEncoder::Msg msg = app.Wait();
+
+        if (msg.type == RPiCamApp::MsgType::Timeout)
+        {
+            LOG_WARN("Device timeout detected, attempting a restart!");
+            app.StopCamera();
+            app.StartCamera();
+            continue;
+        }
+        else if (msg.type == RPiCamEncoder::MsgType::Quit)
+        {
+            break;
+        }
+        else if (msg.type != RPiCamEncoder::MsgType::RequestComplete)
+        {
+            LOGF_ERROR("Video Streaming failed: %d", msg.type);
+            shutdownVideo();
+            return;
+        }
+
+        CompletedRequestPtr &completed_request = std::get<CompletedRequestPtr>(msg.payload);
+        libcamera::FrameBuffer *buffer = completed_request->buffers[stream];
+        recordStreamFrame(buffer->metadata().sequence, buffer->metadata().timestamp);
+
+        BufferReadSync r(&app, buffer);
+        const std::vector<libcamera::Span<uint8_t>> mem = r.Get();
+        if (mem.empty() || mem[0].size() < bufferSize)
+        {
+            m_StreamStats.dropped++;
+            continue;
+        }
+
+        const uint8_t *frame = m_StreamBuffer.data();
+        if (zeroCopy)
+            frame = mem[0].data();
+        else if (!raw)
+            convertYUV420(mem[0].data(), info, m_StreamBuffer.data(), false);
+        else if (depth == 16)
+            unpackRawStream(mem[0].data(), info, format, reinterpret_cast<uint16_t *>(m_StreamBuffer.data()));
+        else
+        {
+            for (unsigned int y = 0; y < info.height; y++)
+                memcpy(m_StreamBuffer.data() + static_cast<size_t>(y) * info.width, mem[0].data() + static_cast<size_t>(y) * info.stride,
+                       info.width);
+        }
+
+        Streamer->newFrame(frame, frameSize);
+
+        if (statsTimer.elapsed() >= 1000)
+        {
+            updateStreamStats();
+            statsTimer.start();
+        }
+    }
+
+    updateStreamStats();
+    app.StopCamera();
+    app.Teardown();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/////////////////////////////////////////////////////////////////////////////
+void INDILibCamera::resetStreamStats()
+{
+    m_StreamStats = StreamStats();
+    for (auto &value : StreamStatsNP)
+        value.setValue(0);
+    StreamStatsNP.setState(IPS_BUSY);
+    StreamStatsNP.apply();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Account for dropped frames using the buffer sequence numbers and collect
+/// the frame interval from the sensor timestamps (ns).
+/////////////////////////////////////////////////////////////////////////////
+void INDILibCamera::recordStreamFrame(uint32_t sequence, uint64_t timestamp)
+{
+    StreamStats &stats = m_StreamStats;
+
+    if (stats.frames > 0)
+    {
+        uint32_t gap = sequence - stats.sequence;
+        if (gap > 1)
+        {
+            stats.dropped += gap - 1;
+            LOGF_DEBUG("Dropped %u frames between sequence %u and %u.", gap - 1, stats.sequence, sequence);
+        }
+
+        if (timestamp > stats.timestamp)
+        {
+            // Interval per sequence step, so drops do not show up as jitter too
+            double interval = (timestamp - stats.timestamp) / 1e6 / std::max(gap, 1u);
+            stats.intervals++;
+            stats.intervalSum += interval;
+            stats.intervalSquares += interval * interval;
+            stats.minInterval = stats.intervals == 1 ? interval : std::min(stats.minInterval, interval);
+            stats.maxInterval = std::max(stats.maxInterval, interval);
+        }
+    }
+
+    stats.frames++;
+    stats.sequence = sequence;
+    stats.timestamp = timestamp;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Publish the stream statistics. Interval and jitter cover the frames since
+/// the last update.
+/////////////////////////////////////////////////////////////////////////////
+void INDILibCamera::updateStreamStats()
+{
+    StreamStats &stats = m_StreamStats;
+
+    StreamStatsNP[STATS_FRAMES].setValue(stats.frames);
+    StreamStatsNP[STATS_DROPPED].setValue(stats.dropped);
+    StreamStatsNP[STATS_SEQUENCE].setValue(stats.sequence);
+
+    if (stats.intervals > 0)
+    {
+        double mean = stats.intervalSum / stats.intervals;
+        double variance = std::max(0.0, stats.intervalSquares / stats.intervals - mean * mean);
+        StreamStatsNP[STATS_INTERVAL].setValue(mean);
+        StreamStatsNP[STATS_JITTER].setValue(std::sqrt(variance));
+        StreamStatsNP[STATS_JITTER_PEAK].setValue(stats.maxInterval - stats.minInterval);
+    }
+
+    stats.intervals = 0;
+    stats.intervalSum = stats.intervalSquares = 0;
+    stats.minInterval = stats.maxInterval = 0;
+
+    StreamStatsNP.setState(IPS_OK);
+    StreamStatsNP.apply();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 ///
 /////////////////////////////////////////////////////////////////////////////
@@ -223,6 +548,15 @@ void INDILibCamera::metadataReady(libcamera::ControlList &metadata)
 /////////////////////////////////////////////////////////////////////////////
 void INDILibCamera::workerExposure(const std::atomic_bool &isAboutToQuit, float duration)
 {
+    if (SessionModeSP[SESSION_PERSISTENT].getState() == ISS_ON)
+    {
+        workerExposurePersistent(isAboutToQuit, duration);
+        return;
+    }
+
+    // Only one camera manager may exist at a time
+    closeSession();
+
     RPiCamINDIApp app;
     auto options = app.GetOptions();
     configureStillOptions(options, duration);
@@ -262,8 +596,144 @@ void INDILibCamera::workerExposure(const std::atomic_bool &isAboutToQuit, float
     }
 
     bool raw = CaptureFormatSP.findOnSwitchIndex() == CAPTURE_DNG;
-    auto stream = raw ? app.RawStream() : app.StillStream();
     auto payload = std::get<CompletedRequestPtr>(msg.payload);
+    processFile(app, payload, raw);
+
+    app.StopCamera();
+    app.Teardown();
+    app.CloseCamera();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Keep the camera open and configured between exposures taken with the same
+/// settings. Only the capture itself is restarted, any change of duration,
+/// gain or adjustments configures the camera from scratch.
+/////////////////////////////////////////////////////////////////////////////
+void INDILibCamera::workerExposurePersistent(const std::atomic_bool &isAboutToQuit, float duration)
+{
+    INDI::ElapsedTimer firstFrameTimer;
+    bool raw = CaptureFormatSP.findOnSwitchIndex() == CAPTURE_DNG;
+
+    if (!openSession(raw, duration))
+    {
+        PrimaryCCD.setExposureFailed();
+        return;
+    }
+
+    RPiCamApp::Msg msg = m_StillSession->Wait();
+    if (msg.type != RPiCamApp::MsgType::RequestComplete)
+    {
+        PrimaryCCD.setExposureFailed();
+        closeSession();
+        LOGF_ERROR("Exposure failed: %d", msg.type);
+        return;
+    }
+    else if (isAboutToQuit)
+    {
+        closeSession();
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    SessionMetricsNP[METRIC_FIRST_FRAME].setValue(firstFrameTimer.nsecsElapsed() / 1e6);
+    // Everything between two consecutive frames that was not spent exposing
+    if (m_LastFrameTime != std::chrono::steady_clock::time_point())
+    {
+        double gap = std::chrono::duration<double, std::milli>(now - m_LastFrameTime).count();
+        SessionMetricsNP[METRIC_DEAD_TIME].setValue(std::max(0.0, gap - duration * 1000.0));
+    }
+    m_LastFrameTime = now;
+    SessionMetricsNP.setState(IPS_OK);
+    SessionMetricsNP.apply();
+
+    {
+        auto payload = std::get<CompletedRequestPtr>(msg.payload);
+        if (!processMemory(*m_StillSession, payload, raw))
+            processFile(*m_StillSession, payload, raw);
+    }
+
+    m_StillSession->StopCamera();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/////////////////////////////////////////////////////////////////////////////
+bool INDILibCamera::openSession(bool raw, double duration)
+{
+    SessionConfig config;
+    config.raw = raw;
+    config.width = PrimaryCCD.getSubW();
+    config.height = PrimaryCCD.getSubH();
+    config.bpp = PrimaryCCD.getBPP();
+    config.duration = duration;
+    for (size_t i = 0; i < AdjustmentNP.size(); i++)
+        config.adjustments.push_back(AdjustmentNP[i].getValue());
+    config.gain = GainNP[0].getValue();
+    config.exposureIndex = AdjustExposureModeSP.findOnSwitchIndex();
+    config.awbIndex = AdjustAwbModeSP.findOnSwitchIndex();
+    config.meteringIndex = AdjustMeteringModeSP.findOnSwitchIndex();
+    config.denoise = AdjustDenoiseModeSP.findOnSwitch()->getName();
+
+    try
+    {
+        if (m_StillSession && !(config == m_SessionConfig))
+        {
+            LOG_DEBUG("Capture settings changed, reconfiguring camera.");
+            closeSession();
+        }
+
+        if (!m_StillSession)
+        {
+            m_StillSession.reset(new RPiCamINDIApp());
+            configureStillOptions(m_StillSession->GetOptions(), duration);
+            m_StillSession->OpenCamera();
+            m_StillSession->ConfigureStill(RPiCamApp::FLAG_STILL_RAW);
+            m_SessionConfig = config;
+            m_LastFrameTime = std::chrono::steady_clock::time_point();
+            SessionMetricsNP[METRIC_RECONFIGURES].setValue(SessionMetricsNP[METRIC_RECONFIGURES].getValue() + 1);
+        }
+
+        m_StillSession->StartCamera();
+    }
+    catch (std::exception &e)
+    {
+        LOGF_ERROR("Error opening camera: %s", e.what());
+        closeSession();
+        return false;
+    }
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+///
+/////////////////////////////////////////////////////////////////////////////
+void INDILibCamera::closeSession()
+{
+    if (!m_StillSession)
+        return;
+
+    try
+    {
+        m_StillSession->StopCamera();
+        m_StillSession->Teardown();
+        m_StillSession->CloseCamera();
+    }
+    catch (std::exception &e)
+    {
+        LOGF_DEBUG("Error closing camera: %s", e.what());
+    }
+
+    m_StillSession.reset();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Save the completed request as DNG/JPEG and load it back.
+/////////////////////////////////////////////////////////////////////////////
+bool INDILibCamera::processFile(RPiCamINDIApp &app, CompletedRequestPtr &payload, bool raw)
+{
+    auto options = app.GetOptions();
+    auto stream = raw ? app.RawStream() : app.StillStream();
     StreamInfo info = app.GetStreamInfo(stream);
     BufferReadSync r(&app, payload->buffers[stream]);
     const std::vector<libcamera::Span<uint8_t>> mem = r.Get();
@@ -296,11 +766,8 @@ void INDILibCamera::workerExposure(const std::atomic_bool &isAboutToQuit, float
                 {
                     LOG_ERROR("Exposure failed to parse raw image.");
                     PrimaryCCD.setExposureFailed();
-                    app.StopCamera();
-                    app.Teardown();
-                    app.CloseCamera();
                     unlink(filename);
-                    return;
+                    return false;
                 }
 
                 SetCCDCapability(GetCCDCapability() | CCD_HAS_BAYER);
@@ -313,11 +780,8 @@ void INDILibCamera::workerExposure(const std::atomic_bool &isAboutToQuit, float
                 {
                     LOG_ERROR("Exposure failed to parse jpeg.");
                     PrimaryCCD.setExposureFailed();
-                    app.StopCamera();
-                    app.Teardown();
-                    app.CloseCamera();
                     unlink(filename);
-                    return;
+                    return false;
                 }
 
                 LOGF_DEBUG("read_jpeg: memsize (%d) naxis (%d) w (%d) h (%d) bpp (%d)", memsize, naxis, w, h, bpp);
@@ -326,81 +790,7 @@ void INDILibCamera::workerExposure(const std::atomic_bool &isAboutToQuit, float
             }
 
             PrimaryCCD.setImageExtension("fits");
-
-            uint16_t subW = PrimaryCCD.getSubW();
-            uint16_t subH = PrimaryCCD.getSubH();
-
-            // If subframing is requested
-            // If either axis is less than the image resolution
-            // then we subframe, given the OTHER axis is within range as well.
-            if ( (subW > 0 && subH > 0) && ((subW < w && subH <= h) || (subH < h && subW <= w)))
-            {
-
-                uint16_t subX = PrimaryCCD.getSubX();
-                uint16_t subY = PrimaryCCD.getSubY();
-
-                int subFrameSize     = subW * subH * bpp / 8 * ((naxis == 3) ? 3 : 1);
-                int oneFrameSize     = subW * subH * bpp / 8;
-
-                int lineW  = subW * bpp / 8;
-
-                LOGF_DEBUG("Subframing... subFrameSize: %d - oneFrameSize: %d - subX: %d - subY: %d - subW: %d - subH: %d",
-                           subFrameSize, oneFrameSize,
-                           subX, subY, subW, subH);
-
-                if (naxis == 2)
-                {
-                    // JM 2020-08-29: Using memmove since regions are overlaping
-                    // as proposed by Camiel Severijns on INDI forums.
-                    for (int i = subY; i < subY + subH; i++)
-                        memmove(memptr + (i - subY) * lineW, memptr + (i * w + subX) * bpp / 8, lineW);
-                }
-                else
-                {
-                    uint8_t * subR = memptr;
-                    uint8_t * subG = memptr + oneFrameSize;
-                    uint8_t * subB = memptr + oneFrameSize * 2;
-
-                    uint8_t * startR = memptr;
-                    uint8_t * startG = memptr + (w * h * bpp / 8);
-                    uint8_t * startB = memptr + (w * h * bpp / 8 * 2);
-
-                    for (int i = subY; i < subY + subH; i++)
-                    {
-                        memcpy(subR + (i - subY) * lineW, startR + (i * w + subX) * bpp / 8, lineW);
-                        memcpy(subG + (i - subY) * lineW, startG + (i * w + subX) * bpp / 8, lineW);
-                        memcpy(subB + (i - subY) * lineW, startB + (i * w + subX) * bpp / 8, lineW);
-                    }
-                }
-
-                PrimaryCCD.setFrameBuffer(memptr);
-                PrimaryCCD.setFrameBufferSize(memsize, false);
-                PrimaryCCD.setResolution(w, h);
-                PrimaryCCD.setFrame(subX, subY, subW, subH);
-                PrimaryCCD.setNAxis(naxis);
-                PrimaryCCD.setBPP(bpp);
-
-                // binning if needed
-                if(PrimaryCCD.getBinX() > 1)
-                    PrimaryCCD.binBayerFrame();
-            }
-            else
-            {
-                if (PrimaryCCD.getSubW() != 0 && (w > PrimaryCCD.getSubW() || h > PrimaryCCD.getSubH()))
-                    LOGF_WARN("Camera image size (%dx%d) is less than requested size (%d,%d). Purge configuration and update frame size to match camera size.",
-                              w, h, PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
-
-                PrimaryCCD.setFrameBuffer(memptr);
-                PrimaryCCD.setFrameBufferSize(memsize, false);
-                PrimaryCCD.setResolution(w, h);
-                PrimaryCCD.setFrame(0, 0, w, h);
-                PrimaryCCD.setNAxis(naxis);
-                PrimaryCCD.setBPP(bpp);
-
-                // binning if needed
-                if(PrimaryCCD.getBinX() > 1)
-                    PrimaryCCD.binBayerFrame();
-            }
+            setupFrameBuffer(memptr, memsize, naxis, w, h, bpp);
         }
         else
         {
@@ -412,11 +802,8 @@ void INDILibCamera::workerExposure(const std::atomic_bool &isAboutToQuit, float
             {
                 LOGF_ERROR("Error opening file %s: %s", filename, strerror(errno));
                 PrimaryCCD.setExposureFailed();
-                app.StopCamera();
-                app.Teardown();
-                app.CloseCamera();
                 close(fd);
-                return;
+                return false;
             }
 
             // Copy file to memory using mmap
@@ -438,11 +825,8 @@ void INDILibCamera::workerExposure(const std::atomic_bool &isAboutToQuit, float
                 {
                     LOGF_ERROR("Error reading file %s: %s", filename, strerror(errno));
                     PrimaryCCD.setExposureFailed();
-                    app.StopCamera();
-                    app.Teardown();
-                    app.CloseCamera();
                     close(fd);
-                    return;
+                    return false;
                 }
 
                 // Copy mmap buffer to ccd buffer
@@ -469,11 +853,136 @@ void INDILibCamera::workerExposure(const std::atomic_bool &isAboutToQuit, float
     {
         LOGF_ERROR("Error saving image: %s", e.what());
         PrimaryCCD.setExposureFailed();
+        return false;
     }
 
-    app.StopCamera();
-    app.Teardown();
-    app.CloseCamera();
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Decode the completed request buffer directly. Returns false if the stream
+/// format is not handled here, in which case the caller goes through a file.
+/////////////////////////////////////////////////////////////////////////////
+bool INDILibCamera::processMemory(RPiCamINDIApp &app, CompletedRequestPtr &payload, bool raw)
+{
+    // Native DNG/JPEG output still needs the encoded file
+    if (EncodeFormatSP[FORMAT_FITS].getState() != ISS_ON)
+        return false;
+
+    auto stream = raw ? app.RawStream() : app.StillStream();
+    StreamInfo info = app.GetStreamInfo(stream);
+    BufferReadSync r(&app, payload->buffers[stream]);
+    const std::vector<libcamera::Span<uint8_t>> mem = r.Get();
+
+    char bayer_pattern[8] = {};
+    uint8_t * memptr = PrimaryCCD.getFrameBuffer();
+    size_t memsize = 0;
+    int naxis = 2, bpp = 8;
+
+    if (raw)
+    {
+        if (!processRAWStream(mem[0], info, &memptr, &memsize, bayer_pattern))
+            return false;
+
+        bpp = 16;
+        SetCCDCapability(GetCCDCapability() | CCD_HAS_BAYER);
+        BayerTP[2].setText(bayer_pattern);
+        BayerTP.apply();
+    }
+    else
+    {
+        if (!processYUV420Stream(mem[0], info, &memptr, &memsize))
+            return false;
+
+        naxis = 3;
+        SetCCDCapability(GetCCDCapability() & ~CCD_HAS_BAYER);
+    }
+
+    PrimaryCCD.setImageExtension("fits");
+    setupFrameBuffer(memptr, memsize, naxis, info.width, info.height, bpp);
+    ExposureComplete(&PrimaryCCD);
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Crop and bin the decoded image into the primary CCD buffer.
+/////////////////////////////////////////////////////////////////////////////
+void INDILibCamera::setupFrameBuffer(uint8_t *memptr, size_t memsize, int naxis, int w, int h, int bpp)
+{
+    uint16_t subW = PrimaryCCD.getSubW();
+    uint16_t subH = PrimaryCCD.getSubH();
+
+    // If subframing is requested
+    // If either axis is less than the image resolution
+    // then we subframe, given the OTHER axis is within range as well.
+    if ( (subW > 0 && subH > 0) && ((subW < w && subH <= h) || (subH < h && subW <= w)))
+    {
+
+        uint16_t subX = PrimaryCCD.getSubX();
+        uint16_t subY = PrimaryCCD.getSubY();
+
+        int subFrameSize     = subW * subH * bpp / 8 * ((naxis == 3) ? 3 : 1);
+        int oneFrameSize     = subW * subH * bpp / 8;
+
+        int lineW  = subW * bpp / 8;
+
+        LOGF_DEBUG("Subframing... subFrameSize: %d - oneFrameSize: %d - subX: %d - subY: %d - subW: %d - subH: %d",
+                   subFrameSize, oneFrameSize,
+                   subX, subY, subW, subH);
+
+        if (naxis == 2)
+        {
+            // JM 2020-08-29: Using memmove since regions are overlaping
+            // as proposed by Camiel Severijns on INDI forums.
+            for (int i = subY; i < subY + subH; i++)
+                memmove(memptr + (i - subY) * lineW, memptr + (i * w + subX) * bpp / 8, lineW);
+        }
+        else
+        {
+            uint8_t * subR = memptr;
+            uint8_t * subG = memptr + oneFrameSize;
+            uint8_t * subB = memptr + oneFrameSize * 2;
+
+            uint8_t * startR = memptr;
+            uint8_t * startG = memptr + (w * h * bpp / 8);
+            uint8_t * startB = memptr + (w * h * bpp / 8 * 2);
+
+            for (int i = subY; i < subY + subH; i++)
+            {
+                memcpy(subR + (i - subY) * lineW, startR + (i * w + subX) * bpp / 8, lineW);
+                memcpy(subG + (i - subY) * lineW, startG + (i * w + subX) * bpp / 8, lineW);
+                memcpy(subB + (i - subY) * lineW, startB + (i * w + subX) * bpp / 8, lineW);
+            }
+        }
+
+        PrimaryCCD.setFrameBuffer(memptr);
+        PrimaryCCD.setFrameBufferSize(memsize, false);
+        PrimaryCCD.setResolution(w, h);
+        PrimaryCCD.setFrame(subX, subY, subW, subH);
+        PrimaryCCD.setNAxis(naxis);
+        PrimaryCCD.setBPP(bpp);
+
+        // binning if needed
+        if(PrimaryCCD.getBinX() > 1)
+            PrimaryCCD.binBayerFrame();
+    }
+    else
+    {
+        if (PrimaryCCD.getSubW() != 0 && (w > PrimaryCCD.getSubW() || h > PrimaryCCD.getSubH()))
+            LOGF_WARN("Camera image size (%dx%d) is less than requested size (%d,%d). Purge configuration and update frame size to match camera size.",
+                      w, h, PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
+
+        PrimaryCCD.setFrameBuffer(memptr);
+        PrimaryCCD.setFrameBufferSize(memsize, false);
+        PrimaryCCD.setResolution(w, h);
+        PrimaryCCD.setFrame(0, 0, w, h);
+        PrimaryCCD.setNAxis(naxis);
+        PrimaryCCD.setBPP(bpp);
+
+        // binning if needed
+        if(PrimaryCCD.getBinX() > 1)
+            PrimaryCCD.binBayerFrame();
+    }
 }
 
 /*
@@ -563,6 +1072,28 @@ bool INDILibCamera::initProperties()
     GainNP[0].fill("GAIN", "Gain", "%.2f", 0.00, 100.00, 1.00, 0.00);
     GainNP.fill(getDeviceName(), "CCD_GAIN", "Gain", IMAGE_CONTROLS_TAB, IP_RW, 60, IPS_IDLE);
 
+    SessionModeSP[SESSION_PERSISTENT].fill("SESSION_PERSISTENT", "Persistent", ISS_ON);
+    SessionModeSP[SESSION_PER_EXPOSURE].fill("SESSION_PER_EXPOSURE", "Per exposure", ISS_OFF);
+    SessionModeSP.fill(getDeviceName(), "CAPTURE_SESSION", "Session", OPTIONS_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    SessionMetricsNP[METRIC_FIRST_FRAME].fill("FIRST_FRAME", "First frame (ms)", "%.1f", 0, 1e7, 0, 0);
+    SessionMetricsNP[METRIC_DEAD_TIME].fill("DEAD_TIME", "Dead time (ms)", "%.1f", 0, 1e7, 0, 0);
+    SessionMetricsNP[METRIC_RECONFIGURES].fill("RECONFIGURES", "Reconfigures", "%.f", 0, 1e9, 0, 0);
+    SessionMetricsNP.fill(getDeviceName(), "SESSION_METRICS", "Session", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
+    StreamFormatSP[STREAM_MJPEG].fill("STREAM_MJPEG", "MJPEG", ISS_ON);
+    StreamFormatSP[STREAM_RAW].fill("STREAM_RAW", "Raw Bayer", ISS_OFF);
+    StreamFormatSP[STREAM_RGB].fill("STREAM_RGB", "RGB", ISS_OFF);
+    StreamFormatSP.fill(getDeviceName(), "STREAM_FORMAT", "Format", STREAMING_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    StreamStatsNP[STATS_FRAMES].fill("FRAMES", "Frames", "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STATS_DROPPED].fill("DROPPED", "Dropped", "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STATS_SEQUENCE].fill("SEQUENCE", "Sequence", "%.f", 0, 1e12, 0, 0);
+    StreamStatsNP[STATS_INTERVAL].fill("INTERVAL", "Interval (ms)", "%.2f", 0, 1e6, 0, 0);
+    StreamStatsNP[STATS_JITTER].fill("JITTER", "Jitter (ms)", "%.3f", 0, 1e6, 0, 0);
+    StreamStatsNP[STATS_JITTER_PEAK].fill("JITTER_PEAK", "Peak jitter (ms)", "%.3f", 0, 1e6, 0, 0);
+    StreamStatsNP.fill(getDeviceName(), "STREAM_STATS", "Stream", STREAMING_TAB, IP_RO, 60, IPS_IDLE);
+
     uint32_t cap = 0;
     cap |= CCD_HAS_BAYER;
     cap |= CCD_HAS_STREAMING;
@@ -602,6 +1133,10 @@ bool INDILibCamera::updateProperties()
         defineProperty(AdjustAwbModeSP);
         defineProperty(AdjustMeteringModeSP);
         defineProperty(AdjustDenoiseModeSP);
+        defineProperty(SessionModeSP);
+        defineProperty(SessionMetricsNP);
+        defineProperty(StreamFormatSP);
+        defineProperty(StreamStatsNP);
     }
     else
     {
@@ -611,6 +1146,10 @@ bool INDILibCamera::updateProperties()
         deleteProperty(AdjustAwbModeSP);
         deleteProperty(AdjustMeteringModeSP);
         deleteProperty(AdjustDenoiseModeSP);
+        deleteProperty(SessionModeSP);
+        deleteProperty(SessionMetricsNP);
+        deleteProperty(StreamFormatSP);
+        deleteProperty(StreamStatsNP);
     }
 
     return true;
@@ -725,6 +1264,7 @@ bool INDILibCamera::Connect()
 bool INDILibCamera::Disconnect()
 {
     m_Worker.quit();
+    closeSession();
     return true;
 }
 
@@ -837,6 +1377,26 @@ bool INDILibCamera::ISNewSwitch(const char *dev, const char *name, ISState * sta
             saveConfig(AdjustDenoiseModeSP);
             return true;
         }
+
+        // Session mode, takes effect on the next exposure
+        if (SessionModeSP.isNameMatch(name))
+        {
+            SessionModeSP.update(states, names, n);
+            SessionModeSP.setState(IPS_OK);
+            SessionModeSP.apply();
+            saveConfig(SessionModeSP);
+            return true;
+        }
+
+        // Stream format, takes effect when streaming starts
+        if (StreamFormatSP.isNameMatch(name))
+        {
+            StreamFormatSP.update(states, names, n);
+            StreamFormatSP.setState(IPS_OK);
+            StreamFormatSP.apply();
+            saveConfig(StreamFormatSP);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewSwitch(dev, name, states, names, n);
@@ -870,7 +1430,10 @@ bool INDILibCamera::StartStreaming()
 {
     // do something dynamic here
     double framerate = Streamer.get()->getTargetFPS();
-    m_Worker.start(std::bind(&INDILibCamera::workerStreamVideo, this, std::placeholders::_1, framerate));
+    if (StreamFormatSP[STREAM_MJPEG].getState() == ISS_ON)
+        m_Worker.start(std::bind(&INDILibCamera::workerStreamVideo, this, std::placeholders::_1, framerate));
+    else
+        m_Worker.start(std::bind(&INDILibCamera::workerStreamRaw, this, std::placeholders::_1, framerate));
     return true;
 }
 
@@ -959,6 +1522,8 @@ bool INDILibCamera::saveConfigItems(FILE * fp)
     AdjustAwbModeSP.save(fp);
     AdjustMeteringModeSP.save(fp);
     AdjustDenoiseModeSP.save(fp);
+    SessionModeSP.save(fp);
+    StreamFormatSP.save(fp);
 
     return true;
 }
@@ -1151,6 +1716,74 @@ bool INDILibCamera::processRAWMemory(unsigned char *inBuffer, unsigned long inSi
     return true;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+/// Unpack a raw Bayer stream buffer (8 bit, 10/12 bit CSI-2 packed or 16 bit
+/// containers) into 16 bit pixels.
+/////////////////////////////////////////////////////////////////////////////
+bool INDILibCamera::processRAWStream(const libcamera::Span<uint8_t> &mem, const StreamInfo &info, uint8_t **memptr,
+                                     size_t *memsize, char *bayer_pattern)
+{
+    RawStreamFormat raw;
+    if (!parseRawFormat(info.pixel_format, raw))
+        return false;
+
+    if (static_cast<size_t>(info.stride) * info.height > mem.size())
+    {
+        LOGF_ERROR("Raw buffer too small: %zu bytes for %ux%u stride %u", mem.size(), info.width, info.height, info.stride);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(info.width) * info.height * sizeof(uint16_t);
+    uint8_t *buffer = static_cast<uint8_t *>(IDSharedBlobRealloc(*memptr, size));
+    if (buffer == nullptr)
+        buffer = static_cast<uint8_t *>(IDSharedBlobAlloc(size));
+    if (buffer == nullptr)
+    {
+        LOGF_ERROR("%s: Failed to allocate %d bytes of memory!", __PRETTY_FUNCTION__, size);
+        return false;
+    }
+
+    *memptr = buffer;
+    *memsize = size;
+    strncpy(bayer_pattern, raw.bayer, 5);
+
+    unpackRawStream(mem.data(), info, raw, reinterpret_cast<uint16_t *>(buffer));
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+/// Convert a full range YUV420 still stream to planar 8 bit RGB, the same
+/// layout processJPEG produces.
+/////////////////////////////////////////////////////////////////////////////
+bool INDILibCamera::processYUV420Stream(const libcamera::Span<uint8_t> &mem, const StreamInfo &info, uint8_t **memptr,
+                                        size_t *memsize)
+{
+    if (info.pixel_format != libcamera::formats::YUV420)
+        return false;
+
+    if (yuv420Size(info) > mem.size())
+    {
+        LOGF_ERROR("YUV buffer too small: %zu bytes for %ux%u stride %u", mem.size(), info.width, info.height, info.stride);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(info.width) * info.height * 3;
+    uint8_t *buffer = static_cast<uint8_t *>(IDSharedBlobRealloc(*memptr, size));
+    if (buffer == nullptr)
+        buffer = static_cast<uint8_t *>(IDSharedBlobAlloc(size));
+    if (buffer == nullptr)
+    {
+        LOGF_ERROR("%s: Failed to allocate %d bytes of memory!", __PRETTY_FUNCTION__, size);
+        return false;
+    }
+
+    *memptr = buffer;
+    *memsize = size;
+
+    convertYUV420(mem.data(), info, buffer, true);
+    return true;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 ///
 /////////////////////////////////////////////////////////////////////////////
@@ -27,6 +27,9 @@
 #include "core/rpicam_encoder.hpp"
 #include "core/still_options.hpp"
 
+#include <chrono>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <indiccd.h>
@@ -88,7 +91,9 @@ protected:
 protected:
     INDI::SingleThreadPool m_Worker;
     void workerStreamVideo(const std::atomic_bool &isAboutToQuit, double framerate);
+    void workerStreamRaw(const std::atomic_bool &isAboutToQuit, double framerate);
     void workerExposure(const std::atomic_bool &isAboutToQuit, float duration);
+    void workerExposurePersistent(const std::atomic_bool &isAboutToQuit, float duration);
     void outputReady(void *mem, size_t size, int64_t timestamp_us, bool keyframe);
     void metadataReady(libcamera::ControlList &metadata);
     bool SetCaptureFormat(uint8_t index) override;
@@ -97,6 +102,10 @@ protected:
     void configureStillOptions(StillOptions *options, double duration);
     void configureVideoOptions(VideoOptions *options, double framerate);
 
+    /** Open and configure the still session if needed, then start capturing. */
+    bool openSession(bool raw, double duration);
+    void closeSession();
+
 
 protected:
     /** Get initial parameters from camera */
@@ -112,12 +121,28 @@ protected:
 
     bool processRAWMemory(unsigned char *inBuffer, unsigned long inSize, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel, char *bayer_pattern);
 
+    bool processRAWStream(const libcamera::Span<uint8_t> &mem, const StreamInfo &info, uint8_t **memptr, size_t *memsize, char *bayer_pattern);
+
+    bool processYUV420Stream(const libcamera::Span<uint8_t> &mem, const StreamInfo &info, uint8_t **memptr, size_t *memsize);
+
+    /** Decode a completed request through a temporary DNG/JPEG file and complete the exposure. */
+    bool processFile(RPiCamINDIApp &app, CompletedRequestPtr &payload, bool raw);
+
+    /** Decode a completed request straight from its buffer. Returns false if the format needs processFile. */
+    bool processMemory(RPiCamINDIApp &app, CompletedRequestPtr &payload, bool raw);
+
+    void setupFrameBuffer(uint8_t *memptr, size_t memsize, int naxis, int w, int h, int bpp);
+
     bool processJPEG(const char *filename, uint8_t **memptr, size_t *memsize, int *naxis, int *w, int *h);
 
     int processJPEGMemory(unsigned char *inBuffer, unsigned long inSize, uint8_t **memptr, size_t *memsize, int *naxis, int *w, int *h);
 
     void shutdownVideo();
 
+    void resetStreamStats();
+    void recordStreamFrame(uint32_t sequence, uint64_t timestamp);
+    void updateStreamStats();
+
 private:
 
     enum
@@ -131,6 +156,88 @@ private:
     INDI::PropertyNumber AdjustmentNP {AdjustAwbBlue+1};
     INDI::PropertyNumber GainNP {1};
 
+    // Keep the camera configured between exposures or open it for each one
+    INDI::PropertySwitch SessionModeSP {2};
+    enum
+    {
+        SESSION_PERSISTENT,
+        SESSION_PER_EXPOSURE
+    };
+
+    INDI::PropertyNumber SessionMetricsNP {3};
+    enum
+    {
+        METRIC_FIRST_FRAME,
+        METRIC_DEAD_TIME,
+        METRIC_RECONFIGURES
+    };
+
+    // Settings the persistent session was configured with. The controls are part of
+    // it too, so a session is only reused when every option it was started with is
+    // still current.
+    struct SessionConfig
+    {
+        bool raw {false};
+        uint32_t width {0};
+        uint32_t height {0};
+        int bpp {0};
+        double duration {0};
+        std::vector<double> adjustments;
+        double gain {0};
+        int exposureIndex {0};
+        int awbIndex {0};
+        int meteringIndex {0};
+        std::string denoise;
+
+        bool operator==(const SessionConfig &other) const
+        {
+            return raw == other.raw && width == other.width && height == other.height && bpp == other.bpp &&
+                   duration == other.duration && adjustments == other.adjustments && gain == other.gain &&
+                   exposureIndex == other.exposureIndex && awbIndex == other.awbIndex &&
+                   meteringIndex == other.meteringIndex && denoise == other.denoise;
+        }
+    };
+
+    std::unique_ptr<RPiCamINDIApp> m_StillSession;
+    SessionConfig m_SessionConfig;
+    std::chrono::steady_clock::time_point m_LastFrameTime;
+
+    // Unencoded streaming
+    INDI::PropertySwitch StreamFormatSP {3};
+    enum
+    {
+        STREAM_MJPEG,
+        STREAM_RAW,
+        STREAM_RGB
+    };
+
+    INDI::PropertyNumber StreamStatsNP {6};
+    enum
+    {
+        STATS_FRAMES,
+        STATS_DROPPED,
+        STATS_SEQUENCE,
+        STATS_INTERVAL,
+        STATS_JITTER,
+        STATS_JITTER_PEAK
+    };
+
+    struct StreamStats
+    {
+        uint64_t frames {0};
+        uint64_t dropped {0};
+        uint32_t sequence {0};
+        uint64_t timestamp {0};
+        // Frame intervals in ms since the last update
+        uint32_t intervals {0};
+        double intervalSum {0};
+        double intervalSquares {0};
+        double minInterval {0};
+        double maxInterval {0};
+    } m_StreamStats;
+
+    std::vector<uint8_t> m_StreamBuffer;
+
     // std::unique_ptr<RPiCamApp> m_CameraApp;
     // std::unique_ptr<RPiCamEncoder> m_CameraEncoder;
 
@@ -26,7 +26,10 @@
 #include "config.h"
 
 #include <math.h>
+#include <algorithm>
+#include <ctime>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -34,6 +37,7 @@
 #define TEMP_COOLER_OFF 100  /* High enough temperature for the camera cooler to turn off (°C) */
 #define MAX_DEVICES     4    /* Max device cameraCount */
 #define MAX_ERROR_LEN   64   /* Max length of error buffer */
+#define OVERLAP_WINDOW  5    /* Max time (s) an overlapped exposure may wait past its end to be taken over */
 
 // There is _one_ binary for USB and ETH driver, but each binary is renamed
 // to its variant (indi_mi_ccd_usb and indi_mi_ccd_eth). The main function will
@@ -135,6 +139,11 @@ MICCD::MICCD(int camId, bool eth) : FilterInterface(this)
 
     canDoPreflash = false;
 
+    exposureSettings = {};
+    overlap          = {};
+    exposureLead     = 0;
+    loopStallMax     = 0;
+
     setDeviceName(name);
     setVersion(INDI_MI_VERSION_MAJOR, INDI_MI_VERSION_MINOR);
 }
@@ -205,6 +214,20 @@ bool MICCD::initProperties()
     IUFillNumberVector(&PreflashNP, PreflashN, 2, getDeviceName(), "NIR_PRE_FLASH", "NIR Preflash",
                        MAIN_CONTROL_TAB, IP_RW, 60, IPS_IDLE);
 
+    // Start the next exposure of a sequence while the last frame is downloaded
+    IUFillSwitch(&OverlapS[0], "OVERLAP_ON", "On", ISS_OFF);
+    IUFillSwitch(&OverlapS[1], "OVERLAP_OFF", "Off", ISS_ON);
+    IUFillSwitchVector(&OverlapSP, OverlapS, 2, getDeviceName(), "CCD_OVERLAP_EXPOSURE", "Overlap Exposures",
+                       OPTIONS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
+    // Download and event loop timing of the last frame
+    IUFillNumber(&AcquisitionStatsN[STATS_DOWNLOAD_TIME], "DOWNLOAD_TIME", "Download (s)", "%.3f", 0, 1000, 0, 0);
+    IUFillNumber(&AcquisitionStatsN[STATS_DOWNLOAD_RATE], "DOWNLOAD_RATE", "Throughput (MB/s)", "%.2f", 0, 1000, 0, 0);
+    IUFillNumber(&AcquisitionStatsN[STATS_LOOP_STALL], "LOOP_STALL", "Max loop stall (ms)", "%.1f", 0, 100000, 0, 0);
+    IUFillNumber(&AcquisitionStatsN[STATS_OVERLAP_LEAD], "OVERLAP_LEAD", "Overlap lead (s)", "%.3f", 0, 100000, 0, 0);
+    IUFillNumberVector(&AcquisitionStatsNP, AcquisitionStatsN, 4, getDeviceName(), "CCD_ACQUISITION_STATS",
+                       "Acquisition", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
     addAuxControls();
 
     setDriverInterface(getDriverInterface() | FILTER_INTERFACE);
@@ -239,6 +262,9 @@ void MICCD::ISGetProperties(const char *dev)
         if (canDoPreflash)
             defineProperty(&PreflashNP);
 
+        defineProperty(&OverlapSP);
+        defineProperty(&AcquisitionStatsNP);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -274,6 +300,9 @@ bool MICCD::updateProperties()
         if (canDoPreflash)
             defineProperty(&PreflashNP);
 
+        defineProperty(&OverlapSP);
+        defineProperty(&AcquisitionStatsNP);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -282,7 +311,8 @@ bool MICCD::updateProperties()
         // Let's get parameters now from CCD
         setupParams();
 
-        timerID = SetTimer(getCurrentPollingPeriod());
+        lastTimerHit = std::chrono::steady_clock::now();
+        timerID      = SetTimer(getCurrentPollingPeriod());
     }
     else
     {
@@ -308,6 +338,9 @@ bool MICCD::updateProperties()
         if (canDoPreflash)
             deleteProperty(PreflashNP.name);
 
+        deleteProperty(OverlapSP.name);
+        deleteProperty(AcquisitionStatsNP.name);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -396,6 +429,10 @@ bool MICCD::Connect()
 
 bool MICCD::Disconnect()
 {
+    exposureScheduler.cancel();
+    worker.quit();
+    discardOverlap();
+
     LOGF_INFO("Disconnected from %s.", name);
     gxccd_release(cameraHandle);
     cameraHandle = nullptr;
@@ -481,39 +518,90 @@ int MICCD::SetTemperature(double temperature)
     return 0;
 }
 
+bool MICCD::ExposureSettings::operator==(const ExposureSettings &other) const
+{
+    return duration == other.duration && useShutter == other.useShutter && readMode == other.readMode &&
+           binX == other.binX && binY == other.binY && x == other.x && y == other.y && w == other.w && d == other.d;
+}
+
 bool MICCD::StartExposure(float duration)
 {
     imageFrameType = PrimaryCCD.getFrameType();
     useShutter = (imageFrameType == INDI::CCDChip::LIGHT_FRAME || imageFrameType == INDI::CCDChip::FLAT_FRAME);
 
-    if (!isSimulation())
+    ExposureSettings settings;
+    settings.duration   = duration;
+    settings.useShutter = useShutter;
+    settings.readMode   = IUFindOnSwitchIndex(&ReadModeSP);
+    settings.binX       = PrimaryCCD.getBinX();
+    settings.binY       = PrimaryCCD.getBinY();
+    // send binned coords
+    settings.x = PrimaryCCD.getSubX() / PrimaryCCD.getBinX();
+    settings.y = PrimaryCCD.getSubY() / PrimaryCCD.getBinY();
+    settings.w = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    settings.d = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+
+    // Take over the exposure started by the last download if it is the one requested
+    // and has not been sitting finished on the chip for too long
+    double lead   = 0;
+    bool takeOver = false;
+    std::chrono::system_clock::time_point leadStart;
     {
-        int mode = IUFindOnSwitchIndex(&ReadModeSP);
-        gxccd_set_read_mode(cameraHandle, mode);
-
-        // send binned coords
-        int x = PrimaryCCD.getSubX() / PrimaryCCD.getBinX();
-        int y = PrimaryCCD.getSubY() / PrimaryCCD.getBinY();
-        int w = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
-        int d = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
-        // invert frame, libgxccd has 0 on the bottom
-        int fd = PrimaryCCD.getYRes() / PrimaryCCD.getBinY();
-        int fy = fd - y - d;
-        gxccd_start_exposure(cameraHandle, duration, useShutter, x, fy, w, d);
+        std::lock_guard<std::mutex> lock(overlapLock);
+        if (overlap.active)
+        {
+            lead     = std::chrono::duration<double>(std::chrono::steady_clock::now() - overlap.start).count();
+            takeOver = overlap.settings == settings && lead <= duration + OVERLAP_WINDOW;
+            leadStart = overlap.startUTC;
+            if (takeOver)
+                overlap.active = false;
+        }
     }
 
-    ExposureRequest = duration;
+    if (takeOver)
+    {
+        LOGF_DEBUG("Taking over the exposure started %.3f seconds ago...", lead);
+    }
+    else
+    {
+        lead = 0;
+        discardOverlap();
+
+        if (!isSimulation())
+        {
+            gxccd_set_read_mode(cameraHandle, settings.readMode);
+
+            // invert frame, libgxccd has 0 on the bottom
+            int fd = PrimaryCCD.getYRes() / PrimaryCCD.getBinY();
+            int fy = fd - settings.y - settings.d;
+            if (gxccd_start_exposure(cameraHandle, duration, useShutter, settings.x, fy, settings.w, settings.d) < 0)
+            {
+                char errorStr[MAX_ERROR_LEN];
+                gxccd_get_last_error(cameraHandle, errorStr, sizeof(errorStr));
+                LOGF_ERROR("Starting exposure failed: %s.", errorStr);
+                return false;
+            }
+        }
+    }
+
+    ExposureRequest  = duration;
+    exposureSettings = settings;
+    exposureLead     = lead;
+    exposureStart    = leadStart;
     PrimaryCCD.setExposureDuration(duration);
 
-    gettimeofday(&ExpStart, nullptr);
-    InExposure  = true;
-    downloading = false;
+    InExposure = true;
     LOGF_DEBUG("Taking a %.3f seconds frame...", ExposureRequest);
+
+    worker.start(std::bind(&MICCD::workerExposure, this, std::placeholders::_1, std::max(0.0, duration - lead)));
     return true;
 }
 
 bool MICCD::AbortExposure()
 {
+    exposureScheduler.cancel();
+    worker.quit();
+
     if (InExposure && !isSimulation())
     {
         if (gxccd_abort_exposure(cameraHandle, false) < 0)
@@ -524,13 +612,34 @@ bool MICCD::AbortExposure()
             return false;
         }
     }
+    discardOverlap();
 
-    InExposure  = false;
-    downloading = false;
+    InExposure = false;
     LOG_INFO("Exposure aborted.");
     return true;
 }
 
+/* Aborts the exposure started by the last download, if any. Returns true if there was one. */
+bool MICCD::discardOverlap()
+{
+    std::lock_guard<std::mutex> lock(overlapLock);
+    if (!overlap.active)
+        return false;
+
+    overlap.active = false;
+    if (!isSimulation() && gxccd_abort_exposure(cameraHandle, false) < 0)
+    {
+        char errorStr[MAX_ERROR_LEN];
+        gxccd_get_last_error(cameraHandle, errorStr, sizeof(errorStr));
+        LOGF_WARN("Aborting overlapped exposure failed: %s.", errorStr);
+    }
+    else
+    {
+        LOG_DEBUG("Overlapped exposure discarded.");
+    }
+    return true;
+}
+
 bool MICCD::UpdateCCDFrame(int x, int y, int w, int h)
 {
     /* Add the X and Y offsets */
@@ -570,6 +679,8 @@ bool MICCD::UpdateCCDBin(int hor, int ver)
                    hor, ver, maxBinX, maxBinY);
         return false;
     }
+    // An overlapped exposure must not see the binning change under it
+    discardOverlap();
     if (gxccd_set_binning(cameraHandle, hor, ver) < 0)
     {
         char errorStr[MAX_ERROR_LEN];
@@ -581,16 +692,6 @@ bool MICCD::UpdateCCDBin(int hor, int ver)
     return UpdateCCDFrame(PrimaryCCD.getSubX(), PrimaryCCD.getSubY(), PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
 }
 
-float MICCD::calcTimeLeft()
-{
-    double timesince;
-    struct timeval now;
-    gettimeofday(&now, nullptr);
-
-    timesince = (now.tv_sec * 1000.0 + now.tv_usec / 1000.0) - (ExpStart.tv_sec * 1000.0 + ExpStart.tv_usec / 1000.0);
-    return ExposureRequest - timesince / 1000.0;
-}
-
 static void mirror_image(void *buf, size_t w, size_t d)
 {
     size_t w2     = w * 2;
@@ -611,15 +712,69 @@ static void mirror_image(void *buf, size_t w, size_t d)
     }
 }
 
-/* Downloads the image from the CCD. */
+void MICCD::workerExposure(const std::atomic_bool &isAboutToQuit, float duration)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    auto readStatus = [&]()
+    {
+        bool ready = false;
+        if (isSimulation())
+        {
+            ready = std::chrono::steady_clock::now() - start >= std::chrono::duration<double>(duration);
+        }
+        else if (gxccd_image_ready(cameraHandle, &ready) < 0)
+        {
+            char errorStr[MAX_ERROR_LEN];
+            gxccd_get_last_error(cameraHandle, errorStr, sizeof(errorStr));
+            LOGF_DEBUG("Getting image ready failed: %s.", errorStr);
+            return ExposureScheduler::STATUS_ERROR;
+        }
+        return ready ? ExposureScheduler::STATUS_DONE : ExposureScheduler::STATUS_WORKING;
+    };
+
+    ExposureScheduler::Outcome outcome = exposureScheduler.wait(duration, readStatus, [this](double timeLeft)
+    {
+        PrimaryCCD.setExposureLeft(timeLeft);
+    }, isAboutToQuit);
+
+    if (outcome == ExposureScheduler::OUTCOME_ABORTED || isAboutToQuit)
+        return;
+
+    if (outcome != ExposureScheduler::OUTCOME_DONE)
+    {
+        LOG_ERROR("Getting image ready failed.");
+        InExposure = false;
+        PrimaryCCD.setExposureFailed();
+        return;
+    }
+
+    PrimaryCCD.setExposureLeft(0);
+    InExposure = false;
+
+    // Don't spam the session log unless it is a long exposure > 5 seconds
+    if (ExposureRequest > 5)
+        LOG_INFO("Exposure done, downloading image...");
+
+    // grab and save image
+    grabImage();
+}
+
+/* Downloads the image from the CCD. With overlapped exposures the camera starts the next
+ * exposure with the same settings before the image is read out. */
 int MICCD::grabImage()
 {
     std::unique_lock<std::mutex> guard(ccdBufferLock);
     int ret              = 0;
     unsigned char *image = (unsigned char *)PrimaryCCD.getFrameBuffer();
+    size_t size          = PrimaryCCD.getFrameBufferSize();
     int width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
     int height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    bool overlapped = IUFindOnSwitchIndex(&OverlapSP) == 0;
 
+    // gxccd_read_image_exposure starts the next exposure before it reads this one out
+    auto start    = std::chrono::steady_clock::now();
+    auto startUTC = std::chrono::system_clock::now();
     if (isSimulation())
     {
         uint16_t *buffer = (uint16_t *)image;
@@ -630,65 +785,72 @@ int MICCD::grabImage()
     }
     else
     {
-        ret = gxccd_read_image(cameraHandle, image, PrimaryCCD.getFrameBufferSize());
+        if (overlapped)
+            ret = gxccd_read_image_exposure(cameraHandle, image, size);
+        else
+            ret = gxccd_read_image(cameraHandle, image, size);
         if (ret < 0)
         {
             char errorStr[MAX_ERROR_LEN];
             gxccd_get_last_error(cameraHandle, errorStr, sizeof(errorStr));
             LOGF_ERROR("Error getting image: %s.", errorStr);
         }
-        else
-        {
-            mirror_image(image, width, height);
-        }
     }
+    auto end = std::chrono::steady_clock::now();
+
+    if (overlapped && !ret)
+    {
+        std::lock_guard<std::mutex> lock(overlapLock);
+        overlap.active   = true;
+        overlap.settings = exposureSettings;
+        overlap.start    = start;
+        overlap.startUTC = startUTC;
+    }
+
+    if (!isSimulation() && !ret)
+        mirror_image(image, width, height);
 
     guard.unlock();
 
     if (ExposureRequest > 5 && !ret)
         LOG_INFO("Download complete.");
 
-    downloading = false;
+    updateAcquisitionStats(std::chrono::duration<double>(end - start).count(), size, exposureLead);
     ExposureComplete(&PrimaryCCD);
 
     return ret;
 }
 
+void MICCD::updateAcquisitionStats(double downloadTime, size_t bytes, double lead)
+{
+    AcquisitionStatsN[STATS_DOWNLOAD_TIME].value = downloadTime;
+    AcquisitionStatsN[STATS_DOWNLOAD_RATE].value = downloadTime > 0 ? bytes / downloadTime / (1024.0 * 1024.0) : 0;
+    AcquisitionStatsN[STATS_OVERLAP_LEAD].value  = lead;
+    {
+        std::lock_guard<std::mutex> lock(statsLock);
+        AcquisitionStatsN[STATS_LOOP_STALL].value = loopStallMax;
+        loopStallMax = 0;
+    }
+    AcquisitionStatsNP.s = IPS_OK;
+    IDSetNumber(&AcquisitionStatsNP, nullptr);
+
+    LOGF_DEBUG("Downloaded %zu bytes in %.3f s (%.2f MB/s), event loop stalled up to %.1f ms.", bytes, downloadTime,
+               AcquisitionStatsN[STATS_DOWNLOAD_RATE].value, AcquisitionStatsN[STATS_LOOP_STALL].value);
+}
+
 void MICCD::TimerHit()
 {
     if (!isConnected())
         return; // No need to reset timer if we are not connected anymore
 
-    if (InExposure)
+    // Exposures are handled by the worker, the timer only measures how late the event loop
+    // runs it, i.e. for how long the loop was blocked
+    auto now      = std::chrono::steady_clock::now();
+    double stall  = std::chrono::duration<double, std::milli>(now - lastTimerHit).count() - getCurrentPollingPeriod();
+    lastTimerHit  = now;
     {
-        float timeleft = calcTimeLeft();
-        bool ready     = false;
-
-        if (!downloading && (gxccd_image_ready(cameraHandle, &ready) < 0))
-        {
-            char errorStr[MAX_ERROR_LEN];
-            gxccd_get_last_error(cameraHandle, errorStr, sizeof(errorStr));
-            LOGF_ERROR("Getting image ready failed: %s.", errorStr);
-        }
-        if (ready)
-        {
-            PrimaryCCD.setExposureLeft(0);
-            InExposure  = false;
-            downloading = true;
-
-            // Don't spam the session log unless it is a long exposure > 5 seconds
-            if (ExposureRequest > 5)
-                LOG_INFO("Exposure done, downloading image...");
-
-            // grab and save image
-            grabImage();
-        }
-        // camera may need some time for image download -> update client only for positive values
-        else if (timeleft >= 0)
-        {
-            LOGF_DEBUG("Exposure in progress: Time left %.2fs", timeleft);
-            PrimaryCCD.setExposureLeft(timeleft);
-        }
+        std::lock_guard<std::mutex> lock(statsLock);
+        loopStallMax = std::max(loopStallMax, stall);
     }
 
     SetTimer(getCurrentPollingPeriod());
@@ -701,6 +863,9 @@ int MICCD::QueryFilter()
 
 bool MICCD::SelectFilter(int position)
 {
+    // An overlapped exposure must not see the wheel move under it
+    discardOverlap();
+
     if (!isSimulation() && gxccd_set_filter(cameraHandle, position - 1) < 0)
     {
         char errorStr[MAX_ERROR_LEN];
@@ -797,6 +962,19 @@ bool MICCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char
             IDSetSwitch(&CoolerSP, nullptr);
             return true;
         }
+        else if (!strcmp(name, OverlapSP.name))
+        {
+            IUUpdateSwitch(&OverlapSP, states, names, n);
+            OverlapSP.s = IPS_OK;
+
+            if (IUFindOnSwitchIndex(&OverlapSP) != 0)
+                discardOverlap();
+            else
+                LOG_INFO("The next exposure of a sequence is started before the last frame is downloaded.");
+
+            IDSetSwitch(&OverlapSP, nullptr);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewSwitch(dev, name, states, names, n);
@@ -865,6 +1043,7 @@ bool MICCD::ISNewNumber(const char *dev, const char *name, double values[], char
         if (!strcmp(name, PreflashNP.name))
         {
             IUUpdateNumber(&PreflashNP, values, names, n);
+            discardOverlap();
 
             // set NIR pre-flash if available.
             if (canDoPreflash)
@@ -889,6 +1068,7 @@ bool MICCD::ISNewNumber(const char *dev, const char *name, double values[], char
         if (!strcmp(name, GainNP.name))
         {
             IUUpdateNumber(&GainNP, values, names, n);
+            discardOverlap();
 
             if (!isSimulation() && gxccd_set_gain(cameraHandle, static_cast<uint16_t>(GainN[0].value)) < 0)
             {
@@ -982,6 +1162,7 @@ bool MICCD::saveConfigItems(FILE *fp)
     INDI::CCD::saveConfigItems(fp);
 
     IUSaveConfigSwitch(fp, &ReadModeSP);
+    IUSaveConfigSwitch(fp, &OverlapSP);
 
     if (numFilters > 0)
     {
@@ -1044,4 +1225,23 @@ void MICCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRec
         fitsKeywords.push_back({"PREFLASH", PreflashN[0].value, 3, "seconds"});
         fitsKeywords.push_back({"NUM-CLR", PreflashN[1].value, 3, nullptr});
     }
+
+    // Overlapped exposure, DATE-OBS is when the camera started it rather than when it was requested
+    if (exposureLead > 0)
+    {
+        std::time_t seconds = std::chrono::system_clock::to_time_t(exposureStart);
+        int ms = std::chrono::duration_cast<std::chrono::milliseconds>(exposureStart.time_since_epoch()).count() % 1000;
+        char date[64], dateObs[80];
+        struct tm utc;
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", gmtime_r(&seconds, &utc));
+        snprintf(dateObs, sizeof(dateObs), "%s.%03d", date, ms);
+
+        for (auto &record : fitsKeywords)
+        {
+            if (record.key() == "DATE-OBS")
+                record = INDI::FITSRecord("DATE-OBS", dateObs, "UTC start date of observation");
+        }
+
+        fitsKeywords.push_back({"EXPLEAD", exposureLead, 3, "seconds"});
+    }
 }
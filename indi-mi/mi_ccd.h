@@ -21,10 +21,17 @@
 
 #pragma once
 
+#include "exposure_scheduler.h"
+
 #include <gxccd.h>
 
 #include <indiccd.h>
 #include <indifilterinterface.h>
+#include <indisinglethreadpool.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
 
 class MICCD : public INDI::CCD, public INDI::FilterInterface
 {
@@ -89,6 +96,19 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
         INumber PreflashN[2];
         INumberVectorProperty PreflashNP;
 
+        ISwitch OverlapS[2];
+        ISwitchVectorProperty OverlapSP;
+
+        INumber AcquisitionStatsN[4];
+        INumberVectorProperty AcquisitionStatsNP;
+        enum
+        {
+            STATS_DOWNLOAD_TIME,
+            STATS_DOWNLOAD_RATE,
+            STATS_LOOP_STALL,
+            STATS_OVERLAP_LEAD,
+        };
+
     private:
         char name[MAXINDIDEVICE];
 
@@ -111,20 +131,53 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
         int temperatureID;
         int timerID;
 
-        bool downloading;
-
         bool canDoPreflash;
 
         INDI::CCDChip::CCD_FRAME imageFrameType;
 
         float TemperatureRequest;
         float ExposureRequest;
-        struct timeval ExpStart;
+
+        // Everything gxccd_start_exposure is given. An exposure started early by
+        // gxccd_read_image_exposure is only taken over by a request with the same settings.
+        struct ExposureSettings
+        {
+            float duration;
+            bool useShutter;
+            int readMode, binX, binY;
+            int x, y, w, d;
+
+            bool operator==(const ExposureSettings &other) const;
+        };
+        ExposureSettings exposureSettings;
+        double exposureLead;    // s the current exposure was started before it was requested
+        std::chrono::system_clock::time_point exposureStart;    // UTC start of a taken over exposure
+
+        struct Overlap
+        {
+            bool active;
+            ExposureSettings settings;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::system_clock::time_point startUTC;
+        };
+        Overlap overlap;
+        std::mutex overlapLock;
+
+        // Waits for the exposure and downloads it, off the INDI event loop
+        INDI::SingleThreadPool worker;
+        ExposureScheduler exposureScheduler;
+
+        // Longest delay of TimerHit since the last frame, i.e. how long the event loop was blocked
+        std::mutex statsLock;
+        double loopStallMax;
+        std::chrono::steady_clock::time_point lastTimerHit;
 
         bool setupParams();
 
-        float calcTimeLeft();
+        void workerExposure(const std::atomic_bool &isAboutToQuit, float duration);
         int grabImage();
+        bool discardOverlap();
+        void updateAcquisitionStats(double downloadTime, size_t bytes, double lead);
 
         void updateTemperature();
         static void updateTemperatureHelper(void *);
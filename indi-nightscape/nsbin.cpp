@@ -0,0 +1,483 @@
+/*
+    Nightscape 8300 CCD Driver binning and byte swap kernels
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "nsbin.h"
+
+#include <atomic>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NSBIN_X86
+#include <immintrin.h>
+#endif
+
+// The vector kernels load the little endian samples directly
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define NSBIN_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define NSBIN_BIG_ENDIAN_HOST true
+#else
+#define NSBIN_BIG_ENDIAN_HOST false
+#endif
+
+namespace NsBin
+{
+
+namespace
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Scalar kernels, any binning and byte order.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+inline uint16_t byteSwap(uint16_t value)
+{
+    return static_cast<uint16_t>((value >> 8) | (value << 8));
+}
+
+inline uint32_t loadSample(const uint8_t *row, size_t i)
+{
+    uint16_t value;
+    memcpy(&value, row + 2 * i, 2);
+    return NSBIN_BIG_ENDIAN_HOST ? byteSwap(value) : value;
+}
+
+template <bool swap>
+void binRowScalar(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t first, size_t width, int xbin,
+                  int ybin)
+{
+    // Byte order change only, simple enough for the compiler to vectorize
+    if (xbin == 1 && ybin == 1)
+    {
+        for (size_t x = first; x < width; x++)
+        {
+            uint16_t value = loadSample(src, x);
+            if (swap)
+                value = byteSwap(value);
+            memcpy(dst + 2 * x, &value, 2);
+        }
+        return;
+    }
+
+    const uint32_t samples = xbin * ybin;
+    for (size_t x = first; x < width; x++)
+    {
+        uint32_t sum = 0;
+        for (int r = 0; r < ybin; r++)
+            for (int b = 0; b < xbin; b++)
+                sum += loadSample(src + r * srcStride, x * xbin + b);
+        uint16_t value = static_cast<uint16_t>(sum / samples);
+        if (swap)
+            value = byteSwap(value);
+        memcpy(dst + 2 * x, &value, 2);
+    }
+}
+
+// swap when the requested order is not the host order
+void binRowScalar(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t first, size_t width, int xbin,
+                  int ybin, bool swap)
+{
+    if (swap)
+        binRowScalar<true>(src, srcStride, dst, first, width, xbin, ybin);
+    else
+        binRowScalar<false>(src, srcStride, dst, first, width, xbin, ybin);
+}
+
+#ifdef NSBIN_X86
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// SSSE3/AVX2 kernels. Eight output pixels come from xbin consecutive 16 byte blocks per source
+/// row, a pshufb per block and phase gathers sample x * xbin + phase of every pixel into one
+/// register. The sums are widened to 32 bit, divided through float and packed back.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+struct PhaseTable
+{
+    alignas(16) uint8_t mask[NSBIN_MAX_BINNING][NSBIN_MAX_BINNING][16];
+};
+
+PhaseTable buildTable(int xbin)
+{
+    PhaseTable table;
+    memset(&table, 0x80, sizeof(table));
+
+    for (int phase = 0; phase < xbin; phase++)
+        for (int pixel = 0; pixel < 8; pixel++)
+        {
+            const int sample = pixel * xbin + phase;
+            uint8_t *mask = table.mask[phase][sample / 8];
+            mask[2 * pixel] = 2 * (sample % 8);
+            mask[2 * pixel + 1] = 2 * (sample % 8) + 1;
+        }
+    return table;
+}
+
+const PhaseTable &phaseTable(int xbin)
+{
+    static const PhaseTable tables[NSBIN_MAX_BINNING] = { buildTable(1), buildTable(2), buildTable(3), buildTable(4) };
+    return tables[xbin - 1];
+}
+
+// floor(sum / samples) of 8 sums. The sums stay below 2^24 so they convert exactly, and the
+// 0.5 offset keeps the quotient clear of the integer boundaries the rounding error could cross.
+__attribute__((target("ssse3")))
+inline __m128i meanSSSE3(__m128i lo, __m128i hi, __m128 scale)
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16(-32768);
+
+    lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_cvtepi32_ps(lo), half), scale));
+    hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_cvtepi32_ps(hi), half), scale));
+    // Unsigned saturation needs SSE4.1, pack as signed around 32768 instead
+    return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32)), bias16);
+}
+
+template <int xbin>
+__attribute__((target("ssse3")))
+size_t binRowSSSE3(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t width, int ybin, bool swap)
+{
+    const PhaseTable &table = phaseTable(xbin);
+    __m128i mask[xbin][xbin];
+    for (int k = 0; k < xbin; k++)
+        for (int i = 0; i < xbin; i++)
+            mask[k][i] = _mm_load_si128(reinterpret_cast<const __m128i *>(table.mask[k][i]));
+
+    const __m128 scale = _mm_set1_ps(1.0f / (xbin * ybin));
+    const __m128i swapMask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m128i zero = _mm_setzero_si128();
+    const size_t groups = width / 8;
+
+    for (size_t g = 0; g < groups; g++)
+    {
+        __m128i lo = zero, hi = zero;
+        for (int r = 0; r < ybin; r++)
+        {
+            const uint8_t *p = src + r * srcStride + g * xbin * 16;
+            __m128i in[xbin];
+            for (int i = 0; i < xbin; i++)
+                in[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i * 16));
+
+            for (int k = 0; k < xbin; k++)
+            {
+                __m128i v = in[0];
+                if (xbin > 1)
+                {
+                    v = _mm_shuffle_epi8(in[0], mask[k][0]);
+                    for (int i = 1; i < xbin; i++)
+                        v = _mm_or_si128(v, _mm_shuffle_epi8(in[i], mask[k][i]));
+                }
+                lo = _mm_add_epi32(lo, _mm_unpacklo_epi16(v, zero));
+                hi = _mm_add_epi32(hi, _mm_unpackhi_epi16(v, zero));
+            }
+        }
+
+        __m128i out = meanSSSE3(lo, hi, scale);
+        if (swap)
+            out = _mm_shuffle_epi8(out, swapMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + g * 16), out);
+    }
+
+    return groups * 8;
+}
+
+// Same as binRowSSSE3, two groups of eight pixels at a time: one per 128 bit lane.
+template <int xbin>
+__attribute__((target("avx2")))
+size_t binRowAVX2(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t width, int ybin, bool swap)
+{
+    const PhaseTable &table = phaseTable(xbin);
+    __m256i mask[xbin][xbin];
+    for (int k = 0; k < xbin; k++)
+        for (int i = 0; i < xbin; i++)
+            mask[k][i] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(table.mask[k][i])));
+
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 scale = _mm256_set1_ps(1.0f / (xbin * ybin));
+    const __m256i bias32 = _mm256_set1_epi32(32768);
+    const __m256i bias16 = _mm256_set1_epi16(-32768);
+    const __m256i swapMask = _mm256_broadcastsi128_si256(
+                                 _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+    const __m256i zero = _mm256_setzero_si256();
+    const size_t groupBytes = xbin * 16;
+    const size_t groups = width / 8;
+
+    size_t g = 0;
+    for (; g + 2 <= groups; g += 2)
+    {
+        __m256i lo = zero, hi = zero;
+        for (int r = 0; r < ybin; r++)
+        {
+            const uint8_t *p = src + r * srcStride + g * groupBytes;
+            __m256i in[xbin];
+            for (int i = 0; i < xbin; i++)
+            {
+                __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i * 16));
+                __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + groupBytes + i * 16));
+                in[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(l), h, 1);
+            }
+
+            for (int k = 0; k < xbin; k++)
+            {
+                __m256i v = in[0];
+                if (xbin > 1)
+                {
+                    v = _mm256_shuffle_epi8(in[0], mask[k][0]);
+                    for (int i = 1; i < xbin; i++)
+                        v = _mm256_or_si256(v, _mm256_shuffle_epi8(in[i], mask[k][i]));
+                }
+                lo = _mm256_add_epi32(lo, _mm256_unpacklo_epi16(v, zero));
+                hi = _mm256_add_epi32(hi, _mm256_unpackhi_epi16(v, zero));
+            }
+        }
+
+        lo = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_add_ps(_mm256_cvtepi32_ps(lo), half), scale));
+        hi = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_add_ps(_mm256_cvtepi32_ps(hi), half), scale));
+        // unpack and pack both work per lane, so every lane holds its own group in order
+        __m256i out = _mm256_xor_si256(_mm256_packs_epi32(_mm256_sub_epi32(lo, bias32), _mm256_sub_epi32(hi, bias32)),
+                                       bias16);
+        if (swap)
+            out = _mm256_shuffle_epi8(out, swapMask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + g * 16), out);
+    }
+
+    if (g < groups)
+        g += binRowSSSE3<xbin>(src + g * groupBytes, srcStride, dst + g * 16, (groups - g) * 8, ybin, swap) / 8;
+
+    return g * 8;
+}
+
+// Returns the number of pixels binned, the caller finishes the row with scalar code.
+size_t binRowX86(Backend backend, const uint8_t *src, size_t srcStride, uint8_t *dst, size_t width, int xbin,
+                 int ybin, bool swap)
+{
+    if (backend == BACKEND_AVX2)
+    {
+        switch (xbin)
+        {
+            case 1: return binRowAVX2<1>(src, srcStride, dst, width, ybin, swap);
+            case 2: return binRowAVX2<2>(src, srcStride, dst, width, ybin, swap);
+            case 3: return binRowAVX2<3>(src, srcStride, dst, width, ybin, swap);
+            default: return binRowAVX2<4>(src, srcStride, dst, width, ybin, swap);
+        }
+    }
+
+    switch (xbin)
+    {
+        case 1: return binRowSSSE3<1>(src, srcStride, dst, width, ybin, swap);
+        case 2: return binRowSSSE3<2>(src, srcStride, dst, width, ybin, swap);
+        case 3: return binRowSSSE3<3>(src, srcStride, dst, width, ybin, swap);
+        default: return binRowSSSE3<4>(src, srcStride, dst, width, ybin, swap);
+    }
+}
+#endif
+
+#ifdef NSBIN_NEON
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// NEON kernels, the structured loads split the samples of eight pixels into one register per phase.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+inline void accumulateNEON(uint32x4_t &lo, uint32x4_t &hi, uint16x8_t v)
+{
+    lo = vaddw_u16(lo, vget_low_u16(v));
+    hi = vaddw_u16(hi, vget_high_u16(v));
+}
+
+inline void loadNEON(const uint16_t *p, int xbin, uint32x4_t &lo, uint32x4_t &hi)
+{
+    switch (xbin)
+    {
+        case 1:
+            accumulateNEON(lo, hi, vld1q_u16(p));
+            break;
+        case 2:
+        {
+            uint16x8x2_t v = vld2q_u16(p);
+            accumulateNEON(lo, hi, v.val[0]);
+            accumulateNEON(lo, hi, v.val[1]);
+            break;
+        }
+        case 3:
+        {
+            uint16x8x3_t v = vld3q_u16(p);
+            accumulateNEON(lo, hi, v.val[0]);
+            accumulateNEON(lo, hi, v.val[1]);
+            accumulateNEON(lo, hi, v.val[2]);
+            break;
+        }
+        default:
+        {
+            uint16x8x4_t v = vld4q_u16(p);
+            accumulateNEON(lo, hi, v.val[0]);
+            accumulateNEON(lo, hi, v.val[1]);
+            accumulateNEON(lo, hi, v.val[2]);
+            accumulateNEON(lo, hi, v.val[3]);
+            break;
+        }
+    }
+}
+
+inline uint16x4_t meanNEON(uint32x4_t sum, float32x4_t scale)
+{
+    return vqmovn_u32(vcvtq_u32_f32(vmulq_f32(vaddq_f32(vcvtq_f32_u32(sum), vdupq_n_f32(0.5f)), scale)));
+}
+
+size_t binRowNEON(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t width, int xbin, int ybin, bool swap)
+{
+    const float32x4_t scale = vdupq_n_f32(1.0f / (xbin * ybin));
+    const size_t groups = width / 8;
+
+    for (size_t g = 0; g < groups; g++)
+    {
+        uint32x4_t lo = vdupq_n_u32(0), hi = vdupq_n_u32(0);
+        for (int r = 0; r < ybin; r++)
+            loadNEON(reinterpret_cast<const uint16_t *>(src + r * srcStride + g * xbin * 16), xbin, lo, hi);
+
+        uint16x8_t out = vcombine_u16(meanNEON(lo, scale), meanNEON(hi, scale));
+        if (swap)
+            out = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(out)));
+        vst1q_u16(reinterpret_cast<uint16_t *>(dst + g * 16), out);
+    }
+
+    return groups * 8;
+}
+#endif
+
+Backend detectBackend()
+{
+    if (isSupported(BACKEND_NEON))
+        return BACKEND_NEON;
+    if (isSupported(BACKEND_AVX2))
+        return BACKEND_AVX2;
+    if (isSupported(BACKEND_SSSE3))
+        return BACKEND_SSSE3;
+    return BACKEND_SCALAR;
+}
+
+std::atomic<int> &currentBackend()
+{
+    static std::atomic<int> current {detectBackend()};
+    return current;
+}
+
+}
+
+bool isValidBinning(int xbin, int ybin)
+{
+    return xbin >= 1 && xbin <= NSBIN_MAX_BINNING && ybin >= 1 && ybin <= NSBIN_MAX_BINNING;
+}
+
+void binFrame(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t dstStride, size_t width, size_t height,
+              int xbin, int ybin, ByteOrder order)
+{
+    if (!isValidBinning(xbin, ybin))
+        return;
+
+    // Plain copy, the samples are already in host order
+    if (xbin == 1 && ybin == 1 && order == ORDER_NATIVE && !NSBIN_BIG_ENDIAN_HOST)
+    {
+        for (size_t y = 0; y < height; y++)
+            memcpy(dst + y * dstStride, src + y * srcStride, width * 2);
+        return;
+    }
+
+    // The vector backends only exist on little endian hosts, where big endian output means swapping
+    const Backend current = backend();
+    const bool swap = (order == ORDER_BIG_ENDIAN);
+
+    for (size_t y = 0; y < height; y++)
+    {
+        const uint8_t *row = src + y * ybin * srcStride;
+        uint8_t *out = dst + y * dstStride;
+        size_t done = 0;
+
+        switch (current)
+        {
+#ifdef NSBIN_X86
+            case BACKEND_SSSE3:
+            case BACKEND_AVX2:
+                done = binRowX86(current, row, srcStride, out, width, xbin, ybin, swap);
+                break;
+#endif
+#ifdef NSBIN_NEON
+            case BACKEND_NEON:
+                done = binRowNEON(row, srcStride, out, width, xbin, ybin, swap);
+                break;
+#endif
+            default:
+                break;
+        }
+
+        binRowScalar(row, srcStride, out, done, width, xbin, ybin, swap != NSBIN_BIG_ENDIAN_HOST);
+    }
+}
+
+Backend backend()
+{
+    return static_cast<Backend>(currentBackend().load(std::memory_order_relaxed));
+}
+
+bool setBackend(Backend backend)
+{
+    if (!isSupported(backend))
+        return false;
+
+    currentBackend().store(backend);
+    return true;
+}
+
+bool isSupported(Backend backend)
+{
+    switch (backend)
+    {
+        case BACKEND_SCALAR:
+            return true;
+#ifdef NSBIN_X86
+        case BACKEND_SSSE3:
+            return __builtin_cpu_supports("ssse3");
+        case BACKEND_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#ifdef NSBIN_NEON
+        case BACKEND_NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+const char *toString(Backend backend)
+{
+    switch (backend)
+    {
+        case BACKEND_SCALAR:
+            return "scalar";
+        case BACKEND_SSSE3:
+            return "ssse3";
+        case BACKEND_AVX2:
+            return "avx2";
+        case BACKEND_NEON:
+            return "neon";
+    }
+    return "unknown";
+}
+
+}
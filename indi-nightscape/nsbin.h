@@ -0,0 +1,85 @@
+/*
+    Nightscape 8300 CCD Driver binning and byte swap kernels
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Binning kernels for the Nightscape download buffer.
+ *
+ * The camera sends 16 bit little endian samples. Every output pixel is the mean, rounded down,
+ * of an xbin by ybin block of samples, written in host or big endian (FITS) byte order. Whole
+ * rows are processed by the best vector backend the CPU supports, the row tails and unsupported
+ * CPUs use plain scalar loops.
+ */
+namespace NsBin
+{
+
+enum Backend
+{
+    BACKEND_SCALAR,
+    BACKEND_SSSE3,
+    BACKEND_AVX2,
+    BACKEND_NEON
+};
+
+enum ByteOrder
+{
+    ORDER_NATIVE,     // host byte order, as expected in the INDI frame buffer
+    ORDER_BIG_ENDIAN  // as written to FITS files
+};
+
+#define NSBIN_MAX_BINNING 4
+
+/** @return true if the kernels support this binning, 1 to NSBIN_MAX_BINNING in each axis */
+bool isValidBinning(int xbin, int ybin);
+
+/**
+ * @brief Bin a block of camera samples.
+ * @param src first sample of the first source row
+ * @param srcStride bytes between source rows, ybin source rows are read per output row
+ * @param dst first pixel of the first output row
+ * @param dstStride bytes between output rows
+ * @param width output pixels per row, width * xbin samples are read from each source row
+ * @param height output rows
+ * @param xbin horizontal binning
+ * @param ybin vertical binning
+ * @param order byte order of the output
+ */
+void binFrame(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t dstStride, size_t width, size_t height,
+              int xbin, int ybin, ByteOrder order);
+
+/** @return backend currently used by binFrame */
+Backend backend();
+
+/**
+ * @brief Force a specific backend, mostly useful for benchmarks and debugging.
+ * @return false if the backend is not supported by this CPU/build.
+ */
+bool setBackend(Backend backend);
+
+/** @return true if the backend can run on this CPU/build */
+bool isSupported(Backend backend);
+
+const char *toString(Backend backend);
+
+}
@@ -0,0 +1,263 @@
+/*
+    Nightscape 8300 CCD Driver binning benchmark
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Benchmark of the NsBin kernels against the loops NsDownload used before, on raw download
+    payloads as written by nstest with image writing enabled (the .bin files). Without payload
+    files a full frame of synthetic sky is used. Every backend is checked against the scalar one.
+
+    Usage: nsbin_bench [iterations] [payload.bin ...]
+*/
+
+#include "nsbin.h"
+#include "kaf_constants.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#define ROW_BYTES (KAF8300_MAX_X * 2)
+
+struct Payload
+{
+    std::string name;
+    std::vector<uint8_t> data;
+};
+
+struct Mode
+{
+    const char *name;
+    int xbin, ybin;
+    NsBin::ByteOrder order;
+};
+
+// x binning is done here, y binning by the camera, so the legacy loops only cover ybin 1
+static const Mode modes[] =
+{
+    {"1x1", 1, 1, NsBin::ORDER_NATIVE},
+    {"2x1", 2, 1, NsBin::ORDER_NATIVE},
+    {"3x1", 3, 1, NsBin::ORDER_NATIVE},
+    {"4x1", 4, 1, NsBin::ORDER_NATIVE},
+    {"2x2", 2, 2, NsBin::ORDER_NATIVE},
+    {"3x3", 3, 3, NsBin::ORDER_NATIVE},
+    {"4x4", 4, 4, NsBin::ORDER_NATIVE},
+    {"1x1 fits", 1, 1, NsBin::ORDER_BIG_ENDIAN},
+};
+
+// NsDownload::copydownload before the kernels, forwards and without rms
+static void legacyCopy(const uint8_t *buffer, int nwrite, uint8_t *dbufp, int xlen, int binning)
+{
+    unsigned char linebuf[KAF8300_MAX_X * 2];
+    const uint8_t *bufp = buffer;
+    int nwriteleft = nwrite;
+
+    while (nwriteleft >= ROW_BYTES)
+    {
+        if (binning > 1)
+        {
+            const uint8_t *lbufp = bufp + (KAF8300_POSTAMBLE * 2);
+            int len = xlen * 2;
+            int linelen = 0;
+            while (len > 0)
+            {
+                short px[4];
+                long pxav = 0;
+                short pxa;
+                memcpy(px, lbufp, binning * 2);
+                for (int a = 0; a < binning; a++)
+                    pxav += px[a];
+                pxav /= binning;
+                pxa = pxav;
+                memcpy(linebuf + linelen, &pxa, 2);
+                linelen += 2;
+                lbufp += 2 * binning;
+                len -= 2 * binning;
+            }
+            memcpy(dbufp, linebuf, (xlen * 2) / binning);
+        }
+        else
+            memcpy(dbufp, bufp + (KAF8300_POSTAMBLE * 2), xlen * 2);
+
+        bufp += ROW_BYTES;
+        dbufp += (xlen * 2) / binning;
+        nwriteleft -= ROW_BYTES;
+    }
+}
+
+// NsDownload::writedownload before the kernels, without the fwrite
+static void legacyFits(const uint8_t *buffer, int nwrite, uint8_t *dbufp)
+{
+    while (nwrite >= ROW_BYTES)
+    {
+        swab(buffer + (KAF8300_POSTAMBLE * 2), dbufp, KAF8300_ACTIVE_X * 2);
+        buffer += ROW_BYTES;
+        dbufp += KAF8300_ACTIVE_X * 2;
+        nwrite -= ROW_BYTES;
+    }
+}
+
+// Dark background around 1000 ADU with read noise, a gradient and saturated stars
+static Payload syntheticPayload()
+{
+    Payload payload;
+    payload.name = "synthetic";
+    payload.data.resize(static_cast<size_t>(ROW_BYTES) * IMG_MAX_Y);
+
+    srand(1);
+    for (size_t i = 0; i < payload.data.size() / 2; i++)
+    {
+        const size_t y = i / KAF8300_MAX_X;
+        int value = 1000 + static_cast<int>(y / 10) + rand() % 64;
+        if (rand() % 500 == 0)
+            value = 65535 - rand() % 4096;
+        payload.data[2 * i] = value & 0xff;
+        payload.data[2 * i + 1] = value >> 8;
+    }
+    return payload;
+}
+
+static bool loadPayload(const char *fileName, Payload &payload)
+{
+    FILE *f = fopen(fileName, "rb");
+    if (f == nullptr)
+    {
+        perror(fileName);
+        return false;
+    }
+
+    payload.name = fileName;
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+        payload.data.insert(payload.data.end(), chunk, chunk + n);
+    fclose(f);
+    return true;
+}
+
+template <typename F>
+static double measure(int iterations, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+    bool failed = false;
+
+    std::vector<Payload> payloads;
+    for (int i = 2; i < argc; i++)
+    {
+        Payload payload;
+        if (!loadPayload(argv[i], payload))
+            return 1;
+        payloads.push_back(payload);
+    }
+    if (payloads.empty())
+        payloads.push_back(syntheticPayload());
+
+    const NsBin::Backend backends[] =
+    {
+        NsBin::BACKEND_SCALAR, NsBin::BACKEND_SSSE3, NsBin::BACKEND_AVX2, NsBin::BACKEND_NEON
+    };
+    const NsBin::Backend defaultBackend = NsBin::backend();
+
+    printf("Default backend: %s\n", NsBin::toString(defaultBackend));
+
+    for (const Payload &payload : payloads)
+    {
+        const int nwrite = static_cast<int>(payload.data.size());
+        const size_t rows = nwrite / ROW_BYTES;
+        printf("\n%s: %zu rows of %d samples\n", payload.name.c_str(), rows, KAF8300_MAX_X);
+        printf("%-9s %10s", "mode", "legacy ms");
+        for (NsBin::Backend backend : backends)
+            if (NsBin::isSupported(backend))
+                printf(" %10s", NsBin::toString(backend));
+        printf(" %8s\n", "speedup");
+
+        for (const Mode &mode : modes)
+        {
+            // a subframe the binning divides, as the legacy loop needs
+            const size_t width = KAF8300_ACTIVE_X / mode.xbin;
+            const size_t height = rows / mode.ybin;
+            const uint8_t *src = payload.data.data() + (KAF8300_POSTAMBLE * 2);
+
+            std::vector<uint8_t> reference(width * height * 2), output(width * height * 2);
+
+            double legacyMs = -1;
+            if (mode.order == NsBin::ORDER_BIG_ENDIAN)
+                legacyMs = measure(iterations, [&]()
+            {
+                legacyFits(payload.data.data(), nwrite, output.data());
+            });
+            else if (mode.ybin == 1)
+                legacyMs = measure(iterations, [&]()
+            {
+                legacyCopy(payload.data.data(), nwrite, output.data(), width * mode.xbin, mode.xbin);
+            });
+
+            printf("%-9s", mode.name);
+            if (legacyMs < 0)
+                printf(" %10s", "-");
+            else
+                printf(" %10.2f", legacyMs);
+
+            double bestMs = 0;
+            for (NsBin::Backend backend : backends)
+            {
+                if (!NsBin::setBackend(backend))
+                    continue;
+
+                std::vector<uint8_t> &dst = (backend == NsBin::BACKEND_SCALAR) ? reference : output;
+                std::fill(dst.begin(), dst.end(), 0);
+                double ms = measure(iterations, [&]()
+                {
+                    NsBin::binFrame(src, ROW_BYTES, dst.data(), width * 2, width, height, mode.xbin, mode.ybin, mode.order);
+                });
+                printf(" %10.2f", ms);
+
+                if (backend == defaultBackend)
+                    bestMs = ms;
+
+                if (backend != NsBin::BACKEND_SCALAR && output != reference)
+                {
+                    printf(" MISMATCH");
+                    failed = true;
+                }
+            }
+
+            if (legacyMs < 0)
+                printf(" %8s\n", "-");
+            else
+                printf(" %7.2fx\n", legacyMs / bestMs);
+        }
+    }
+
+    NsBin::setBackend(defaultBackend);
+    return failed ? 1 : 0;
+}
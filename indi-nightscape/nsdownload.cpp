@@ -1,4 +1,5 @@
 #include "nsdownload.h"
+#include "nsbin.h"
 #include "kaf_constants.h"
 #include <string.h>
 #include <errno.h>
@@ -6,7 +7,6 @@
 #include  <unistd.h>
 #include <string.h>
 #include "nsdebug.h"
-#include <math.h>
 
 void NsDownload::setFrameYBinning(int binning) {
 			ctx->imgp->ybinning = binning;	
@@ -289,7 +289,7 @@ void NsDownload::writedownload(int pad, int cooked)
 		unsigned char * bufp = retrBuf->buffer;
 		writelines = 0;
 	  while (nwriteleft >= (KAF8300_MAX_X*2)) {
-	  	swab (bufp + (KAF8300_POSTAMBLE*2),  linebuf, KAF8300_ACTIVE_X*2 );
+	  	NsBin::binFrame(bufp + (KAF8300_POSTAMBLE*2), 0, linebuf, 0, KAF8300_ACTIVE_X, 1, 1, 1, NsBin::ORDER_BIG_ENDIAN);
 			fwrite (linebuf, sizeof(char), KAF8300_ACTIVE_X*2 , img);
 			bufp +=  KAF8300_MAX_X*2;
 			nwriteleft -= KAF8300_MAX_X*2;
@@ -304,12 +304,6 @@ void NsDownload::writedownload(int pad, int cooked)
 
 void NsDownload::copydownload(unsigned char *buf, int xstart, int xlen, int xbin, int pad, int cooked)
 {
-	unsigned char linebuf[KAF8300_MAX_X*2];
-	bool forwards = true;
-	bool rms = false;
-	int binning = xbin;
-	uint8_t * dbufp = buf;
-	uint8_t * bufp;
 	int nwrite = 0;
 	
 	if (retrBuf == NULL) {
@@ -324,65 +318,18 @@ void NsDownload::copydownload(unsigned char *buf, int xstart, int xlen, int xbin
 		} else {
 			nwrite = retrBuf->nread;
 		}
-		memcpy (dbufp, retrBuf->buffer, nwrite);
+		memcpy (buf, retrBuf->buffer, nwrite);
 	} else {
-		//int actlines = nwrite / (KAF8300_MAX_X*2);
-	  //int rem = nwrite % (KAF8300_MAX_X*2);
-	  nwrite = retrBuf->nread;
-		int nwriteleft = nwrite;
-		if (forwards) {
-			bufp = retrBuf->buffer;
-			//dbufp =  (dbufp +(KAF8300_ACTIVE_X*2*IMG_Y)) - (KAF8300_ACTIVE_X*2);
-		} else {
-			bufp = (retrBuf->buffer + nwrite) - (KAF8300_MAX_X*2);
-			dbufp =  (dbufp +(KAF8300_ACTIVE_X*2*IMG_MAX_Y)) - (KAF8300_ACTIVE_X*2);
+		// the camera bins vertically, only the horizontal binning is left to do
+		if (!NsBin::isValidBinning(xbin, 1)) {
+			DO_ERR("unsupported binning %d\n", xbin);
+			return;
 		}
-		writelines = 0;
-	  while (nwriteleft >= (KAF8300_MAX_X*2)) {
-	  //swab (bufp + (KAF8300_POSTAMBLE*2),  linebuf, KAF8300_ACTIVE_X*2 );
-	   //memcpy (dbufp, linebuf, KAF8300_ACTIVE_X*2);
-	    if (binning > 1) {
-	    	uint8_t * lbufp = bufp + (KAF8300_POSTAMBLE*2) + xstart*2;
-	    	int len = xlen * 2;
-	    	int linelen = 0;
-	    	while (len > 0) {
-	    		short px[4];
-	    		long long pxsq =0;
-	    		long pxav =0;
-	    		short pxa;
-	    		memcpy(px, lbufp,binning * 2);
-	    		for (int a = 0; a < binning; a++) {
-	    			pxav += px[a];
-	    			pxsq	+= px[a]*px[a];
-	    		}
-	    		pxav /= binning;
-	    		pxsq /= binning;
-	    		if(rms) {
-	    			pxa = round(sqrt((double)	pxsq));
-	    			
-	    		} else {
-	    			pxa = pxav;	
-	    		}
-	    		memcpy (linebuf + linelen, &pxa, 2);
-	    		linelen += 2;
-	    		lbufp += 2*binning;
-	    		len -= 2* binning;
-				}
-				memcpy (dbufp, linebuf, (xlen*2)/binning);
-
-	    } else {
-	  		memcpy (dbufp, bufp + (KAF8300_POSTAMBLE*2) + xstart*2, xlen * 2 ); //KAF8300_ACTIVE_X*2 );
-	  	}
-			if (forwards) { 
-				bufp +=  KAF8300_MAX_X*2;
-				dbufp +=(xlen*2)/binning;
-			} else {
-				bufp -=  KAF8300_MAX_X*2;
-				dbufp-=(xlen*2)/binning;
-			}
-			nwriteleft -= KAF8300_MAX_X*2;
-			writelines++;
-	  }
+	  nwrite = retrBuf->nread;
+		int width = xlen / xbin;
+		writelines = nwrite / (KAF8300_MAX_X*2);
+		NsBin::binFrame(retrBuf->buffer + (KAF8300_POSTAMBLE*2) + xstart*2, KAF8300_MAX_X*2,
+		                buf, width*2, width, writelines, xbin, 1, NsBin::ORDER_NATIVE);
 	 DO_INFO( "wrote %d lines\n", writelines);
 	}	 
 }
@@ -24,6 +24,7 @@
 
 #include "playerone_base.h"
 #include "playerone_helpers.h"
+#include "pixel_convert.h"
 
 #include "config.h"
 
@@ -108,8 +109,7 @@ void POABase::workerStreamVideo(const std::atomic_bool &isAbortToQuit)
         }
 
         if (mCurrentVideoFormat == POA_RGB24)
-            for (uint32_t i = 0; i < totalBytes; i += 3)
-                std::swap(targetFrame[i], targetFrame[i + 2]);
+            PixelConvert::swapRedBlue(targetFrame, totalBytes / 3, 3, 1);
 
         Streamer->newFrame(targetFrame, totalBytes);
     }
@@ -1249,14 +1249,18 @@ int POABase::grabImage(float duration)
     int nChannels = (type == POA_RGB24) ? 3 : 1;
     size_t nTotalBytes = subW * subH * nChannels * (PrimaryCCD.getBPP() / 8);
 
+    ScratchBuffer scratch;
     if (type == POA_RGB24)
     {
-        buffer = static_cast<uint8_t *>(malloc(nTotalBytes));
-        if (buffer == nullptr)
+        scratch = mScratchPool.acquire(nTotalBytes);
+        if (!scratch)
         {
-            LOGF_ERROR("%s: %d malloc failed (RGB 24).", getDeviceName());
+            LOGF_ERROR("%s: scratch buffer allocation failed (RGB 24).", getDeviceName());
             return -1;
         }
+        buffer = scratch.data();
+        LOGF_DEBUG("Scratch buffers: %zu bytes mapped, peak %zu bytes.", mScratchPool.allocatedBytes(),
+                   mScratchPool.highWaterMark());
     }
 
     ret = POAGetImageData(mCameraInfo.cameraID, buffer, nTotalBytes, -1);
@@ -1266,28 +1270,12 @@ int POABase::grabImage(float duration)
             "Failed to get data after exposure (%dx%d #%d channels) (%s).",
             subW, subH, nChannels, Helpers::toString(ret)
         );
-        if (type == POA_RGB24)
-            free(buffer);
         return -1;
     }
 
     if (type == POA_RGB24)
     {
-        uint8_t *dstR = image;
-        uint8_t *dstG = image + subW * subH;
-        uint8_t *dstB = image + subW * subH * 2;
-
-        const uint8_t *src = buffer;
-        const uint8_t *end = buffer + subW * subH * 3;
-
-        while (src != end)
-        {
-            *dstB++ = *src++;
-            *dstG++ = *src++;
-            *dstR++ = *src++;
-        }
-
-        free(buffer);
+        PixelConvert::interleavedToPlanar(buffer, image, subW * subH, 3, 1, PixelConvert::ORDER_BGR);
     }
     guard.unlock();
 
@@ -26,6 +26,7 @@
 #include "indipropertynumber.h"
 #include "indipropertytext.h"
 #include "indisinglethreadpool.h"
+#include "scratch_buffer_pool.h"
 
 #include <vector>
 
@@ -172,4 +173,7 @@ class POABase : public INDI::CCD
         uint8_t mExposureRetry {0};
         POAImgFormat                      mCurrentVideoFormat;
         std::vector<POAConfigAttributes>  mControlCaps;
+
+        /** Reusable buffers for colour frame deinterleaving */
+        ScratchBufferPool mScratchPool;
 };
@@ -23,6 +23,7 @@
 #include "qhy_ccd.h"
 #include "config.h"
 #include <stream/streammanager.h>
+#include <sharedblob.h>
 
 #include <libnova/julian_day.h>
 #include <algorithm>
@@ -32,6 +33,9 @@
 #include <deque>
 
 #define UPDATE_THRESHOLD       0.05   /* Differential temperature threshold (C)*/
+#define GPS_PUBLISH_MS         1000   /* Minimum interval between GPS data updates while streaming (ms) */
+#define BURST_TIMEOUT_MS       5000   /* Time past the exposure to wait for the next frame of a burst (ms) */
+#define BURST_STATS_MS         1000   /* Minimum interval between burst statistics updates (ms) */
 
 //NB Disable for real driver
 //#define USE_SIMULATION
@@ -272,6 +276,16 @@ bool QHYCCD::initProperties()
     // GPS header On/Off
     IUFillSwitch(&GPSControlS[INDI_ENABLED], "INDI_ENABLED", "Enable", ISS_OFF);
     IUFillSwitch(&GPSControlS[INDI_DISABLED], "INDI_DISABLED", "Disable", ISS_ON);
+    IUFillSwitch(&GPSDecodeS[GPS_DECODE_EVERY_FRAME], "GPS_DECODE_EVERY_FRAME", "Every frame", ISS_OFF);
+    IUFillSwitch(&GPSDecodeS[GPS_DECODE_ON_UPDATE], "GPS_DECODE_ON_UPDATE", "On update", ISS_ON);
+    IUFillSwitchVector(&GPSDecodeSP, GPSDecodeS, 2, getDeviceName(), "GPS_DECODE", "Decode", GPS_CONTROL_TAB,
+                       IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    IUFillSwitch(&GPSTimestampS[INDI_ENABLED], "INDI_ENABLED", "Enable", ISS_ON);
+    IUFillSwitch(&GPSTimestampS[INDI_DISABLED], "INDI_DISABLED", "Disable", ISS_OFF);
+    IUFillSwitchVector(&GPSTimestampSP, GPSTimestampS, 2, getDeviceName(), "GPS_TIMESTAMP", "Frame Timestamp", GPS_CONTROL_TAB,
+                       IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
     IUFillSwitchVector(&GPSControlSP, GPSControlS, 2, getDeviceName(), "GPS_CONTROL", "GPS Header", GPS_CONTROL_TAB,
                        IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
@@ -319,6 +333,56 @@ bool QHYCCD::initProperties()
     IUFillText(&GPSDataNowT[GPS_DATA_NOW_TS], "GPS_DATA_NOW_TS", "TS", "NA");
     IUFillTextVector(&GPSDataNowTP, GPSDataNowT, 4, getDeviceName(), "GPS_DATA_NOW", "Now", GPS_DATA_TAB, IP_RO, 60, IPS_IDLE);
 
+    /////////////////////////////////////////////////////////////////////////////
+    /// Streaming Acquisition
+    /////////////////////////////////////////////////////////////////////////////
+    IUFillSwitch(&StreamAcquisitionS[ACQUISITION_DIRECT], "ACQUISITION_DIRECT", "Direct", ISS_OFF);
+    IUFillSwitch(&StreamAcquisitionS[ACQUISITION_STAGED], "ACQUISITION_STAGED", "Staged", ISS_ON);
+    IUFillSwitchVector(&StreamAcquisitionSP, StreamAcquisitionS, 2, getDeviceName(), "STREAM_ACQUISITION", "Acquisition",
+                       STREAMING_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
+    IUFillNumber(&StreamLatencyN[LATENCY_1MS], "LATENCY_1MS", "< 1 ms", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamLatencyN[LATENCY_2MS], "LATENCY_2MS", "< 2 ms", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamLatencyN[LATENCY_5MS], "LATENCY_5MS", "< 5 ms", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamLatencyN[LATENCY_10MS], "LATENCY_10MS", "< 10 ms", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamLatencyN[LATENCY_SLOW], "LATENCY_SLOW", ">= 10 ms", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamLatencyN[LATENCY_AVERAGE], "LATENCY_AVERAGE", "Average (ms)", "%.3f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&StreamLatencyNP, StreamLatencyN, 6, getDeviceName(), "STREAM_FRAME_LATENCY", "Latency",
+                       STREAMING_TAB, IP_RO, 60, IPS_IDLE);
+
+    IUFillNumber(&StreamRetriesN[RETRIES_NONE], "RETRIES_NONE", "None", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamRetriesN[RETRIES_ONE], "RETRIES_ONE", "1", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamRetriesN[RETRIES_FEW], "RETRIES_FEW", "2-3", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamRetriesN[RETRIES_MANY], "RETRIES_MANY", "4-9", "%.f", 0, 1e12, 0, 0);
+    IUFillNumber(&StreamRetriesN[RETRIES_FAILED], "RETRIES_FAILED", "Failed", "%.f", 0, 1e12, 0, 0);
+    IUFillNumberVector(&StreamRetriesNP, StreamRetriesN, 5, getDeviceName(), "STREAM_FRAME_RETRIES", "Retries",
+                       STREAMING_TAB, IP_RO, 60, IPS_IDLE);
+
+    /////////////////////////////////////////////////////////////////////////////
+    /// Burst Mode
+    /////////////////////////////////////////////////////////////////////////////
+    IUFillSwitch(&BurstModeS[BURST_OFF], "BURST_OFF", "Off", ISS_ON);
+    IUFillSwitch(&BurstModeS[BURST_IMAGES], "BURST_IMAGES", "Images", ISS_OFF);
+    IUFillSwitch(&BurstModeS[BURST_STREAM], "BURST_STREAM", "Stream", ISS_OFF);
+    IUFillSwitchVector(&BurstModeSP, BurstModeS, 3, getDeviceName(), "QHY_BURST_MODE", "Burst", BURST_TAB, IP_RW,
+                       ISR_1OFMANY, 60, IPS_IDLE);
+
+    IUFillNumber(&BurstN[BURST_START_FRAME], "BURST_START_FRAME", "Start frame", "%.f", 1, 65535, 1, 1);
+    IUFillNumber(&BurstN[BURST_END_FRAME], "BURST_END_FRAME", "End frame", "%.f", 1, 65535, 1, 10);
+    IUFillNumber(&BurstN[BURST_PATCH], "BURST_PATCH", "Patch number", "%.f", 0, 1e9, 1, 0);
+    IUFillNumber(&BurstN[BURST_QUEUE], "BURST_QUEUE", "Queue frames", "%.f", 1, 256, 1, 8);
+    IUFillNumberVector(&BurstNP, BurstN, 4, getDeviceName(), "QHY_BURST_SETTINGS", "Settings", BURST_TAB, IP_RW, 60,
+                       IPS_IDLE);
+
+    IUFillNumber(&BurstStatsN[BURST_RECEIVED], "BURST_RECEIVED", "Received", "%.f", 0, 65535, 0, 0);
+    IUFillNumber(&BurstStatsN[BURST_DROPPED], "BURST_DROPPED", "Dropped", "%.f", 0, 65535, 0, 0);
+    IUFillNumber(&BurstStatsN[BURST_FIRST], "BURST_FIRST", "First frame (ms)", "%.3f", 0, 1e9, 0, 0);
+    IUFillNumber(&BurstStatsN[BURST_INTERVAL], "BURST_INTERVAL", "Interval (ms)", "%.3f", 0, 1e9, 0, 0);
+    IUFillNumber(&BurstStatsN[BURST_INTERVAL_MAX], "BURST_INTERVAL_MAX", "Max interval (ms)", "%.3f", 0, 1e9, 0, 0);
+    IUFillNumber(&BurstStatsN[BURST_QUEUE_PEAK], "BURST_QUEUE_PEAK", "Queue peak", "%.f", 0, 256, 0, 0);
+    IUFillNumberVector(&BurstStatsNP, BurstStatsN, 6, getDeviceName(), "QHY_BURST_STATS", "Last burst", BURST_TAB, IP_RO,
+                       60, IPS_IDLE);
+
     addAuxControls();
     setDriverInterface(getDriverInterface());
 
@@ -387,6 +451,8 @@ void QHYCCD::ISGetProperties(const char *dev)
             defineProperty(&GPSLEDEndPosNP);
 
             defineProperty(&GPSControlSP);
+            defineProperty(&GPSDecodeSP);
+            defineProperty(&GPSTimestampSP);
 
             defineProperty(&GPSStateLP);
             defineProperty(&GPSDataHeaderTP);
@@ -398,6 +464,20 @@ void QHYCCD::ISGetProperties(const char *dev)
         //NEW CODE - Add support for overscan/calibration area
         if(HasOverscanArea)
             defineProperty(&OverscanAreaSP);
+
+        if (HasStreaming())
+        {
+            defineProperty(&StreamAcquisitionSP);
+            defineProperty(&StreamLatencyNP);
+            defineProperty(&StreamRetriesNP);
+        }
+
+        if (HasBurstMode)
+        {
+            defineProperty(&BurstModeSP);
+            defineProperty(&BurstNP);
+            defineProperty(&BurstStatsNP);
+        }
     }
 }
 
@@ -615,6 +695,8 @@ bool QHYCCD::updateProperties()
             defineProperty(&GPSLEDStartPosNP);
             defineProperty(&GPSLEDEndPosNP);
             defineProperty(&GPSControlSP);
+            defineProperty(&GPSDecodeSP);
+            defineProperty(&GPSTimestampSP);
 
             defineProperty(&GPSStateLP);
             defineProperty(&GPSDataHeaderTP);
@@ -627,6 +709,20 @@ bool QHYCCD::updateProperties()
         if (HasOverscanArea)
             defineProperty(&OverscanAreaSP);
 
+        if (HasStreaming())
+        {
+            defineProperty(&StreamAcquisitionSP);
+            defineProperty(&StreamLatencyNP);
+            defineProperty(&StreamRetriesNP);
+        }
+
+        if (HasBurstMode)
+        {
+            defineProperty(&BurstModeSP);
+            defineProperty(&BurstNP);
+            defineProperty(&BurstStatsNP);
+        }
+
         // Let's get parameters now from CCD
         setupParams();
     }
@@ -691,6 +787,8 @@ bool QHYCCD::updateProperties()
             deleteProperty(GPSLEDStartPosNP.name);
             deleteProperty(GPSLEDEndPosNP.name);
             deleteProperty(GPSControlSP.name);
+            deleteProperty(GPSDecodeSP.name);
+            deleteProperty(GPSTimestampSP.name);
 
             deleteProperty(GPSStateLP.name);
             deleteProperty(GPSDataHeaderTP.name);
@@ -702,6 +800,20 @@ bool QHYCCD::updateProperties()
         //NEW CODE - Add support for overscan/calibration area
         if (HasOverscanArea)
             deleteProperty(OverscanAreaSP.name);
+
+        if (HasStreaming())
+        {
+            deleteProperty(StreamAcquisitionSP.name);
+            deleteProperty(StreamLatencyNP.name);
+            deleteProperty(StreamRetriesNP.name);
+        }
+
+        if (HasBurstMode)
+        {
+            deleteProperty(BurstModeSP.name);
+            deleteProperty(BurstNP.name);
+            deleteProperty(BurstStatsNP.name);
+        }
     }
 
     return true;
@@ -867,6 +979,17 @@ bool QHYCCD::Connect()
 
         LOGF_DEBUG("Has Streaming: %s", (cap & CCD_HAS_STREAMING) ? "True" : "False");
 
+        ////////////////////////////////////////////////////////////////////
+        /// Burst Mode Support
+        ////////////////////////////////////////////////////////////////////
+        ret = IsQHYCCDControlAvailable(m_CameraHandle, CAM_BURST_MODE);
+        if (ret == QHYCCD_SUCCESS && (cap & CCD_HAS_STREAMING))
+        {
+            HasBurstMode = true;
+        }
+
+        LOGF_DEBUG("Burst Mode: %s", HasBurstMode ? "True" : "False");
+
         ////////////////////////////////////////////////////////////////////
         /// AutoMode Cooler Support
         ////////////////////////////////////////////////////////////////////
@@ -1156,6 +1279,7 @@ bool QHYCCD::Disconnect()
     pthread_cond_signal(&cv);
     pthread_mutex_unlock(&condMutex);
     pthread_join(m_ImagingThread, nullptr);
+    releaseStagingBuffer();
     //tState = StateNone;
     if (isSimulation() == false)
     {
@@ -1295,6 +1419,38 @@ bool QHYCCD::StartExposure(float duration)
         return false;
     }
 
+    // Capture a burst of frames in live mode, each one is sent as an image
+    if (HasBurstMode && BurstModeS[BURST_IMAGES].s == ISS_ON && !isSimulation())
+    {
+        if (InExposure)
+        {
+            LOG_ERROR("Cannot take exposure while a burst is in progress.");
+            return false;
+        }
+
+        m_ExposureRequest = static_cast<double>(duration);
+        PrimaryCCD.setExposureDuration(m_ExposureRequest);
+        // Live mode has its own exposure setting, make sure the next single frame sets it again
+        m_LastExposureRequestuS = 0;
+
+        if (!setupLiveMode(duration * 1000 * 1000))
+            return false;
+        if (SetQHYCCDBitsMode(m_CameraHandle, PrimaryCCD.getBPP()) != QHYCCD_SUCCESS)
+            LOGF_WARN("SetQHYCCDBitsMode %dbit failed.", PrimaryCCD.getBPP());
+        if (!armBurst())
+            return false;
+
+        m_BurstArmed = true;
+        gettimeofday(&ExpStart, nullptr);
+        InExposure = true;
+        pthread_mutex_lock(&condMutex);
+        m_ThreadRequest = StateExposure;
+        pthread_cond_signal(&cv);
+        pthread_mutex_unlock(&condMutex);
+        return true;
+    }
+    m_BurstArmed = false;
+
     // Set streaming mode and re-initialize camera
     if (currentQHYStreamMode == 1 && !isSimulation())
     {
@@ -1425,6 +1581,15 @@ bool QHYCCD::AbortExposure()
     }
     pthread_mutex_unlock(&condMutex);
 
+    // The imaging thread stopped the burst on its way out
+    if (m_BurstArmed)
+    {
+        m_BurstArmed = false;
+        InExposure = false;
+        LOG_INFO("Burst aborted.");
+        return true;
+    }
+
     if (std::string(m_CamID) != "QHY5-M-")
     {
         int rc = CancelQHYCCDExposingAndReadout(m_CameraHandle);
@@ -1555,7 +1720,10 @@ int QHYCCD::grabImage()
         LOG_DEBUG("Download complete.");
 
     if (HasGPS && GPSControlS[INDI_ENABLED].s == ISS_ON)
-        decodeGPSHeader();
+    {
+        captureGPSHeader(PrimaryCCD.getFrameBuffer());
+        publishGPSHeader();
+    }
 
     ExposureComplete(&PrimaryCCD);
 
@@ -1774,6 +1942,28 @@ bool QHYCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
             return true;
         }
 
+        //////////////////////////////////////////////////////////////////////
+        /// GPS Header Decoding
+        //////////////////////////////////////////////////////////////////////
+        else if (!strcmp(GPSDecodeSP.name, name))
+        {
+            IUUpdateSwitch(&GPSDecodeSP, states, names, n);
+            GPSDecodeSP.s = IPS_OK;
+            IDSetSwitch(&GPSDecodeSP, nullptr);
+            return true;
+        }
+
+        //////////////////////////////////////////////////////////////////////
+        /// GPS Frame Timestamp
+        //////////////////////////////////////////////////////////////////////
+        else if (!strcmp(GPSTimestampSP.name, name))
+        {
+            IUUpdateSwitch(&GPSTimestampSP, states, names, n);
+            GPSTimestampSP.s = IPS_OK;
+            IDSetSwitch(&GPSTimestampSP, nullptr);
+            return true;
+        }
+
         //////////////////////////////////////////////////////////////////////
         /// GPS Slaving Mode
         //////////////////////////////////////////////////////////////////////
@@ -1891,6 +2081,48 @@ bool QHYCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
             IDSetSwitch(&OverscanAreaSP, nullptr);
             return true;
         }
+
+        //////////////////////////////////////////////////////////////////////
+        /// Streaming Acquisition Mode
+        //////////////////////////////////////////////////////////////////////
+        else if (!strcmp(StreamAcquisitionSP.name, name))
+        {
+            // Picked up by the streaming thread when streaming starts
+            if (Streamer->isBusy())
+            {
+                LOG_WARN("Cannot change the acquisition mode while streaming.");
+                StreamAcquisitionSP.s = IPS_ALERT;
+                IDSetSwitch(&StreamAcquisitionSP, nullptr);
+                return true;
+            }
+
+            IUUpdateSwitch(&StreamAcquisitionSP, states, names, n);
+            StreamAcquisitionSP.s = IPS_OK;
+            IDSetSwitch(&StreamAcquisitionSP, nullptr);
+            saveConfig(true, StreamAcquisitionSP.name);
+            return true;
+        }
+
+        //////////////////////////////////////////////////////////////////////
+        /// Burst Mode
+        //////////////////////////////////////////////////////////////////////
+        else if (!strcmp(BurstModeSP.name, name))
+        {
+            // Picked up by the next exposure or stream
+            if (InExposure || Streamer->isBusy())
+            {
+                LOG_WARN("Cannot change the burst mode while capturing.");
+                BurstModeSP.s = IPS_ALERT;
+                IDSetSwitch(&BurstModeSP, nullptr);
+                return true;
+            }
+
+            IUUpdateSwitch(&BurstModeSP, states, names, n);
+            BurstModeSP.s = IPS_OK;
+            IDSetSwitch(&BurstModeSP, nullptr);
+            saveConfig(true, BurstModeSP.name);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewSwitch(dev, name, states, names, n);
@@ -1918,6 +2150,37 @@ bool QHYCCD::ISNewNumber(const char *dev, const char *name, double values[], cha
         if (INDI::FilterInterface::processNumber(dev, name, values, names, n))
             return true;
 
+        //////////////////////////////////////////////////////////////////////
+        /// Burst Settings
+        //////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, BurstNP.name))
+        {
+            if (InExposure || Streamer->isBusy())
+            {
+                LOG_WARN("Cannot change the burst settings while capturing.");
+                BurstNP.s = IPS_ALERT;
+                IDSetNumber(&BurstNP, nullptr);
+                return true;
+            }
+
+            double start = BurstN[BURST_START_FRAME].value, end = BurstN[BURST_END_FRAME].value;
+            IUUpdateNumber(&BurstNP, values, names, n);
+            if (BurstN[BURST_END_FRAME].value < BurstN[BURST_START_FRAME].value)
+            {
+                LOG_ERROR("The end frame of the burst must not be before the start frame.");
+                BurstN[BURST_START_FRAME].value = start;
+                BurstN[BURST_END_FRAME].value = end;
+                BurstNP.s = IPS_ALERT;
+            }
+            else
+            {
+                BurstNP.s = IPS_OK;
+                saveConfig(true, BurstNP.name);
+            }
+            IDSetNumber(&BurstNP, nullptr);
+            return true;
+        }
+
         //////////////////////////////////////////////////////////////////////
         /// Gain Control
         //////////////////////////////////////////////////////////////////////
@@ -2356,12 +2619,23 @@ bool QHYCCD::saveConfigItems(FILE *fp)
     if (HasGPS)
     {
         IUSaveConfigSwitch(fp, &GPSControlSP);
+        IUSaveConfigSwitch(fp, &GPSDecodeSP);
+        IUSaveConfigSwitch(fp, &GPSTimestampSP);
         IUSaveConfigSwitch(fp, &GPSSlavingSP);
         IUSaveConfigNumber(fp, &VCOXFreqNP);
     }
 
     IUSaveConfigNumber(fp, &USBBufferNP);
 
+    if (HasStreaming())
+        IUSaveConfigSwitch(fp, &StreamAcquisitionSP);
+
+    if (HasBurstMode)
+    {
+        IUSaveConfigSwitch(fp, &BurstModeSP);
+        IUSaveConfigNumber(fp, &BurstNP);
+    }
+
     return true;
 }
 
@@ -2375,9 +2649,6 @@ bool QHYCCD::StartStreaming()
     int ret = 0;
     m_ExposureRequest = 1.0 / Streamer->getTargetFPS();
 
-    //NEW CODE - Add support for overscan/calibration area
-    uint32_t subX = (PrimaryCCD.getSubX() + (IgnoreOverscanArea ? effectiveROI.subX : 0)) / PrimaryCCD.getBinX();
-    uint32_t subY = (PrimaryCCD.getSubY() + (IgnoreOverscanArea ? effectiveROI.subY : 0)) / PrimaryCCD.getBinY();
     uint32_t subW = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
     uint32_t subH = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
 
@@ -2388,6 +2659,60 @@ bool QHYCCD::StartStreaming()
         { "RGGB", INDI_BAYER_RGGB }
     };
 
+    double uSecs = static_cast<long>(m_ExposureRequest * 950000.0);
+    if (!setupLiveMode(uSecs))
+        return false;
+
+    INDI_PIXEL_FORMAT qhyFormat = INDI_MONO;
+    if (BayerTP[2].getText() && formats.count(BayerTP[2].getText()) != 0)
+        qhyFormat = formats.at(BayerTP[2].getText());
+
+    ret = SetQHYCCDBitsMode(m_CameraHandle, 8);
+    if (ret == QHYCCD_SUCCESS)
+        Streamer->setPixelFormat(qhyFormat, 8);
+    else
+    {
+        LOG_WARN("SetQHYCCDBitsMode 8bit failed.");
+        Streamer->setPixelFormat(qhyFormat, PrimaryCCD.getBPP());
+    }
+
+    //LOG_INFO("start live mode"); //DEBUG
+
+    LOGF_INFO("Starting video streaming with exposure %.f seconds (%.f FPS), w=%d h=%d", m_ExposureRequest,
+              Streamer->getTargetFPS(), subW, subH);
+    resetStreamStats();
+
+    // A burst streams the armed frame range once instead of free running live frames
+    m_BurstArmed = HasBurstMode && BurstModeS[BURST_STREAM].s == ISS_ON && !isSimulation();
+    if (m_BurstArmed)
+    {
+        if (!armBurst())
+        {
+            m_BurstArmed = false;
+            return false;
+        }
+    }
+    else
+        BeginQHYCCDLive(m_CameraHandle);
+
+    pthread_mutex_lock(&condMutex);
+    m_ThreadRequest = StateStream;
+    pthread_cond_signal(&cv);
+    pthread_mutex_unlock(&condMutex);
+
+    return true;
+}
+
+bool QHYCCD::setupLiveMode(double uSecs)
+{
+    int ret = 0;
+
+    //NEW CODE - Add support for overscan/calibration area
+    uint32_t subX = (PrimaryCCD.getSubX() + (IgnoreOverscanArea ? effectiveROI.subX : 0)) / PrimaryCCD.getBinX();
+    uint32_t subY = (PrimaryCCD.getSubY() + (IgnoreOverscanArea ? effectiveROI.subY : 0)) / PrimaryCCD.getBinY();
+    uint32_t subW = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    uint32_t subH = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+
     // Set Stream Mode and re-initialize camera
     //SetQHYCCDStreamMode(m_CameraHandle, currentQHYStreamMode);
     if (currentQHYStreamMode == 0  && !isSimulation())
@@ -2443,12 +2768,6 @@ bool QHYCCD::StartStreaming()
 
     LOGF_DEBUG("SetQHYCCDResolution x: %d y: %d w: %d h: %d", subX, subY, subW, subH, ret);
 
-    INDI_PIXEL_FORMAT qhyFormat = INDI_MONO;
-    if (BayerTP[2].getText() && formats.count(BayerTP[2].getText()) != 0)
-        qhyFormat = formats.at(BayerTP[2].getText());
-
-    double uSecs = static_cast<long>(m_ExposureRequest * 950000.0);
-
     SetQHYCCDParam(m_CameraHandle, CONTROL_EXPOSURE, uSecs);
 
     if (HasUSBSpeed)
@@ -2465,25 +2784,6 @@ bool QHYCCD::StartStreaming()
             LOG_WARN("SetQHYCCDParam CONTROL_USBTRAFFIC 20.0 failed.");
     }
 
-    ret = SetQHYCCDBitsMode(m_CameraHandle, 8);
-    if (ret == QHYCCD_SUCCESS)
-        Streamer->setPixelFormat(qhyFormat, 8);
-    else
-    {
-        LOG_WARN("SetQHYCCDBitsMode 8bit failed.");
-        Streamer->setPixelFormat(qhyFormat, PrimaryCCD.getBPP());
-    }
-
-    //LOG_INFO("start live mode"); //DEBUG
-
-    LOGF_INFO("Starting video streaming with exposure %.f seconds (%.f FPS), w=%d h=%d", m_ExposureRequest,
-              Streamer->getTargetFPS(), subW, subH);
-    BeginQHYCCDLive(m_CameraHandle);
-    pthread_mutex_lock(&condMutex);
-    m_ThreadRequest = StateStream;
-    pthread_cond_signal(&cv);
-    pthread_mutex_unlock(&condMutex);
-
     return true;
 }
 
@@ -2498,6 +2798,9 @@ bool QHYCCD::StopStreaming()
     }
     pthread_mutex_unlock(&condMutex);
     StopQHYCCDLive(m_CameraHandle);
+    m_BurstArmed = false;
+    releaseStagingBuffer();
+    updateStreamStats();
 
     //LOG_INFO("stopped live mode"); //DEBUG
 
@@ -2543,11 +2846,17 @@ void *QHYCCD::imagingThreadEntry()
         m_ThreadState = m_ThreadRequest;
         if (m_ThreadRequest == StateExposure)
         {
-            getExposure();
+            if (m_BurstArmed)
+                captureBurst(StateExposure);
+            else
+                getExposure();
         }
         else if (m_ThreadRequest == StateStream)
         {
-            streamVideo();
+            if (m_BurstArmed)
+                captureBurst(StateStream);
+            else
+                streamVideo();
         }
         else if (m_ThreadRequest == StateRestartExposure)
         {
@@ -2574,34 +2883,161 @@ void *QHYCCD::imagingThreadEntry()
     return nullptr;
 }
 
+uint32_t QHYCCD::readLiveFrame(uint8_t *buffer, uint32_t &w, uint32_t &h, uint32_t &bpp, uint32_t &channels,
+                               uint32_t &retries)
+{
+    uint32_t ret = QHYCCD_ERROR;
+    for (retries = 0; retries < 10; retries++)
+    {
+        ret = GetQHYCCDLiveFrame(m_CameraHandle, &w, &h, &bpp, &channels, buffer);
+        if (ret != QHYCCD_ERROR)
+            break;
+        usleep(1000);
+    }
+    return ret;
+}
+
+bool QHYCCD::allocateStagingBuffer()
+{
+    // Allocated the same way as the frame buffer since the two are swapped.
+    int size = PrimaryCCD.getFrameBufferSize();
+    if (m_StagingBuffer != nullptr && m_StagingBufferSize == size)
+        return true;
+
+    if (m_StagingBuffer)
+        m_StagingBuffer = static_cast<uint8_t *>(IDSharedBlobRealloc(m_StagingBuffer, size));
+    else
+        m_StagingBuffer = static_cast<uint8_t *>(IDSharedBlobAlloc(size));
+    m_StagingBufferSize = m_StagingBuffer ? size : 0;
+    if (m_StagingBuffer == nullptr)
+        LOGF_ERROR("Failed to allocate %d bytes staging buffer.", size);
+    return m_StagingBuffer != nullptr;
+}
+
+void QHYCCD::releaseStagingBuffer()
+{
+    if (m_StagingBuffer)
+        IDSharedBlobFree(m_StagingBuffer);
+    m_StagingBuffer = nullptr;
+    m_StagingBufferSize = 0;
+}
+
+void QHYCCD::resetStreamStats()
+{
+    for (auto &n : StreamLatencyN)
+        n.value = 0;
+    for (auto &n : StreamRetriesN)
+        n.value = 0;
+    m_StreamLatencyTotal = 0;
+    m_StreamLatencyFrames = 0;
+    StreamLatencyNP.s = IPS_IDLE;
+    StreamRetriesNP.s = IPS_IDLE;
+}
+
+void QHYCCD::recordStreamFrame(double latency, uint32_t retries, bool success)
+{
+    if (!success)
+    {
+        StreamRetriesN[RETRIES_FAILED].value++;
+        return;
+    }
+
+    if (retries == 0)
+        StreamRetriesN[RETRIES_NONE].value++;
+    else if (retries == 1)
+        StreamRetriesN[RETRIES_ONE].value++;
+    else if (retries < 4)
+        StreamRetriesN[RETRIES_FEW].value++;
+    else
+        StreamRetriesN[RETRIES_MANY].value++;
+
+    if (latency < 1)
+        StreamLatencyN[LATENCY_1MS].value++;
+    else if (latency < 2)
+        StreamLatencyN[LATENCY_2MS].value++;
+    else if (latency < 5)
+        StreamLatencyN[LATENCY_5MS].value++;
+    else if (latency < 10)
+        StreamLatencyN[LATENCY_10MS].value++;
+    else
+        StreamLatencyN[LATENCY_SLOW].value++;
+
+    m_StreamLatencyTotal += latency;
+    m_StreamLatencyFrames++;
+    StreamLatencyN[LATENCY_AVERAGE].value = m_StreamLatencyTotal / m_StreamLatencyFrames;
+}
+
+void QHYCCD::updateStreamStats()
+{
+    if (!HasStreaming())
+        return;
+
+    StreamLatencyNP.s = IPS_OK;
+    IDSetNumber(&StreamLatencyNP, nullptr);
+    StreamRetriesNP.s = StreamRetriesN[RETRIES_FAILED].value > 0 ? IPS_BUSY : IPS_OK;
+    IDSetNumber(&StreamRetriesNP, nullptr);
+}
+
 void QHYCCD::streamVideo()
 {
     uint32_t ret = 0, w, h, bpp, channels;
+    // In staged mode the SDK fills a private buffer, which may take several retries, and only the
+    // pointer swap into the frame buffer is done under ccdBufferLock.
+    bool staged = StreamAcquisitionS[ACQUISITION_STAGED].s == ISS_ON;
+    INDI::ElapsedTimer statsTimer;
     //uint32_t t_start = time(NULL), frames = 0;
     while (m_ThreadRequest == StateStream)
     {
         pthread_mutex_unlock(&condMutex);
         uint32_t retries = 0;
-        std::unique_lock<std::mutex> guard(ccdBufferLock);
-        uint8_t *buffer = PrimaryCCD.getFrameBuffer();
-        while (retries++ < 10)
+        uint8_t *buffer = nullptr;
+        INDI::ElapsedTimer acquisition;
+
+        if (staged && allocateStagingBuffer())
+        {
+            ret = readLiveFrame(m_StagingBuffer, w, h, bpp, channels, retries);
+            if (ret == QHYCCD_SUCCESS)
+            {
+                std::unique_lock<std::mutex> guard(ccdBufferLock);
+                // Drop the frame if the frame buffer was resized while reading
+                if (PrimaryCCD.getFrameBufferSize() == m_StagingBufferSize)
+                {
+                    buffer = m_StagingBuffer;
+                    m_StagingBuffer = PrimaryCCD.getFrameBuffer();
+                    PrimaryCCD.setFrameBuffer(buffer);
+                }
+                else
+                    ret = QHYCCD_ERROR;
+            }
+        }
+        else
         {
+            std::unique_lock<std::mutex> guard(ccdBufferLock);
+            buffer = PrimaryCCD.getFrameBuffer();
+            ret = readLiveFrame(buffer, w, h, bpp, channels, retries);
+        }
 
-            ret = GetQHYCCDLiveFrame(m_CameraHandle, &w, &h, &bpp, &channels, buffer);
-            if (ret == QHYCCD_ERROR)
-                usleep(1000);
-            else
-                break;
+        recordStreamFrame(acquisition.nsecsElapsed() / 1e6, retries, ret == QHYCCD_SUCCESS);
+        if (statsTimer.elapsed() >= 1000)
+        {
+            updateStreamStats();
+            statsTimer.start();
         }
-        guard.unlock();
+
         if (ret == QHYCCD_SUCCESS)
         {
             uint64_t timestamp = 0;
             if (HasGPS && GPSControlS[INDI_ENABLED].s == ISS_ON)
             {
-                decodeGPSHeader();
-                timestamp = (uint64_t)GPSHeader.start_sec * 1e6;
-                timestamp += GPSHeader.start_us + QHY_SER_US_EPOCH;
+                captureGPSHeader(buffer);
+                if (GPSTimestampS[INDI_ENABLED].s == ISS_ON)
+                    timestamp = GPSFrameTime.start;
+
+                if (GPSDecodeS[GPS_DECODE_EVERY_FRAME].s == ISS_ON || m_GPSPublishTimer.elapsed() >= GPS_PUBLISH_MS)
+                {
+                    publishGPSHeader();
+                    m_GPSPublishTimer.start();
+                }
             }
 
             Streamer->newFrame(buffer, w * h * bpp / 8 * channels, timestamp);
@@ -2666,6 +3102,267 @@ void QHYCCD::getExposure()
     }
 }
 
+bool QHYCCD::armBurst()
+{
+    const uint32_t frames = BurstN[BURST_END_FRAME].value - BurstN[BURST_START_FRAME].value + 1;
+    const size_t depth = std::min<size_t>(frames, BurstN[BURST_QUEUE].value);
+
+    // Frames are read straight into the queue, sized for the largest image the SDK may return
+    size_t size = GetQHYCCDMemLength(m_CameraHandle);
+    if (size == 0)
+        size = PrimaryCCD.getFrameBufferSize();
+
+    {
+        std::lock_guard<std::mutex> lock(m_BurstMutex);
+        m_BurstReady.clear();
+        m_BurstFree.clear();
+        try
+        {
+            m_BurstSlots.resize(depth);
+            for (auto &slot : m_BurstSlots)
+                slot.resize(size);
+            m_BurstDiscard.resize(size);
+        }
+        catch (const std::bad_alloc &)
+        {
+            LOGF_ERROR("Failed to allocate %zu burst buffers of %zu bytes.", depth, size);
+            m_BurstSlots.clear();
+            m_BurstDiscard.clear();
+            return false;
+        }
+        for (size_t i = 0; i < depth; i++)
+            m_BurstFree.push_back(i);
+    }
+
+    uint32_t ret = EnableQHYCCDBurstMode(m_CameraHandle, true);
+    if (ret != QHYCCD_SUCCESS)
+    {
+        LOGF_ERROR("Failed to enable burst mode (%d).", ret);
+        return false;
+    }
+
+    ret = SetQHYCCDBurstModeStartEnd(m_CameraHandle, static_cast<unsigned short>(BurstN[BURST_START_FRAME].value),
+                                     static_cast<unsigned short>(BurstN[BURST_END_FRAME].value));
+    if (ret != QHYCCD_SUCCESS)
+    {
+        LOGF_ERROR("Failed to set the burst frame range (%d).", ret);
+        EnableQHYCCDBurstMode(m_CameraHandle, false);
+        return false;
+    }
+
+    if (BurstN[BURST_PATCH].value > 0)
+        SetQHYCCDBurstModePatchNumber(m_CameraHandle, static_cast<uint32_t>(BurstN[BURST_PATCH].value));
+
+    // The camera waits in burst idle until captureBurst releases it
+    BeginQHYCCDLive(m_CameraHandle);
+    SetQHYCCDBurstIDLE(m_CameraHandle);
+
+    for (auto &n : BurstStatsN)
+        n.value = 0;
+    m_BurstIntervalTotal = 0;
+    m_BurstFrame = {};
+    publishBurstStats(IPS_BUSY);
+
+    LOGF_INFO("Burst of frames %.f to %.f armed, %zu queue buffers of %zu bytes.", BurstN[BURST_START_FRAME].value,
+              BurstN[BURST_END_FRAME].value, depth, size);
+    return true;
+}
+
+/* Called with the mutex held, returns with it held */
+void QHYCCD::captureBurst(ImageState state)
+{
+    const uint32_t frames = BurstN[BURST_END_FRAME].value - BurstN[BURST_START_FRAME].value + 1;
+    const double timeout = m_ExposureRequest * 1000 + BURST_TIMEOUT_MS;
+    pthread_mutex_unlock(&condMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(m_BurstMutex);
+        m_BurstDone = false;
+    }
+
+    // Frame arrivals are timed from here, the publisher dates the frames from the wall clock time
+    INDI::ElapsedTimer burstTimer, statsTimer;
+    gettimeofday(&m_BurstStart, nullptr);
+    m_BurstPublisher = std::thread(&QHYCCD::publishBurst, this, state == StateStream);
+
+    double lastArrival = 0;
+    uint32_t received = 0;
+    bool stalled = false;
+
+    uint32_t ret = ReleaseQHYCCDBurstIDLE(m_CameraHandle);
+    if (ret != QHYCCD_SUCCESS)
+    {
+        LOGF_ERROR("Failed to start the burst (%d).", ret);
+        stalled = true;
+    }
+
+    pthread_mutex_lock(&condMutex);
+    while (m_ThreadRequest == state && !stalled && received < frames)
+    {
+        pthread_mutex_unlock(&condMutex);
+
+        // Without a free buffer the frame is still read out, then dropped
+        size_t slot = m_BurstSlots.size();
+        uint8_t *buffer = m_BurstDiscard.data();
+        {
+            std::lock_guard<std::mutex> lock(m_BurstMutex);
+            if (!m_BurstFree.empty())
+            {
+                slot = m_BurstFree.front();
+                m_BurstFree.pop_front();
+                buffer = m_BurstSlots[slot].data();
+            }
+        }
+
+        uint32_t w, h, bpp, channels;
+        ret = GetQHYCCDLiveFrame(m_CameraHandle, &w, &h, &bpp, &channels, buffer);
+        double now = burstTimer.nsecsElapsed() / 1e6;
+
+        if (ret == QHYCCD_SUCCESS)
+        {
+            BurstFrame frame {slot, ++received, w * h * bpp / 8 * channels, now, now - lastArrival};
+            lastArrival = now;
+
+            BurstStatsN[BURST_RECEIVED].value = received;
+            if (received == 1)
+                BurstStatsN[BURST_FIRST].value = now;
+            else
+            {
+                m_BurstIntervalTotal += frame.interval;
+                BurstStatsN[BURST_INTERVAL].value = m_BurstIntervalTotal / (received - 1);
+                BurstStatsN[BURST_INTERVAL_MAX].value = std::max(BurstStatsN[BURST_INTERVAL_MAX].value, frame.interval);
+            }
+            LOGF_DEBUG("Burst frame %u of %u at %.3f ms, %.3f ms after the previous one%s.", received, frames, now,
+                       frame.interval, slot == m_BurstSlots.size() ? ", queue full, dropped" : "");
+
+            if (slot == m_BurstSlots.size())
+                BurstStatsN[BURST_DROPPED].value++;
+            else
+            {
+                std::lock_guard<std::mutex> lock(m_BurstMutex);
+                m_BurstReady.push_back(frame);
+                BurstStatsN[BURST_QUEUE_PEAK].value = std::max<double>(BurstStatsN[BURST_QUEUE_PEAK].value,
+                                                      m_BurstReady.size());
+                m_BurstCondition.notify_all();
+            }
+        }
+        else
+        {
+            if (slot < m_BurstSlots.size())
+            {
+                std::lock_guard<std::mutex> lock(m_BurstMutex);
+                m_BurstFree.push_front(slot);
+            }
+
+            // Frames the camera never sent count as dropped
+            if (now - lastArrival > timeout)
+            {
+                LOGF_WARN("Burst stalled after %u of %u frames.", received, frames);
+                BurstStatsN[BURST_DROPPED].value += frames - received;
+                stalled = true;
+            }
+            else
+                usleep(1000);
+        }
+
+        if (statsTimer.elapsed() >= BURST_STATS_MS)
+        {
+            publishBurstStats(IPS_BUSY);
+            statsTimer.start();
+        }
+
+        pthread_mutex_lock(&condMutex);
+    }
+    const bool aborted = m_ThreadRequest != state;
+    pthread_mutex_unlock(&condMutex);
+
+    // Let the publisher empty the queue, unless the burst was aborted
+    {
+        std::lock_guard<std::mutex> lock(m_BurstMutex);
+        m_BurstDone = true;
+        if (aborted)
+            m_BurstReady.clear();
+    }
+    m_BurstCondition.notify_all();
+    m_BurstPublisher.join();
+
+    EnableQHYCCDBurstMode(m_CameraHandle, false);
+    if (state == StateExposure)
+        StopQHYCCDLive(m_CameraHandle);
+
+    {
+        std::lock_guard<std::mutex> lock(m_BurstMutex);
+        m_BurstFree.clear();
+        m_BurstSlots.clear();
+        m_BurstDiscard.clear();
+    }
+
+    publishBurstStats(aborted || BurstStatsN[BURST_DROPPED].value > 0 ? IPS_ALERT : IPS_OK);
+    if (!aborted)
+        LOGF_INFO("Burst complete: %u of %u frames received, %.f dropped.", received, frames,
+                  BurstStatsN[BURST_DROPPED].value);
+
+    // An aborted burst is wrapped up by AbortExposure
+    if (state == StateExposure && !aborted)
+    {
+        m_BurstArmed = false;
+        InExposure = false;
+        if (received == 0)
+            PrimaryCCD.setExposureFailed();
+    }
+
+    pthread_mutex_lock(&condMutex);
+    if (state == StateExposure)
+        exposureSetRequest(StateIdle);
+    else
+    {
+        // The stream stays up without frames until it is stopped
+        while (m_ThreadRequest == StateStream)
+            pthread_cond_wait(&cv, &condMutex);
+    }
+}
+
+void QHYCCD::publishBurst(bool toStreamer)
+{
+    std::unique_lock<std::mutex> lock(m_BurstMutex);
+    while (true)
+    {
+        m_BurstCondition.wait(lock, [this]()
+        {
+            return !m_BurstReady.empty() || m_BurstDone;
+        });
+        if (m_BurstReady.empty())
+            break;
+
+        BurstFrame frame = m_BurstReady.front();
+        m_BurstReady.pop_front();
+        lock.unlock();
+
+        const uint8_t *data = m_BurstSlots[frame.slot].data();
+        if (toStreamer)
+            Streamer->newFrame(data, frame.size);
+        else
+        {
+            {
+                std::unique_lock<std::mutex> guard(ccdBufferLock);
+                memcpy(PrimaryCCD.getFrameBuffer(), data, std::min<size_t>(frame.size, PrimaryCCD.getFrameBufferSize()));
+            }
+            m_BurstFrame = frame;
+            PrimaryCCD.setExposureLeft(0);
+            ExposureComplete(&PrimaryCCD);
+        }
+
+        lock.lock();
+        m_BurstFree.push_back(frame.slot);
+    }
+}
+
+void QHYCCD::publishBurstStats(IPState state)
+{
+    BurstStatsNP.s = state;
+    IDSetNumber(&BurstStatsNP, nullptr);
+}
+
 /* Caller must hold the mutex */
 void QHYCCD::exposureSetRequest(ImageState request)
 {
@@ -2752,6 +3449,27 @@ void QHYCCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRe
         fitsKeywords.push_back({"AMPGLOW", IUFindOnSwitch(&AMPGlowSP)->label, "Mode"});
     }
 
+    if (m_BurstArmed && m_BurstFrame.index > 0)
+    {
+        fitsKeywords.push_back({"BURSTIDX", static_cast<int64_t>(m_BurstFrame.index), "Frame of the burst"});
+        fitsKeywords.push_back({"BURSTT", m_BurstFrame.arrival, 3, "Arrival after burst start (ms)"});
+        fitsKeywords.push_back({"BURSTDT", m_BurstFrame.interval, 3, "Time since previous burst frame (ms)"});
+
+        // Every frame of the burst answers the same request, date each from its arrival instead
+        double start = m_BurstStart.tv_sec + m_BurstStart.tv_usec / 1e6 + m_BurstFrame.arrival / 1000 - m_ExposureRequest;
+        time_t seconds = static_cast<time_t>(start);
+        char date[64], dateObs[80];
+        struct tm utc;
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", gmtime_r(&seconds, &utc));
+        snprintf(dateObs, sizeof(dateObs), "%s.%03d", date, static_cast<int>((start - seconds) * 1000));
+
+        for (auto &record : fitsKeywords)
+        {
+            if (record.key() == "DATE-OBS")
+                record = INDI::FITSRecord("DATE-OBS", dateObs, "UTC start date of observation");
+        }
+    }
+
     if (HasReadMode)
     {
         fitsKeywords.push_back({"READMODE", ReadModeN[0].value, 1, "Read Mode"});
@@ -2759,6 +3477,9 @@ void QHYCCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRe
 
     if (HasGPS)
     {
+        char ts[64] = {0};
+        decodeGPSHeader();
+
         // #1 Start
         // ## Flag
         fitsKeywords.push_back({"GPS_SFLG", GPSHeader.start_flag, "StartFlag"});
@@ -2767,7 +3488,8 @@ void QHYCCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRe
         // ## Microseconds
         fitsKeywords.push_back({"GPS_SU", GPSHeader.start_us, 3, "StartShutterMicroSeconds"});
         // ## Time
-        fitsKeywords.push_back({"GPS_ST", GPSDataStartT[GPS_DATA_START_TS].text, "StartShutterTime"});
+        formatGPSTime(GPSHeader.start_jd, GPSHeader.start_us, ts);
+        fitsKeywords.push_back({"GPS_ST", ts, "StartShutterTime"});
 
         // #2 End
         // ## Flag
@@ -2777,7 +3499,8 @@ void QHYCCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRe
         // ## Microseconds
         fitsKeywords.push_back({"GPS_EU", GPSHeader.end_us, 3, "EndShutterMicroSeconds"});
         // ## Time
-        fitsKeywords.push_back({"GPS_ET", GPSDataStartT[GPS_DATA_END_TS].text, "EndShutterTime"});
+        formatGPSTime(GPSHeader.end_jd, GPSHeader.end_us, ts);
+        fitsKeywords.push_back({"GPS_ET", ts, "EndShutterTime"});
 
         // #3 Now
         // ## Flag
@@ -2787,7 +3510,8 @@ void QHYCCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRe
         // ## Microseconds
         fitsKeywords.push_back({"GPS_NU", GPSHeader.now_us, 3, "NowShutterMicroSeconds"});
         // ## Time
-        fitsKeywords.push_back({"GPS_NT", GPSDataStartT[GPS_DATA_NOW_TS].text, "NowShutterTime"});
+        formatGPSTime(GPSHeader.now_jd, GPSHeader.now_us, ts);
+        fitsKeywords.push_back({"GPS_NT", ts, "NowShutterTime"});
 
         // PPS Counter
         fitsKeywords.push_back({"GPS_PPSC", GPSHeader.max_clock, "PPSCounter"});
@@ -2811,6 +3535,15 @@ void QHYCCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRe
 
         // Temperorary Sequence Number
         fitsKeywords.push_back({"GPS_TMP", GPSHeader.tempNumber, "Temporary Sequence Number"});
+
+        // Shutter times straight from the frame timestamp
+        if (GPSTimestampS[INDI_ENABLED].s == ISS_ON)
+        {
+            fitsKeywords.push_back({"GPS_SJD", GPSHeader.start_jd, 10, "Start Shutter Julian Date"});
+            fitsKeywords.push_back({"GPS_EJD", GPSHeader.end_jd, 10, "End Shutter Julian Date"});
+            fitsKeywords.push_back({"GPS_EXPT", (static_cast<double>(GPSFrameTime.end) - GPSFrameTime.start) / 1e6, 6,
+                                    "GPS Exposure Time (s)"});
+        }
     }
 
 }
@@ -2825,29 +3558,39 @@ void QHYCCD::setLEDStartPosNP(const INumberVectorProperty &value)
     GPSLEDStartPosNP = value;
 }
 
+void QHYCCD::captureGPSHeader(const uint8_t *frame)
+{
+    const uint8_t *gpsarray = GPSRawHeader.data;
+    memcpy(GPSRawHeader.data, frame, sizeof(GPSRawHeader.data));
+    GPSRawHeader.decoded = false;
+
+    // Only what is needed to timestamp the frame, the rest is decoded when used.
+    // It's a 10Mhz crystal so we divide by 10 to get microseconds
+    uint32_t start_sec = gpsarray[18] << 24 | gpsarray[19] << 16 | gpsarray[20] << 8 | gpsarray[21];
+    uint32_t start_ticks = gpsarray[22] << 16 | gpsarray[23] << 8 | gpsarray[24];
+    uint32_t end_sec = gpsarray[26] << 24 | gpsarray[27] << 16 | gpsarray[28] << 8 | gpsarray[29];
+    uint32_t end_ticks = gpsarray[30] << 16 | gpsarray[31] << 8 | gpsarray[32];
+
+    GPSFrameTime.seqNumber = gpsarray[0] << 24 | gpsarray[1] << 16 | gpsarray[2] << 8 | gpsarray[3];
+    GPSFrameTime.start = start_sec * 1000000ULL + start_ticks / 10 + QHY_SER_US_EPOCH;
+    GPSFrameTime.end = end_sec * 1000000ULL + end_ticks / 10 + QHY_SER_US_EPOCH;
+}
+
 void QHYCCD::decodeGPSHeader()
 {
-    char ts[64] = {0}, iso8601[64] = {0}, data[64] = {0};
+    if (GPSRawHeader.decoded)
+        return;
 
-    uint8_t gpsarray[64] = {0};
-    memcpy(gpsarray, PrimaryCCD.getFrameBuffer(), 64);
+    const uint8_t *gpsarray = GPSRawHeader.data;
+    GPSRawHeader.decoded = true;
 
     // Sequence Number
     GPSHeader.seqNumber = gpsarray[0] << 24 | gpsarray[1] << 16 | gpsarray[2] << 8 | gpsarray[3];
-    snprintf(data, 64, "%u", GPSHeader.seqNumber);
-    IUSaveText(&GPSDataHeaderT[GPS_DATA_SEQ_NUMBER], data);
-
     GPSHeader.tempNumber = gpsarray[4];
 
-    // Width
+    // Dimension
     GPSHeader.width = gpsarray[5] << 8 | gpsarray[6];
-    snprintf(data, 64, "%u", GPSHeader.width);
-    IUSaveText(&GPSDataHeaderT[GPS_DATA_WIDTH], data);
-
-    // Height
     GPSHeader.height = gpsarray[7] << 8 | gpsarray[8];
-    snprintf(data, 64, "%u", GPSHeader.height);
-    IUSaveText(&GPSDataHeaderT[GPS_DATA_HEIGHT], data);
 
     // Latitude
     uint32_t latitude = gpsarray[9] << 24 | gpsarray[10] << 16 | gpsarray[11] << 8 | gpsarray[12];
@@ -2855,8 +3598,6 @@ void QHYCCD::decodeGPSHeader()
     GPSHeader.latitude = (latitude % 1000000000) / 10000000;
     GPSHeader.latitude += (latitude % 10000000) / 6000000.0;
     GPSHeader.latitude *= latitude > 1000000000 ? -1.0 : 1.0;
-    snprintf(data, 64, "%f", GPSHeader.latitude);
-    IUSaveText(&GPSDataHeaderT[GPS_DATA_LATITUDE], data);
 
     // Longitude
     uint32_t longitude = gpsarray[13] << 24 | gpsarray[14] << 16 | gpsarray[15] << 8 | gpsarray[16];
@@ -2864,84 +3605,80 @@ void QHYCCD::decodeGPSHeader()
     GPSHeader.longitude = (longitude % 1000000000) / 1000000;
     GPSHeader.longitude += (longitude % 1000000) / 600000.0;
     GPSHeader.longitude *= longitude > 1000000000 ? -1.0 : 1.0;
+
+    // Start
+    // It's a 10Mhz crystal so we divide by 10 to get microseconds
+    GPSHeader.start_flag = gpsarray[17];
+    GPSHeader.start_sec = gpsarray[18] << 24 | gpsarray[19] << 16 | gpsarray[20] << 8 | gpsarray[21];
+    GPSHeader.start_us = (gpsarray[22] << 16 | gpsarray[23] << 8 | gpsarray[24]) / 10.0;
+    GPSHeader.start_jd = JStoJD(GPSHeader.start_sec, GPSHeader.start_us);
+
+    // End
+    GPSHeader.end_flag = gpsarray[25];
+    GPSHeader.end_sec = gpsarray[26] << 24 | gpsarray[27] << 16 | gpsarray[28] << 8 | gpsarray[29];
+    GPSHeader.end_us = (gpsarray[30] << 16 | gpsarray[31] << 8 | gpsarray[32]) / 10.0;
+    GPSHeader.end_jd = JStoJD(GPSHeader.end_sec, GPSHeader.end_us);
+
+    // Now
+    GPSHeader.now_flag = gpsarray[33];
+    GPSHeader.now_sec = gpsarray[34] << 24 | gpsarray[35] << 16 | gpsarray[36] << 8 | gpsarray[37];
+    GPSHeader.now_us = (gpsarray[38] << 16 | gpsarray[39] << 8 | gpsarray[40]) / 10.0;
+    GPSHeader.now_jd = JStoJD(GPSHeader.now_sec, GPSHeader.now_us);
+
+    // PPS
+    GPSHeader.max_clock = gpsarray[41] << 16 | gpsarray[42] << 8 | gpsarray[43];
+}
+
+void QHYCCD::publishGPSHeader()
+{
+    char ts[64] = {0}, data[64] = {0};
+
+    decodeGPSHeader();
+
+    // Header
+    snprintf(data, 64, "%u", GPSHeader.seqNumber);
+    IUSaveText(&GPSDataHeaderT[GPS_DATA_SEQ_NUMBER], data);
+    snprintf(data, 64, "%u", GPSHeader.width);
+    IUSaveText(&GPSDataHeaderT[GPS_DATA_WIDTH], data);
+    snprintf(data, 64, "%u", GPSHeader.height);
+    IUSaveText(&GPSDataHeaderT[GPS_DATA_HEIGHT], data);
+    snprintf(data, 64, "%f", GPSHeader.latitude);
+    IUSaveText(&GPSDataHeaderT[GPS_DATA_LATITUDE], data);
     snprintf(data, 64, "%f", GPSHeader.longitude);
     IUSaveText(&GPSDataHeaderT[GPS_DATA_LONGITUDE], data);
+    snprintf(data, 64, "%u", GPSHeader.max_clock);
+    IUSaveText(&GPSDataHeaderT[GPS_DATA_MAX_CLOCK], data);
 
-    // Start Flag
-    GPSHeader.start_flag = gpsarray[17];
+    // Start
     snprintf(data, 64, "%u", GPSHeader.start_flag);
     IUSaveText(&GPSDataStartT[GPS_DATA_START_FLAG], data);
-
-    // Start Seconds
-    GPSHeader.start_sec = gpsarray[18] << 24 | gpsarray[19] << 16 | gpsarray[20] << 8 | gpsarray[21];
     snprintf(data, 64, "%u", GPSHeader.start_sec);
     IUSaveText(&GPSDataStartT[GPS_DATA_START_SEC], data);
-
-    // Start microseconds
-    // It's a 10Mhz crystal so we divide by 10 to get microseconds
-    GPSHeader.start_us = (gpsarray[22] << 16 | gpsarray[23] << 8 | gpsarray[24]) / 10.0;
     snprintf(data, 64, "%.1f", GPSHeader.start_us);
     IUSaveText(&GPSDataStartT[GPS_DATA_START_USEC], data);
-
-    // Start JD
-    GPSHeader.start_jd = JStoJD(GPSHeader.start_sec, GPSHeader.start_us);
-    // Get ISO8601
-    JDtoISO8601(GPSHeader.start_jd, iso8601);
-    // Add millisecond
-    snprintf(ts, sizeof(ts), "%s.%03d", iso8601, static_cast<int>(GPSHeader.start_us / 1000.0));
+    formatGPSTime(GPSHeader.start_jd, GPSHeader.start_us, ts);
     IUSaveText(&GPSDataStartT[GPS_DATA_START_TS], ts);
 
-    // End Flag
-    GPSHeader.end_flag = gpsarray[25];
+    // End
     snprintf(data, 64, "%u", GPSHeader.end_flag);
     IUSaveText(&GPSDataEndT[GPS_DATA_END_FLAG], data);
-
-    // End Seconds
-    GPSHeader.end_sec = gpsarray[26] << 24 | gpsarray[27] << 16 | gpsarray[28] << 8 | gpsarray[29];
     snprintf(data, 64, "%u", GPSHeader.end_sec);
     IUSaveText(&GPSDataEndT[GPS_DATA_END_SEC], data);
-
-    // End Microseconds
-    GPSHeader.end_us = (gpsarray[30] << 16 | gpsarray[31] << 8 | gpsarray[32]) / 10.0;
     snprintf(data, 64, "%.1f", GPSHeader.end_us);
     IUSaveText(&GPSDataEndT[GPS_DATA_END_USEC], data);
-
-    // End JD
-    GPSHeader.end_jd = JStoJD(GPSHeader.end_sec, GPSHeader.end_us);
-    // Get ISO8601
-    JDtoISO8601(GPSHeader.end_jd, iso8601);
-    // Add millisecond
-    snprintf(ts, sizeof(ts), "%s.%03d", iso8601, static_cast<int>(GPSHeader.end_us / 1000.0));
+    formatGPSTime(GPSHeader.end_jd, GPSHeader.end_us, ts);
     IUSaveText(&GPSDataEndT[GPS_DATA_END_TS], ts);
 
-    // Now Flag
-    GPSHeader.now_flag = gpsarray[33];
+    // Now
     snprintf(data, 64, "%u", GPSHeader.now_flag);
     IUSaveText(&GPSDataNowT[GPS_DATA_NOW_FLAG], data);
-
-    // Now Seconds
-    GPSHeader.now_sec = gpsarray[34] << 24 | gpsarray[35] << 16 | gpsarray[36] << 8 | gpsarray[37];
     snprintf(data, 64, "%u", GPSHeader.now_sec);
     IUSaveText(&GPSDataNowT[GPS_DATA_NOW_SEC], data);
-
-    // Now microseconds
-    GPSHeader.now_us = (gpsarray[38] << 16 | gpsarray[39] << 8 | gpsarray[40]) / 10.0;
     snprintf(data, 64, "%.1f", GPSHeader.now_us);
     IUSaveText(&GPSDataNowT[GPS_DATA_NOW_USEC], data);
-
-    // Now JD
-    GPSHeader.now_jd = JStoJD(GPSHeader.now_sec, GPSHeader.now_us);
-    // Get ISO8601
-    JDtoISO8601(GPSHeader.now_jd, iso8601);
-    // Add millisecond
-    snprintf(ts, sizeof(ts), "%s.%03d", iso8601, static_cast<int>(GPSHeader.now_us / 1000.0));
+    formatGPSTime(GPSHeader.now_jd, GPSHeader.now_us, ts);
     IUSaveText(&GPSDataNowT[GPS_DATA_NOW_TS], ts);
 
-    // PPS
-    GPSHeader.max_clock = gpsarray[41] << 16 | gpsarray[42] << 8 | gpsarray[43];
-    snprintf(data, 64, "%u", GPSHeader.max_clock);
-    IUSaveText(&GPSDataHeaderT[GPS_DATA_MAX_CLOCK], data);
-
     IDSetText(&GPSDataHeaderTP, nullptr);
     IDSetText(&GPSDataStartTP, nullptr);
     IDSetText(&GPSDataEndTP, nullptr);
@@ -2961,6 +3698,15 @@ void QHYCCD::decodeGPSHeader()
     }
 }
 
+void QHYCCD::formatGPSTime(double JD, double us, char *ts)
+{
+    char iso8601[64] = {0};
+    // Get ISO8601
+    JDtoISO8601(JD, iso8601);
+    // Add millisecond
+    snprintf(ts, 64, "%s.%03d", iso8601, static_cast<int>(us / 1000.0));
+}
+
 double QHYCCD::JStoJD(uint32_t JS, double us)
 {
     // Convert Julian seconds (plus microsecond) to Julian Days since epoch 2450000
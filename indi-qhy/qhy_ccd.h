@@ -24,9 +24,16 @@
 #include <qhyccd.h>
 #include <indiccd.h>
 #include <indifilterinterface.h>
+#include <indielapsedtimer.h>
 #include <unistd.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <mutex>
 #include <pthread.h>
+#include <thread>
+#include <vector>
 
 #define DEVICE struct usb_device *
 
@@ -239,6 +246,19 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         ISwitchVectorProperty GPSControlSP;
         ISwitch GPSControlS[2];
 
+        // GPS header decoding
+        ISwitchVectorProperty GPSDecodeSP;
+        ISwitch GPSDecodeS[2];
+        enum
+        {
+            GPS_DECODE_EVERY_FRAME,     // format the GPS data properties for every frame
+            GPS_DECODE_ON_UPDATE,       // format them only when the properties are sent
+        };
+
+        // GPS frame timestamp in SER frames and FITS headers
+        ISwitchVectorProperty GPSTimestampSP;
+        ISwitch GPSTimestampS[2];
+
         // GPS Status
         ILightVectorProperty GPSStateLP;
         ILight GPSStateL[4];
@@ -289,6 +309,80 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
             GPS_DATA_NOW_TS,
         };
 
+        /////////////////////////////////////////////////////////////////////////////
+        /// Properties: Streaming Acquisition
+        /////////////////////////////////////////////////////////////////////////////
+        // Live frame acquisition mode
+        ISwitchVectorProperty StreamAcquisitionSP;
+        ISwitch StreamAcquisitionS[2];
+        enum
+        {
+            ACQUISITION_DIRECT,     // read live frames straight into the frame buffer, under lock
+            ACQUISITION_STAGED,     // read into a staging buffer and swap it in
+        };
+
+        // Live frame acquisition latency histogram (frames per bucket)
+        INumberVectorProperty StreamLatencyNP;
+        INumber StreamLatencyN[6];
+        enum
+        {
+            LATENCY_1MS,
+            LATENCY_2MS,
+            LATENCY_5MS,
+            LATENCY_10MS,
+            LATENCY_SLOW,
+            LATENCY_AVERAGE,
+        };
+
+        // Live frame retry histogram (frames per bucket)
+        INumberVectorProperty StreamRetriesNP;
+        INumber StreamRetriesN[5];
+        enum
+        {
+            RETRIES_NONE,
+            RETRIES_ONE,
+            RETRIES_FEW,
+            RETRIES_MANY,
+            RETRIES_FAILED,
+        };
+
+        /////////////////////////////////////////////////////////////////////////////
+        /// Properties: Burst Mode
+        /////////////////////////////////////////////////////////////////////////////
+        // Where the frames of a burst go
+        ISwitchVectorProperty BurstModeSP;
+        ISwitch BurstModeS[3];
+        enum
+        {
+            BURST_OFF,
+            BURST_IMAGES,   // an exposure captures the burst, every frame is sent as an image
+            BURST_STREAM,   // streaming captures the burst, frames go to the stream and recorder
+        };
+
+        // Frame range of the burst and queue depth
+        INumberVectorProperty BurstNP;
+        INumber BurstN[4];
+        enum
+        {
+            BURST_START_FRAME,
+            BURST_END_FRAME,
+            BURST_PATCH,
+            BURST_QUEUE,
+        };
+
+        // Frames and timing of the last burst
+        INumberVectorProperty BurstStatsNP;
+        INumber BurstStatsN[6];
+        enum
+        {
+            BURST_RECEIVED,
+            BURST_DROPPED,
+            BURST_FIRST,
+            BURST_INTERVAL,
+            BURST_INTERVAL_MAX,
+            BURST_QUEUE_PEAK,
+        };
+
 
     private:
         /////////////////////////////////////////////////////////////////////////////
@@ -373,6 +467,21 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
             GPSState gps_status = GPS_ON;
         } GPSHeader;
 
+        // Raw copy of the GPS header of the last frame, decoded into GPSHeader on demand
+        struct
+        {
+            uint8_t data[64] = {0};
+            bool decoded = true;
+        } GPSRawHeader;
+
+        // GPS shutter times of the last frame in microseconds since the SER epoch
+        struct
+        {
+            uint32_t seqNumber = 0;
+            uint64_t start = 0;
+            uint64_t end = 0;
+        } GPSFrameTime;
+
         struct
         {
             double latitude = 0;
@@ -392,6 +501,27 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         void getExposure();
         void exposureSetRequest(ImageState request);
         int grabImage();
+        // Switch to live mode with the current binning, ROI and exposure
+        bool setupLiveMode(double uSecs);
+
+        /////////////////////////////////////////////////////////////////////////////
+        /// Burst Capture
+        /////////////////////////////////////////////////////////////////////////////
+        // A frame of the burst waiting in the queue
+        struct BurstFrame
+        {
+            size_t slot;
+            uint32_t index;         // frame number within the burst, from 1
+            uint32_t size;
+            double arrival;         // ms since the burst was released
+            double interval;        // ms since the previous frame
+        };
+        // Allocate the queue and arm the camera, the burst starts in captureBurst
+        bool armBurst();
+        // Release the armed burst and read its frames into the queue, runs on the imaging thread
+        void captureBurst(ImageState state);
+        void publishBurst(bool toStreamer);
+        void publishBurstStats(IPState state);
 
         /////////////////////////////////////////////////////////////////////////////
         /// Cooling
@@ -414,8 +544,14 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         bool isQHY5PIIC();
         // Call when max filter count is known
         bool updateFilterProperties();
+        // Keep the GPS header of the frame and extract its shutter times, without any formatting
+        void captureGPSHeader(const uint8_t *frame);
         // Decode GPS Header
         void decodeGPSHeader();
+        // Format and send the GPS data properties
+        void publishGPSHeader();
+        // Format the time of a GPS header as ISO8601 with milliseconds
+        void formatGPSTime(double JD, double us, char *ts);
         /**
          * @brief JStoJD Convert Julian Second to Julian Date
          * @param JS Julian Second
@@ -438,11 +574,13 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         bool HasCoolerManualMode { false };
         bool HasReadMode { false };
         bool HasGPS { false };
+        INDI::ElapsedTimer m_GPSPublishTimer;
         bool HasHumidity { false };
         bool HasAmpGlow { false };
         //NEW CODE - Add support for overscan/calibration area
         bool HasOverscanArea { false };
         bool IgnoreOverscanArea { true };
+        bool HasBurstMode { false };
 
         /////////////////////////////////////////////////////////////////////////////
         /// Private Variables
@@ -489,6 +627,44 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         pthread_cond_t cv         = PTHREAD_COND_INITIALIZER;
         pthread_mutex_t condMutex = PTHREAD_MUTEX_INITIALIZER;
 
+        /////////////////////////////////////////////////////////////////////////////
+        /// Streaming
+        /////////////////////////////////////////////////////////////////////////////
+        // Poll GetQHYCCDLiveFrame until a frame is ready, at most 10 times.
+        uint32_t readLiveFrame(uint8_t *buffer, uint32_t &w, uint32_t &h, uint32_t &bpp, uint32_t &channels,
+                               uint32_t &retries);
+        // Make sure the staging buffer matches the frame buffer size.
+        bool allocateStagingBuffer();
+        void releaseStagingBuffer();
+        void resetStreamStats();
+        void recordStreamFrame(double latency, uint32_t retries, bool success);
+        void updateStreamStats();
+
+        // Staging buffer for live frames, swapped with the primary frame buffer once filled
+        uint8_t *m_StagingBuffer {nullptr};
+        int m_StagingBufferSize {0};
+        double m_StreamLatencyTotal {0};
+        uint64_t m_StreamLatencyFrames {0};
+
+        /////////////////////////////////////////////////////////////////////////////
+        /// Burst
+        /////////////////////////////////////////////////////////////////////////////
+        // The exposure or stream in progress captures a burst, cleared by the imaging thread without condMutex
+        std::atomic_bool m_BurstArmed {false};
+        // Preallocated frame buffers, the free ones and the frames waiting to be published
+        std::vector<std::vector<uint8_t>> m_BurstSlots;
+        std::vector<uint8_t> m_BurstDiscard;
+        std::deque<size_t> m_BurstFree;
+        std::deque<BurstFrame> m_BurstReady;
+        bool m_BurstDone {false};
+        std::mutex m_BurstMutex;
+        std::condition_variable m_BurstCondition;
+        std::thread m_BurstPublisher;
+        double m_BurstIntervalTotal {0};
+        // Frame being published as an image and when the burst was released, for the FITS header
+        BurstFrame m_BurstFrame {};
+        timeval m_BurstStart {0, 0};
+
         void logQHYMessages(const std::string &message);
         std::function<void(const std::string &)> m_QHYLogCallback;
 
@@ -497,5 +673,7 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         /////////////////////////////////////////////////////////////////////////////
         static constexpr const char * GPS_CONTROL_TAB = "GPS Control";
         static constexpr const char * GPS_DATA_TAB = "GPS Data";
+        static constexpr const char * STREAMING_TAB = "Streaming";
+        static constexpr const char * BURST_TAB = "Burst";
         static constexpr uint64_t QHY_SER_US_EPOCH = 62948880000000000; // offset to SER epoch January 1, 1 AD
 };
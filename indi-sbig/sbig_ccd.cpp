@@ -52,6 +52,8 @@
 #define MAX_DEVICES         20   /* Max device cameraCount */
 #define MAX_THREAD_RETRIES  3
 #define MAX_THREAD_WAIT     300000
+#define READOUT_BATCH_ROWS  16
+#define READOUT_FAILURE_LIMIT 8
 
 static class Loader
 {
@@ -289,6 +291,33 @@ SBIGCCD::SBIGCCD() : FilterInterface(this)
         strncpy(name, getDeviceName(), MAXINDINAME);
 
     setVersion(SBIG_VERSION_MAJOR, SBIG_VERSION_MINOR);
+
+    m_Readout.setCommands(
+    {
+        [this](StartReadoutParams * srp)
+        {
+            return StartReadout(srp);
+        },
+        [this](ReadoutLineParams * rlp, uint16_t *results, bool subtract)
+        {
+            return ReadoutLine(rlp, results, subtract);
+        },
+        [this](EndReadoutParams * erp)
+        {
+            return EndReadout(erp);
+        }
+    });
+    m_Readout.setBatchRows(READOUT_BATCH_ROWS);
+    m_Readout.setFailureLimit(READOUT_FAILURE_LIMIT);
+    m_Readout.setProgressCallback([this](const SBIGReadout::Stats & stats)
+    {
+        ReadoutN[READOUT_PROGRESS].value  = stats.rows > 0 ? 100.0 * stats.rowsDone / stats.rows : 0;
+        ReadoutN[READOUT_LINE_MEAN].value = stats.lineMeanMs;
+        ReadoutN[READOUT_LINE_MAX].value  = stats.lineMaxMs;
+        ReadoutN[READOUT_FAILED_ROWS].value = stats.rowsFailed;
+        ReadoutNP.s = stats.rowsDone < stats.rows ? IPS_BUSY : IPS_OK;
+        IDSetNumber(&ReadoutNP, nullptr);
+    });
 }
 
 //==========================================================================
@@ -383,6 +412,15 @@ bool SBIGCCD::initProperties()
     IUFillSwitchVector(&IgnoreErrorsSP, IgnoreErrorsS, 1, getDeviceName(), "CCD_IGNORE_ERRORS", "Ignore", OPTIONS_TAB, IP_RW,
                        ISR_NOFMANY, 0, IPS_OK);
 
+    // Readout progress and line latency
+    IUFillNumber(&ReadoutN[READOUT_PROGRESS], "READOUT_PROGRESS", "Progress (%)", "%.f", 0, 100, 0, 0);
+    IUFillNumber(&ReadoutN[READOUT_LINE_MEAN], "READOUT_LINE_MEAN", "Line mean (ms)", "%.3f", 0, 10000, 0, 0);
+    IUFillNumber(&ReadoutN[READOUT_LINE_MAX], "READOUT_LINE_MAX", "Line max (ms)", "%.3f", 0, 10000, 0, 0);
+    IUFillNumber(&ReadoutN[READOUT_RETRIES], "READOUT_RETRIES", "Retries", "%.f", 0, 10000, 0, 0);
+    IUFillNumber(&ReadoutN[READOUT_FAILED_ROWS], "READOUT_FAILED_ROWS", "Failed rows", "%.f", 0, 65535, 0, 0);
+    IUFillNumberVector(&ReadoutNP, ReadoutN, 5, getDeviceName(), "CCD_READOUT", "Readout", IMAGE_INFO_TAB, IP_RO, 0,
+                       IPS_IDLE);
+
     // CFW PRODUCT
     IUFillText(&FilterProdcutT[0], "NAME", "Name", "");
     IUFillText(&FilterProdcutT[1], "ID", "ID", "");
@@ -530,6 +568,7 @@ bool SBIGCCD::updateProperties()
             defineProperty(&CoolerNP);
         }
         defineProperty(&IgnoreErrorsSP);
+        defineProperty(&ReadoutNP);
         if (m_hasFilterWheel)
         {
             defineProperty(&FilterConnectionSP);
@@ -572,6 +611,7 @@ bool SBIGCCD::updateProperties()
             deleteProperty(CoolerNP.name);
         }
         deleteProperty(IgnoreErrorsSP.name);
+        deleteProperty(ReadoutNP.name);
 
         if (m_hasAO)
         {
@@ -1447,6 +1487,7 @@ bool SBIGCCD::grabImage(INDI::CCDChip *targetChip)
 
     LOGF_DEBUG("%s readout in progress...", targetChip == &PrimaryCCD ? "Primary camera" : "Guide head");
 
+    m_ReadoutFailedRows = 0;
     if (isSimulation())
     {
         uint8_t *image = targetChip->getFrameBuffer();
@@ -1462,11 +1503,15 @@ bool SBIGCCD::grabImage(INDI::CCDChip *targetChip)
     {
         uint16_t *buffer = reinterpret_cast<uint16_t *>(targetChip->getFrameBuffer());
         int res                = 0;
+        ReadoutN[READOUT_RETRIES].value = 0;
         for (int i = 0; i < MAX_THREAD_RETRIES; i++)
         {
+            // Only a readout that failed before the first line is tried again,
+            // once lines have been shifted out of the CCD they cannot be read twice
             res = readoutCCD(left, top, width, height, buffer, targetChip);
-            if (res == CE_NO_ERROR)
+            if (res == CE_NO_ERROR || m_Readout.stats().rowsDone > 0)
                 break;
+            ReadoutN[READOUT_RETRIES].value = i + 1;
             LOGF_DEBUG("Readout error, retrying...", res);
             usleep(MAX_THREAD_WAIT);
         }
@@ -1482,6 +1527,14 @@ bool SBIGCCD::grabImage(INDI::CCDChip *targetChip)
     return true;
 }
 
+void SBIGCCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRecord> &fitsKeywords)
+{
+    INDI::CCD::addFITSKeywords(targetChip, fitsKeywords);
+
+    if (m_ReadoutFailedRows > 0)
+        fitsKeywords.push_back({"BADROWS", static_cast<int64_t>(m_ReadoutFailedRows), "Rows filled from their neighbours"});
+}
+
 bool SBIGCCD::saveConfigItems(FILE *fp)
 {
     INDI::CCD::saveConfigItems(fp);
@@ -2638,7 +2691,7 @@ bool SBIGCCD::isExposureDone(INDI::CCDChip *targetChip)
 int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t height,
                         uint16_t *buffer, INDI::CCDChip *targetChip)
 {
-    int h, ccd, binning, res;
+    int ccd, binning, res;
     if (targetChip == &PrimaryCCD)
     {
         ccd = CCD_IMAGING;
@@ -2659,33 +2712,21 @@ int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t he
     srp.width       = width;
     srp.height      = height;
     std::unique_lock<std::mutex> guard(sbigLock);
-    res = StartReadout(&srp);
+    res = m_Readout.readout(srp, buffer);
+    guard.unlock();
+
+    SBIGReadout::Stats stats = m_Readout.stats();
+    m_ReadoutFailedRows = stats.rowsFailed;
     if (res != CE_NO_ERROR)
     {
-        LOGF_ERROR("%s readoutCCD - StartReadout error! (%s)",
-                   (targetChip == &PrimaryCCD) ? "Primary" : "Guide", GetErrorString(res));
-        guard.unlock();
-        return res;
-    }
-    ReadoutLineParams rlp;
-    rlp.ccd         = ccd;
-    rlp.readoutMode = binning;
-    rlp.pixelStart  = left;
-    rlp.pixelLength = width;
-    for (h = 0; h < height; h++)
-    {
-        ReadoutLine(&rlp, buffer + (h * width), false);
-    }
-    EndReadoutParams erp;
-    erp.ccd = ccd;
-    if ((res = EndReadout(&erp)) != CE_NO_ERROR)
-    {
-        LOGF_ERROR("%s readoutCCD - EndReadout error! (%s)",
-                   (targetChip == &PrimaryCCD) ? "Primary" : "Guide", GetErrorString(res));
-        guard.unlock();
+        LOGF_ERROR("%s readoutCCD - readout failed at row %d of %d! (%s)", (targetChip == &PrimaryCCD) ? "Primary" : "Guide",
+                   stats.rowsDone, height, GetErrorString(res));
         return res;
     }
-    guard.unlock();
+    if (stats.rowsFailed > 0)
+        LOGF_WARN("%d of %d rows could not be read and were filled from their neighbours.", stats.rowsFailed, height);
+    LOGF_DEBUG("Read %d rows in %.3f seconds, line mean %.3f ms, max %.3f ms.", stats.rowsDone, stats.elapsed,
+               stats.lineMeanMs, stats.lineMaxMs);
     return res;
 }
 
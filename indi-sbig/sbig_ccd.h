@@ -37,6 +37,8 @@
 #include <sbigudrv.h>
 #endif
 
+#include "sbig_readout.h"
+
 #include <string>
 
 #define DEVICE struct usb_device *
@@ -163,6 +165,7 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         virtual int SetTemperature(double temperature) override;
 
 
+        virtual void addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRecord> &fitsKeywords) override;
         virtual bool saveConfigItems(FILE *fp) override;
 
         virtual bool UpdateGuiderFrame(int x, int y, int w, int h) override;
@@ -251,6 +254,20 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         ISwitch IgnoreErrorsS[1];
         ISwitchVectorProperty IgnoreErrorsSP;
 
+        /////////////////////////////////////////////////////////////////////////////
+        /// Readout Properties
+        /////////////////////////////////////////////////////////////////////////////
+        INumber ReadoutN[5];
+        INumberVectorProperty ReadoutNP;
+        enum
+        {
+            READOUT_PROGRESS,
+            READOUT_LINE_MEAN,
+            READOUT_LINE_MAX,
+            READOUT_RETRIES,
+            READOUT_FAILED_ROWS,
+        };
+
         /////////////////////////////////////////////////////////////////////////////
         /// Filter Wheel Properties
         /////////////////////////////////////////////////////////////////////////////
@@ -277,6 +294,8 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         /// Threading Variables
         /////////////////////////////////////////////////////////////////////////////
         std::mutex sbigLock;
+        SBIGReadout m_Readout;
+        int m_ReadoutFailedRows { 0 };
 
         /////////////////////////////////////////////////////////////////////////////
         /// Exposure Variables
@@ -0,0 +1,123 @@
+/*
+    SBIG universal driver stand-in for the readout benchmark
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja AT ikarustech DOT com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "sbig_mock_udrv.h"
+
+#ifdef __APPLE__
+#include <libsbig/sbigudrv.h>
+#else
+#include <sbigudrv.h>
+#endif
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+std::mutex mockLock;
+SBIGMock::Config mockConfig;
+SBIGMock::Counters mockCounters;
+
+bool inReadout = false;
+uint32_t nextRow = 0;
+uint32_t lastRow = 0;
+uint32_t burstLeft = 0;
+}
+
+void SBIGMock::configure(const Config &config)
+{
+    std::lock_guard<std::mutex> lock(mockLock);
+    mockConfig   = config;
+    mockCounters = Counters();
+    inReadout    = false;
+    burstLeft    = 0;
+}
+
+SBIGMock::Counters SBIGMock::counters()
+{
+    std::lock_guard<std::mutex> lock(mockLock);
+    return mockCounters;
+}
+
+short SBIGUnivDrvCommand(short command, void *Params, void *pResults)
+{
+    std::unique_lock<std::mutex> lock(mockLock);
+
+    switch (command)
+    {
+        case CC_START_READOUT:
+        {
+            const StartReadoutParams *srp = static_cast<const StartReadoutParams *>(Params);
+            mockCounters.startReadouts++;
+            inReadout = true;
+            nextRow   = srp->top;
+            lastRow   = srp->top + srp->height;
+            return CE_NO_ERROR;
+        }
+
+        case CC_END_READOUT:
+            mockCounters.endReadouts++;
+            inReadout = false;
+            return CE_NO_ERROR;
+
+        case CC_READOUT_LINE:
+        case CC_READ_SUBTRACT_LINE:
+        {
+            const ReadoutLineParams *rlp = static_cast<const ReadoutLineParams *>(Params);
+            uint16_t *line = static_cast<uint16_t *>(pResults);
+            const SBIGMock::Config config = mockConfig;
+            const uint32_t request = mockCounters.lineRequests++;
+
+            if (!inReadout || nextRow >= lastRow)
+                return CE_BAD_PARAMETER;
+
+            if (burstLeft == 0 && config.failEvery > 0 && request >= config.failAfter &&
+                    (request - config.failAfter) % config.failEvery == 0)
+                burstLeft = config.failBurst;
+
+            // A failed request still shifts the line out of the CCD, its pixels are lost
+            const bool fail = burstLeft > 0;
+            if (fail)
+                burstLeft--;
+            else
+            {
+                for (uint32_t x = 0; x < rlp->pixelLength; x++)
+                    line[x] = SBIGMock::expectedPixel(rlp->pixelStart + x, nextRow);
+            }
+            nextRow++;
+
+            lock.unlock();
+            std::this_thread::sleep_for(std::chrono::nanoseconds(
+                                            config.lineMicros * 1000ull + static_cast<uint64_t>(config.pixelNanos) * rlp->pixelLength));
+
+            if (fail)
+            {
+                std::lock_guard<std::mutex> guard(mockLock);
+                mockCounters.failures++;
+                return CE_RX_TIMEOUT;
+            }
+            return CE_NO_ERROR;
+        }
+
+        default:
+            return CE_NO_ERROR;
+    }
+}
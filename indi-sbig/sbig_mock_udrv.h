@@ -0,0 +1,62 @@
+/*
+    SBIG universal driver stand-in for the readout benchmark
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja AT ikarustech DOT com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Stand-in for the readout commands of the SBIG universal driver, linked instead of libsbig
+ * to benchmark the readout without a camera.
+ *
+ * The simulated CCD has a deterministic image, pixel(x, y) = expectedPixel(x, y) in binned
+ * coordinates, and every CC_READOUT_LINE takes lineMicros. Failures can be injected: from
+ * the failAfter-th line request on, every failEvery-th line fails failBurst times in a row.
+ * A failed request loses the line, the next request returns the line after it.
+ */
+namespace SBIGMock
+{
+
+struct Config
+{
+    uint32_t lineMicros { 0 };
+    uint32_t pixelNanos { 0 };     // added per pixel of a line
+    uint32_t failAfter { 0 };
+    uint32_t failEvery { 0 };      // 0 never fails
+    uint32_t failBurst { 1 };
+};
+
+struct Counters
+{
+    uint32_t startReadouts { 0 };
+    uint32_t endReadouts { 0 };
+    uint32_t lineRequests { 0 };
+    uint32_t failures { 0 };
+};
+
+void configure(const Config &config);
+Counters counters();
+
+inline uint16_t expectedPixel(uint32_t x, uint32_t y)
+{
+    return static_cast<uint16_t>(x * 7 + y * 131 + (x ^ y));
+}
+
+}
@@ -0,0 +1,241 @@
+/*
+    SBIG CCD Camera INDI Driver frame readout
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja AT ikarustech DOT com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "sbig_readout.h"
+
+#include <algorithm>
+
+SBIGReadout::SBIGReadout()
+{
+    mWorker = std::thread(&SBIGReadout::workerLoop, this);
+}
+
+SBIGReadout::~SBIGReadout()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTerminate = true;
+    }
+    mCondition.notify_all();
+    mWorker.join();
+}
+
+void SBIGReadout::setCommands(Commands commands)
+{
+    mCommands = std::move(commands);
+}
+
+void SBIGReadout::setBatchRows(uint16_t rows)
+{
+    mBatchRows = std::max<uint16_t>(1, rows);
+}
+
+void SBIGReadout::setFailureLimit(uint16_t lines)
+{
+    mFailureLimit = std::max<uint16_t>(1, lines);
+}
+
+void SBIGReadout::setProgressCallback(ProgressCallback callback)
+{
+    mProgressCallback = std::move(callback);
+}
+
+SBIGReadout::Stats SBIGReadout::stats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+std::vector<uint16_t> SBIGReadout::failedRows() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFailedRows;
+}
+
+int SBIGReadout::readLine(ReadoutLineParams &rlp, uint16_t row, bool subtract)
+{
+    auto start = std::chrono::steady_clock::now();
+    int res = mCommands.readoutLine(&rlp, mBuffer + static_cast<size_t>(row) * mWidth, subtract);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.rowsDone++;
+    if (res != CE_NO_ERROR)
+    {
+        mStats.rowsFailed++;
+        mFailedRows.push_back(row);
+        return res;
+    }
+
+    mLineTotalMs += ms;
+    mStats.lineMeanMs = mLineTotalMs / (mStats.rowsDone - mStats.rowsFailed);
+    mStats.lineMaxMs  = std::max(mStats.lineMaxMs, ms);
+    return res;
+}
+
+int SBIGReadout::readout(const StartReadoutParams &params, uint16_t *buffer, bool subtract)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats      = Stats();
+        mStats.rows = params.height;
+        mFailedRows.clear();
+        mRepaired = 0;
+    }
+    mBuffer      = buffer;
+    mWidth       = params.width;
+    mLineTotalMs = 0;
+    mStart       = std::chrono::steady_clock::now();
+
+    if (!mCommands.startReadout || !mCommands.readoutLine || !mCommands.endReadout)
+        return CE_DRIVER_NOT_OPEN;
+
+    ReadoutLineParams rlp;
+    rlp.ccd         = params.ccd;
+    rlp.readoutMode = params.readoutMode;
+    rlp.pixelStart  = params.left;
+    rlp.pixelLength = params.width;
+
+    StartReadoutParams srp = params;
+    int res = mCommands.startReadout(&srp);
+    if (res != CE_NO_ERROR)
+        return res;
+
+    uint16_t row = 0, failures = 0;
+    while (res == CE_NO_ERROR && row < params.height)
+    {
+        const uint16_t last = std::min<int>(params.height, row + mBatchRows);
+
+        for (; row < last; row++)
+        {
+            int lineRes = readLine(rlp, row, subtract);
+            if (lineRes == CE_NO_ERROR)
+                failures = 0;
+            else if (++failures >= mFailureLimit)
+            {
+                res = lineRes;
+                break;
+            }
+        }
+
+        post();
+    }
+
+    EndReadoutParams erp;
+    erp.ccd = params.ccd;
+    int endRes = mCommands.endReadout(&erp);
+    if (res == CE_NO_ERROR)
+        res = endRes;
+
+    drain();
+    return res;
+}
+
+/* Fill the failed rows of the rows read so far with the mean of the rows above and below
+ * them. A run of failed rows waits for the row after it, unless it ends the frame. Runs on
+ * the worker thread, the rows it touches are not written by the readout anymore. */
+void SBIGReadout::repairRows(uint16_t rowsDone)
+{
+    std::vector<uint16_t> failed;
+    uint16_t rows;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        failed.assign(mFailedRows.begin() + mRepaired, mFailedRows.end());
+        rows = mStats.rows;
+    }
+
+    size_t repaired = 0;
+    while (repaired < failed.size())
+    {
+        size_t end = repaired + 1;
+        while (end < failed.size() && failed[end] == failed[end - 1] + 1)
+            end++;
+
+        const uint16_t first = failed[repaired], next = failed[end - 1] + 1;
+        if (next >= rowsDone && rowsDone < rows)
+            break;
+
+        const uint16_t *above = first > 0 ? mBuffer + static_cast<size_t>(first - 1) * mWidth : nullptr;
+        const uint16_t *below = next < rows ? mBuffer + static_cast<size_t>(next) * mWidth : nullptr;
+        for (uint16_t row = first; row < next; row++)
+        {
+            uint16_t *line = mBuffer + static_cast<size_t>(row) * mWidth;
+            for (uint16_t x = 0; x < mWidth; x++)
+            {
+                if (above && below)
+                    line[x] = (above[x] + below[x] + 1) / 2;
+                else
+                    line[x] = above ? above[x] : (below ? below[x] : 0);
+            }
+        }
+        repaired = end;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRepaired += repaired;
+}
+
+void SBIGReadout::post()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+        mQueue.push_back(mStats);
+    }
+    mCondition.notify_all();
+}
+
+void SBIGReadout::drain()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]()
+    {
+        return mQueue.empty() && !mBusy;
+    });
+}
+
+void SBIGReadout::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mCondition.wait(lock, [this]()
+        {
+            return mTerminate || !mQueue.empty();
+        });
+        if (mQueue.empty())
+            break;
+
+        Stats stats = mQueue.front();
+        mQueue.pop_front();
+        mBusy = true;
+        lock.unlock();
+
+        if (stats.rowsFailed > 0)
+            repairRows(stats.rowsDone);
+
+        if (mProgressCallback)
+            mProgressCallback(stats);
+
+        lock.lock();
+        mBusy = false;
+        mCondition.notify_all();
+    }
+}
@@ -0,0 +1,134 @@
+/*
+    SBIG CCD Camera INDI Driver frame readout
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja AT ikarustech DOT com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#ifdef __APPLE__
+#include <libsbig/sbigudrv.h>
+#else
+#include <sbigudrv.h>
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Reads a frame out of an SBIG camera through the universal driver.
+ *
+ * The universal driver only digitizes one line per command, so the rows are requested in
+ * batches of back to back CC_READOUT_LINE commands. The commands go through the camera's
+ * wrappers, which select its driver handle. While the next batch is being requested, a worker
+ * thread repairs the failed rows of the batches read so far and reports the progress.
+ *
+ * A failed line request still shifts the line out of the CCD, so the line is not requested
+ * again. The readout resumes with the next line, which keeps every other row in place, and
+ * the failed row is filled from the rows above and below it and listed in failedRows(). Only
+ * failureLimit consecutive failures, a camera that stopped answering, end the readout with
+ * an error.
+ */
+class SBIGReadout
+{
+    public:
+        struct Stats
+        {
+            uint16_t rows { 0 };          // rows in the frame
+            uint16_t rowsDone { 0 };      // rows requested so far, including the failed ones
+            uint16_t rowsFailed { 0 };    // rows that could not be read
+            double lineMeanMs { 0 };      // mean time of a successful line request
+            double lineMaxMs { 0 };       // slowest successful line request
+            double elapsed { 0 };         // seconds since the readout started
+        };
+
+        /** Universal driver commands of the camera, each returns CE_NO_ERROR or the error */
+        struct Commands
+        {
+            std::function<int(StartReadoutParams *srp)> startReadout;
+            std::function<int(ReadoutLineParams *rlp, uint16_t *results, bool subtract)> readoutLine;
+            std::function<int(EndReadoutParams *erp)> endReadout;
+        };
+
+        /** Called on the worker thread after every batch */
+        using ProgressCallback = std::function<void(const Stats &stats)>;
+
+        SBIGReadout();
+        ~SBIGReadout();
+
+        SBIGReadout(const SBIGReadout &) = delete;
+        SBIGReadout &operator=(const SBIGReadout &) = delete;
+
+        void setCommands(Commands commands);
+
+        /** Rows requested before the worker reports the progress, 1 or more */
+        void setBatchRows(uint16_t rows);
+
+        /** Consecutive line failures that end the readout, 1 or more */
+        void setFailureLimit(uint16_t lines);
+
+        void setProgressCallback(ProgressCallback callback);
+
+        /**
+         * @brief Read a frame, the worker is done with it when this returns.
+         * @param params window and binning, as for CC_START_READOUT
+         * @param buffer params.width * params.height pixels
+         * @param subtract use CC_READ_SUBTRACT_LINE instead of CC_READOUT_LINE
+         * @return CE_NO_ERROR, also with repaired rows, or the error of the command that ended the readout
+         */
+        int readout(const StartReadoutParams &params, uint16_t *buffer, bool subtract = false);
+
+        /** @return statistics of the current or last readout */
+        Stats stats() const;
+
+        /** @return rows of the last readout that could not be read, in order */
+        std::vector<uint16_t> failedRows() const;
+
+    private:
+        int readLine(ReadoutLineParams &rlp, uint16_t row, bool subtract);
+        void repairRows(uint16_t rowsDone);
+        void post();
+        void drain();
+        void workerLoop();
+
+        Commands mCommands;
+        uint16_t mBatchRows { 16 };
+        uint16_t mFailureLimit { 8 };
+
+        ProgressCallback mProgressCallback;
+
+        uint16_t *mBuffer { nullptr };
+        uint16_t mWidth { 0 };
+        double mLineTotalMs { 0 };
+        std::chrono::steady_clock::time_point mStart;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::deque<Stats> mQueue;
+        Stats mStats;
+        std::vector<uint16_t> mFailedRows;
+        size_t mRepaired { 0 };         // failed rows the worker has filled in
+        bool mBusy { false };
+        bool mTerminate { false };
+        std::thread mWorker;
+};
@@ -0,0 +1,245 @@
+/*
+    SBIG CCD Camera INDI Driver readout benchmark
+
+    Copyright (C) 2026 Jasem Mutlaq (mutlaqja AT ikarustech DOT com)
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Benchmark of SBIGReadout against the line by line loop SBIGCCD::readoutCCD used before,
+    both running on the mock universal driver. Every batch of rows is followed by some post
+    processing, like publishing the progress to a slow client, which the old loop has to do in
+    line and SBIGReadout does while the next batch is read. Frames are checked pixel by pixel:
+    with failing lines the old loop delivers bad rows unnoticed, SBIGReadout has to list every
+    failed line in failedRows(), fill it from its neighbours and keep all other rows intact.
+    A camera that stops answering has to end the SBIGReadout readout with an error.
+
+    Usage: sbig_readout_bench [width] [height] [line us] [post us per batch]
+*/
+
+#include "sbig_readout.h"
+#include "sbig_mock_udrv.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#define BATCH_ROWS 16
+#define FAILURE_LIMIT 8
+
+struct Scenario
+{
+    const char *name;
+    SBIGMock::Config config;
+};
+
+struct Result
+{
+    double ms;
+    double lineMaxMs;
+    uint32_t lineRequests;
+    int res;
+    size_t badRows;
+    size_t failedRows;
+    size_t unrepairedRows;
+};
+
+static bool isFailed(const std::vector<uint16_t> &failedRows, uint32_t y)
+{
+    return std::find(failedRows.begin(), failedRows.end(), y) != failedRows.end();
+}
+
+// Rows that are wrong and not listed as failed
+static size_t badRows(const std::vector<uint16_t> &frame, const StartReadoutParams &srp,
+                      const std::vector<uint16_t> &failedRows)
+{
+    size_t bad = 0;
+    for (uint32_t y = 0; y < srp.height; y++)
+    {
+        if (isFailed(failedRows, y))
+            continue;
+        for (uint32_t x = 0; x < srp.width; x++)
+        {
+            if (frame[y * srp.width + x] != SBIGMock::expectedPixel(srp.left + x, srp.top + y))
+            {
+                bad++;
+                break;
+            }
+        }
+    }
+    return bad;
+}
+
+// Single failed rows between two good ones that are not the mean of their neighbours
+static size_t unrepairedRows(const std::vector<uint16_t> &frame, const StartReadoutParams &srp,
+                             const std::vector<uint16_t> &failedRows)
+{
+    size_t bad = 0;
+    for (uint16_t y : failedRows)
+    {
+        if (y == 0 || y + 1 >= srp.height || isFailed(failedRows, y - 1) || isFailed(failedRows, y + 1))
+            continue;
+        const uint16_t *above = &frame[(y - 1) * srp.width], *line = &frame[y * srp.width], *below = &frame[(y + 1) * srp.width];
+        for (uint32_t x = 0; x < srp.width; x++)
+        {
+            if (line[x] != (above[x] + below[x] + 1) / 2)
+            {
+                bad++;
+                break;
+            }
+        }
+    }
+    return bad;
+}
+
+// SBIGCCD::readoutCCD before SBIGReadout, with the whole readout retried by grabImage
+static int legacyReadout(const StartReadoutParams &srp, uint16_t *buffer, uint32_t postMicros, double &lineMaxMs)
+{
+    int res = CE_NO_ERROR;
+    for (int i = 0; i < 3; i++)
+    {
+        StartReadoutParams params = srp;
+        if ((res = SBIGUnivDrvCommand(CC_START_READOUT, &params, nullptr)) == CE_NO_ERROR)
+        {
+            ReadoutLineParams rlp;
+            rlp.ccd         = srp.ccd;
+            rlp.readoutMode = srp.readoutMode;
+            rlp.pixelStart  = srp.left;
+            rlp.pixelLength = srp.width;
+            for (int h = 0; h < srp.height; h++)
+            {
+                auto start = std::chrono::steady_clock::now();
+                SBIGUnivDrvCommand(CC_READOUT_LINE, &rlp, buffer + (h * srp.width));
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                lineMaxMs = std::max(lineMaxMs, ms);
+
+                if ((h + 1) % BATCH_ROWS == 0 || h + 1 == srp.height)
+                    std::this_thread::sleep_for(std::chrono::microseconds(postMicros));
+            }
+            EndReadoutParams erp;
+            erp.ccd = srp.ccd;
+            res = SBIGUnivDrvCommand(CC_END_READOUT, &erp, nullptr);
+        }
+        if (res == CE_NO_ERROR)
+            break;
+        std::this_thread::sleep_for(std::chrono::microseconds(300000));
+    }
+    return res;
+}
+
+static Result run(bool legacy, const Scenario &scenario, const StartReadoutParams &srp, uint32_t postMicros)
+{
+    std::vector<uint16_t> frame(static_cast<size_t>(srp.width) * srp.height, 0);
+    Result result = {};
+    std::vector<uint16_t> failedRows;
+
+    SBIGMock::configure(scenario.config);
+    auto start = std::chrono::steady_clock::now();
+
+    if (legacy)
+    {
+        result.res = legacyReadout(srp, frame.data(), postMicros, result.lineMaxMs);
+    }
+    else
+    {
+        SBIGReadout readout;
+        readout.setCommands(
+        {
+            [](StartReadoutParams * params)
+            {
+                return SBIGUnivDrvCommand(CC_START_READOUT, params, nullptr);
+            },
+            [](ReadoutLineParams * rlp, uint16_t *results, bool subtract)
+            {
+                return SBIGUnivDrvCommand(subtract ? CC_READ_SUBTRACT_LINE : CC_READOUT_LINE, rlp, results);
+            },
+            [](EndReadoutParams * erp)
+            {
+                return SBIGUnivDrvCommand(CC_END_READOUT, erp, nullptr);
+            }
+        });
+        readout.setBatchRows(BATCH_ROWS);
+        readout.setFailureLimit(FAILURE_LIMIT);
+        readout.setProgressCallback([postMicros](const SBIGReadout::Stats &)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(postMicros));
+        });
+        result.res       = readout.readout(srp, frame.data());
+        result.lineMaxMs = readout.stats().lineMaxMs;
+        failedRows       = readout.failedRows();
+    }
+
+    result.ms           = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.lineRequests = SBIGMock::counters().lineRequests;
+    result.badRows      = badRows(frame, srp, failedRows);
+    result.failedRows   = failedRows.size();
+    result.unrepairedRows = unrepairedRows(frame, srp, failedRows);
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    StartReadoutParams srp;
+    srp.ccd         = CCD_IMAGING;
+    srp.readoutMode = RM_1X1;
+    srp.left        = 16;
+    srp.top         = 8;
+    srp.width       = argc > 1 ? atoi(argv[1]) : 2048;
+    srp.height      = argc > 2 ? atoi(argv[2]) : 512;
+
+    const uint32_t lineMicros = argc > 3 ? atoi(argv[3]) : 100;
+    const uint32_t postMicros = argc > 4 ? atoi(argv[4]) : 1500;
+
+    const Scenario scenarios[] =
+    {
+        {"clean", {lineMicros, 0, 0, 0, 1}},
+        {"1/200 fail", {lineMicros, 0, 50, 200, 1}},
+        {"burst fail", {lineMicros, 0, 100, 250, 4}},
+        {"dead", {lineMicros, 0, 100, 100000, 100000}},
+    };
+
+    printf("%u x %u frame, %u us per line, %u us post processing per %d rows\n\n", srp.width, srp.height, lineMicros,
+           postMicros, BATCH_ROWS);
+    printf("%-11s %-8s %9s %9s %10s %8s %6s %6s %s\n", "scenario", "readout", "total ms", "ms/row", "max row ms", "lines",
+           "bad", "failed", "result");
+
+    bool failed = false;
+    for (const Scenario &scenario : scenarios)
+    {
+        for (const bool legacy : {true, false})
+        {
+            Result r = run(legacy, scenario, srp, postMicros);
+            const uint32_t failures = SBIGMock::counters().failures;
+            printf("%-11s %-8s %9.1f %9.3f %10.3f %8u %6zu %6zu %s\n", scenario.name, legacy ? "legacy" : "batched", r.ms,
+                   r.ms / srp.height, r.lineMaxMs, r.lineRequests, r.badRows, r.failedRows,
+                   r.res != CE_NO_ERROR ? "error" : "ok");
+
+            if (legacy)
+                continue;
+
+            // Every failed line is flagged and repaired, every other row is intact
+            if (r.failedRows != failures || r.unrepairedRows > 0 || (r.res == CE_NO_ERROR && r.badRows > 0))
+                failed = true;
+
+            // Only a camera that stopped answering fails the frame
+            if ((r.res != CE_NO_ERROR) != (scenario.config.failBurst >= FAILURE_LIMIT))
+                failed = true;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
@@ -23,6 +23,7 @@
 
 #include "svbony_base.h"
 #include "svbony_helpers.h"
+#include "pixel_convert.h"
 
 #include "config.h"
 
@@ -141,8 +142,7 @@ void SVBONYBase::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
             if (Helpers::isRGB(mCurrentVideoFormat))
             {
                 int nChannels = Helpers::getNChannels(mCurrentVideoFormat);
-                for (uint32_t i = 0; i < totalBytes; i += nChannels)
-                    std::swap(targetFrame[i], targetFrame[i + 2]); // swap R and B channel.
+                PixelConvert::swapRedBlue(targetFrame, totalBytes / nChannels, nChannels, 1);
             }
 
             Streamer->newFrame(targetFrame, totalBytes);
@@ -238,15 +238,19 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
     int nChannels = Helpers::getNChannels(type);
     size_t nTotalBytes = subW * subH * nChannels * (PrimaryCCD.getBPP() / 8);
 
+    ScratchBuffer scratch;
     if (Helpers::isRGB(type))
     {
-        buffer = static_cast<uint8_t *>(malloc(nTotalBytes));
-        if (buffer == nullptr)
+        scratch = mScratchPool.acquire(nTotalBytes);
+        if (!scratch)
         {
-            LOGF_ERROR("%s: %d malloc failed (RGB 24/32).", getDeviceName(), nTotalBytes);
+            LOGF_ERROR("%s: %zu bytes scratch buffer allocation failed (RGB 24/32).", getDeviceName(), nTotalBytes);
             guard.unlock();
             return;
         }
+        buffer = scratch.data();
+        LOGF_DEBUG("Scratch buffers: %zu bytes mapped, peak %zu bytes.", mScratchPool.allocatedBytes(),
+                   mScratchPool.highWaterMark());
     }
 
     /*
@@ -259,8 +263,6 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
         {
             ret = SVBGetVideoData(mCameraInfo.CameraID, buffer, nTotalBytes,  1000);
             LOGF_DEBUG("Discard unretrieved exposure data: SVBGetVideoData(%s)", Helpers::toString(ret));
-            if (Helpers::isRGB(type))
-                free(buffer);
             guard.unlock();
             PrimaryCCD.setExposureLeft(0);
             return;
@@ -296,38 +298,9 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
                 case SVB_SUCCESS:
                     if (Helpers::isRGB(type))
                     {
-                        uint8_t *dstR = image;
-                        uint8_t *dstG = image + subW * subH;
-                        uint8_t *dstB = image + subW * subH * 2;
-
-                        const uint8_t *src = buffer;
-
-                        /*
-                            To optimize execution speed, RGB32 and RGB24 are discriminated outside of while loop.
-                        */
-                        if (type == SVB_IMG_RGB32)
-                        {
-                            const uint8_t *end = buffer + subW * subH * 4;
-                            uint8_t *dstA = image + subW * subH * 3; // Alpha channel destination address
-                            while (src != end)
-                            {
-                                *dstB++ = *src++;
-                                *dstG++ = *src++;
-                                *dstR++ = *src++;
-                                *dstA++ = *src++;
-                            }
-                        }
-                        else
-                        {
-                            const uint8_t *end = buffer + subW * subH * 3;
-                            while (src != end)
-                            {
-                                *dstB++ = *src++;
-                                *dstG++ = *src++;
-                                *dstR++ = *src++;
-                            }
-                        }
-                        free(buffer);
+                        // BGR(A) to R, G, B (and A) planes
+                        PixelConvert::interleavedToPlanar(buffer, image, subW * subH, nChannels, 1, PixelConvert::ORDER_BGR);
+                        scratch.reset();
                     }
                     guard.unlock();
                     sendImage(type, duration);
@@ -350,8 +323,6 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
                     }
                 //fall through
                 default: // Cannot continue to retrive image data when ret is any error except timeout.
-                    if (Helpers::isRGB(type))
-                        free(buffer);
                     guard.unlock();
                     PrimaryCCD.setExposureLeft(0);
                     PrimaryCCD.setExposureFailed();
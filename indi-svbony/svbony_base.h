@@ -29,6 +29,7 @@
 #include "indipropertynumber.h"
 #include "indipropertytext.h"
 #include "indisinglethreadpool.h"
+#include "scratch_buffer_pool.h"
 
 #include <vector>
 
@@ -169,4 +170,7 @@ class SVBONYBase : public INDI::CCD
         uint8_t mExposureRetry {0};
         SVB_IMG_TYPE mCurrentVideoFormat;
         std::vector<SVB_CONTROL_CAPS> mControlCaps;
+
+        /** Reusable buffers for colour frame deinterleaving */
+        ScratchBufferPool mScratchPool;
 };
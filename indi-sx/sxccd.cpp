@@ -33,6 +33,7 @@
 
 #include "sxconfig.h"
 
+#include <climits>
 #include <cmath>
 #include <deque>
 #include <memory>
@@ -511,15 +512,21 @@ void SXCCD::ExposureTimerHit()
                     if (rc)
                         rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_ODD | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2,
                                            subW, subH / 2, binX, 1);
-                    if (rc)
-                        rc = sxReadPixels(handle, oddBuf, size);
-                    if (rc)
+                    // Interleave the rows of both fields while the rest of the odd field is transferred
+                    int i = 0, j = 0;
+                    auto merge = [&](unsigned long ready)
                     {
-                        for (int i = 0, j = 0; i < subH; i += 2, j++)
+                        for (; i < subH && static_cast<unsigned long>(j + 1) * subWW <= ready; i += 2, j++)
                         {
                             memcpy(buf + i * subWW, oddBuf + (j * subWW), subWW);
                             memcpy(buf + ((i + 1) * subWW), evenBuf + (j * subWW), subWW);
                         }
+                    };
+                    if (rc)
+                        rc = sxReadPixelsAsync(handle, oddBuf, size, merge);
+                    if (rc)
+                    {
+                        merge(ULONG_MAX);
                         //            deinterlace((unsigned short *)buf, subW, subH);
                     }
                 }
@@ -531,22 +538,23 @@ void SXCCD::ExposureTimerHit()
                 {
                     if (binX == 1 && binY == 1)
                     {
-                        rc = sxReadPixels(handle, evenBuf, size * 2);
-                        if (rc)
-                        {
-                            uint16_t *buf16 = reinterpret_cast<uint16_t *>(buf);
-                            uint16_t *evenBuf16 = reinterpret_cast<uint16_t *>(evenBuf);
+                        uint16_t *buf16 = reinterpret_cast<uint16_t *>(buf);
+                        uint16_t *evenBuf16 = reinterpret_cast<uint16_t *>(evenBuf);
 
-                            int offset_1 = 2, offset_2 = 3;
-                            if (strstr(getDeviceName(), "SXVF-M25C"))
-                            {
-                                // Patch by Greg Bosch on 2020-01-02 to fix bayer pattern
-                                // on SXVF-M25C.
-                                offset_1 = 3;
-                                offset_2 = 2;
-                            }
+                        int offset_1 = 2, offset_2 = 3;
+                        if (strstr(getDeviceName(), "SXVF-M25C"))
+                        {
+                            // Patch by Greg Bosch on 2020-01-02 to fix bayer pattern
+                            // on SXVF-M25C.
+                            offset_1 = 3;
+                            offset_2 = 2;
+                        }
 
-                            for (int i = 0; i < subH; i += 2)
+                        // Reorder each pair of rows as soon as it has been transferred
+                        int i = 0;
+                        auto reorder = [&](unsigned long ready)
+                        {
+                            for (; i < subH && static_cast<unsigned long>(i + 2) * subW * 2 <= ready; i += 2)
                             {
                                 for (int j = 0; j < subW; j += 2)
                                 {
@@ -561,7 +569,11 @@ void SXCCD::ExposureTimerHit()
 
                                 }
                             }
-                        }
+                        };
+
+                        rc = sxReadPixelsAsync(handle, evenBuf, size * 2, reorder);
+                        if (rc)
+                            reorder(ULONG_MAX);
                     }
                     else
                     {
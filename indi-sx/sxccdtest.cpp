@@ -31,9 +31,13 @@
 
 #include "sxconfig.h"
 
+#include <chrono>
 #include <iostream>
 #include <memory.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <vector>
 
 int n;
 DEVICE devices[20];
@@ -43,17 +47,82 @@ HANDLE handles[20];
 struct t_sxccd_params params;
 unsigned short pixels[10 * 10];
 
-int main()
+/*
+ * Readout throughput of full frames with the synchronous and the asynchronous engine.
+ * Works against a real camera or a stand-in gadget enumerating with the SX vendor ID,
+ * e.g. a raw-gadget/FunctionFS emulator on dummy_hcd or a device exported over usbip.
+ */
+static void benchmark(HANDLE handle, int iterations)
+{
+    memset(&params, 0, sizeof(params));
+    if (sxGetCameraParams(handle, 0, &params) == 0 || params.width == 0 || params.height == 0)
+    {
+        std::cout << "benchmark: cannot read camera parameters" << std::endl;
+        return;
+    }
+
+    unsigned long count = 2UL * params.width * params.height;
+    std::vector<unsigned char> frame(count);
+    std::cout << "benchmark: " << params.width << "x" << params.height << ", " << count << " bytes per frame, "
+              << iterations << " frames" << std::endl;
+
+    for (int mode = 0; mode < 2; mode++)
+    {
+        double seconds = 0;
+        int frames     = 0;
+        for (int k = 0; k < iterations; k++)
+        {
+            sxClearPixels(handle, 0, 0);
+            if (!sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, 0, 0, params.width, params.height, 1, 1))
+                continue;
+
+            auto start = std::chrono::steady_clock::now();
+            int rc     = mode == 0 ? sxReadPixelsSync(handle, frame.data(), count) :
+                         sxReadPixelsAsync(handle, frame.data(), count);
+            seconds   += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (rc)
+                frames++;
+        }
+
+        std::cout << (mode == 0 ? "  sync:  " : "  async: ") << frames << " frames, ";
+        if (frames > 0)
+            std::cout << seconds * 1000 / frames << " ms/frame, " << count * frames / seconds / (1024 * 1024) << " MB/s";
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char *argv[])
 {
     int i = 0;
     unsigned short us = 0;
+    int iterations = 0;
 
-    sxDebug(true);
+    if (argc > 1 && strcmp(argv[1], "-b") == 0)
+        iterations = argc > 2 ? atoi(argv[2]) : 10;
+
+    sxDebug(iterations == 0);
 
     std::cout << "sx_ccd_test version " << VERSION_MAJOR << "." << VERSION_MINOR << std::endl << std::endl;
     n = sxList(devices, names, 20);
     std::cout << "sxList() -> " << n << std::endl << std::endl;
 
+    if (iterations > 0)
+    {
+        // Throughput benchmark only: sx_ccd_test -b [frames]
+        for (int j = 0; j < n; j++)
+        {
+            HANDLE handle;
+            std::cout << "benchmarking " << names[j] << " -----------------------------------" << std::endl << std::endl;
+            if (sxOpen(devices[j], &handle))
+            {
+                benchmark(handle, iterations);
+                sxClose(&handle);
+            }
+        }
+        return 0;
+    }
+
     for (int j = 0; j < n; j++)
     {
         HANDLE handle;
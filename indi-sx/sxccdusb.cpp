@@ -40,6 +40,7 @@
 #include <indidevapi.h>
 
 #include <memory>
+#include <vector>
 
 #include <stdarg.h>
 #include <stdlib.h>
@@ -125,6 +126,16 @@
 //#warning "Intel mode, 16MB CHUNK_SIZE"
 #endif
 
+// Asynchronous readout: ASYNC_TRANSFERS transfers of ASYNC_CHUNK_SIZE bytes in flight, which
+// stays well below the default 16MB usbfs memory limit. The chunk size must be a multiple of
+// the bulk packet size so only the last transfer of a frame can be short.
+#define ASYNC_TRANSFERS  4
+#ifdef __arm__
+#define ASYNC_CHUNK_SIZE (256 * 1024)
+#else
+#define ASYNC_CHUNK_SIZE (1024 * 1024)
+#endif
+
 #if 1
 #define TRACE(c) (c)
 #define DEBUG(c) (c)
@@ -735,6 +746,135 @@ int sxExposePixelsGated(HANDLE sxHandle, unsigned short flags, unsigned short ca
 }
 
 int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count)
+{
+    return sxReadPixelsAsync(sxHandle, pixels, count);
+}
+
+struct AsyncRead
+{
+    unsigned char *pixels;
+    unsigned long count;
+    unsigned long submitted;
+    int inFlight;
+    bool failed;
+    std::vector<bool> done;
+};
+
+static void LIBUSB_CALL sxReadPixelsCallback(struct libusb_transfer *transfer)
+{
+    AsyncRead *read        = static_cast<AsyncRead *>(transfer->user_data);
+    unsigned long offset   = transfer->buffer - read->pixels;
+    bool last              = offset + transfer->length == read->count;
+
+    read->inFlight--;
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED || (transfer->actual_length < transfer->length && !last))
+    {
+        DEBUG(log(true, "sxReadPixelsAsync: transfer at %lu failed, status %d, %d of %d bytes\n", offset,
+                  transfer->status, transfer->actual_length, transfer->length));
+        read->failed = true;
+        return;
+    }
+    read->done[offset / ASYNC_CHUNK_SIZE] = true;
+
+    // Reuse the transfer for the next chunk
+    if (read->failed || read->submitted >= read->count)
+        return;
+    int size = read->count - read->submitted;
+    if (size > ASYNC_CHUNK_SIZE)
+        size = ASYNC_CHUNK_SIZE;
+    transfer->buffer = read->pixels + read->submitted;
+    transfer->length = size;
+    if (libusb_submit_transfer(transfer) < 0)
+    {
+        read->failed = true;
+        return;
+    }
+    read->submitted += size;
+    read->inFlight++;
+}
+
+int sxReadPixelsAsync(HANDLE sxHandle, void *pixels, unsigned long count,
+                      const std::function<void(unsigned long ready)> &progress)
+{
+    AsyncRead read;
+    read.pixels    = static_cast<unsigned char *>(pixels);
+    read.count     = count;
+    read.submitted = 0;
+    read.inFlight  = 0;
+    read.failed    = false;
+    read.done.assign((count + ASYNC_CHUNK_SIZE - 1) / ASYNC_CHUNK_SIZE, false);
+
+    struct libusb_transfer *transfers[ASYNC_TRANSFERS] = { nullptr };
+    for (int i = 0; i < ASYNC_TRANSFERS && read.submitted < count; i++)
+    {
+        transfers[i] = libusb_alloc_transfer(0);
+        if (transfers[i] == nullptr)
+            break;
+        int size = count - read.submitted;
+        if (size > ASYNC_CHUNK_SIZE)
+            size = ASYNC_CHUNK_SIZE;
+        libusb_fill_bulk_transfer(transfers[i], sxHandle, BULK_IN, read.pixels + read.submitted, size,
+                                  sxReadPixelsCallback, &read, BULK_DATA_TIMEOUT);
+        if (libusb_submit_transfer(transfers[i]) < 0)
+            break;
+        read.submitted += size;
+        read.inFlight++;
+    }
+
+    int rc = 0;
+    if (read.inFlight == 0)
+    {
+        // Nothing could be queued (e.g. usbfs memory limit), do it the old way
+        DEBUG(log(true, "sxReadPixelsAsync: no transfer submitted, falling back to synchronous read\n"));
+        rc = sxReadPixelsSync(sxHandle, pixels, count);
+        if (rc && progress)
+            progress(count);
+    }
+    else
+    {
+        unsigned long ready = 0;
+        size_t chunk        = 0;
+        bool cancelled      = false;
+        while (read.inFlight > 0)
+        {
+            struct timeval tv = { 1, 0 };
+            int rc2 = libusb_handle_events_timeout_completed(ctx, &tv, nullptr);
+            if (rc2 < 0 && rc2 != LIBUSB_ERROR_INTERRUPTED)
+            {
+                DEBUG(log(true, "sxReadPixelsAsync: libusb_handle_events -> %s\n", libusb_error_name(rc2)));
+                read.failed = true;
+            }
+
+            if (read.failed && !cancelled)
+            {
+                for (int i = 0; i < ASYNC_TRANSFERS; i++)
+                    if (transfers[i] != nullptr)
+                        libusb_cancel_transfer(transfers[i]);
+                cancelled = true;
+            }
+
+            // Chunks complete in order on one endpoint, report the contiguous part
+            unsigned long previous = ready;
+            while (chunk < read.done.size() && read.done[chunk])
+                chunk++;
+            ready = chunk * static_cast<unsigned long>(ASYNC_CHUNK_SIZE);
+            if (ready > count)
+                ready = count;
+            if (!read.failed && ready > previous && progress)
+                progress(ready);
+        }
+        rc = !read.failed && ready == count;
+        DEBUG(log(true, "sxReadPixelsAsync: %lu bytes -> %s\n", count, rc ? "OK" : "failed"));
+    }
+
+    for (int i = 0; i < ASYNC_TRANSFERS; i++)
+        if (transfers[i] != nullptr)
+            libusb_free_transfer(transfers[i]);
+
+    return rc;
+}
+
+int sxReadPixelsSync(HANDLE sxHandle, void *pixels, unsigned long count)
 {
     int transferred;
     unsigned long read = 0;
@@ -37,6 +37,7 @@
 
 #pragma once
 #include <libusb.h>
+#include <functional>
 
 /*
  * CCD color representation.
@@ -155,6 +156,17 @@ int sxExposePixelsGated(HANDLE sxHandle, unsigned short flags, unsigned short ca
                         unsigned short yoffset, unsigned short width, unsigned short height, unsigned short xbin,
                         unsigned short ybin, unsigned long msec);
 int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count);
+/*
+ * Read pixels with several bulk transfers in flight. progress is called from the calling
+ * thread each time more leading bytes of pixels are available, so the caller can process
+ * them while the rest of the frame is transferred.
+ */
+int sxReadPixelsAsync(HANDLE sxHandle, void *pixels, unsigned long count,
+                      const std::function<void(unsigned long ready)> &progress = nullptr);
+/*
+ * Read pixels with one synchronous bulk transfer at a time.
+ */
+int sxReadPixelsSync(HANDLE sxHandle, void *pixels, unsigned long count);
 int sxSetShutter(HANDLE sxHandle, unsigned short state);
 int sxSetTimer(HANDLE sxHandle, unsigned long msec);
 unsigned long sxGetTimer(HANDLE sxHandle);
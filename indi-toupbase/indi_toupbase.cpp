@@ -21,13 +21,21 @@
 
 #include "indi_toupbase.h"
 #include "config.h"
+#include "pixel_convert.h"
 #include <stream/streammanager.h>
+#include <sharedblob.h>
 #include <unordered_map>
 #include <unistd.h>
 #include <deque>
+#include <algorithm>
+#include <chrono>
+#include <functional>
 
 #define BITDEPTH_FLAG       (CP(FLAG_RAW10) | CP(FLAG_RAW12) | CP(FLAG_RAW14) | CP(FLAG_RAW16))
 #define CONTROL_TAB         "Control"
+#define SEQUENCE_MAX_FRAMES 1000    /* Max exposures in a trigger sequence */
+#define SEQUENCE_AHEAD      4       /* Max frames of a sequence triggered or queued ahead of the client */
+#define SEQUENCE_MAX_AGE    60      /* Max seconds a queued frame is kept for the next request */
 
 #ifndef MAKEFOURCC
 #define MAKEFOURCC(ch0, ch1, ch2, ch3) \
@@ -254,6 +262,14 @@ bool ToupBase::initProperties()
     IUFillNumberVector(&m_TimeoutFactorNP, &m_TimeoutFactorN, 1, getDeviceName(), "TIMEOUT_FACTOR", "Timeout", OPTIONS_TAB,
                        IP_RW, 60, IPS_IDLE);
 
+    ///////////////////////////////////////////////////////////////////////////////////
+    /// Trigger Sequence
+    ///////////////////////////////////////////////////////////////////////////////////
+    IUFillNumber(&m_SequenceN[TC_SEQUENCE_FRAMES], "FRAMES", "Frames", "%.f", 1, SEQUENCE_MAX_FRAMES, 1, 1);
+    IUFillNumber(&m_SequenceN[TC_SEQUENCE_GAP], "GAP", "Gap (ms)", "%.f", 0, 60000, 10, 0);
+    IUFillNumberVector(&m_SequenceNP, m_SequenceN, 2, getDeviceName(), "TC_TRIGGER_SEQUENCE", "Trigger Sequence",
+                       OPTIONS_TAB, IP_RW, 60, IPS_IDLE);
+
     if (m_Instance->model->flag & (CP(FLAG_CG) | CP(FLAG_CGHDR)))
     {
         ///////////////////////////////////////////////////////////////////////////////////
@@ -341,6 +357,16 @@ bool ToupBase::initProperties()
     m_ADCDepthNP[0].fill("BITS", "Bits", "%2.0f", 0, 32, 1, m_maxBitDepth);
     m_ADCDepthNP.fill(getDeviceName(), "ADC_DEPTH", "ADC Depth", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
 
+    m_PullStatsNP[TC_PULL_FRAMES].fill("FRAMES", "Frames", "%.f", 0, 1e12, 0, 0);
+    m_PullStatsNP[TC_PULL_TEARS].fill("TEARS", "Tears", "%.f", 0, 1e12, 0, 0);
+    m_PullStatsNP[TC_PULL_OVERRUNS].fill("OVERRUNS", "Overruns", "%.f", 0, 1e12, 0, 0);
+    m_PullStatsNP.fill(getDeviceName(), "PULL_STATS", "Pulled Images", IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
+    m_SequenceStatusNP[TC_SEQUENCE_PENDING].fill("PENDING", "Pending", "%.f", 0, 65535, 0, 0);
+    m_SequenceStatusNP[TC_SEQUENCE_QUEUED].fill("QUEUED", "Queued", "%.f", 0, 65535, 0, 0);
+    m_SequenceStatusNP.fill(getDeviceName(), "TC_SEQUENCE_STATUS", "Trigger Sequence", IMAGE_INFO_TAB, IP_RO, 60,
+                            IPS_IDLE);
+
     PrimaryCCD.setMinMaxStep("CCD_BINNING", "HOR_BIN", 1, 4, 1, false);
     PrimaryCCD.setMinMaxStep("CCD_BINNING", "VER_BIN", 1, 4, 1, false);
 
@@ -382,6 +408,7 @@ bool ToupBase::updateProperties()
             defineProperty(&m_FanSP);
 
         defineProperty(&m_TimeoutFactorNP);
+        defineProperty(&m_SequenceNP);
         defineProperty(&m_ControlNP);
         defineProperty(&m_AutoExposureSP);
         defineProperty(&m_ResolutionSP);
@@ -418,6 +445,8 @@ bool ToupBase::updateProperties()
         defineProperty(&m_CameraTP);
         defineProperty(&m_SDKVersionTP);
         defineProperty(m_ADCDepthNP);
+        defineProperty(m_PullStatsNP);
+        defineProperty(m_SequenceStatusNP);
     }
     else
     {
@@ -435,6 +464,7 @@ bool ToupBase::updateProperties()
             deleteProperty(m_FanSP.name);
 
         deleteProperty(m_TimeoutFactorNP.name);
+        deleteProperty(m_SequenceNP.name);
         deleteProperty(m_ControlNP.name);
         deleteProperty(m_AutoExposureSP.name);
         deleteProperty(m_ResolutionSP.name);
@@ -468,6 +498,8 @@ bool ToupBase::updateProperties()
         deleteProperty(m_CameraTP.name);
         deleteProperty(m_SDKVersionTP.name);
         deleteProperty(m_ADCDepthNP.getName());
+        deleteProperty(m_PullStatsNP.getName());
+        deleteProperty(m_SequenceStatusNP.getName());
     }
 
     return true;
@@ -491,6 +523,10 @@ bool ToupBase::Connect()
         return false;
     }
 
+    for (auto &stat : m_PullStatsNP)
+        stat.setValue(0);
+    m_PullStatsNP.setState(IPS_IDLE);
+
     uint32_t cap = CCD_CAN_BIN | CCD_CAN_ABORT | CCD_HAS_STREAMING | CCD_CAN_SUBFRAME;
     if (m_MonoCamera == false)
         cap |= CCD_HAS_BAYER;
@@ -529,15 +565,12 @@ bool ToupBase::Disconnect()
 {
     stopGuidePulse(mTimerNS);
     stopGuidePulse(mTimerWE);
+    stopSequence();
 
     FP(Close(m_Handle));
 
-    if (m_rgbBuffer)
-    {
-        free(m_rgbBuffer);
-        m_rgbBuffer = nullptr;
-    }
-    m_rgbBufferSize = 0;
+    m_ScratchPool.trim();
+    releaseBackBuffer();
 
     return true;
 }
@@ -868,6 +901,9 @@ bool ToupBase::ISNewNumber(const char *dev, const char *name, double values[], c
                 return true;
             }
 
+            // Frames of the trigger sequence were taken with the old controls
+            stopSequence();
+
             for (uint8_t i = 0; i < m_ControlNP.nnp; i++)
             {
                 int value = static_cast<int>(m_ControlN[i].value);
@@ -991,6 +1027,7 @@ bool ToupBase::ISNewNumber(const char *dev, const char *name, double values[], c
         if (!strcmp(name, m_OffsetNP.name))
         {
             IUUpdateNumber(&m_OffsetNP, values, names, n);
+            stopSequence();
             int bLevel = static_cast<uint16_t>(m_OffsetN[0].value);
 
             HRESULT rc = FP(put_Option(m_Handle, CP(OPTION_BLACKLEVEL), bLevel));
@@ -1045,6 +1082,17 @@ bool ToupBase::ISNewNumber(const char *dev, const char *name, double values[], c
             IDSetNumber(&m_TimeoutFactorNP, nullptr);
             return true;
         }
+
+        //////////////////////////////////////////////////////////////////////
+        /// Trigger sequence, applies from the next exposure that arms one
+        //////////////////////////////////////////////////////////////////////
+        if (!strcmp(name, m_SequenceNP.name))
+        {
+            IUUpdateNumber(&m_SequenceNP, values, names, n);
+            m_SequenceNP.s = IPS_OK;
+            IDSetNumber(&m_SequenceNP, nullptr);
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -1087,6 +1135,7 @@ bool ToupBase::ISNewSwitch(const char *dev, const char *name, ISState *states, c
         {
             int prevIndex = IUFindOnSwitchIndex(&m_HighFullwellSP);
             IUUpdateSwitch(&m_HighFullwellSP, states, names, n);
+            stopSequence();
             HRESULT rc = FP(put_Option(m_Handle, CP(OPTION_HIGH_FULLWELL), m_HighFullwellS[INDI_ENABLED].s));
             if (SUCCEEDED(rc))
                 m_HighFullwellSP.s = IPS_OK;
@@ -1110,6 +1159,7 @@ bool ToupBase::ISNewSwitch(const char *dev, const char *name, ISState *states, c
         {
             int prevIndex = IUFindOnSwitchIndex(&m_LowNoiseSP);
             IUUpdateSwitch(&m_LowNoiseSP, states, names, n);
+            stopSequence();
             HRESULT rc = FP(put_Option(m_Handle, CP(OPTION_LOW_NOISE), m_LowNoiseS[INDI_ENABLED].s));
             if (SUCCEEDED(rc))
                 m_LowNoiseSP.s = IPS_OK;
@@ -1163,6 +1213,7 @@ bool ToupBase::ISNewSwitch(const char *dev, const char *name, ISState *states, c
         if (!strcmp(name, m_GainConversionSP.name))
         {
             IUUpdateSwitch(&m_GainConversionSP, states, names, n);
+            stopSequence();
             m_GainConversionSP.s = IPS_OK;
             FP(put_Option(m_Handle, CP(OPTION_CG), IUFindOnSwitchIndex(&m_GainConversionSP)));
             IDSetSwitch(&m_GainConversionSP, nullptr);
@@ -1315,6 +1366,8 @@ bool ToupBase::ISNewSwitch(const char *dev, const char *name, ISState *states, c
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 bool ToupBase::StartStreaming()
 {
+    stopSequence();
+
     const uint32_t uSecs = static_cast<uint32_t>(1000000.0f / Streamer->getTargetFPS());
     HRESULT rc = FP(put_ExpoTime(m_Handle, uSecs));
     if (FAILED(rc))
@@ -1429,6 +1482,34 @@ bool ToupBase::StartExposure(float duration)
     time_t uSecs = static_cast<time_t>(duration * 1000000.0f);
 
     m_ExposureRequest = duration;
+
+    timeval current_time, exposure_time;
+    exposure_time.tv_sec = uSecs / 1000000;
+    exposure_time.tv_usec = uSecs % 1000000;
+    gettimeofday(&current_time, nullptr);
+
+    // Take the frame from the running trigger sequence if it was armed for this exposure
+    SequenceSettings settings = currentSequenceSettings();
+    {
+        std::lock_guard<std::mutex> lock(m_SequenceMutex);
+        if (m_SequenceActive && m_SequenceSettings == settings)
+        {
+            if (!m_SequenceQueue.empty() && current_time.tv_sec - m_SequenceQueue.front().received.tv_sec <= SEQUENCE_MAX_AGE)
+            {
+                m_ExposureEnd = current_time;
+                m_SequenceDeliveryID = IEAddTimer(0, &ToupBase::deliverSequenceFrameHelper, this);
+                return true;
+            }
+            if (m_SequenceQueue.empty() && (m_SequencePending > 0 || m_SequenceRemaining > 0))
+            {
+                timeradd(&current_time, &exposure_time, &m_ExposureEnd);
+                InExposure = true;
+                return true;
+            }
+        }
+    }
+    stopSequence();
+
     if (FAILED(rc = FP(put_ExpoTime(m_Handle, uSecs))))
     {
         LOGF_ERROR("Failed to set exposure time. %s", errorCodes(rc).c_str());
@@ -1443,13 +1524,23 @@ bool ToupBase::StartExposure(float duration)
         m_CurrentTriggerMode = TRIGGER_SOFTWARE;
     }
 
-    timeval current_time, exposure_time;
-    exposure_time.tv_sec = uSecs / 1000000;
-    exposure_time.tv_usec = uSecs % 1000000;
     gettimeofday(&current_time, nullptr);
     timeradd(&current_time, &exposure_time, &m_ExposureEnd);
 
     InExposure = true;
+
+    // Arm the next exposures of a flat or focus series with the same settings in one go
+    int frames = static_cast<int>(m_SequenceN[TC_SEQUENCE_FRAMES].value);
+    if (frames > 1)
+    {
+        if (!startSequence(settings, frames, static_cast<int>(m_SequenceN[TC_SEQUENCE_GAP].value)))
+        {
+            InExposure = false;
+            return false;
+        }
+        return true;
+    }
+
     if (FAILED(rc = FP(Trigger(m_Handle, 1))))// Trigger an exposure
     {
         LOGF_ERROR("Failed to trigger exposure. %s", errorCodes(rc).c_str());
@@ -1464,6 +1555,7 @@ bool ToupBase::StartExposure(float duration)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 bool ToupBase::AbortExposure()
 {
+    stopSequence();
     FP(Trigger(m_Handle, 0));
     InExposure = false;
     return true;
@@ -1575,6 +1667,9 @@ void ToupBase::TimerHit()
         PrimaryCCD.setExposureLeft(timeleft);
     }
 
+    if (m_SequenceStatusNP.getState() == IPS_BUSY)
+        updateSequenceStatus();
+
     if (m_Instance->model->flag & CP(FLAG_GETTEMPERATURE))
     {
         int16_t nTemperature = 0;
@@ -1812,6 +1907,42 @@ void ToupBase::addFITSKeywords(INDI::CCDChip * targetChip, std::vector<INDI::FIT
     fitsKeywords.push_back({"PRODATE", m_CameraT[TC_CAMERA_DATE].text, "Production Date"});
     fitsKeywords.push_back({"FIRMVER", m_CameraT[TC_CAMERA_FW_VERSION].text, "Firmware Version"});
     fitsKeywords.push_back({"HARDVER", m_CameraT[TC_CAMERA_HW_VERSION].text, "Hardware Version"});
+    if (m_FrameTimestamp > 0)
+        fitsKeywords.push_back({"CAMSTAMP", static_cast<int64_t>(m_FrameTimestamp), "Camera timestamp (us)"});
+    if (m_FrameIndex > 0)
+    {
+        fitsKeywords.push_back({"SEQFRAME", static_cast<int64_t>(m_FrameIndex), "Frame of the trigger sequence"});
+        fitsKeywords.push_back({"SEQWAIT", m_FrameQueued, 3, "Seconds queued before download"});
+    }
+
+    // Later frames of the trigger sequence were exposed before the client asked for them
+    if (m_FrameIndex > 1)
+    {
+        char date[64], dateObs[80];
+        struct tm utc;
+        time_t seconds = m_FrameStart.tv_sec;
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", gmtime_r(&seconds, &utc));
+        snprintf(dateObs, sizeof(dateObs), "%s.%03d", date, static_cast<int>(m_FrameStart.tv_usec / 1000));
+
+        for (auto &record : fitsKeywords)
+        {
+            if (record.key() == "DATE-OBS")
+                record = INDI::FITSRecord("DATE-OBS", dateObs, "UTC start date of observation");
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Start of the exposure of a frame of the trigger sequence that arrived at received
+////////////////////////////////////////////////////////////////////////////////////////////////////
+timeval ToupBase::exposureStart(const timeval &received)
+{
+    timeval exposure, start;
+    uint32_t uSecs = static_cast<uint32_t>(m_ExposureRequest * 1000000.0f);
+    exposure.tv_sec = uSecs / 1000000;
+    exposure.tv_usec = uSecs % 1000000;
+    timersub(&received, &exposure, &start);
+    return start;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1847,18 +1978,6 @@ void ToupBase::eventCB(unsigned event, void* pCtx)
     static_cast<ToupBase*>(pCtx)->eventCallBack(event);
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-///
-////////////////////////////////////////////////////////////////////////////////////////////////////
-uint8_t* ToupBase::getRgbBuffer()
-{
-    if (m_rgbBuffer && (m_rgbBufferSize == PrimaryCCD.getXRes() * PrimaryCCD.getYRes() * 3))
-        return m_rgbBuffer;
-    m_rgbBufferSize = PrimaryCCD.getXRes() * PrimaryCCD.getYRes() * 3;
-    m_rgbBuffer = static_cast<uint8_t*>(realloc(m_rgbBuffer, m_rgbBufferSize));
-    return m_rgbBuffer;
-}
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ///
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1881,21 +2000,80 @@ void ToupBase::eventCallBack(unsigned event)
             int captureBits = m_BitsPerPixel == 8 ? 8 : m_maxBitDepth;
             if (Streamer->isStreaming() || Streamer->isRecording())
             {
-                HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, PrimaryCCD.getFrameBuffer(), captureBits * m_Channels, -1, nullptr));
-                if (SUCCEEDED(rc))
+                if (!allocateBackBuffer())
+                {
+                    FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
+                    break;
+                }
+
+                XP(FrameInfoV2) info;
+                memset(&info, 0, sizeof(XP(FrameInfoV2)));
+
+                HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, m_BackBuffer, captureBits * m_Channels, -1, &info));
+                // Never block the SDK thread while streaming, a busy frame buffer drops the frame
+                if (SUCCEEDED(rc) && !isTornFrame(info) && swapBackBuffer(false))
                     Streamer->newFrame(PrimaryCCD.getFrameBuffer(), PrimaryCCD.getFrameBufferSize());
+                updatePullStats(false);
             }
-            else if (InExposure)
+            else
             {
-                InExposure = false;
+                // The frame either completes the exposure in progress, is an early frame of the trigger sequence
+                // which is kept until the client asks for it, or is not wanted at all.
+                bool direct = false, queued = false;
+                int index = 0;
+                {
+                    std::lock_guard<std::mutex> lock(m_SequenceMutex);
+                    direct = InExposure;
+                    InExposure = false;
+                    if (m_SequencePending > 0 && (direct || m_SequenceActive))
+                    {
+                        m_SequencePending--;
+                        index = ++m_SequenceReceived;
+                        queued = !direct;
+                    }
+                }
+                m_SequenceCondition.notify_all();
+
+                if (queued)
+                {
+                    queueSequenceFrame(index);
+                    break;
+                }
+                if (!direct)
+                {
+                    HRESULT rc = FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
+                    if (FAILED(rc))
+                        LOGF_ERROR("Failed to flush image. %s", errorCodes(rc).c_str());
+                    break;
+                }
+
                 PrimaryCCD.setExposureLeft(0);
 
                 XP(FrameInfoV2) info;
                 memset(&info, 0, sizeof(XP(FrameInfoV2)));
 
-                uint8_t *buffer = PrimaryCCD.getFrameBuffer();
+                uint8_t *buffer = nullptr;
+                ScratchBuffer rgbScratch;
                 if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
-                    buffer = getRgbBuffer();
+                {
+                    rgbScratch = m_ScratchPool.acquire(pullSize());
+                    if (!rgbScratch)
+                    {
+                        LOG_ERROR("Failed to allocate RGB scratch buffer.");
+                        PrimaryCCD.setExposureFailed();
+                        break;
+                    }
+                    buffer = rgbScratch.data();
+                    LOGF_DEBUG("Scratch buffers: %zu bytes mapped, peak %zu bytes.", m_ScratchPool.allocatedBytes(),
+                               m_ScratchPool.highWaterMark());
+                }
+                else if (allocateBackBuffer())
+                    buffer = m_BackBuffer;
+                else
+                {
+                    PrimaryCCD.setExposureFailed();
+                    break;
+                }
 
                 HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, buffer, captureBits * m_Channels, -1, &info));
                 if (FAILED(rc))
@@ -1905,36 +2083,28 @@ void ToupBase::eventCallBack(unsigned event)
                 }
                 else
                 {
+                    if (isTornFrame(info))
+                        LOGF_WARN("Image size %dx%d does not match the frame.", info.width, info.height);
+
                     if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
+                        storeFrame(buffer, rgbScratch.size());
+                    else if (!swapBackBuffer(true))
                     {
-                        uint8_t *image  = PrimaryCCD.getFrameBuffer();
-                        uint32_t width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX() * (PrimaryCCD.getBPP() / 8);
-                        uint32_t height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY() * (PrimaryCCD.getBPP() / 8);
-
-                        uint8_t *subR = image;
-                        uint8_t *subG = image + width * height;
-                        uint8_t *subB = image + width * height * 2;
-                        int size      = width * height * 3 - 3;
-
-                        // RGB to three sepearate R-frame, G-frame, and B-frame for color FITS
-                        for (int i = 0; i <= size; i += 3)
-                        {
-                            *subR++ = buffer[i];
-                            *subG++ = buffer[i + 1];
-                            *subB++ = buffer[i + 2];
-                        }
+                        PrimaryCCD.setExposureFailed();
+                        updatePullStats(true);
+                        break;
                     }
 
                     LOGF_DEBUG("Image received. Width: %d, Height: %d, flag: %d, timestamp: %ld", info.width, info.height, info.flag,
                                info.timestamp);
+                    m_FrameTimestamp = info.timestamp;
+                    m_FrameIndex = index;
+                    m_FrameQueued = 0;
+                    gettimeofday(&m_FrameStart, nullptr);
+                    m_FrameStart = exposureStart(m_FrameStart);
                     ExposureComplete(&PrimaryCCD);
                 }
-            }
-            else
-            {
-                HRESULT rc = FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
-                if (FAILED(rc))
-                    LOGF_ERROR("Failed to flush image. %s", errorCodes(rc).c_str());
+                updatePullStats(true);
             }
         }
         break;
@@ -1968,6 +2138,14 @@ void ToupBase::eventCallBack(unsigned event)
             break;
         case CP(EVENT_NOFRAMETIMEOUT):
             LOG_ERROR("Camera timed out");
+            {
+                // The remaining frames of the trigger sequence will not come either
+                std::lock_guard<std::mutex> lock(m_SequenceMutex);
+                m_SequencePending = 0;
+                m_SequenceRemaining = 0;
+                m_SequenceCancelled = true;
+            }
+            m_SequenceCondition.notify_all();
             PrimaryCCD.setExposureFailed();
             break;
         default:
@@ -1975,6 +2153,359 @@ void ToupBase::eventCallBack(unsigned event)
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ToupBase::allocateBackBuffer()
+{
+    int size = PrimaryCCD.getFrameBufferSize();
+    if (m_BackBuffer != nullptr && m_BackBufferSize == size)
+        return true;
+
+    if (m_BackBuffer)
+        m_BackBuffer = static_cast<uint8_t *>(IDSharedBlobRealloc(m_BackBuffer, size));
+    else
+        m_BackBuffer = static_cast<uint8_t *>(IDSharedBlobAlloc(size));
+
+    m_BackBufferSize = m_BackBuffer ? size : 0;
+    if (m_BackBuffer == nullptr)
+        LOGF_ERROR("Failed to allocate %d bytes image buffer.", size);
+    return m_BackBuffer != nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::releaseBackBuffer()
+{
+    if (m_BackBuffer)
+        IDSharedBlobFree(m_BackBuffer);
+    m_BackBuffer = nullptr;
+    m_BackBufferSize = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Swap the freshly pulled back buffer with the frame buffer. When wait is false and the frame buffer
+/// is in use (upload, streamer), the frame is dropped and counted as an overrun.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ToupBase::swapBackBuffer(bool wait)
+{
+    std::unique_lock<std::mutex> guard(ccdBufferLock, std::defer_lock);
+    if (wait)
+        guard.lock();
+    else if (!guard.try_lock())
+    {
+        m_PullStatsNP[TC_PULL_OVERRUNS].setValue(m_PullStatsNP[TC_PULL_OVERRUNS].getValue() + 1);
+        return false;
+    }
+
+    // Frame buffer was resized (ROI, binning, format) while the image was pulled
+    if (PrimaryCCD.getFrameBufferSize() != m_BackBufferSize)
+    {
+        m_PullStatsNP[TC_PULL_TEARS].setValue(m_PullStatsNP[TC_PULL_TEARS].getValue() + 1);
+        return false;
+    }
+
+    uint8_t *front = PrimaryCCD.getFrameBuffer();
+    PrimaryCCD.setFrameBuffer(m_BackBuffer);
+    m_BackBuffer = front;
+    m_PullStatsNP[TC_PULL_FRAMES].setValue(m_PullStatsNP[TC_PULL_FRAMES].getValue() + 1);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// A pulled image that does not match the current frame geometry would only partially overwrite
+/// the frame buffer.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ToupBase::isTornFrame(const XP(FrameInfoV2) &info)
+{
+    if (info.width == 0 || info.height == 0)
+        return false;
+
+    if (info.width == static_cast<unsigned>(PrimaryCCD.getSubW() / PrimaryCCD.getBinX()) &&
+            info.height == static_cast<unsigned>(PrimaryCCD.getSubH() / PrimaryCCD.getBinY()))
+        return false;
+
+    m_PullStatsNP[TC_PULL_TEARS].setValue(m_PullStatsNP[TC_PULL_TEARS].getValue() + 1);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::updatePullStats(bool force)
+{
+    if (!force && m_PullStatsTimer.elapsed() < 1000)
+        return;
+
+    m_PullStatsTimer.start();
+    bool lost = m_PullStatsNP[TC_PULL_TEARS].getValue() > 0 || m_PullStatsNP[TC_PULL_OVERRUNS].getValue() > 0;
+    m_PullStatsNP.setState(lost ? IPS_BUSY : IPS_OK);
+    m_PullStatsNP.apply();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Copy a pulled image into the frame buffer. RGB images are split into three separate R-frame,
+/// G-frame and B-frame for color FITS.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::storeFrame(const uint8_t *buffer, size_t size)
+{
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
+    if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
+    {
+        uint32_t width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+        uint32_t height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+        PixelConvert::interleavedToPlanar(buffer, PrimaryCCD.getFrameBuffer(), std::min<size_t>(width * height, size / 3),
+                                          3, 1, PixelConvert::ORDER_RGB);
+    }
+    else
+        memcpy(PrimaryCCD.getFrameBuffer(), buffer, std::min<size_t>(size, PrimaryCCD.getFrameBufferSize()));
+    m_PullStatsNP[TC_PULL_FRAMES].setValue(m_PullStatsNP[TC_PULL_FRAMES].getValue() + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+ToupBase::SequenceSettings ToupBase::currentSequenceSettings()
+{
+    SequenceSettings settings;
+    settings.duration = m_ExposureRequest;
+    settings.x        = PrimaryCCD.getSubX();
+    settings.y        = PrimaryCCD.getSubY();
+    settings.w        = PrimaryCCD.getSubW();
+    settings.h        = PrimaryCCD.getSubH();
+    settings.binX     = PrimaryCCD.getBinX();
+    settings.binY     = PrimaryCCD.getBinY();
+    settings.format   = m_CurrentVideoFormat;
+    settings.pullSize = pullSize();
+    return settings;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Bytes of a pulled image of the current subframe, binning and bit depth
+////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t ToupBase::pullSize()
+{
+    int captureBits = m_BitsPerPixel == 8 ? 8 : m_maxBitDepth;
+    size_t width    = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    size_t height   = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    return width * height * m_Channels * (captureBits > 8 ? 2 : 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Arm frames software triggered exposures, the first one is the exposure in progress. Without a gap
+/// up to SEQUENCE_AHEAD frames are triggered at once and the worker triggers more as the client takes
+/// them, otherwise the worker triggers them one by one.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ToupBase::startSequence(const SequenceSettings &settings, int frames, int gap)
+{
+    int armed = gap > 0 ? 1 : std::min(frames, SEQUENCE_AHEAD);
+    {
+        std::lock_guard<std::mutex> lock(m_SequenceMutex);
+        m_SequenceSettings  = settings;
+        m_SequencePending   = armed;
+        m_SequenceRemaining = frames - armed;
+        m_SequenceReceived  = 0;
+        m_SequenceActive    = true;
+        m_SequenceCancelled = false;
+    }
+
+    HRESULT rc = FP(Trigger(m_Handle, armed));
+    if (FAILED(rc))
+    {
+        LOGF_ERROR("Failed to trigger exposure. %s", errorCodes(rc).c_str());
+        std::lock_guard<std::mutex> lock(m_SequenceMutex);
+        m_SequencePending   = 0;
+        m_SequenceRemaining = 0;
+        m_SequenceActive    = false;
+        return false;
+    }
+
+    if (frames > armed)
+        m_SequenceWorker.start(std::bind(&ToupBase::workerSequence, this, std::placeholders::_1, gap));
+
+    LOGF_DEBUG("Trigger sequence of %d frames armed, %d ms apart.", frames, gap);
+    updateSequenceStatus();
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::stopSequence()
+{
+    bool active = false;
+    {
+        std::lock_guard<std::mutex> lock(m_SequenceMutex);
+        active = m_SequenceActive;
+        m_SequenceActive    = false;
+        m_SequenceCancelled = true;
+        m_SequencePending   = 0;
+        m_SequenceRemaining = 0;
+        m_SequenceQueue.clear();
+        if (m_SequenceDeliveryID >= 0)
+        {
+            IERmTimer(m_SequenceDeliveryID);
+            m_SequenceDeliveryID = -1;
+        }
+    }
+    m_SequenceCondition.notify_all();
+    m_SequenceWorker.quit();
+
+    if (active)
+    {
+        FP(Trigger(m_Handle, 0));
+        updateSequenceStatus();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Trigger the rest of the sequence, keeping at most SEQUENCE_AHEAD frames in flight or queued. With a
+/// gap, the next exposure is triggered once the previous frame arrived and the gap passed. Runs on the
+/// worker.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::workerSequence(const std::atomic_bool &isAboutToQuit, int gap)
+{
+    std::unique_lock<std::mutex> lock(m_SequenceMutex);
+    while (m_SequenceRemaining > 0)
+    {
+        auto stopped = [&]()
+        {
+            return isAboutToQuit || m_SequenceCancelled;
+        };
+        auto ahead = [&]()
+        {
+            return m_SequencePending + static_cast<int>(m_SequenceQueue.size());
+        };
+
+        while (!stopped() && (ahead() >= SEQUENCE_AHEAD || (gap > 0 && m_SequencePending > 0)))
+            m_SequenceCondition.wait_for(lock, std::chrono::milliseconds(100));
+
+        // Sleep in short steps so quitting the worker is noticed
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(gap);
+        while (!stopped() && std::chrono::steady_clock::now() < deadline)
+        {
+            auto step = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+            m_SequenceCondition.wait_until(lock, std::min(deadline, step));
+        }
+
+        if (stopped())
+            return;
+
+        // Count the frames as pending before triggering, so the SDK callback keeps them
+        int count = gap > 0 ? 1 : std::min(m_SequenceRemaining, SEQUENCE_AHEAD - ahead());
+        m_SequencePending   += count;
+        m_SequenceRemaining -= count;
+
+        lock.unlock();
+        HRESULT rc = FP(Trigger(m_Handle, count));
+        lock.lock();
+        if (FAILED(rc))
+        {
+            LOGF_ERROR("Failed to trigger exposures of the sequence. %s", errorCodes(rc).c_str());
+            m_SequencePending   = 0;
+            m_SequenceRemaining = 0;
+            return;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Pull a frame of the trigger sequence nobody asked for yet into a scratch buffer. Runs on the
+/// SDK callback thread.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::queueSequenceFrame(int index)
+{
+    size_t pullSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_SequenceMutex);
+        pullSize = m_SequenceSettings.pullSize;
+    }
+
+    SequenceFrame frame;
+    frame.data = m_ScratchPool.acquire(pullSize);
+    if (!frame.data)
+    {
+        LOG_ERROR("Failed to allocate trigger sequence buffer.");
+        FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
+        return;
+    }
+
+    XP(FrameInfoV2) info;
+    memset(&info, 0, sizeof(XP(FrameInfoV2)));
+    int captureBits = m_BitsPerPixel == 8 ? 8 : m_maxBitDepth;
+    HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, frame.data.data(), captureBits * m_Channels, -1, &info));
+    if (FAILED(rc))
+    {
+        LOGF_ERROR("Failed to pull image %d of the sequence. %s", index, errorCodes(rc).c_str());
+        return;
+    }
+    if (isTornFrame(info))
+        LOGF_WARN("Image size %dx%d does not match the frame.", info.width, info.height);
+
+    frame.timestamp = info.timestamp;
+    frame.index = index;
+    gettimeofday(&frame.received, nullptr);
+
+    std::lock_guard<std::mutex> lock(m_SequenceMutex);
+    if (m_SequenceActive)
+        m_SequenceQueue.push_back(std::move(frame));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::deliverSequenceFrameHelper(void *context)
+{
+    static_cast<ToupBase *>(context)->deliverSequenceFrame();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Complete the exposure with the oldest queued frame of the trigger sequence
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::deliverSequenceFrame()
+{
+    SequenceFrame frame;
+    {
+        std::lock_guard<std::mutex> lock(m_SequenceMutex);
+        m_SequenceDeliveryID = -1;
+        if (m_SequenceQueue.empty())
+            return;
+        frame = std::move(m_SequenceQueue.front());
+        m_SequenceQueue.pop_front();
+    }
+    // Room for the worker to trigger the next frame
+    m_SequenceCondition.notify_all();
+
+    storeFrame(frame.data.data(), frame.data.size());
+
+    timeval now, queued;
+    gettimeofday(&now, nullptr);
+    timersub(&now, &frame.received, &queued);
+    m_FrameTimestamp = frame.timestamp;
+    m_FrameIndex = frame.index;
+    m_FrameQueued = queued.tv_sec + queued.tv_usec / 1e6;
+    m_FrameStart = exposureStart(frame.received);
+
+    LOGF_DEBUG("Sequence frame %d delivered after %.3f s in the queue.", frame.index, m_FrameQueued);
+    PrimaryCCD.setExposureLeft(0);
+    updatePullStats(true);
+    updateSequenceStatus();
+    ExposureComplete(&PrimaryCCD);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::updateSequenceStatus()
+{
+    std::lock_guard<std::mutex> lock(m_SequenceMutex);
+    m_SequenceStatusNP[TC_SEQUENCE_PENDING].setValue(m_SequencePending + m_SequenceRemaining);
+    m_SequenceStatusNP[TC_SEQUENCE_QUEUED].setValue(m_SequenceQueue.size());
+    m_SequenceStatusNP.setState(m_SequenceActive ? IPS_BUSY : IPS_IDLE);
+    m_SequenceStatusNP.apply();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ///
 ////////////////////////////////////////////////////////////////////////////////////////////////////
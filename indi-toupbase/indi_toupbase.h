@@ -23,7 +23,15 @@
 
 #include <indiccd.h>
 #include <inditimer.h>
+#include <indielapsedtimer.h>
+#include <indisinglethreadpool.h>
 #include "libtoupbase.h"
+#include "scratch_buffer_pool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 class ToupBase : public INDI::CCD
 {
@@ -89,9 +97,53 @@ class ToupBase : public INDI::CCD
         // Capture
         //#############################################################################
         void allocateFrameBuffer();
+        // The SDK callback pulls frames into a back buffer which is then swapped with the frame buffer under ccdBufferLock
+        bool allocateBackBuffer();
+        void releaseBackBuffer();
+        bool swapBackBuffer(bool wait);
+        bool isTornFrame(const XP(FrameInfoV2) &info);
+        void updatePullStats(bool force);
         timeval m_ExposureEnd;
         double m_ExposureRequest;
 
+        //#############################################################################
+        // Trigger Sequence
+        //#############################################################################
+        // Exposure settings a sequence was armed with, a request with other settings stops it
+        struct SequenceSettings
+        {
+            double duration;
+            int x, y, w, h, binX, binY;
+            uint8_t format;
+            size_t pullSize;    // bytes pulled from the SDK per frame
+
+            bool operator==(const SequenceSettings &other) const
+            {
+                return duration == other.duration && x == other.x && y == other.y && w == other.w && h == other.h &&
+                       binX == other.binX && binY == other.binY && format == other.format && pullSize == other.pullSize;
+            }
+        };
+        // A frame of the sequence that arrived before the client asked for it
+        struct SequenceFrame
+        {
+            ScratchBuffer data;
+            uint64_t timestamp;     // camera timestamp, microseconds
+            timeval received;
+            int index;
+        };
+        SequenceSettings currentSequenceSettings();
+        size_t pullSize();
+        bool startSequence(const SequenceSettings &settings, int frames, int gap);
+        void stopSequence();
+        void queueSequenceFrame(int index);
+        static void deliverSequenceFrameHelper(void *context);
+        void deliverSequenceFrame();
+        void workerSequence(const std::atomic_bool &isAboutToQuit, int gap);
+        // Copy a pulled image into the frame buffer, splitting RGB into planes
+        void storeFrame(const uint8_t *buffer, size_t size);
+        void updateSequenceStatus();
+        timeval exposureStart(const timeval &received);
+
         //#############################################################################
         // Video Format & Streaming
         //#############################################################################
@@ -264,6 +316,31 @@ class ToupBase : public INDI::CCD
 
         INDI::PropertyNumber  m_ADCDepthNP{1};
 
+        // Pulled image statistics
+        INDI::PropertyNumber m_PullStatsNP {3};
+        enum
+        {
+            TC_PULL_FRAMES,
+            TC_PULL_TEARS,
+            TC_PULL_OVERRUNS,
+        };
+        INDI::ElapsedTimer m_PullStatsTimer;
+
+        // Trigger sequence
+        INumberVectorProperty m_SequenceNP;
+        INumber m_SequenceN[2];
+        enum
+        {
+            TC_SEQUENCE_FRAMES,
+            TC_SEQUENCE_GAP,
+        };
+        INDI::PropertyNumber m_SequenceStatusNP {2};
+        enum
+        {
+            TC_SEQUENCE_PENDING,
+            TC_SEQUENCE_QUEUED,
+        };
+
         // Timeout factor
         INumberVectorProperty m_TimeoutFactorNP;
         INumber m_TimeoutFactorN;
@@ -291,9 +368,32 @@ class ToupBase : public INDI::CCD
         uint8_t m_maxBitDepth { 8 };
         uint8_t m_Channels { 1 };
 
-        uint8_t *getRgbBuffer();
-        uint8_t *m_rgbBuffer { nullptr };
-        int32_t m_rgbBufferSize { 0 };
+        /** Reusable buffers for RGB frames before they are split into colour planes */
+        ScratchBufferPool m_ScratchPool;
+
+        /** Back buffer for pulled images, allocated like the frame buffer since the two are swapped */
+        uint8_t *m_BackBuffer {nullptr};
+        int m_BackBufferSize {0};
 
         int m_ConfigResolutionIndex {-1};
+
+        /** Trigger sequence state, shared with the SDK callback */
+        std::mutex m_SequenceMutex;
+        std::condition_variable m_SequenceCondition;
+        SequenceSettings m_SequenceSettings {};
+        std::deque<SequenceFrame> m_SequenceQueue;
+        int m_SequencePending {0};      // frames triggered but not received yet
+        int m_SequenceRemaining {0};    // frames not triggered yet
+        int m_SequenceReceived {0};
+        bool m_SequenceActive {false};
+        bool m_SequenceCancelled {false};
+        int m_SequenceDeliveryID {-1};
+        // Triggers the rest of the sequence as the client takes frames or the inter-frame gap passes
+        INDI::SingleThreadPool m_SequenceWorker;
+
+        /** Origin of the frame being published, for the FITS header */
+        uint64_t m_FrameTimestamp {0};
+        int m_FrameIndex {0};
+        double m_FrameQueued {0};
+        timeval m_FrameStart {0, 0};
 };
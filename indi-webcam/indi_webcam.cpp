@@ -193,7 +193,7 @@ indi_webcam::indi_webcam()
     frameRate = 30;
     videoSize = "640x480";
     webcamStacking = false;
-    averaging = false;
+    stackMethod = StackEngine::METHOD_SUM;
     outputFormat = "8 bit RGB";
 
     protocol = "HTTP";
@@ -487,6 +487,9 @@ bool indi_webcam::Disconnect()
 {
     if (isConnected())
     {
+        // Release the stack memory kept between exposures
+        stackEngine.clear();
+
         // Close the codecs
         avcodec_close(pCodecCtx);
 
@@ -520,15 +523,23 @@ bool indi_webcam::initProperties()
     CaptureFormat rgb = {"INDI_RGB", "RGB", 8, true};
     addCaptureFormat(rgb);
 
-    RapidStacking = new ISwitch[3];
+    RapidStacking = new ISwitch[5];
     IUFillSwitch(&RapidStacking[0], "Integration", "Integration", ISS_OFF);
     IUFillSwitch(&RapidStacking[1], "Average", "Average", ISS_OFF);
-    IUFillSwitch(&RapidStacking[2], "Off", "Off", ISS_ON);
+    IUFillSwitch(&RapidStacking[2], "Median", "Median", ISS_OFF);
+    IUFillSwitch(&RapidStacking[3], "Kappa-Sigma", "Kappa-Sigma", ISS_OFF);
+    IUFillSwitch(&RapidStacking[4], "Off", "Off", ISS_ON);
 
-    IUFillSwitchVector(&RapidStackingSelection, RapidStacking, 3, getDeviceName(), "RAPID_STACKING_OPTION", "Rapid Stacking",
+    IUFillSwitchVector(&RapidStackingSelection, RapidStacking, 5, getDeviceName(), "RAPID_STACKING_OPTION", "Rapid Stacking",
                        MAIN_CONTROL_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
     defineProperty(&RapidStackingSelection);
 
+    //Values further than kappa standard deviations from the mean are rejected by Kappa-Sigma stacking
+    IUFillNumber(&RapidStackingKappaN[0], "KAPPA", "Kappa", "%.2f", 0.5, 10, 0.1, stackKappa);
+    IUFillNumberVector(&RapidStackingKappaNP, RapidStackingKappaN, NARRAY(RapidStackingKappaN), getDeviceName(),
+                       "RAPID_STACKING_KAPPA", "Stacking Kappa", OPTIONS_TAB, IP_RW, 0, IPS_IDLE);
+    defineProperty(&RapidStackingKappaNP);
+
     OutputFormats = new ISwitch[3];
     IUFillSwitch(&OutputFormats[0], "16 bit Grayscale", "16 bit Grayscale", ISS_OFF);
     IUFillSwitch(&OutputFormats[1], "16 bit RGB", "16 bit RGB", ISS_OFF);
@@ -667,6 +678,7 @@ bool indi_webcam::initProperties()
     SetCCDCapability(cap);
 
     loadConfig(true, RapidStackingSelection.name);
+    loadConfig(true, RapidStackingKappaNP.name);
     loadConfig(true, OutputFormatSelection.name);
     loadConfig(true, PixelSizeTP.name);
     loadConfig(true, InputOptionsTP.name);
@@ -897,6 +909,16 @@ bool indi_webcam::ISNewNumber (const char *dev, const char *name, double values[
         return true;
     }
 
+    if (!strcmp(name, RapidStackingKappaNP.name) )
+    {
+        IUUpdateNumber(&RapidStackingKappaNP, values, names, n);
+        stackKappa = RapidStackingKappaN[0].value;
+        DEBUGF(INDI::Logger::DBG_SESSION, "New Stacking Kappa: %.2f", stackKappa);
+        RapidStackingKappaNP.s = IPS_OK;
+        IDSetNumber(&RapidStackingKappaNP, nullptr);
+        return true;
+    }
+
     if (!strcmp(name, TimeoutOptionsTP.name) )
     {
         IUUpdateNumber(&TimeoutOptionsTP, values, names, n);
@@ -1039,21 +1061,17 @@ bool indi_webcam::ISNewSwitch (const char *dev, const char *name, ISState *state
         ISwitch *sp = IUFindOnSwitch(&RapidStackingSelection);
         if (sp)
         {
+            webcamStacking = true;
             if(!strcmp(sp->name, "Integration"))
-            {
-                webcamStacking = true;
-                averaging = false;
-            }
-            if(!strcmp(sp->name, "Average"))
-            {
-                webcamStacking = true;
-                averaging = true;
-            }
-            if(!strcmp(sp->name, "Off"))
-            {
+                stackMethod = StackEngine::METHOD_SUM;
+            else if(!strcmp(sp->name, "Average"))
+                stackMethod = StackEngine::METHOD_MEAN;
+            else if(!strcmp(sp->name, "Median"))
+                stackMethod = StackEngine::METHOD_MEDIAN;
+            else if(!strcmp(sp->name, "Kappa-Sigma"))
+                stackMethod = StackEngine::METHOD_KAPPA_SIGMA;
+            else
                 webcamStacking = false;
-                averaging = false;
-            }
             RapidStackingSelection.s = IPS_OK;
             IDSetSwitch(&RapidStackingSelection, nullptr);
             return true;
@@ -1233,13 +1251,9 @@ bool indi_webcam::StartExposure(float duration)
         return false;
     }
 
-    //This resets the stack buffer
+    //This resets the stack, it is sized again on the first frame
     if(webcamStacking)
-    {
-        if(stackBuffer)
-            free(stackBuffer);
-        stackBuffer = nullptr;
-    }
+        resetStack();
 
     //This sets up the output format for the exposure
     if(outputFormat == "16 bit RGB")
@@ -1299,8 +1313,7 @@ bool indi_webcam::StartExposure(float duration)
 
 bool indi_webcam::AbortExposure()
 {
-    if(stackBuffer)
-        free(stackBuffer);
+    resetStack();
     InExposure = false;
     return true;
 }
@@ -1387,98 +1400,42 @@ bool indi_webcam::grabImage()
     return true;
 }
 
-//This adds each image to the running stack
-bool indi_webcam::addToStack()
+//This starts a new stack, keeping the stack memory when the frame size is the same
+void indi_webcam::resetStack()
 {
-    if(!stackBuffer)
-    {
-        stackBuffer = (float *)malloc(numBytes * sizeof(float_t));
-        numberOfFramesInStack = 0;
-    }
-
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    int h = pCodecCtx->height;
+    //Channels are interleaved in the frame buffer, so an RGB row is just three times as long
+    size_t w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
+    size_t h = pCodecCtx->height;
 
-    for (int i = 0; i < w * h; i++)
-    {
-        int x = i % w;
-        int y = i / w;
-        if(x >= 0 && y >= 0 && x < w && y < h)
-        {
-            if(numberOfFramesInStack == 0)
-                stackBuffer[i] = getImageDataFloatValue(x, y);
-            else
-                stackBuffer[i] += getImageDataFloatValue(x, y);
-        }
-    }
-    numberOfFramesInStack++;
-    return true;
+    stackEngine.reset(w, h, stackMethod, stackKappa);
 }
 
-//This gets the pixel value at an x, y position in the image
-float indi_webcam::getImageDataFloatValue(int x, int y)
+//This adds each image to the running stack
+bool indi_webcam::addToStack()
 {
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    uint8_t *primaryBuffer = PrimaryCCD.getFrameBuffer();
+    if(stackEngine.frames() == 0)
+        resetStack();
+
     if(PrimaryCCD.getBPP() == 8)
-        return (float) primaryBuffer[y * w + x];
+        stackEngine.add(PrimaryCCD.getFrameBuffer());
     else if(PrimaryCCD.getBPP() == 16)
-    {
-        uint16_t *newBuffer = reinterpret_cast<uint16_t *>(primaryBuffer);
-        return (float) newBuffer[y * w + x];
-    }
+        stackEngine.add(reinterpret_cast<uint16_t *>(PrimaryCCD.getFrameBuffer()));
     else
-        return 0;
-}
-//This sets the pixel value at an x, y position in the image
-void indi_webcam::setImageDataValueFromFloat(int x, int y, float value, bool roundAnswer)
-{
-    uint8_t *primaryBuffer = PrimaryCCD.getFrameBuffer();
-    int w = pCodecCtx->width * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    if(!stackBuffer)
-        return;
-    if(PrimaryCCD.getBPP() == 8)
-    {
-        int max = std::numeric_limits<uint8_t>::max();
-        if (value > max)
-            value = max;
-        if(roundAnswer)
-            primaryBuffer[y * w + x] = round(value);
-        else
-            primaryBuffer[y * w + x] = value;
-    }
-    else if(PrimaryCCD.getBPP() == 16)
-    {
-        int max = std::numeric_limits<uint16_t>::max();
-        if (value > max)
-            value = max;
-        uint16_t *newBuffer = reinterpret_cast<uint16_t *>(primaryBuffer);
-        if(roundAnswer)
-            newBuffer[y * w + x] = round(value);
-        else
-            newBuffer[y * w + x] = value;
-    }
+        return false;
+
+    return true;
 }
 
 //This will take the final image stack and copy it back to the primary buffer for final download.
 void indi_webcam::copyFinalStackToPrimaryFrameBuffer()
 {
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    int h = pCodecCtx->height;
-    for (int i = 0; i < w * h; i++)
-    {
-        int x = i % w;
-        int y = i / w;
-        if(x >= 0 && y >= 0 && x < w && y < h)
-        {
-            if(averaging)
-                setImageDataValueFromFloat(x, y, round(stackBuffer[i] / numberOfFramesInStack), true);
-            else //Integrating
-                setImageDataValueFromFloat(x, y, round(stackBuffer[i]), true);
-        }
-    }
+    if(PrimaryCCD.getBPP() == 8)
+        stackEngine.result(PrimaryCCD.getFrameBuffer());
+    else if(PrimaryCCD.getBPP() == 16)
+        stackEngine.result(reinterpret_cast<uint16_t *>(PrimaryCCD.getFrameBuffer()));
 
-    LOGF_INFO("Final Image is a stack of %u exposures.", numberOfFramesInStack);
+    LOGF_INFO("Final Image is a stack of %u exposures.", stackEngine.frames());
+    resetStack();
 }
 
 //This will crop the image to a subframe if desired.
@@ -1911,6 +1868,7 @@ bool indi_webcam::saveConfigItems(FILE *fp)
     INDI::CCD::saveConfigItems(fp);
     IUSaveConfigSwitch(fp, &CaptureDeviceSelection);
     IUSaveConfigSwitch(fp, &RapidStackingSelection);
+    IUSaveConfigNumber(fp, &RapidStackingKappaNP);
     IUSaveConfigSwitch(fp, &OutputFormatSelection);
     IUSaveConfigSwitch(fp, &OnlineProtocolSelection);
     IUSaveConfigNumber(fp, &PixelSizeTP);
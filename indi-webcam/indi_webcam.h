@@ -28,6 +28,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <indiccd.h>
 #include <stream/streammanager.h>
 
+#include "stack_engine.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -117,15 +119,12 @@ private:
     bool webcamStacking = false;
     bool gotAnImageAlready = false;
     bool loadingSettings = false;
-    bool averaging = false;
-    float *stackBuffer = nullptr;
-    int numberOfFramesInStack = 0;
+    StackEngine::Method stackMethod = StackEngine::METHOD_SUM;
+    double stackKappa = 2.5;
+    StackEngine stackEngine;
+    void resetStack();
     bool addToStack();
     void copyFinalStackToPrimaryFrameBuffer();
-    void setImageDataValueFromFloat(int x, int y, float value, bool roundAnswer);
-    void setRGBImageDataValueFromFloat(int x, int y, int channel, float value, bool roundAnswer);
-    float getImageDataFloatValue(int x, int y);
-    float getRGBImageDataFloatValue(int x, int y, int channel);
 
     //These are our device capture settings
     bool use16Bit = true;
@@ -183,6 +182,8 @@ private:
     INumberVectorProperty TimeoutOptionsTP;
     INumber PixelSizeT[1] {};
     INumberVectorProperty PixelSizeTP;
+    INumber RapidStackingKappaN[1] {};
+    INumberVectorProperty RapidStackingKappaNP;
     INumber VideoAdjustmentsT[3] {};
     INumberVectorProperty VideoAdjustmentsTP;
 
@@ -0,0 +1,295 @@
+/*
+INDI Webcam CCD Driver frame stacking
+
+Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "stack_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#define MAX_STACK_THREADS 16
+
+// Kappa-Sigma only starts rejecting once this many values were accepted
+#define KAPPA_SIGMA_WARMUP 3.0f
+// Smallest variance used for rejection, so quantized noise-free samples are not pinned
+#define KAPPA_SIGMA_MIN_VARIANCE 0.25f
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Row kernels
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+static void loadRow(const T *__restrict src, float *__restrict dst, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        dst[i] = src[i];
+}
+
+template <typename T>
+static void accumulateRow(const T *__restrict src, float *__restrict sum, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        sum[i] += src[i];
+}
+
+template <typename T>
+static void medianRow(const T *__restrict src, float *__restrict estimate, float *__restrict spread, size_t n,
+                      float rate, float stepScale)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        float diff = src[i] - estimate[i];
+        float distance = std::fabs(diff);
+        spread[i] += (distance - spread[i]) * rate;
+        // Never step past the new value
+        estimate[i] += std::copysign(std::min(distance, spread[i] * stepScale), diff);
+    }
+}
+
+template <typename T>
+static void kappaSigmaRow(const T *__restrict src, float *__restrict mean, float *__restrict m2,
+                          float *__restrict count, size_t n, float kappa2)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        float value = src[i];
+        float accepted = count[i];
+        float delta = value - mean[i];
+        float variance = std::max(m2[i] / std::max(accepted - 1.0f, 1.0f), KAPPA_SIGMA_MIN_VARIANCE);
+        float keep = (accepted < KAPPA_SIGMA_WARMUP || delta * delta <= kappa2 * variance) ? 1.0f : 0.0f;
+
+        accepted += keep;
+        mean[i] += keep * delta / accepted;
+        m2[i] += keep * delta * (value - mean[i]);
+        count[i] = accepted;
+    }
+}
+
+template <typename T>
+static void storeRow(const float *__restrict src, T *__restrict dst, size_t n, float scale)
+{
+    const float maximum = std::numeric_limits<T>::max();
+    for (size_t i = 0; i < n; i++)
+        dst[i] = static_cast<T>(std::min(std::max(src[i] * scale + 0.5f, 0.0f), maximum));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// StackEngine
+////////////////////////////////////////////////////////////////////////////////////////////////////
+StackEngine::StackEngine(unsigned int threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, static_cast<unsigned int>(MAX_STACK_THREADS));
+
+    mBands = threads;
+}
+
+void StackEngine::startWorkers()
+{
+    for (size_t i = 1; i < mBands; i++)
+        mWorkers.push_back(std::thread(&StackEngine::workerLoop, this, i - 1));
+}
+
+StackEngine::~StackEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQuit = true;
+    }
+    mWake.notify_all();
+
+    for (auto &worker : mWorkers)
+        worker.join();
+}
+
+void StackEngine::reset(size_t width, size_t height, Method method, float kappa)
+{
+    mWidth = width;
+    mHeight = height;
+    mMethod = method;
+    mKappa = kappa;
+    mFrames = 0;
+
+    size_t planes = 1;
+    if (method == METHOD_MEDIAN)
+        planes = 2;
+    else if (method == METHOD_KAPPA_SIGMA)
+        planes = 3;
+
+    // Keep the memory of the previous stack when the size is the same
+    for (size_t i = 0; i < 3; i++)
+    {
+        if (i < planes)
+            mPlanes[i].resize(width * height);
+        else
+            std::vector<float>().swap(mPlanes[i]);
+    }
+}
+
+void StackEngine::clear()
+{
+    for (auto &plane : mPlanes)
+        std::vector<float>().swap(plane);
+    mFrames = 0;
+}
+
+void StackEngine::add(const uint8_t *frame)
+{
+    addFrame(frame);
+}
+
+void StackEngine::add(const uint16_t *frame)
+{
+    addFrame(frame);
+}
+
+void StackEngine::result(uint8_t *frame)
+{
+    resultFrame(frame);
+}
+
+void StackEngine::result(uint16_t *frame)
+{
+    resultFrame(frame);
+}
+
+template <typename T>
+void StackEngine::addFrame(const T *frame)
+{
+    if (mPlanes[0].size() < mWidth * mHeight)
+        return;
+
+    const bool first = mFrames == 0;
+    const float frames = mFrames + 1;
+    const float kappa2 = mKappa * mKappa;
+
+    std::function<void(size_t, size_t)> job = [&](size_t y0, size_t y1)
+    {
+        const size_t offset = y0 * mWidth, n = (y1 - y0) * mWidth;
+        const T *src = frame + offset;
+
+        if (first)
+        {
+            loadRow(src, mPlanes[0].data() + offset, n);
+            if (mMethod == METHOD_MEDIAN)
+                std::fill_n(mPlanes[1].data() + offset, n, 0.0f);
+            else if (mMethod == METHOD_KAPPA_SIGMA)
+            {
+                std::fill_n(mPlanes[1].data() + offset, n, 0.0f);
+                std::fill_n(mPlanes[2].data() + offset, n, 1.0f);
+            }
+            return;
+        }
+
+        switch (mMethod)
+        {
+            case METHOD_SUM:
+            case METHOD_MEAN:
+                accumulateRow(src, mPlanes[0].data() + offset, n);
+                break;
+            case METHOD_MEDIAN:
+                medianRow(src, mPlanes[0].data() + offset, mPlanes[1].data() + offset, n, 1.0f / frames,
+                          1.5f / std::sqrt(frames));
+                break;
+            case METHOD_KAPPA_SIGMA:
+                kappaSigmaRow(src, mPlanes[0].data() + offset, mPlanes[1].data() + offset, mPlanes[2].data() + offset, n,
+                              kappa2);
+                break;
+        }
+    };
+
+    parallelRows(job);
+    mFrames++;
+}
+
+template <typename T>
+void StackEngine::resultFrame(T *frame)
+{
+    if (mFrames == 0 || mPlanes[0].size() < mWidth * mHeight)
+        return;
+
+    const float scale = (mMethod == METHOD_MEAN) ? 1.0f / mFrames : 1.0f;
+
+    std::function<void(size_t, size_t)> job = [&](size_t y0, size_t y1)
+    {
+        const size_t offset = y0 * mWidth;
+        storeRow(mPlanes[0].data() + offset, frame + offset, (y1 - y0) * mWidth, scale);
+    };
+
+    parallelRows(job);
+}
+
+void StackEngine::parallelRows(const std::function<void(size_t, size_t)> &job)
+{
+    if (mWorkers.empty() && mBands > 1)
+        startWorkers();
+
+    if (mWorkers.empty())
+    {
+        job(0, mHeight);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJob = &job;
+        mPending = mWorkers.size();
+        mGeneration++;
+    }
+    mWake.notify_all();
+
+    // The calling thread takes the first band
+    job(0, mHeight / mBands);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDone.wait(lock, [this]
+    {
+        return mPending == 0;
+    });
+    mJob = nullptr;
+}
+
+void StackEngine::workerLoop(size_t index)
+{
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        const std::function<void(size_t, size_t)> *job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWake.wait(lock, [&]
+            {
+                return mQuit || mGeneration != generation;
+            });
+            if (mQuit)
+                return;
+            generation = mGeneration;
+            job = mJob;
+        }
+
+        const size_t band = index + 1;
+        (*job)(mHeight * band / mBands, mHeight * (band + 1) / mBands);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mPending == 0)
+            mDone.notify_one();
+    }
+}
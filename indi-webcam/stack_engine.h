@@ -0,0 +1,124 @@
+/*
+INDI Webcam CCD Driver frame stacking
+
+Copyright (C) 2026 Jasem Mutlaq (mutlaqja@ikarustech.com)
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Combines a series of frames into one, without keeping the frames around.
+ *
+ * Frames are 8 or 16 bit samples, rows of interleaved channels are simply treated as
+ * longer rows. The work is split in bands of rows handed to a small pool of worker
+ * threads, and every band is processed by plain loops over contiguous float planes that
+ * the compiler can vectorize.
+ *
+ * - Sum and Mean accumulate the samples.
+ * - Median keeps a running estimate per sample that moves towards each new value by a
+ *   step scaled by the running mean absolute deviation and shrinking with the frame count.
+ * - Kappa-Sigma keeps a running mean and variance per sample, and once a few frames are in
+ *   rejects values further than kappa standard deviations from the mean.
+ */
+class StackEngine
+{
+    public:
+        enum Method
+        {
+            METHOD_SUM,
+            METHOD_MEAN,
+            METHOD_MEDIAN,
+            METHOD_KAPPA_SIGMA
+        };
+
+        /** @param threads threads to use, 0 picks one per CPU core. The worker threads are only
+         *  started by the first frame. */
+        explicit StackEngine(unsigned int threads = 0);
+        ~StackEngine();
+
+        StackEngine(const StackEngine &) = delete;
+        StackEngine &operator=(const StackEngine &) = delete;
+
+        /**
+         * @brief Start a new stack.
+         * @param width samples per row (pixels * channels)
+         * @param height rows
+         */
+        void reset(size_t width, size_t height, Method method, float kappa = 2.5f);
+
+        /** Add a frame of width * height samples. */
+        void add(const uint8_t *frame);
+        void add(const uint16_t *frame);
+
+        /** Write the stacked frame, rounded and clamped to the sample range. */
+        void result(uint8_t *frame);
+        void result(uint16_t *frame);
+
+        /** Release the stack memory. reset() keeps it for the next stack of the same size. */
+        void clear();
+
+        uint32_t frames() const
+        {
+            return mFrames;
+        }
+
+        Method method() const
+        {
+            return mMethod;
+        }
+
+        unsigned int threads() const
+        {
+            return static_cast<unsigned int>(mBands);
+        }
+
+    private:
+        template <typename T> void addFrame(const T *frame);
+        template <typename T> void resultFrame(T *frame);
+
+        /** Run job over [0, height) split in bands, on the workers and the calling thread. */
+        void parallelRows(const std::function<void(size_t, size_t)> &job);
+        void startWorkers();
+        void workerLoop(size_t index);
+
+        size_t mWidth {0};
+        size_t mHeight {0};
+        Method mMethod {METHOD_MEAN};
+        float mKappa {2.5f};
+        uint32_t mFrames {0};
+
+        // Per sample state: sum, or estimate plus spread, or mean plus M2 plus accepted count
+        std::vector<float> mPlanes[3];
+
+        std::vector<std::thread> mWorkers;
+        size_t mBands {1};
+        std::mutex mMutex;
+        std::condition_variable mWake;
+        std::condition_variable mDone;
+        const std::function<void(size_t, size_t)> *mJob {nullptr};
+        uint64_t mGeneration {0};
+        size_t mPending {0};
+        bool mQuit {false};
+};
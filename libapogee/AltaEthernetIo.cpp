@@ -105,7 +105,8 @@ namespace
 //////////////////////////// 
 // CTOR 
 AltaEthernetIo::AltaEthernetIo( const std::string url ) : m_url( url ),
-                                                          m_fileName( __BASE_FILE__ )
+                                                          m_fileName( __BASE_FILE__ ),
+                                                          m_ImgCurl( new CLibCurlWrap )
 
 { 
     //open a session with the camera
@@ -325,17 +326,16 @@ void AltaEthernetIo::GetImageData(std::vector<uint16_t> & ImageData)
     const int32_t NumBytesExpected = 
         apgHelper::SizeT2Int32( ImageData.size() )*sizeof(uint16_t);
 
-    //grab the data
+    //grab the data, swapped to host order as it arrives
     std::string fullUrl = m_url + "/UE/image.bin";
 
-    CLibCurlWrap theCurl;
-    std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    const size_t NumBytesReceived = m_ImgCurl->HttpGetSwap16( fullUrl, 
+        &ImageData[0], ImageData.size() );
 
-    if( NumBytesExpected !=  apgHelper::SizeT2Int32( result.size() ) )
+    if( NumBytesExpected !=  apgHelper::SizeT2Int32( NumBytesReceived ) )
     {
         std::stringstream received;
-        received <<  result.size();
+        received <<  NumBytesReceived;
 
         std::stringstream requested;
         requested << NumBytesExpected;
@@ -345,22 +345,6 @@ void AltaEthernetIo::GetImageData(std::vector<uint16_t> & ImageData)
         apgHelper::throwRuntimeException( m_fileName, errMsg, 
             __LINE__, Apg::ErrorType_Critical );
     }
-    
-    std::string::iterator strIter;
-    std::string::iterator strIterNext;
-    std::vector<uint16_t>::iterator dataIter;
-    int32_t i=0;
-
-    for(strIter = result.begin(); strIter != result.end(); strIter+=2, ++i)
-    {
-        strIterNext = strIter+1;
-        uint8_t a = (*strIter);
-        uint8_t b = (*strIterNext);
-
-        //TODO verify this works on mac...
-        uint16_t v = ((a << 8) | b);
-        ImageData.at(i) = v;
-    }
 }
 
 //////////////////////////// 
@@ -17,9 +17,13 @@
 #include <vector>
 #include <map>
 
+#include <memory>
+
 #include "ICamIo.h" 
 #include "IAltaSerialPortIo.h" 
 
+class CLibCurlWrap;
+
 class AltaEthernetIo : public ICamIo, public IAltaSerialPortIo
 { 
     public: 
@@ -84,6 +88,8 @@ class AltaEthernetIo : public ICamIo, public IAltaSerialPortIo
         const std::string m_url;
         const std::string m_fileName;
         std::vector<uint16_t> m_StatusRegs;
+        // kept across images so the connection is reused
+        std::shared_ptr<CLibCurlWrap> m_ImgCurl;
 
         //disabling the copy ctor and assignment operator
         //generated by the compiler - don't want them
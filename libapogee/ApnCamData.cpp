@@ -13,6 +13,7 @@
 #include "ApnCamData.h"
 
 #include "apgHelper.h"
+#include "CfgBinCache.h"
 #include "helpers.h"
 #include "parseCfgTabDelim.h"
 
@@ -156,6 +157,18 @@ void CApnCamData::Set( const std::string &path,
         std::string fixedPath = help::FixPath(path);
         std::string fullFile = fixedPath + cfgFile;
 
+        //try the parsed data from the last connect first
+        std::string cacheDir = CfgBinCache::GetCacheDir();
+        std::string cacheFile;
+        if( !cacheDir.empty() )
+        {
+            cacheFile = CfgBinCache::MkCacheFileName( cacheDir, CamId );
+            if( CfgBinCache::Load( cacheFile, fullFile, CamId, *this ) )
+            {
+                return;
+            }
+        }
+
         m_MetaData = parseCfgTabDelim::FetchMetaData( fullFile, CamId );
 
         //use the sensor data to
@@ -226,6 +239,12 @@ void CApnCamData::Set( const std::string &path,
         //Fast roi dual
         m_RoiPatternFastDual  = parseCfgTabDelim::FetchHorizontalPattern(
                                     MkPatternFileName( fixedPath, m_MetaData.RoiPatternFastDual )  );
+
+        if( !cacheFile.empty() )
+        {
+            CfgBinCache::Save( cacheFile,
+                CfgBinCache::SourceFiles( fixedPath, cfgFile, *this ), *this );
+        }
     }
     catch( std::exception &e)
     {
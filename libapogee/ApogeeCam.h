@@ -1166,6 +1166,17 @@ class DLL_EXPORT ApogeeCam
          */
         virtual void GetImage( std::vector<uint16_t> & out ) = 0;
 
+        /*! 
+         * Downloads the image data from the camera straight into a caller 
+         * supplied buffer, without allocating per image.  The camera data is
+         * staged in a buffer kept across images and reordered in one pass into out.
+         * \param [out] out Buffer that will recieve the image data
+         * \param [in] count Number of pixels out can hold, must be at least
+         * GetRoiNumCols() times the number of rows of the image
+         * \exception std::runtime_error
+         */
+        virtual void GetImage( uint16_t * out, size_t count ) = 0;
+
         /*! 
          * This method halts an in progress exposure. If this method is called 
          * and there is no exposure in progress a std::runtime_error exception is thrown.
@@ -1284,7 +1295,7 @@ class DLL_EXPORT ApogeeCam
         virtual uint16_t GetImageZ() = 0;
         virtual uint16_t GetIlluminationMask() = 0;
         virtual void FixImgFromCamera( const std::vector<uint16_t> & data,
-            std::vector<uint16_t> & out,  int32_t rows, int32_t cols) = 0;
+            uint16_t * out,  int32_t rows, int32_t cols) = 0;
                 
 //this code removes vc++ compiler warning C4251
 //from http://www.unknownroad.com/rtfm/VisualStudio/warningC4251.html
@@ -1316,6 +1327,10 @@ class DLL_EXPORT ApogeeCam
         bool m_IsInitialized;
         bool m_IsConnected;
 		double m_LastExposureTime;
+
+        // raw data from the camera, kept across images so it is only
+        // allocated (and zeroed) when the image gets bigger
+        std::vector<uint16_t> m_ImgStaging;
      
     private:
 
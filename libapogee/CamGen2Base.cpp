@@ -316,6 +316,23 @@ Apg::Status CamGen2Base::GetImagingStatus()
 //////////////////////////// 
 // GET  IMAGE 
 void CamGen2Base::GetImage( std::vector<uint16_t> & out )
+{
+    uint16_t r=0, c = 0;
+    ExposureAndGetImgRC( r, c );
+    const int32_t numPixels = r*GetImageZ()*GetRoiNumCols();
+
+    if( numPixels != apgHelper::SizeT2Int32( out.size() ) )
+    {
+        out.clear();
+        out.resize( numPixels );
+    }
+
+    GetImage( &out[0], out.size() );
+}
+
+//////////////////////////// 
+// GET  IMAGE 
+void CamGen2Base::GetImage( uint16_t * out, const size_t count )
 {
 #ifdef DEBUGGING_CAMERA
     apgHelper::DebugMsg( "CamGen2Base::GetImage -> BEGIN" );
@@ -342,29 +359,32 @@ void CamGen2Base::GetImage( std::vector<uint16_t> & out )
     }
 
 
-    // allocating the buffers for the image
-    // doing this outside of the try / catch, so that
+    // the raw camera data goes to a staging buffer kept across
+    // images, it is sized outside of the try / catch, so that
     // even if the GetImage function throws
     // we can try to copy whatever data we managed
     // to fetch from the camera into the user supplied
-    // vector
-    uint16_t r=0, c= 0;
+    // buffer
+    uint16_t r=0, c = 0;
     ExposureAndGetImgRC( r, c );
     const uint16_t z = GetImageZ();
-    std::vector<uint16_t>  datafromCam( r*c*z );
+    m_ImgStaging.resize( r*c*z );
 
     const int32_t dataLen = r*z;
-    const int32_t numCols = GetRoiNumCols();
-    
-    if( dataLen*numCols != apgHelper::SizeT2Int32( out.size() ) )
+    const int32_t numCols = GetRoiNumCols();  
+
+    if( static_cast<size_t>( dataLen*numCols ) > count )
     {
-        out.clear();
-        out.resize( dataLen*numCols );
+        std::stringstream msg;
+        msg << "Output buffer of " << count << " pixels too small for image of ";
+        msg << dataLen*numCols << " pixels.";
+        apgHelper::throwRuntimeException( m_fileName, msg.str(), 
+            __LINE__, Apg::ErrorType_InvalidUsage );
     }
 
     try
     {
-        m_CamIo->GetImageData( datafromCam );
+        m_CamIo->GetImageData( m_ImgStaging );
     }
     catch(std::exception & err )
     {
@@ -374,7 +394,7 @@ void CamGen2Base::GetImage( std::vector<uint16_t> & out )
         ApgLogger::Instance().Write(ApgLogger::LEVEL_RELEASE,"error",
         apgHelper::mkMsg( m_fileName, msg, __LINE__) );
 
-        FixImgFromCamera( datafromCam, out, dataLen, numCols );
+        FixImgFromCamera( m_ImgStaging, out, dataLen, numCols );
         throw;
     }
         
@@ -401,7 +421,7 @@ void CamGen2Base::GetImage( std::vector<uint16_t> & out )
     }
     
     // at a minimum removing the AD garbage pixels at the beginning of every row
-    FixImgFromCamera( datafromCam, out, dataLen, numCols );
+    FixImgFromCamera( m_ImgStaging, out, dataLen, numCols );
 
    ApgLogger::Instance().Write(ApgLogger::LEVEL_DEBUG,"info","Get Image Completed.");
 
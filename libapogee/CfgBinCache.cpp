@@ -0,0 +1,566 @@
+/*!
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \brief Binary cache of the parsed configuration matrix and pattern files.
+*
+* Layout, native byte order: magic, version, camera id, the source files as
+* path, mtime and size, then the metadata and the 18 pattern tables in the
+* order of the CApnCamData members. Strings and vectors are prefixed with
+* their uint32_t length.
+*/
+
+#include "CfgBinCache.h"
+#include "ApnCamData.h"
+#include "apgHelper.h"
+#include "helpers.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef WIN_OS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const uint32_t CACHE_MAGIC = 0x43475041; // "APGC"
+    const uint32_t CACHE_VERSION = 1;
+
+    struct SourceStamp
+    {
+        int64_t MtimeSec;
+        int64_t MtimeNsec;
+        uint64_t Size;
+    };
+
+    //  GET     SOURCE      STAMP
+    bool GetSourceStamp( const std::string & fileName, SourceStamp & stamp )
+    {
+#ifdef WIN_OS
+        return false;
+#else
+        struct stat st;
+        if( stat( fileName.c_str(), &st ) != 0 )
+        {
+            return false;
+        }
+
+        stamp.MtimeSec = st.st_mtime;
+#if defined(__APPLE__)
+        stamp.MtimeNsec = st.st_mtimespec.tv_nsec;
+#else
+        stamp.MtimeNsec = st.st_mtim.tv_nsec;
+#endif
+        stamp.Size = st.st_size;
+        return true;
+#endif
+    }
+
+    //  WRITER
+    class Writer
+    {
+        public:
+            template <typename T> void operator()( const T & value )
+            {
+                Raw( &value, sizeof(value) );
+            }
+
+            void operator()( const bool value )
+            {
+                (*this)( static_cast<uint8_t>( value ? 1 : 0 ) );
+            }
+
+            void operator()( const CamCfg::ApnAdType value )
+            {
+                (*this)( static_cast<int32_t>( value ) );
+            }
+
+            void operator()( const std::string & value )
+            {
+                (*this)( static_cast<uint32_t>( value.size() ) );
+                Raw( value.data(), value.size() );
+            }
+
+            void operator()( const std::vector<uint16_t> & value )
+            {
+                (*this)( static_cast<uint32_t>( value.size() ) );
+                Raw( value.data(), value.size() * sizeof(uint16_t) );
+            }
+
+            void operator()( const std::vector< std::vector<uint16_t> > & value )
+            {
+                (*this)( static_cast<uint32_t>( value.size() ) );
+                for( size_t i = 0; i < value.size(); ++i )
+                {
+                    (*this)( value[i] );
+                }
+            }
+
+            const std::string & Data() const { return m_Data; }
+
+        private:
+            void Raw( const void * data, size_t len )
+            {
+                m_Data.append( static_cast<const char *>( data ), len );
+            }
+
+            std::string m_Data;
+    };
+
+    //  READER
+    class Reader
+    {
+        public:
+            Reader( const uint8_t * data, size_t len ) : m_Pos( data ), m_End( data + len ) {}
+
+            template <typename T> void operator()( T & value )
+            {
+                Raw( &value, sizeof(value) );
+            }
+
+            void operator()( bool & value )
+            {
+                uint8_t v = 0;
+                (*this)( v );
+                value = ( v != 0 );
+            }
+
+            void operator()( CamCfg::ApnAdType & value )
+            {
+                int32_t v = 0;
+                (*this)( v );
+                value = CamCfg::ConvertInt2ApnAdType( v );
+            }
+
+            void operator()( std::string & value )
+            {
+                const uint32_t len = Length( 1 );
+                value.assign( reinterpret_cast<const char *>( m_Pos ), len );
+                m_Pos += len;
+            }
+
+            void operator()( std::vector<uint16_t> & value )
+            {
+                const uint32_t len = Length( sizeof(uint16_t) );
+                value.resize( len );
+                Raw( value.data(), len * sizeof(uint16_t) );
+            }
+
+            void operator()( std::vector< std::vector<uint16_t> > & value )
+            {
+                const uint32_t len = Length( sizeof(uint32_t) );
+                value.resize( len );
+                for( size_t i = 0; i < value.size(); ++i )
+                {
+                    (*this)( value[i] );
+                }
+            }
+
+            bool AtEnd() const { return m_Pos == m_End; }
+
+        private:
+            // reads a length prefix and checks that many items can still follow
+            uint32_t Length( size_t itemSize )
+            {
+                uint32_t len = 0;
+                (*this)( len );
+                if( static_cast<size_t>( m_End - m_Pos ) / itemSize < len )
+                {
+                    throw std::runtime_error( "truncated cache file" );
+                }
+                return len;
+            }
+
+            void Raw( void * data, size_t len )
+            {
+                if( static_cast<size_t>( m_End - m_Pos ) < len )
+                {
+                    throw std::runtime_error( "truncated cache file" );
+                }
+                if( len > 0 )
+                {
+                    memcpy( data, m_Pos, len );
+                    m_Pos += len;
+                }
+            }
+
+            const uint8_t * m_Pos;
+            const uint8_t * m_End;
+    };
+
+    //  SERIALIZE     META
+    template <typename Archive, typename Meta>
+    void SerializeMeta( Archive & ar, Meta & m )
+    {
+        ar( m.Sensor );
+        ar( m.CameraId );
+        ar( m.CameraLine );
+        ar( m.CameraModel );
+        ar( m.InterlineCCD );
+        ar( m.SupportsSerialA );
+        ar( m.SupportsSerialB );
+        ar( m.SensorTypeCCD );
+        ar( m.TotalColumns );
+        ar( m.ImagingColumns );
+        ar( m.ClampColumns );
+        ar( m.PreRoiSkipColumns );
+        ar( m.PostRoiSkipColumns );
+        ar( m.OverscanColumns );
+        ar( m.TotalRows );
+        ar( m.ImagingRows );
+        ar( m.UnderscanRows );
+        ar( m.OverscanRows );
+        ar( m.VFlushBinning );
+        ar( m.EnableSingleRowOffset );
+        ar( m.RowOffsetBinning );
+        ar( m.HFlushDisable );
+        ar( m.ShutterCloseDelay );
+        ar( m.PixelSizeX );
+        ar( m.PixelSizeY );
+        ar( m.Color );
+        ar( m.ReportedGainSixteenBit );
+        ar( m.MinSuggestedExpTime );
+        ar( m.CoolingSupported );
+        ar( m.RegulatedCoolingSupported );
+        ar( m.TempSetPoint );
+        ar( m.TempRampRateOne );
+        ar( m.TempRampRateTwo );
+        ar( m.TempBackoffPoint );
+        ar( m.PrimaryADType );
+        ar( m.AlternativeADType );
+        ar( m.PrimaryADLatency );
+        ar( m.AlternativeADLatency );
+        ar( m.IRPreflashTime );
+        ar( m.AdCfg );
+        ar( m.DefaultGainLeft );
+        ar( m.DefaultOffsetLeft );
+        ar( m.DefaultGainRight );
+        ar( m.DefaultOffsetRight );
+        ar( m.DefaultRVoltage );
+        ar( m.DefaultDataReduction );
+        ar( m.VideoSubSample );
+        ar( m.AmpCutoffDisable );
+        ar( m.NumAdOutputs );
+        ar( m.SupportsSingleDualReadoutSwitching );
+        ar( m.VerticalPattern );
+        ar( m.ClampPatternNormal );
+        ar( m.SkipPatternNormal );
+        ar( m.RoiPatternNormal );
+        ar( m.ClampPatternFast );
+        ar( m.SkipPatternFast );
+        ar( m.RoiPatternFast );
+        ar( m.VerticalPatternVideo );
+        ar( m.ClampPatternVideo );
+        ar( m.SkipPatternVideo );
+        ar( m.RoiPatternVideo );
+        ar( m.ClampPatternNormalDual );
+        ar( m.SkipPatternNormalDual );
+        ar( m.RoiPatternNormalDual );
+        ar( m.ClampPatternFastDual );
+        ar( m.SkipPatternFastDual );
+        ar( m.RoiPatternFastDual );
+    }
+
+    //  SERIALIZE     PATTERN
+    template <typename Archive, typename Pattern>
+    void SerializeVPattern( Archive & ar, Pattern & p )
+    {
+        ar( p.Mask );
+        ar( p.PatternData );
+    }
+
+    template <typename Archive, typename Pattern>
+    void SerializeHPattern( Archive & ar, Pattern & p )
+    {
+        ar( p.Mask );
+        ar( p.RefPatternData );
+        ar( p.BinPatternData );
+        ar( p.SigPatternData );
+    }
+
+    //  SERIALIZE     CAM     DATA
+    template <typename Archive, typename CamData>
+    void SerializeCamData( Archive & ar, CamData & d )
+    {
+        SerializeMeta( ar, d.m_MetaData );
+        SerializeVPattern( ar, d.m_VerticalPattern );
+        SerializeHPattern( ar, d.m_ClampPatternNormal );
+        SerializeHPattern( ar, d.m_SkipPatternNormal );
+        SerializeHPattern( ar, d.m_RoiPatternNormal );
+        SerializeHPattern( ar, d.m_ClampPatternFast );
+        SerializeHPattern( ar, d.m_SkipPatternFast );
+        SerializeHPattern( ar, d.m_RoiPatternFast );
+        SerializeVPattern( ar, d.m_VerticalPatternVideo );
+        SerializeHPattern( ar, d.m_ClampPatternVideo );
+        SerializeHPattern( ar, d.m_SkipPatternVideo );
+        SerializeHPattern( ar, d.m_RoiPatternVideo );
+        SerializeHPattern( ar, d.m_ClampPatternNormalDual );
+        SerializeHPattern( ar, d.m_SkipPatternNormalDual );
+        SerializeHPattern( ar, d.m_RoiPatternNormalDual );
+        SerializeHPattern( ar, d.m_ClampPatternFastDual );
+        SerializeHPattern( ar, d.m_SkipPatternFastDual );
+        SerializeHPattern( ar, d.m_RoiPatternFastDual );
+    }
+
+    //  READ     CACHE
+    bool ReadCache( const uint8_t * data, size_t len, const std::string & cfgFile,
+        uint16_t CamId, CApnCamData & out )
+    {
+        Reader ar( data, len );
+
+        uint32_t magic = 0, version = 0, numSources = 0;
+        uint16_t id = 0;
+        ar( magic );
+        ar( version );
+        ar( id );
+        if( magic != CACHE_MAGIC || version != CACHE_VERSION || id != CamId )
+        {
+            return false;
+        }
+
+        ar( numSources );
+        for( uint32_t i = 0; i < numSources; ++i )
+        {
+            std::string fileName;
+            SourceStamp cached, current;
+            ar( fileName );
+            ar( cached.MtimeSec );
+            ar( cached.MtimeNsec );
+            ar( cached.Size );
+
+            //the first source is the matrix the cache was built from
+            if( 0 == i && fileName != cfgFile )
+            {
+                return false;
+            }
+
+            if( !GetSourceStamp( fileName, current ) ||
+                current.MtimeSec != cached.MtimeSec ||
+                current.MtimeNsec != cached.MtimeNsec ||
+                current.Size != cached.Size )
+            {
+                return false;
+            }
+        }
+
+        if( 0 == numSources )
+        {
+            return false;
+        }
+
+        SerializeCamData( ar, out );
+        return ar.AtEnd();
+    }
+
+    //  MK     DIRS
+    bool MkDirs( const std::string & dir )
+    {
+#ifdef WIN_OS
+        return false;
+#else
+        for( size_t pos = dir.find( '/', 1 ); ; pos = dir.find( '/', pos + 1 ) )
+        {
+            const std::string sub = dir.substr( 0, pos );
+            if( !sub.empty() && mkdir( sub.c_str(), 0755 ) != 0 && errno != EEXIST )
+            {
+                return false;
+            }
+
+            if( std::string::npos == pos )
+            {
+                return true;
+            }
+        }
+#endif
+    }
+}
+
+//--------------------------------------------------------------------------------
+
+////////////////////////////
+//      GET     CACHE      DIR
+std::string CfgBinCache::GetCacheDir()
+{
+#ifdef WIN_OS
+    return std::string();
+#else
+    //an empty override turns the cache off
+    const char * dir = getenv( "APOGEE_CFG_CACHE_DIR" );
+    if( dir )
+    {
+        return ( *dir ? help::FixPath( dir ) : std::string() );
+    }
+
+    dir = getenv( "XDG_CACHE_HOME" );
+    if( dir && *dir )
+    {
+        return help::FixPath( dir ) + "libapogee/";
+    }
+
+    dir = getenv( "HOME" );
+    if( dir && *dir )
+    {
+        return help::FixPath( dir ) + ".cache/libapogee/";
+    }
+
+    return std::string();
+#endif
+}
+
+////////////////////////////
+//      MK      CACHE      FILE     NAME
+std::string CfgBinCache::MkCacheFileName( const std::string & cacheDir, const uint16_t CamId )
+{
+    return help::FixPath( cacheDir ) + "apncfg_" + help::uShort2Str( CamId ) + ".bin";
+}
+
+////////////////////////////
+//      SOURCE      FILES
+std::vector<std::string> CfgBinCache::SourceFiles( const std::string & path,
+    const std::string & cfgFile, const CApnCamData & data )
+{
+    const std::string fixedPath = help::FixPath( path );
+    const CamCfg::APN_CAMERA_METADATA & m = data.m_MetaData;
+
+    const std::string patterns[] =
+    {
+        m.VerticalPattern, m.ClampPatternNormal, m.SkipPatternNormal, m.RoiPatternNormal,
+        m.ClampPatternFast, m.SkipPatternFast, m.RoiPatternFast,
+        m.VerticalPatternVideo, m.ClampPatternVideo, m.SkipPatternVideo, m.RoiPatternVideo,
+        m.ClampPatternNormalDual, m.SkipPatternNormalDual, m.RoiPatternNormalDual,
+        m.ClampPatternFastDual, m.SkipPatternFastDual, m.RoiPatternFastDual
+    };
+
+    std::vector<std::string> result;
+    result.push_back( fixedPath + cfgFile );
+
+    //patterns are shared between modes, list each file once
+    for( size_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); ++i )
+    {
+        const std::string fileName = fixedPath + patterns[i] + ".txt";
+        if( std::find( result.begin(), result.end(), fileName ) == result.end() )
+        {
+            result.push_back( fileName );
+        }
+    }
+
+    return result;
+}
+
+////////////////////////////
+//      LOAD
+bool CfgBinCache::Load( const std::string & cacheFile, const std::string & cfgFile,
+    const uint16_t CamId, CApnCamData & out )
+{
+#ifdef WIN_OS
+    return false;
+#else
+    const int fd = open( cacheFile.c_str(), O_RDONLY | O_CLOEXEC );
+    if( fd < 0 )
+    {
+        return false;
+    }
+
+    struct stat st;
+    if( fstat( fd, &st ) != 0 || st.st_size <= 0 )
+    {
+        close( fd );
+        return false;
+    }
+
+    const size_t len = st.st_size;
+    void * map = mmap( nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+
+    if( MAP_FAILED == map )
+    {
+        return false;
+    }
+
+    CApnCamData data;
+    bool result = false;
+    try
+    {
+        result = ReadCache( static_cast<const uint8_t *>( map ), len, cfgFile, CamId, data );
+    }
+    catch( std::exception & )
+    {
+        result = false;
+    }
+
+    munmap( map, len );
+
+    if( result )
+    {
+        out = data;
+    }
+
+    return result;
+#endif
+}
+
+////////////////////////////
+//      SAVE
+void CfgBinCache::Save( const std::string & cacheFile,
+    const std::vector<std::string> & sources, const CApnCamData & data )
+{
+#ifndef WIN_OS
+    Writer ar;
+    ar( CACHE_MAGIC );
+    ar( CACHE_VERSION );
+    ar( data.m_MetaData.CameraId );
+    ar( static_cast<uint32_t>( sources.size() ) );
+
+    std::vector<std::string>::const_iterator iter;
+    for( iter = sources.begin(); iter != sources.end(); ++iter )
+    {
+        SourceStamp stamp;
+        if( !GetSourceStamp( *iter, stamp ) )
+        {
+            return;
+        }
+
+        ar( *iter );
+        ar( stamp.MtimeSec );
+        ar( stamp.MtimeNsec );
+        ar( stamp.Size );
+    }
+
+    SerializeCamData( ar, data );
+
+    //write a temporary file and rename it over the cache, so a
+    //concurrent Load never sees a partial file
+    const size_t slash = cacheFile.rfind( '/' );
+    std::stringstream tmpFile;
+    tmpFile << cacheFile << ".tmp" << getpid();
+
+    bool written = ( std::string::npos == slash || MkDirs( cacheFile.substr( 0, slash ) ) );
+
+    if( written )
+    {
+        FILE * fp = fopen( tmpFile.str().c_str(), "wb" );
+        written = ( fp != nullptr );
+        if( fp )
+        {
+            written = ( fwrite( ar.Data().data(), 1, ar.Data().size(), fp ) == ar.Data().size() );
+            written = ( 0 == fclose( fp ) ) && written;
+        }
+    }
+
+    if( !written || rename( tmpFile.str().c_str(), cacheFile.c_str() ) != 0 )
+    {
+        remove( tmpFile.str().c_str() );
+        apgHelper::LogWarningMsg( __FILE__, "Failed writing configuration cache " + cacheFile, __LINE__ );
+    }
+#endif
+}
@@ -0,0 +1,63 @@
+/*!
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \brief Binary cache of the parsed configuration matrix and pattern files.
+*
+* One cache file per camera id holds the metadata and all pattern tables of
+* that camera, together with the path, mtime and size of every source file
+* they were parsed from. Loading maps the cache file once and rebuilds the
+* data from it, a cache whose sources changed is ignored and rewritten.
+*/
+
+
+#ifndef CFGBINCACHE_INCLUDE_H__
+#define CFGBINCACHE_INCLUDE_H__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class CApnCamData;
+
+namespace CfgBinCache
+{
+    /*!
+     * Directory holding the cache files, $APOGEE_CFG_CACHE_DIR, else
+     * $XDG_CACHE_HOME/libapogee/ or $HOME/.cache/libapogee/.
+     * \return empty string when there is no usable location
+     */
+    std::string GetCacheDir();
+
+    /*!
+     * \param [in] cacheDir Directory returned by GetCacheDir()
+     * \param [in] CamId Camera id
+     * \return full path of the cache file for the camera
+     */
+    std::string MkCacheFileName( const std::string & cacheDir, uint16_t CamId );
+
+    /*!
+     * Files the camera data was parsed from, the configuration matrix first
+     * followed by every pattern file named in the metadata.
+     */
+    std::vector<std::string> SourceFiles( const std::string & path,
+        const std::string & cfgFile, const CApnCamData & data );
+
+    /*!
+     * Fills out from the cache file if it was built for CamId from the given
+     * configuration matrix, and none of its source files changed since.
+     * \return false on a missing, stale or damaged cache, out is left untouched
+     */
+    bool Load( const std::string & cacheFile, const std::string & cfgFile,
+        uint16_t CamId, CApnCamData & out );
+
+    /*!
+     * Writes the cache file for data, parsed from the given sources. Failures
+     * are logged as warnings, the cache is only an optimization.
+     */
+    void Save( const std::string & cacheFile,
+        const std::vector<std::string> & sources, const CApnCamData & data );
+}
+
+#endif
@@ -0,0 +1,231 @@
+/*!
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \file CfgCacheBench.cpp
+* \brief Times CApnCamData::Set, the connect time configuration load, for
+* every camera in the configuration matrix.
+*
+* Each camera is loaded three times: parsing the text files with the cache
+* turned off, parsing them and writing the cache, and from the cache. The
+* parsed and cached data are compared field by field through their cache
+* encoding.
+*
+* std::regex recurses for every character the pattern file sections match,
+* the larger files in conf/ need more than the default 8 MB of stack to
+* parse, so the benchmark runs on a thread with a bigger one.
+*
+* Usage: cfgcache_bench [conf dir] [rounds]
+*/
+
+#include "ApnCamData.h"
+#include "CfgBinCache.h"
+#include "parseCfgTabDelim.h"
+#include "helpers.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct Timing
+    {
+        double total;
+        double max;
+    };
+
+    std::string ReadAll( const std::string & fileName )
+    {
+        std::ifstream file( fileName.c_str(), std::ios::binary );
+        return std::string( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+    }
+
+    // loads every camera once, returns the failures
+    int LoadAll( const std::string & confDir, const std::vector<uint16_t> & ids,
+        std::vector<CApnCamData> & out, Timing & timing )
+    {
+        int failed = 0;
+        timing.total = timing.max = 0;
+        out.assign( ids.size(), CApnCamData() );
+
+        for( size_t i = 0; i < ids.size(); ++i )
+        {
+            Clock::time_point start = Clock::now();
+            try
+            {
+                out[i].Set( confDir, "apnmatrix.txt", ids[i] );
+            }
+            catch( std::exception & )
+            {
+                ++failed;
+            }
+            const double ms = std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+            timing.total += ms;
+            timing.max = std::max( timing.max, ms );
+        }
+
+        return failed;
+    }
+
+    void Report( const char * name, const Timing & timing, size_t cameras )
+    {
+        printf( "%-8s | %10.1f | %9.3f | %9.3f\n", name, timing.total, timing.total / cameras, timing.max );
+    }
+
+    int Run( const std::string & confDir, int rounds )
+    {
+        std::vector< std::shared_ptr<CamCfg::APN_CAMERA_METADATA> > meta;
+        parseCfgTabDelim::FetchMetaData( confDir + "apnmatrix.txt", meta );
+
+        std::vector<uint16_t> ids;
+        for( size_t i = 0; i < meta.size(); ++i )
+        {
+            if( std::find( ids.begin(), ids.end(), meta[i]->CameraId ) == ids.end() )
+            {
+                ids.push_back( meta[i]->CameraId );
+            }
+        }
+
+        char cacheDir[] = "/tmp/cfgcache_benchXXXXXX";
+        if( !mkdtemp( cacheDir ) )
+        {
+            perror( "mkdtemp" );
+            return 1;
+        }
+
+        std::vector<CApnCamData> parsed, built, cached;
+        Timing parseTime = { 0, 0 }, buildTime = { 0, 0 }, cacheTime = { 0, 0 };
+        int failed = 0;
+
+        for( int r = 0; r < rounds; ++r )
+        {
+            Timing t;
+
+            setenv( "APOGEE_CFG_CACHE_DIR", "", 1 );
+            failed = LoadAll( confDir, ids, parsed, t );
+            parseTime.total += t.total / rounds;
+            parseTime.max = std::max( parseTime.max, t.max );
+
+            //every round rebuilds the cache from scratch
+            setenv( "APOGEE_CFG_CACHE_DIR", cacheDir, 1 );
+            for( size_t i = 0; i < ids.size(); ++i )
+            {
+                remove( CfgBinCache::MkCacheFileName( cacheDir, ids[i] ).c_str() );
+            }
+            LoadAll( confDir, ids, built, t );
+            buildTime.total += t.total / rounds;
+            buildTime.max = std::max( buildTime.max, t.max );
+
+            LoadAll( confDir, ids, cached, t );
+            cacheTime.total += t.total / rounds;
+            cacheTime.max = std::max( cacheTime.max, t.max );
+        }
+
+        //compare through the cache encoding, and count the source files covered
+        std::set<std::string> covered;
+        int mismatches = 0;
+        const std::string fileA = std::string( cacheDir ) + "/a.bin";
+        const std::string fileB = std::string( cacheDir ) + "/b.bin";
+        size_t cacheBytes = 0;
+        for( size_t i = 0; i < ids.size(); ++i )
+        {
+            std::vector<std::string> sources = CfgBinCache::SourceFiles( confDir, "apnmatrix.txt", parsed[i] );
+            covered.insert( sources.begin(), sources.end() );
+
+            CfgBinCache::Save( fileA, sources, parsed[i] );
+            CfgBinCache::Save( fileB, sources, cached[i] );
+            if( ReadAll( fileA ) != ReadAll( fileB ) )
+            {
+                ++mismatches;
+            }
+
+            cacheBytes += ReadAll( CfgBinCache::MkCacheFileName( cacheDir, ids[i] ) ).size();
+            remove( CfgBinCache::MkCacheFileName( cacheDir, ids[i] ).c_str() );
+        }
+        remove( fileA.c_str() );
+        remove( fileB.c_str() );
+        rmdir( cacheDir );
+
+        size_t confFiles = 0;
+        if( DIR * dir = opendir( confDir.c_str() ) )
+        {
+            while( struct dirent * entry = readdir( dir ) )
+            {
+                if( entry->d_name[0] != '.' )
+                {
+                    ++confFiles;
+                }
+            }
+            closedir( dir );
+        }
+
+        printf( "%zu cameras, %zu of %zu files in %s, %d failed to load, %d rounds\n",
+            ids.size(), covered.size(), confFiles, confDir.c_str(), failed, rounds );
+        printf( "cache files %.1f KB in total\n\n", cacheBytes / 1024.0 );
+        printf( "%-8s | %10s | %9s | %9s\n", "load", "total ms", "ms/cam", "max ms" );
+        Report( "parse", parseTime, ids.size() );
+        Report( "build", buildTime, ids.size() );
+        Report( "cached", cacheTime, ids.size() );
+        printf( "\nspeedup %.1fx\n", parseTime.total / cacheTime.total );
+
+        if( mismatches )
+        {
+            printf( "\n%d cameras differ between the parsed and cached data\n", mismatches );
+            return 1;
+        }
+
+        return 0;
+    }
+
+    struct Args
+    {
+        std::string confDir;
+        int rounds;
+        int result;
+    };
+
+    void * RunThread( void * arg )
+    {
+        Args * args = static_cast<Args *>( arg );
+        args->result = Run( args->confDir, args->rounds );
+        return nullptr;
+    }
+}
+
+int main( int argc, char * argv[] )
+{
+    Args args;
+    args.confDir = help::FixPath( argc > 1 ? argv[1] : "conf" );
+    args.rounds = argc > 2 ? std::max( 1, atoi( argv[2] ) ) : 3;
+    args.result = 1;
+
+    pthread_attr_t attr;
+    pthread_attr_init( &attr );
+    pthread_attr_setstacksize( &attr, 256 * 1024 * 1024 );
+
+    pthread_t thread;
+    if( pthread_create( &thread, &attr, RunThread, &args ) != 0 )
+    {
+        perror( "pthread_create" );
+        return 1;
+    }
+    pthread_join( thread, nullptr );
+    pthread_attr_destroy( &attr );
+
+    return args.result;
+}
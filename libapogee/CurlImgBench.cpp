@@ -0,0 +1,205 @@
+/*!
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \file CurlImgBench.cpp
+* \brief Times the Alta ethernet image download against a local HTTP server.
+*
+* A server thread on the loopback interface serves a synthetic big endian
+* image.bin. The legacy path downloads it on a new handle into a string and
+* swaps it into the image with at(), the streaming path swaps every chunk
+* straight into the image on a handle kept across downloads.
+*
+* Usage: curl_img_bench [cols] [rows] [downloads]
+*/
+
+#include "libCurlWrap.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<uint8_t> imageBin;
+
+    // minimal HTTP/1.1 server, answers every request on a connection with image.bin
+    void ServeConnection( int fd )
+    {
+        std::string request;
+        char buf[4096];
+
+        while( true )
+        {
+            const ssize_t n = recv( fd, buf, sizeof(buf), 0 );
+            if( n <= 0 )
+                break;
+            request.append( buf, n );
+
+            size_t end;
+            while( (end = request.find( "\r\n\r\n" )) != std::string::npos )
+            {
+                request.erase( 0, end + 4 );
+
+                char header[256];
+                const int len = snprintf( header, sizeof(header),
+                    "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: %zu\r\n\r\n",
+                    imageBin.size() );
+                send( fd, header, len, MSG_NOSIGNAL );
+
+                size_t sent = 0;
+                while( sent < imageBin.size() )
+                {
+                    const ssize_t s = send( fd, &imageBin[sent], imageBin.size() - sent, MSG_NOSIGNAL );
+                    if( s <= 0 )
+                    {
+                        close( fd );
+                        return;
+                    }
+                    sent += s;
+                }
+            }
+        }
+        close( fd );
+    }
+
+    int StartServer()
+    {
+        const int fd = socket( AF_INET, SOCK_STREAM, 0 );
+        sockaddr_in addr;
+        memset( &addr, 0, sizeof(addr) );
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        addr.sin_port = 0;
+
+        socklen_t addrLen = sizeof(addr);
+        if( bind( fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr) ) != 0 ||
+            listen( fd, 8 ) != 0 ||
+            getsockname( fd, reinterpret_cast<sockaddr *>(&addr), &addrLen ) != 0 )
+        {
+            perror( "server" );
+            exit( 1 );
+        }
+
+        std::thread( [fd]
+        {
+            while( true )
+            {
+                const int client = accept( fd, nullptr, nullptr );
+                if( client < 0 )
+                    return;
+                std::thread( ServeConnection, client ).detach();
+            }
+        } ).detach();
+
+        return ntohs( addr.sin_port );
+    }
+
+    long StatusKb( const char * key )
+    {
+        std::ifstream status( "/proc/self/status" );
+        std::string line;
+        while( std::getline( status, line ) )
+        {
+            if( line.compare( 0, strlen(key), key ) == 0 )
+                return atol( line.c_str() + strlen(key) );
+        }
+        return 0;
+    }
+
+    // starts a new peak RSS measurement, returns the current RSS
+    long ResetPeak()
+    {
+        std::ofstream clearRefs( "/proc/self/clear_refs" );
+        clearRefs << "5";
+        return StatusKb( "VmRSS:" );
+    }
+
+    // AltaEthernetIo::GetImageData before the streaming download
+    void LegacyDownload( const std::string & url, std::vector<uint16_t> & ImageData )
+    {
+        CLibCurlWrap theCurl;
+        std::string result;
+        theCurl.HttpGet( url, result );
+
+        std::string::iterator strIter;
+        int32_t i=0;
+        for(strIter = result.begin(); strIter != result.end(); strIter+=2, ++i)
+        {
+            uint8_t a = (*strIter);
+            uint8_t b = (*(strIter+1));
+            uint16_t v = ((a << 8) | b);
+            ImageData.at(i) = v;
+        }
+    }
+
+    void Report( const char * name, double seconds, int downloads, long peakKb )
+    {
+        const double mb = static_cast<double>( imageBin.size() ) * downloads / (1024.0 * 1024.0);
+        printf( "%-10s | %9.2f | %9.1f | %10ld\n", name, seconds * 1000.0 / downloads, mb / seconds, peakKb );
+    }
+}
+
+int main( int argc, char * argv[] )
+{
+    const size_t cols = argc > 1 ? atoi( argv[1] ) : 3072;
+    const size_t rows = argc > 2 ? atoi( argv[2] ) : 2048;
+    const int downloads = argc > 3 ? atoi( argv[3] ) : 10;
+
+    // big endian ramp, so a swap error shows up in the check
+    imageBin.resize( cols * rows * 2 );
+    for( size_t i = 0; i < cols * rows; ++i )
+    {
+        imageBin[2*i] = static_cast<uint8_t>( (i * 7) >> 8 );
+        imageBin[2*i+1] = static_cast<uint8_t>( i * 7 );
+    }
+
+    char url[64];
+    snprintf( url, sizeof(url), "http://127.0.0.1:%d/UE/image.bin", StartServer() );
+
+    printf( "%zux%zu image, %.1f MB, %d downloads\n\n", cols, rows, imageBin.size() / (1024.0 * 1024.0), downloads );
+    printf( "%-10s | %9s | %9s | %10s\n", "path", "ms/image", "MB/s", "peak KB" );
+
+    std::vector<uint16_t> streamed( cols * rows ), legacy( cols * rows );
+
+    // streaming first, peak RSS only ever grows
+    {
+        CLibCurlWrap curl;
+        long base = ResetPeak();
+        Clock::time_point start = Clock::now();
+        for( int i = 0; i < downloads; ++i )
+            curl.HttpGetSwap16( url, &streamed[0], streamed.size() );
+        Report( "streaming", std::chrono::duration<double>( Clock::now() - start ).count(), downloads,
+                StatusKb( "VmHWM:" ) - base );
+    }
+
+    {
+        long base = ResetPeak();
+        Clock::time_point start = Clock::now();
+        for( int i = 0; i < downloads; ++i )
+            LegacyDownload( url, legacy );
+        Report( "legacy", std::chrono::duration<double>( Clock::now() - start ).count(), downloads,
+                StatusKb( "VmHWM:" ) - base );
+    }
+
+    if( streamed != legacy )
+    {
+        printf( "\nMISMATCH between the streaming and legacy images\n" );
+        return 1;
+    }
+
+    return 0;
+}
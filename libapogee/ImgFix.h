@@ -38,6 +38,20 @@ namespace ImgFix
                                      std::vector<uint16_t> & out,
                                      const int32_t rows,  const int32_t cols,
                                      const int32_t numLatencyPixels );
+
+    // raw pointer versions, writing straight into a caller supplied buffer
+    // of at least rows*cols elements.  the vector versions above call these.
+    void SingleOuputCopy( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t numImgCols, int32_t numLatencyPixels );
+
+    void QuadOuputCopy( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t cols, int32_t numLatencyPixels );
+
+    void QuadOuputFix( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t cols, int32_t numLatencyPixels );
+
+    void DualOuputFix( const uint16_t * data, uint16_t * out,
+        int32_t rows, int32_t cols, int32_t numLatencyPixels );
 }; 
 
 #endif
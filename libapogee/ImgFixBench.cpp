@@ -0,0 +1,234 @@
+/*!
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \file ImgFixBench.cpp
+* \brief Times the download side of GetImage for every output channel configuration.
+*
+* The legacy path allocates a zeroed vector for the camera data, fixes it into
+* an output vector and copies that into the frame buffer. The direct path keeps
+* the staging buffer across frames and fixes it straight into the frame buffer.
+* The camera transfer itself is not simulated, both paths start from the same
+* raw data.
+*
+* Usage: imgfix_bench [frames]
+*/
+
+#include "ImgFix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    enum Outputs { SINGLE, DUAL, QUAD_FIX, QUAD_COPY };
+
+    struct Config
+    {
+        const char * name;
+        Outputs outputs;
+        int32_t rows;
+        int32_t cols;
+        int32_t latency;
+    };
+
+    // the vector kernels as they were before the pointer versions
+    namespace Legacy
+    {
+        void SingleOuputCopy( const std::vector<uint16_t> & data,
+            std::vector<uint16_t> & out, const int32_t rows, const int32_t numImgCols,
+            const int32_t numLatencyPixels )
+        {
+            const int32_t actNumCols = numImgCols + numLatencyPixels;
+
+            for(int32_t r = 0, actColsOffset=numLatencyPixels, outColsOffset=0; r < rows;
+                actColsOffset += actNumCols, outColsOffset += numImgCols, ++r)
+            {
+                std::vector<uint16_t>::const_iterator start = data.begin()+actColsOffset;
+                std::vector<uint16_t>::const_iterator end = start + numImgCols;
+                std::vector<uint16_t>::iterator outStart = out.begin() + outColsOffset;
+                std::copy( start, end, outStart );
+            }
+        }
+
+        void QuadOuputCopy( const std::vector<uint16_t> & data,
+            std::vector<uint16_t> & out, const int32_t rows, const int32_t cols,
+            const int32_t numLatencyPixels )
+        {
+            int32_t numGood = ( cols / 2 ) * 4;
+            int32_t numBad = numLatencyPixels*2;
+            int32_t down = rows*cols;
+            int32_t goodStart = 0;
+            int32_t badStart = numLatencyPixels*2;
+
+            while( down > 0 )
+            {
+                int32_t len = std::min<int32_t>( down, numGood );
+                std::vector<uint16_t>::const_iterator start = data.begin()+badStart;
+                std::copy( start, start + len, out.begin() + goodStart );
+                goodStart += len;
+                badStart += (len + numBad);
+                down -= len;
+            }
+        }
+
+        void QuadOuputFix( const std::vector<uint16_t> & data,
+            std::vector<uint16_t> & out, const int32_t rows, const int32_t cols,
+            const int32_t numLatencyPixels )
+        {
+            const int32_t HALF_COLS = cols / 2;
+            const int32_t HALF_ROWS = rows / 2;
+            int32_t index = numLatencyPixels*2;
+
+            for( int32_t r=0; r < HALF_ROWS; ++r )
+            {
+                int32_t topOffset = cols*r;
+                int32_t bottomOffset = (cols*(rows-(r+1)));
+
+                for( int32_t c=0; c < HALF_COLS; ++c)
+                {
+                    out[topOffset + c] = data[index];
+                    ++index;
+                    out[topOffset + (cols-(c+1))] = data[index];
+                    ++index;
+                    out[bottomOffset + (cols-(c+1))] = data[index];
+                    ++index;
+                    out[bottomOffset + c] = data[index];
+                    ++index;
+                }
+                index += numLatencyPixels*2;
+            }
+        }
+
+        void DualOuputFix( const std::vector<uint16_t> & data,
+            std::vector<uint16_t> & out, const int32_t rows, const int32_t cols,
+            const int32_t numLatencyPixels )
+        {
+            const int32_t HALF_COLS = cols / 2;
+            const int32_t oddAdjust = ( cols % 2 ) ? 1 : 0;
+            int32_t index = numLatencyPixels;
+
+            for( int32_t r=0; r < rows; ++r )
+            {
+                int32_t topOffset = cols*r;
+                for( int32_t c=0; c < HALF_COLS; ++c)
+                {
+                    out[topOffset + (cols-(c+1)) - oddAdjust] = data[index];
+                    ++index;
+                    out[topOffset + c] = data[index];
+                    ++index;
+                }
+                index += numLatencyPixels;
+            }
+        }
+    }
+
+    // size of the raw camera data, latency pixels included
+    size_t RawSize( const Config & cfg )
+    {
+        switch( cfg.outputs )
+        {
+            case DUAL:
+                return static_cast<size_t>( cfg.rows ) * ( cfg.cols + cfg.latency );
+            case QUAD_FIX:
+            case QUAD_COPY:
+                return static_cast<size_t>( cfg.rows / 2 ) * ( cfg.cols * 2 + cfg.latency * 2 ) + cfg.latency * 2;
+            default:
+                return static_cast<size_t>( cfg.rows ) * ( cfg.cols + cfg.latency );
+        }
+    }
+
+    void LegacyFix( const Config & cfg, const std::vector<uint16_t> & data, std::vector<uint16_t> & out )
+    {
+        switch( cfg.outputs )
+        {
+            case SINGLE:    Legacy::SingleOuputCopy( data, out, cfg.rows, cfg.cols, cfg.latency ); break;
+            case DUAL:      Legacy::DualOuputFix( data, out, cfg.rows, cfg.cols, cfg.latency ); break;
+            case QUAD_FIX:  Legacy::QuadOuputFix( data, out, cfg.rows, cfg.cols, cfg.latency ); break;
+            case QUAD_COPY: Legacy::QuadOuputCopy( data, out, cfg.rows, cfg.cols, cfg.latency ); break;
+        }
+    }
+
+    void DirectFix( const Config & cfg, const uint16_t * data, uint16_t * out )
+    {
+        switch( cfg.outputs )
+        {
+            case SINGLE:    ImgFix::SingleOuputCopy( data, out, cfg.rows, cfg.cols, cfg.latency ); break;
+            case DUAL:      ImgFix::DualOuputFix( data, out, cfg.rows, cfg.cols, cfg.latency ); break;
+            case QUAD_FIX:  ImgFix::QuadOuputFix( data, out, cfg.rows, cfg.cols, cfg.latency ); break;
+            case QUAD_COPY: ImgFix::QuadOuputCopy( data, out, cfg.rows, cfg.cols, cfg.latency ); break;
+        }
+    }
+
+    double Ms( Clock::time_point start )
+    {
+        return std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+    }
+}
+
+int main( int argc, char * argv[] )
+{
+    const int frames = argc > 1 ? std::max( 1, atoi( argv[1] ) ) : 20;
+
+    // latency values as seen from GetPixelShift and the quad ExposureAndGetImgRC
+    const Config configs[] =
+    {
+        { "single 3072x2048", SINGLE,    2048, 3072, 8  },
+        { "dual   4096x4096", DUAL,      4096, 4096, 16 },
+        { "quad   4096x4096", QUAD_FIX,  4096, 4096, 32 },
+        { "quad copy",        QUAD_COPY, 4096, 4096, 32 },
+    };
+
+    printf( "%d frames per configuration\n\n", frames );
+    printf( "%-18s | %21s | %21s | %s\n", "", "legacy", "direct", "" );
+    printf( "%-18s | %9s %11s | %9s %11s | %7s\n", "outputs", "ms/frame", "MPix/s", "ms/frame", "MPix/s", "speedup" );
+
+    for( size_t i = 0; i < sizeof( configs ) / sizeof( configs[0] ); ++i )
+    {
+        const Config & cfg = configs[i];
+        const size_t pixels = static_cast<size_t>( cfg.rows ) * cfg.cols;
+
+        // what the camera sent
+        std::vector<uint16_t> wire( RawSize( cfg ) );
+        for( size_t p = 0; p < wire.size(); ++p )
+            wire[p] = static_cast<uint16_t>( rand() );
+
+        std::vector<uint16_t> frameLegacy( pixels ), frameDirect( pixels );
+
+        Clock::time_point start = Clock::now();
+        for( int f = 0; f < frames; ++f )
+        {
+            std::vector<uint16_t> datafromCam( wire.size(), 0 );
+            memcpy( &datafromCam[0], &wire[0], wire.size() * sizeof( uint16_t ) );
+
+            std::vector<uint16_t> out( pixels );
+            LegacyFix( cfg, datafromCam, out );
+            std::copy( out.begin(), out.end(), frameLegacy.begin() );
+        }
+        const double legacyMs = Ms( start ) / frames;
+
+        std::vector<uint16_t> staging;
+        start = Clock::now();
+        for( int f = 0; f < frames; ++f )
+        {
+            staging.resize( wire.size() );
+            memcpy( &staging[0], &wire[0], wire.size() * sizeof( uint16_t ) );
+
+            DirectFix( cfg, &staging[0], &frameDirect[0] );
+        }
+        const double directMs = Ms( start ) / frames;
+
+        printf( "%-18s | %9.2f %11.1f | %9.2f %11.1f | %6.2fx%s\n", cfg.name,
+            legacyMs, pixels / legacyMs / 1000.0, directMs, pixels / directMs / 1000.0,
+            legacyMs / directMs, frameLegacy == frameDirect ? "" : "  MISMATCH" );
+    }
+
+    return 0;
+}
@@ -11,6 +11,7 @@
 
 #include "libCurlWrap.h" 
 #include <stdexcept>
+#include <algorithm>
 
 #include "apgHelper.h" 
 
@@ -44,6 +45,58 @@ static int32_t strWriter(char *data, size_t size, size_t nmemb,
     return apgHelper::SizeT2Int32( numBytes );
 }
 
+//////////////////////////// 
+// SWAP16 WRITER
+// Writes big endian 16 bit data into the destination as it is received.
+// Chunks can end half way through a value, the odd byte is kept until
+// the next chunk completes it.
+struct Swap16Sink
+{
+    uint16_t * dest;
+    size_t capacity;    // bytes
+    size_t received;    // bytes
+    uint8_t carry;
+};
+
+static size_t swap16Writer(char *data, size_t size, size_t nmemb,
+                  Swap16Sink *sink)
+{
+    const size_t numBytes = size * nmemb;
+    const size_t pos = sink->received;
+    sink->received += numBytes;
+
+    // anything past the end is only counted, the caller checks the size
+    if( pos >= sink->capacity )
+    {
+        return numBytes;
+    }
+
+    const uint8_t * src = reinterpret_cast<const uint8_t *>( data );
+    size_t n = std::min( numBytes, sink->capacity - pos );
+    uint16_t * out = sink->dest + pos / 2;
+
+    if( pos & 1 )
+    {
+        *out++ = static_cast<uint16_t>( (sink->carry << 8) | src[0] );
+        ++src;
+        --n;
+    }
+
+    // simple enough for the compiler to vectorize
+    const size_t words = n / 2;
+    for( size_t i = 0; i < words; ++i )
+    {
+        out[i] = static_cast<uint16_t>( (src[2*i] << 8) | src[2*i+1] );
+    }
+
+    if( n & 1 )
+    {
+        sink->carry = src[n-1];
+    }
+
+    return numBytes;
+}
+
 //////////////////////////// 
 // LOCAL     NAMESPACE
 namespace
@@ -64,6 +117,10 @@ CLibCurlWrap::CLibCurlWrap() : m_curlHandle( 0 ),
          apgHelper::throwRuntimeException( m_fileName, 
              errStr, __LINE__, Apg::ErrorType_Connection );
     }
+
+    // the connection is reused by later requests on this handle,
+    // keep it alive between them
+    curl_easy_setopt(m_curlHandle, CURLOPT_TCP_KEEPALIVE, 1L);
 } 
 
 //////////////////////////// 
@@ -118,6 +175,32 @@ void CLibCurlWrap::HttpPost(const std::string & url,
 }
 
 
+//////////////////////////// 
+// HTTP GET     SWAP 16
+size_t CLibCurlWrap::HttpGetSwap16(const std::string & url,
+            uint16_t * dest, const size_t count)
+{
+    Swap16Sink sink = { dest, count * sizeof(uint16_t), 0, 0 };
+
+    curl_easy_setopt(m_curlHandle, CURLOPT_ERRORBUFFER, errorBuffer);  
+    curl_easy_setopt(m_curlHandle, CURLOPT_URL, url.c_str());  
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEFUNCTION, swap16Writer);  
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEDATA, &sink); 
+    curl_easy_setopt(m_curlHandle, CURLOPT_TIMEOUT, m_timeout);
+
+    const CURLcode returnCode = curl_easy_perform(m_curlHandle);
+
+    if( CURLE_OK != returnCode )
+    {
+        std::string curlError( errorBuffer );
+
+        apgHelper::throwRuntimeException( m_fileName, curlError, 
+            __LINE__, Apg::ErrorType_Critical );
+    }
+
+    return sink.received;
+}
+
 //////////////////////////// 
 // CURL     SETUP  STR  WRITE
 void CLibCurlWrap::CurlSetupStrWrite(const std::string & url)
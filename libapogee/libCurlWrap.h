@@ -38,6 +38,12 @@ class CLibCurlWrap
             const std::string & postFields, 
             std::vector<uint8_t> & result);
 
+        // downloads 16 bit big endian data straight into dest,
+        // swapping each chunk to host order as it arrives.  at most
+        // count elements are written, returns the number of bytes received
+        size_t HttpGetSwap16(const std::string & url,
+            uint16_t * dest, size_t count);
+
 		void setTimeout( int timeout );
 		unsigned int getTimeout();
 
@@ -61,6 +61,7 @@
 #include "libfli-camera.h"
 #include "libfli-camera-usb.h"
 #include "libfli-usb.h"
+#include "libfli-swab.h"
 #include "indimacros.h"
 
 double dconvert(void *buf)
@@ -1085,17 +1086,8 @@ long fli_camera_usb_grab_row(flidev_t dev, void *buff, size_t width)
 				cam->gbuf[2] = htons((unsigned short) cam->grabrowbatchsize);
 				IO(dev, cam->gbuf, &wlen, &rlen);
 
-				for (x = 0; x < (cam->grabrowwidth * cam->grabrowbatchsize); x++)
-				{
-					if ((DEVICE->devinfo.hwrev & 0xff00) == 0x0100)
-					{
-						cam->gbuf[x] = ntohs(cam->gbuf[x]) + 32768;
-					}
-					else
-					{
-						cam->gbuf[x] = ntohs(cam->gbuf[x]);
-					}
-				}
+				fli_be16toh(cam->gbuf, cam->gbuf, cam->grabrowwidth * cam->grabrowbatchsize,
+					((DEVICE->devinfo.hwrev & 0xff00) == 0x0100) ? 32768 : 0);
 				cam->grabrowbufferindex = 0;
 			}
 
@@ -1289,7 +1281,6 @@ long fli_camera_usb_grab_row(flidev_t dev, void *buff, size_t width)
 		case FLIUSB_PROLINE_ID:
 		{
 			long rlen = 0, rtotal = 0;
-			int index = 0;
 
 			/*
 			 * cam->gbuf_siz -- size of the grab buffer (bytes)
@@ -1527,11 +1518,8 @@ long fli_camera_usb_grab_row(flidev_t dev, void *buff, size_t width)
 					cam->bytesleft -= rlen;
 				}
 
-				for (index = 0; index < (rlen / (long) sizeof(unsigned short)); index ++)
-				{
-					*cam->ibuf_wr_idx = ((cam->gbuf[index] << 8) & 0xff00) | ((cam->gbuf[index] >> 8) & 0x00ff);
-					cam->ibuf_wr_idx++;
-				}
+				fli_be16toh(cam->ibuf_wr_idx, cam->gbuf, rlen / sizeof(unsigned short), 0);
+				cam->ibuf_wr_idx += rlen / sizeof(unsigned short);
 			}
 
 			memset(left, 0x00, width * sizeof(unsigned short));
@@ -1730,6 +1718,147 @@ long fli_camera_usb_grab_row(flidev_t dev, void *buff, size_t width)
 	return 0;
 }
 
+/* Reads in flight while FLIGrabFrame() fills the Proline image buffer */
+#define FLIUSB_GRAB_QUEUE_DEPTH (8)
+
+/* Converts one completed read of the Proline image stream in place */
+static long fli_camera_usb_proline_chunk(void *ctx, void *buf, long len)
+{
+	flicamdata_t *cam = ctx;
+
+	fli_be16toh(buf, buf, len / sizeof(unsigned short), 0);
+	cam->ibuf_wr_idx += len / sizeof(unsigned short);
+
+	if (len == 0x03) /* The camera is telling us there is no more data */
+	{
+		cam->bytesleft = 0;
+		return 1;
+	}
+
+	cam->bytesleft -= len;
+	return 0;
+}
+
+/* Streams at least bytes of the Proline image into the image buffer, where
+ * fli_camera_usb_grab_row() picks the rows up without further IO. Reads are
+ * whole max_usb_xfer blocks from the start of the image, as when the image is
+ * read in one go, only the last one is short. Bytes read past the request stay
+ * in the image buffer for the next rows. */
+static long fli_camera_usb_proline_fill(flidev_t dev, size_t bytes)
+{
+	flicamdata_t *cam = DEVICE->device_data;
+	long rlen, r = 0;
+
+	if (cam->ibuf == NULL)
+		return -ENOMEM;
+
+	if (bytes == 0)
+		return 0;
+
+	bytes = ((bytes + cam->max_usb_xfer - 1) / cam->max_usb_xfer) * cam->max_usb_xfer;
+	bytes = MIN(bytes, cam->bytesleft);
+	if (bytes == 0)
+		return 0;
+
+	debug(FLIDEBUG_INFO, "Streaming %d bytes of image data.", bytes);
+
+#ifdef usb_bulkread_queued
+	rlen = (long) bytes;
+	r = usb_bulkread_queued(dev, 0x82, cam->ibuf_wr_idx, &rlen, cam->max_usb_xfer,
+		FLIUSB_GRAB_QUEUE_DEPTH, fli_camera_usb_proline_chunk, cam);
+#else
+	while ((r == 0) && (bytes > 0))
+	{
+		long rtotal;
+
+		rlen = rtotal = (long) MIN(bytes, (size_t) cam->max_usb_xfer);
+		r = usb_bulktransfer(dev, 0x82, cam->ibuf_wr_idx, &rlen);
+		bytes -= rlen;
+
+		if (fli_camera_usb_proline_chunk(cam, cam->ibuf_wr_idx, rlen) || (rlen < rtotal))
+			break;
+	}
+#endif
+
+	if (r != 0)
+		debug(FLIDEBUG_FAIL, "Read failed...");
+
+	return r;
+}
+
+long fli_camera_usb_grab_frame(flidev_t dev, void *buff, size_t buffsize, size_t *bytesgrabbed)
+{
+	flicamdata_t *cam = DEVICE->device_data;
+	size_t width, rowsize, rows, row;
+	long r = 0;
+
+	*bytesgrabbed = 0;
+
+	width = cam->image_area.lr.x - cam->image_area.ul.x;
+	rowsize = width * sizeof(unsigned short);
+
+	if ((rowsize == 0) || (buffsize < rowsize))
+	{
+		debug(FLIDEBUG_FAIL, "Buffer not large enough to receive a row.");
+		return -EINVAL;
+	}
+
+	/* Whole rows only, continuing where the last grab stopped */
+	rows = buffsize / rowsize;
+
+	switch (DEVICE->devinfo.devid)
+  {
+		/* MaxCam and IMG cameras send rows in batches on request */
+		case FLIUSB_CAM_ID:
+			if (cam->grabrowindex >= cam->grabrowcounttot)
+				rows = 0;
+			else
+				rows = MIN(rows, (size_t) (cam->grabrowcounttot - cam->grabrowindex));
+			break;
+
+		case FLIUSB_PROLINE_ID:
+		{
+			size_t bytes = cam->bytesleft;
+
+			if (cam->grabrowindex >= cam->grabrowcount)
+				rows = 0;
+			else
+				rows = MIN(rows, (size_t) (cam->grabrowcount - cam->grabrowindex));
+
+			/* TDI rows are read one at a time as they are clocked out */
+			if ((rows == 0) || (cam->tdirate != 0))
+				break;
+
+			/* Single quadrant readouts are stored row after row, stream what
+			 * these rows need, rounded up to whole transfers. Otherwise the
+			 * bottom rows come last. */
+			if (cam->bottom_height == 0)
+			{
+				size_t need = (cam->grabrowindex + rows) * (cam->left_width + cam->right_width);
+				size_t have = cam->ibuf_wr_idx - cam->ibuf;
+
+				bytes = (need > have) ? (need - have) * sizeof(unsigned short) : 0;
+			}
+
+			if ((r = fli_camera_usb_proline_fill(dev, bytes)))
+				return r;
+		}
+		break;
+
+		default:
+			debug(FLIDEBUG_WARN, "Hmmm, shouldn't be here, operation on NO camera...");
+			return -EINVAL;
+	}
+
+	for (row = 0; (r == 0) && (row < rows); row++)
+	{
+		if ((r = fli_camera_usb_grab_row(dev, (unsigned short *) buff + row * width, width)) == 0)
+			*bytesgrabbed += rowsize;
+	}
+
+	return r;
+}
+
 long fli_camera_usb_stop_video_mode(flidev_t dev)
 {
   flicamdata_t *cam = DEVICE->device_data;
@@ -1861,6 +1990,9 @@ long fli_camera_usb_grab_video_frame(flidev_t dev, void *buff, size_t size)
 	}
 
 	status = 0;
+	if (cam->tdirate == 0)
+		status = fli_camera_usb_proline_fill(dev, cam->bytesleft);
+
   while ((status == 0) && (y < cam->grabrowcount))
 	{
 //		debug(FLIDEBUG_INFO, "Grabbing row %d of %d of width %d.", y, cam->grabrowcount, cam->grabrowwidth);
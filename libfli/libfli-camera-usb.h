@@ -114,6 +114,7 @@ long fli_camera_usb_cancel_exposure(flidev_t dev);
 long fli_camera_usb_set_temperature(flidev_t dev, double temperature);
 long fli_camera_usb_get_temperature(flidev_t dev, double *temperature);
 long fli_camera_usb_grab_row(flidev_t dev, void *buff, size_t width);
+long fli_camera_usb_grab_frame(flidev_t dev, void *buff, size_t buffsize, size_t *bytesgrabbed);
 long fli_camera_usb_expose_frame(flidev_t dev);
 long fli_camera_usb_flush_rows(flidev_t dev, long rows, long repeat);
 long fli_camera_usb_set_bit_depth(flidev_t dev, flibitdepth_t bitdepth);
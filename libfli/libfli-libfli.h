@@ -265,6 +265,7 @@ extern flidevdesc_t *devices[MAX_OPEN_DEVICES];
 	FLI_COMMAND(FLI_READ_EEPROM, 4) \
 	FLI_COMMAND(FLI_WRITE_EEPROM, 4) \
 	FLI_COMMAND(FLI_GET_FILTER_NAME, 3) \
+	FLI_COMMAND(FLI_GRAB_FRAME, 3) \
 
 /* Enumerate the commands */
 enum _commands {
@@ -0,0 +1,94 @@
+/*
+
+  Copyright (c) 2002 Finger Lakes Instrumentation (FLI), L.L.C.
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+        Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+        Redistributions in binary form must reproduce the above
+        copyright notice, this list of conditions and the following
+        disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+        Neither the name of Finger Lakes Instrumentation (FLI), LLC
+        nor the names of its contributors may be used to endorse or
+        promote products derived from this software without specific
+        prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+
+  ======================================================================
+
+  Finger Lakes Instrumentation, L.L.C. (FLI)
+  web: http://www.fli-cam.com
+  email: support@fli-cam.com
+
+*/
+
+#ifdef _WIN32
+#include <winsock.h>
+#else
+#include <netinet/in.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#include <arm_neon.h>
+#define FLI_SWAB_NEON
+#endif
+
+#include "libfli-swab.h"
+
+void fli_be16toh(unsigned short *dst, const unsigned short *src,
+		 size_t count, unsigned short bias)
+{
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	/* x86 is little endian, swap the two bytes of every sample */
+	const __m128i b = _mm_set1_epi16((short) bias);
+
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i v0 = _mm_loadu_si128((const __m128i *) (src + i));
+		__m128i v1 = _mm_loadu_si128((const __m128i *) (src + i + 8));
+
+		v0 = _mm_or_si128(_mm_slli_epi16(v0, 8), _mm_srli_epi16(v0, 8));
+		v1 = _mm_or_si128(_mm_slli_epi16(v1, 8), _mm_srli_epi16(v1, 8));
+
+		_mm_storeu_si128((__m128i *) (dst + i), _mm_add_epi16(v0, b));
+		_mm_storeu_si128((__m128i *) (dst + i + 8), _mm_add_epi16(v1, b));
+	}
+#elif defined(FLI_SWAB_NEON)
+	const uint16x8_t b = vdupq_n_u16(bias);
+
+	for (; i + 16 <= count; i += 16)
+	{
+		uint16x8_t v0 = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8((const uint8_t *) (src + i))));
+		uint16x8_t v1 = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8((const uint8_t *) (src + i + 8))));
+
+		vst1q_u16(dst + i, vaddq_u16(v0, b));
+		vst1q_u16(dst + i + 8, vaddq_u16(v1, b));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = (unsigned short) (ntohs(src[i]) + bias);
+}
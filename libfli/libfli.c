@@ -225,14 +225,44 @@ LIBFLIAPI FLIUsbBulkIO(flidev_t dev, int ep, void *buf, long *len)
 	return usb_bulktransfer(dev, ep, buf, len);
 }
 
+/**
+   Grab rows of an image.  This function grabs as many of the next
+   available rows of the image from camera device \texttt{dev} as fit in
+   the \texttt{buffsize} bytes pointed to by \texttt{buff}, continuing
+   where the last call to this function or \texttt{FLIGrabRow} stopped.
+   Rows are the full width of the image area, 16 bits per pixel. The
+   number of bytes placed in the buffer is returned in
+   \texttt{bytesgrabbed}, zero once the whole image has been grabbed.
+   Call it repeatedly with a part of the image buffer to follow the
+   progress of the download. On cameras that stream their image the
+   data is read with several USB transfers queued ahead.
+
+   @param dev Camera whose image to grab the next available rows from.
+
+   @param buff Pointer to where the rows will be placed.
+
+   @param buffsize Size of the buffer in bytes, at least one row.
+
+   @param bytesgrabbed Pointer to where the number of bytes grabbed
+   will be placed.
+
+   @return Zero on success.
+   @return Non-zero on failure.
+
+   @see FLIGrabRow
+   @see FLIExposeFrame
+*/
 LIBFLIAPI FLIGrabFrame(flidev_t dev, void* buff,
 		       size_t buffsize, size_t* bytesgrabbed)
 {
-  INDI_UNUSED(dev);
-  INDI_UNUSED(buff);
-  INDI_UNUSED(buffsize);
-  INDI_UNUSED(bytesgrabbed);
-	return -EINVAL;
+  CHKDEVICE(dev);
+
+  if (bytesgrabbed == NULL)
+    return -EINVAL;
+
+  *bytesgrabbed = 0;
+
+  return DEVICE->fli_command(dev, FLI_GRAB_FRAME, 3, buff, &buffsize, bytesgrabbed);
 }
 
 /**
@@ -61,6 +61,7 @@
 #define unix_usb_disconnect	libusb_usb_disconnect
 #define unix_bulktransfer	libusb_bulktransfer
 #define unix_usb_list libusb_list
+#define unix_bulkread_queued	libusb_bulkread_queued
 
 #elif defined(__FreeBSD__) || defined(__NetBSD__)
 
@@ -87,6 +88,7 @@
 #define unix_usb_disconnect	libusb_usb_disconnect
 #define unix_bulktransfer	libusb_bulktransfer
 #define unix_usb_list libusb_list
+#define unix_bulkread_queued	libusb_bulkread_queued
 
 #else
 #error "Unknown system"
@@ -100,6 +102,17 @@ long unix_usb_disconnect(flidev_t dev, fli_unixio_t *io);
 long unix_bulktransfer(flidev_t dev, int ep, void *buf, long *len);
 long unix_usb_list(char *pattern, flidomain_t domain,char ***names);
 
+#ifdef unix_bulkread_queued
+/* Called in order for every completed read of unix_bulkread_queued(),
+ * while the following reads are still in flight. A non-zero return ends
+ * the transfer early. */
+typedef long (*fli_bulkchunk_t)(void *ctx, void *buf, long len);
+
+long unix_bulkread_queued(flidev_t dev, int ep, void *buf, long *len,
+			  long xfer, int depth, fli_bulkchunk_t chunk, void *ctx);
+#define usb_bulkread_queued unix_bulkread_queued
+#endif
+
 #if defined(__APPLE__) && !defined(__LIBUSB__)
 #define usb_bulktransfer mac_bulktransfer
 #else
@@ -333,6 +333,163 @@ long libusb_bulkread(flidev_t dev, void *buf, long *rlen)
   return libusb_bulktransfer(dev, ep | LIBUSB_ENDPOINT_IN, buf, rlen);
 }
 
+#define FLIUSB_QUEUE_DEPTH_MAX (16)
+
+static void LIBUSB_CALL libusb_queued_done(struct libusb_transfer *transfer)
+{
+  *((int *) transfer->user_data) = 1;
+}
+
+static long libusb_queued_error(struct libusb_transfer *transfer)
+{
+  switch (transfer->status)
+  {
+  case LIBUSB_TRANSFER_COMPLETED:
+    return 0;
+
+  case LIBUSB_TRANSFER_TIMED_OUT:
+    return -ETIMEDOUT;
+
+  case LIBUSB_TRANSFER_NO_DEVICE:
+    return -ENODEV;
+
+  default:
+    return -EIO;
+  }
+}
+
+/* Read *len bytes from endpoint ep keeping up to depth transfers of xfer
+ * bytes queued on the device. Completed transfers are handed to chunk in
+ * order while the next ones are still in flight, so the caller can process
+ * the data without the bus going idle. Stops at the first short transfer,
+ * *len is set to the number of contiguous bytes received. */
+long libusb_bulkread_queued(flidev_t dev, int ep, void *buf, long *len,
+			    long xfer, int depth, fli_bulkchunk_t chunk, void *ctx)
+{
+  fli_unixio_t *io;
+  struct libusb_transfer *transfers[FLIUSB_QUEUE_DEPTH_MAX];
+  int done[FLIUSB_QUEUE_DEPTH_MAX];
+  unsigned int timeout;
+  long submitted = 0, received = 0, err = 0;
+  int head = 0, inflight = 0, stop = 0, i, r;
+
+  io = DEVICE->io_data;
+  timeout = (DEVICE->io_timeout < FLIUSB_MIN_TIMEOUT)?FLIUSB_MIN_TIMEOUT:DEVICE->io_timeout;
+
+  if (xfer <= 0 || xfer > USB_READ_SIZ_MAX)
+    xfer = USB_READ_SIZ_MAX;
+  if (depth < 1)
+    depth = 1;
+  if (depth > FLIUSB_QUEUE_DEPTH_MAX)
+    depth = FLIUSB_QUEUE_DEPTH_MAX;
+
+  for (i = 0; i < depth; i++)
+  {
+    if ((transfers[i] = libusb_alloc_transfer(0)) == NULL)
+    {
+      depth = i;
+      break;
+    }
+  }
+
+  if (depth == 0)
+  {
+    *len = 0;
+    return -ENOMEM;
+  }
+
+  debug(FLIDEBUG_INFO, "%s: reading %ld bytes, %d x %ld bytes queued",
+	__PRETTY_FUNCTION__, *len, depth, xfer);
+
+  while (1)
+  {
+    struct libusb_transfer *transfer;
+
+    /* Top up the queue */
+    while ((stop == 0) && (inflight < depth) && (submitted < *len))
+    {
+      int slot = (head + inflight) % depth;
+      long count = MIN(xfer, *len - submitted);
+
+      done[slot] = 0;
+      libusb_fill_bulk_transfer(transfers[slot], io->han, ep | LIBUSB_ENDPOINT_IN,
+				(unsigned char *) buf + submitted, count,
+				libusb_queued_done, &done[slot], timeout);
+
+      if ((r = libusb_submit_transfer(transfers[slot])) != 0)
+      {
+	debug(FLIDEBUG_WARN, "LibUSB Error: %s", libusb_error_name(r));
+	err = (r == LIBUSB_ERROR_NO_DEVICE) ? -ENODEV : -EIO;
+	stop = 1;
+	break;
+      }
+
+      submitted += count;
+      inflight++;
+    }
+
+    if (inflight == 0)
+      break;
+
+    /* Transfers on one endpoint complete in the order they were queued */
+    transfer = transfers[head];
+    while (done[head] == 0)
+    {
+      if ((r = libusb_handle_events_completed(NULL, &done[head])) != 0 &&
+	  r != LIBUSB_ERROR_INTERRUPTED)
+      {
+	debug(FLIDEBUG_WARN, "LibUSB Error: %s", libusb_error_name(r));
+	if (stop == 0)
+	{
+	  err = -EIO;
+	  stop = 1;
+	}
+
+	/* Make sure the transfer comes back before its memory goes away */
+	libusb_cancel_transfer(transfer);
+      }
+    }
+
+    if (stop == 0)
+    {
+      if ((err = libusb_queued_error(transfer)) != 0)
+      {
+	debug(FLIDEBUG_WARN, "LibUSB transfer failed, status %d", transfer->status);
+	stop = 1;
+      }
+      else
+      {
+	received += transfer->actual_length;
+
+	if (chunk != NULL &&
+	    chunk(ctx, (unsigned char *) buf + received - transfer->actual_length,
+		  transfer->actual_length) != 0)
+	  stop = 1;
+
+	if (transfer->actual_length < transfer->length)
+	  stop = 1;
+      }
+
+      /* Whatever is still queued can no longer land in the right place */
+      if (stop != 0)
+      {
+	for (i = 1; i < inflight; i++)
+	  libusb_cancel_transfer(transfers[(head + i) % depth]);
+      }
+    }
+
+    head = (head + 1) % depth;
+    inflight--;
+  }
+
+  for (i = 0; i < depth; i++)
+    libusb_free_transfer(transfers[i]);
+
+  *len = received;
+
+  return err;
+}
+
 long libusb_usb_disconnect(flidev_t dev,  fli_unixio_t *io)
 {
   INDI_UNUSED(dev);
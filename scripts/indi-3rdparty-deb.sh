@@ -35,6 +35,7 @@ for driver in ${DRIVER_LIST}; do
     cp -r ${INDI_SRCS}/${driver} .
     cp -r ${INDI_SRCS}/debian/${driver} debian
     cp -r ${INDI_SRCS}/cmake_modules ./
+    cp -r ${INDI_SRCS}/common ./
     fakeroot debian/rules -j$(($(nproc)+1)) binary
     popd
 done